@@ -6,27 +6,338 @@
  * numbers provided as command-line arguments. It includes robust error
  * handling for invalid input and division by zero.
  *
+ * It also evaluates whole expressions with the usual precedence, parentheses,
+ * unary minus, right-associative `^`, the functions sqrt, log, log10, exp,
+ * sin, cos, tan and abs, the constants pi and e, and variables bound with
+ * `name=value` arguments. An expression is compiled once into a compact
+ * stack bytecode, with its numbers already converted, which a small
+ * interpreter loop then runs as often as needed.
+ *
+ * With `-e`, the expression is evaluated for every row of a CSV file whose
+ * header names the variables, printing one result per line. The columns the
+ * expression reads are parsed into contiguous arrays and evaluated a block
+ * of rows at a time, split across threads for large inputs. With `--jit`,
+ * each block runs in x86-64 SSE2/AVX code generated from the bytecode.
+ *
+ * Numbers are read with Clinger's fast path or the Eisel-Lemire algorithm,
+ * falling back to strtod, and printed in the shortest form that reads back
+ * exactly (Grisu3).
+ *
+ * With `--precision=N`, the same bytecode runs over arbitrary-precision
+ * fixed-point numbers instead, giving results exact to N decimal places.
+ * Multiplication moves from the schoolbook method to Karatsuba and then
+ * Toom-3 as operands grow, and long division to a Newton reciprocal.
+ *
  * @example
  *   ./calculator 10 + 20
  *   ./calculator 5.5 '*' 2
  *   ./calculator 100 / 2.5
+ *   ./calculator '2 * (3 + 4) ^ 2'
+ *   ./calculator 'sqrt(x^2 + y^2)' x=3 y=4
+ *   ./calculator -e 'x * rate + y' --in data.csv rate=1.08
+ *   ./calculator --precision=50 '1 / 7'
  *
  * @author Gemini
  * @date 2025-07-04
  *
  ******************************************************************************/
 
+#define _POSIX_C_SOURCE 200809L // For sysconf and posix_madvise
+#define _DEFAULT_SOURCE         // For MAP_ANONYMOUS
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 #include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "threadpool.h"
+
+// --- Constants and Type Definitions ---
+
+#define EXPR_MAX_VARIABLES 64 // Variables an expression can refer to
+#define EXPR_MAX_STACK 64     // Operands an expression may have pending at once
+#define EXPR_MAX_NESTING 256  // Parentheses and operators the parser may nest
+#define EXPR_MAX_NUMBER 512   // Longest numeric literal accepted, except under --precision
+
+#define EVAL_OK 0
+#define EVAL_DIVISION_BY_ZERO 1
+#define EVAL_TOO_LARGE 2 // Exact evaluation only, from here on
+#define EVAL_FRACTIONAL_POWER 3
+#define EVAL_NEGATIVE_ROOT 4
+#define EVAL_INVALID_NUMBER 5
+
+#define BULK_BLOCK 1024                // Rows evaluated together, one operation at a time
+#define BULK_MIN_CHUNK (1024 * 1024)   // Input bytes worth handing to another thread
+#define BULK_MAX_THREADS 64
+#define BULK_OUTPUT_BUFFER (1024 * 1024)
+#define BULK_MAX_FIELD 512             // Longest numeric field accepted
+
+#define JIT_OFF 0    // Bulk evaluation runs the interpreter
+#define JIT_ON 1     // ...native code compiled from the bytecode
+#define JIT_VERIFY 2 // ...both, failing on the first row where they differ
+
+#define JIT_REGISTERS 15                    // xmm0-xmm14 hold the evaluation stack
+#define JIT_SCRATCH 15                      // xmm15 holds masks and zero tests
+#define JIT_SLOT 32                         // Bytes of spill area per stack register
+#define JIT_FRAME (JIT_REGISTERS * JIT_SLOT) // With five pushes, keeps calls 16-byte aligned
+#define JIT_RIP (-1)                        // Memory operand base: the constant pool
+
+#define POWER_OF_FIVE_MIN (-342) // Range of the 128-bit powers of five table
+#define POWER_OF_FIVE_MAX 324
+#define NUMBER_MAX_TEXT 32        // Longest text format_double writes, with its NUL
+
+#define BIG_MAX_PRECISION 100000          // Most decimal places --precision accepts
+#define BIG_MAX_BITS (1 << 25)            // Largest value exact evaluation computes, about 10 million digits
+#define BIG_KARATSUBA_THRESHOLD 40        // Limbs from which multiplication uses Karatsuba
+#define BIG_TOOM3_THRESHOLD 768           // Limbs from which multiplication uses Toom-3
+#define BIG_NEWTON_THRESHOLD 4096         // Limbs from which division uses a Newton reciprocal
+#define BIG_DIGITS_BASECASE 360           // Digits converted without splitting
+
+/**
+ * @brief The operations of the expression bytecode.
+ *
+ * Each instruction pops its operands from the evaluation stack and pushes
+ * its result; OP_CONST and OP_VAR push a constant or variable by index.
+ */
+typedef enum
+{
+    OP_CONST,
+    OP_VAR,
+    OP_ADD,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV,
+    OP_POW,
+    OP_NEG,
+    OP_SQRT,
+    OP_LOG,
+    OP_LOG10,
+    OP_EXP,
+    OP_SIN,
+    OP_COS,
+    OP_TAN,
+    OP_ABS
+} Opcode;
+
+/**
+ * @brief A single bytecode instruction.
+ */
+typedef struct
+{
+    uint16_t op;
+    uint16_t arg; // Constant or variable index, for OP_CONST and OP_VAR
+} Instruction;
+
+/**
+ * @brief A stretch of the expression's source text.
+ */
+typedef struct
+{
+    uint32_t offset;
+    uint32_t length;
+} TextSpan;
+
+/**
+ * @brief A compiled expression: postfix bytecode and its constant pool.
+ */
+typedef struct
+{
+    Instruction *code;
+    size_t length;
+    size_t capacity;
+    double *constants;
+    TextSpan *constant_text; // Exact programs only: where each constant is written in the source
+    size_t constant_count;
+    size_t constant_capacity;
+    uint64_t variables_used; // Bit i is set if variable i is read
+    int max_depth;           // Deepest the evaluation stack gets
+    int exact;               // Compiled for --precision
+} Program;
+
+/**
+ * @brief The state of the expression compiler.
+ */
+typedef struct
+{
+    const char *source;
+    const char *cursor;
+    Program *program;
+    const char *const *variables;
+    int variable_count;
+    int depth;   // Current evaluation stack depth of the emitted code
+    int nesting; // Current recursion depth of the parser
+} Parser;
+
+/**
+ * @brief A built-in function or constant the parser recognises by name.
+ */
+typedef struct
+{
+    const char *name;
+    Opcode op;
+} FunctionDef;
+
+/**
+ * @brief Native code for one bulk evaluation: evaluates `count` rows into
+ * `out` with the same contract as program_run_block.
+ */
+typedef int (*JitFunction)(const double *const *columns, size_t count, double *out);
+
+/**
+ * @brief A compiled JitFunction and the executable mapping that holds it.
+ */
+typedef struct
+{
+    JitFunction run; // NULL when the expression runs in the interpreter
+    void *memory;
+    size_t size;
+} JitCode;
+
+/**
+ * @brief Emits x86-64 machine code. With `code` NULL it only measures, so
+ * that the mapping can be sized before the real pass writes into it.
+ */
+typedef struct
+{
+    uint8_t *code;
+    size_t length;
+    size_t pool; // Offset of the constant pool, for RIP-relative operands
+    int lanes;   // Rows each instruction handles: 4 (AVX), 2 (SSE2) or 1
+    int avx;     // VEX encoding rather than legacy SSE
+} JitAssembler;
+
+/**
+ * @brief A memory operand: [base + index * 8 + disp], or pool entry `disp`
+ * when base is JIT_RIP.
+ */
+typedef struct
+{
+    int base;
+    int index; // -1 for none
+    int32_t disp;
+} JitMemory;
+
+/**
+ * @brief An expression evaluated over every row of a CSV input.
+ *
+ * Variables are the header's columns followed by the command-line bindings.
+ * Only the columns the expression reads are parsed, each into one array.
+ */
+typedef struct
+{
+    const Program *program;
+    int column_count;                     // Columns in the input's header
+    int field_map[EXPR_MAX_VARIABLES];    // Variable read from each column, or -1
+    double *columns[EXPR_MAX_VARIABLES];  // Per variable: its values, or NULL for a binding
+    double scalars[EXPR_MAX_VARIABLES];   // Per variable: the value it is bound to
+    JitCode jit;
+    int jit_mode; // JIT_OFF, JIT_ON or JIT_VERIFY
+} BulkJob;
+
+/**
+ * @brief One thread's share of a bulk evaluation: whole lines of the input.
+ */
+typedef struct
+{
+    const BulkJob *job;
+    const char *begin;
+    const char *end;
+    size_t first_row; // Index of the chunk's first row in the columns
+    size_t rows;
+    size_t error_row; // First row that failed, or SIZE_MAX
+    int error;        // BULK_ERROR_* kind for error_row
+    int error_column;
+    const char *error_field;
+    size_t error_length;
+    char *text; // The formatted results
+    size_t text_length;
+} BulkTask;
+
+#define BULK_ERROR_NONE 0
+#define BULK_ERROR_NUMBER 1  // A field is not a valid number
+#define BULK_ERROR_RANGE 2   // A field is out of range
+#define BULK_ERROR_MISSING 3 // A row has too few fields
+#define BULK_ERROR_DIVISION 4
+#define BULK_ERROR_MEMORY 5
+#define BULK_ERROR_JIT 6 // Native code and the interpreter disagree
+
+/**
+ * @brief A floating-point number with a 64-bit significand: f * 2^e.
+ */
+typedef struct
+{
+    uint64_t f;
+    int e;
+} DiyFp;
+
+/**
+ * @brief An arbitrary-precision integer: a sign and a magnitude in base
+ * 2^32 limbs, least significant first, without leading zero limbs.
+ */
+typedef struct
+{
+    uint32_t *limbs;
+    size_t length; // Zero for zero, which is never negative
+    size_t capacity;
+    int negative;
+} BigInt;
+
+static const FunctionDef FUNCTIONS[] = {
+    {"sqrt", OP_SQRT}, {"log", OP_LOG}, {"log10", OP_LOG10}, {"exp", OP_EXP},
+    {"sin", OP_SIN},   {"cos", OP_COS}, {"tan", OP_TAN},     {"abs", OP_ABS},
+};
 
 // --- Function Prototypes ---
 
 static void print_usage_and_exit(const char *prog_name);
 static double parse_double(const char *str);
 static double calculate(double num1, char op, double num2);
+static int evaluate_expression(const char *expression, int binding_count, char *bindings[]);
+static int parse_bindings(int count, char *bindings[], const char **names, double *values);
+
+// Expression Compiler
+static int program_compile(Program *program, const char *source, const char *const *variables, int variable_count, int exact);
+static void program_free(Program *program);
+static int parse_expression(Parser *parser, int min_power);
+static int parse_operand(Parser *parser);
+
+// Bytecode Interpreter
+static int program_run(const Program *program, const double *variables, double *result);
+static int program_run_block(const Program *program, const double *const *columns, const double *scalars,
+                             size_t count, double *stack, double *out);
+
+// Native Code Generation
+static int jit_compile(JitCode *jit, const Program *program, int column_count, const double *scalars);
+static void jit_free(JitCode *jit);
+
+// Number Conversion
+static int parse_decimal(const char *begin, const char *end, double *value);
+static char *format_double(double value, char *out);
+
+// Bulk Evaluation
+static int bulk_evaluate(const char *expression, const char *input, int thread_count, int jit_mode, int binding_count,
+                         char *bindings[]);
+
+// Exact Arithmetic
+static void big_add(BigInt *r, const BigInt *a, const BigInt *b);
+static void big_sub(BigInt *r, const BigInt *a, const BigInt *b);
+static void big_mul(BigInt *r, const BigInt *a, const BigInt *b);
+static void big_shift_left(BigInt *r, const BigInt *a, size_t bits);
+static void big_shift_right(BigInt *r, const BigInt *a, size_t bits);
+static uint32_t big_div_small(BigInt *x, uint32_t divisor);
+static void mpn_mul(uint32_t *r, const uint32_t *a, size_t an, const uint32_t *b, size_t bn);
+static void mpn_mul_n(uint32_t *r, const uint32_t *a, const uint32_t *b, size_t n);
+
+// Exact Evaluation
+static int evaluate_exact(const char *expression, int scale, int binding_count, char *bindings[]);
 
 // --- Main Application Logic ---
 
@@ -41,12 +352,90 @@ static double calculate(double num1, char op, double num2);
  */
 int main(int argc, char *argv[])
 {
-    // Validate the number of command-line arguments.
-    if (argc != 4)
+    if (argc < 2)
     {
         print_usage_and_exit(argv[0]);
     }
 
+    if (strcmp(argv[1], "-e") == 0)
+    {
+        if (argc < 3)
+        {
+            print_usage_and_exit(argv[0]);
+        }
+        const char *input = NULL;
+        int thread_count = 0;
+        int jit_mode = JIT_OFF;
+        int first_binding = 3;
+        while (first_binding < argc)
+        {
+            if (strcmp(argv[first_binding], "--jit") == 0 || strcmp(argv[first_binding], "--jit=verify") == 0)
+            {
+                jit_mode = argv[first_binding][5] == '\0' ? JIT_ON : JIT_VERIFY;
+                first_binding++;
+                continue;
+            }
+            if (first_binding + 1 == argc || (strcmp(argv[first_binding], "--in") != 0 && strcmp(argv[first_binding], "--threads") != 0))
+            {
+                break;
+            }
+            if (strcmp(argv[first_binding], "--in") == 0)
+            {
+                input = argv[first_binding + 1];
+            }
+            else
+            {
+                const double threads = parse_double(argv[first_binding + 1]);
+                if (threads < 1 || threads > BULK_MAX_THREADS || threads != (int)threads)
+                {
+                    fprintf(stderr, "Error: Thread count must be a whole number from 1 to %d.\n", BULK_MAX_THREADS);
+                    return EXIT_FAILURE;
+                }
+                thread_count = (int)threads;
+            }
+            first_binding += 2;
+        }
+        const int status = bulk_evaluate(argv[2], input, thread_count, jit_mode, argc - first_binding, argv + first_binding);
+        return status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (strncmp(argv[1], "--precision=", 12) == 0)
+    {
+        const double places = parse_double(argv[1] + 12);
+        if (places < 0 || places > BIG_MAX_PRECISION || places != (int)places)
+        {
+            fprintf(stderr, "Error: Precision must be a whole number of decimal places from 0 to %d.\n", BIG_MAX_PRECISION);
+            return EXIT_FAILURE;
+        }
+        if (argc < 3)
+        {
+            print_usage_and_exit(argv[0]);
+        }
+        if (argc != 5 || strchr(argv[3], '=') != NULL)
+        {
+            return evaluate_exact(argv[2], (int)places, argc - 3, argv + 3) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        // The classic form, evaluated as the expression it spells.
+        const size_t length = strlen(argv[2]) + strlen(argv[3]) + strlen(argv[4]) + 3;
+        char *expression = (char *)malloc(length);
+        if (expression == NULL)
+        {
+            perror("Failed to allocate memory for the expression");
+            return EXIT_FAILURE;
+        }
+        snprintf(expression, length, "%s %s %s", argv[2], argv[3], argv[4]);
+        const int status = evaluate_exact(expression, (int)places, 0, NULL);
+        free(expression);
+        return status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Anything but the classic `<number> <operator> <number>` form is an
+    // expression followed by its variable bindings.
+    if (argc != 4 || strchr(argv[2], '=') != NULL)
+    {
+        return evaluate_expression(argv[1], argc - 2, argv + 2) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
     // The operator should be a single character.
     if (strlen(argv[2]) != 1)
     {
@@ -61,8 +450,12 @@ int main(int argc, char *argv[])
     // Perform the calculation.
     const double result = calculate(num1, operator, num2);
 
-    // Print the result with user-friendly formatting.
-    printf("Result: %g %c %g = %g\n", num1, operator, num2, result);
+    // Print each number in the fewest digits that still read back exactly.
+    char text1[NUMBER_MAX_TEXT], text2[NUMBER_MAX_TEXT], result_text[NUMBER_MAX_TEXT];
+    format_double(num1, text1);
+    format_double(num2, text2);
+    format_double(result, result_text);
+    printf("Result: %s %c %s = %s\n", text1, operator, text2, result_text);
 
     return EXIT_SUCCESS;
 }
@@ -77,13 +470,28 @@ int main(int argc, char *argv[])
 static void print_usage_and_exit(const char *prog_name)
 {
     fprintf(stderr, "Usage: %s <number1> <operator> <number2>\n", prog_name);
+    fprintf(stderr, "       %s <expression> [name=value ...]\n", prog_name);
+    fprintf(stderr, "       %s -e <expression> [--in file.csv] [--threads N] [--jit[=verify]] [name=value ...]\n", prog_name);
+    fprintf(stderr, "       %s --precision=N <expression> [name=value ...]\n", prog_name);
     fprintf(stderr, "  A simple command-line calculator.\n\n");
     fprintf(stderr, "Arguments:\n");
     fprintf(stderr, "  number1    The first number (integer or floating-point).\n");
     fprintf(stderr, "  operator   One of the supported arithmetic operators: +, -, *, /.\n");
-    fprintf(stderr, "  number2    The second number (integer or floating-point).\n\n");
-    fprintf(stderr, "Example:\n");
+    fprintf(stderr, "  number2    The second number (integer or floating-point).\n");
+    fprintf(stderr, "  expression An expression using numbers, variables, + - * / ^, parentheses,\n");
+    fprintf(stderr, "             the functions sqrt log log10 exp sin cos tan abs, and pi and e.\n");
+    fprintf(stderr, "  name=value Binds a variable used in the expression.\n\n");
+    fprintf(stderr, "With -e, the expression is evaluated for each row of a CSV file (or stdin) whose\n");
+    fprintf(stderr, "header row names its columns, and one result is printed per row. --jit compiles the\n");
+    fprintf(stderr, "expression to native code first; --jit=verify also runs the interpreter and checks\n");
+    fprintf(stderr, "that every result matches.\n\n");
+    fprintf(stderr, "With --precision=N, the expression is evaluated exactly to N decimal places (0 for\n");
+    fprintf(stderr, "whole numbers of any size), truncating; only + - * / ^, sqrt and abs are allowed.\n\n");
+    fprintf(stderr, "Examples:\n");
     fprintf(stderr, "  %s 10.5 \"*\" 2\n", prog_name);
+    fprintf(stderr, "  %s \"sqrt(x^2 + y^2)\" x=3 y=4\n", prog_name);
+    fprintf(stderr, "  %s -e \"x * 1.08 + y\" --in data.csv\n", prog_name);
+    fprintf(stderr, "  %s --precision=0 \"2 ^ 521 - 1\"\n", prog_name);
     exit(EXIT_FAILURE);
 }
 
@@ -99,10 +507,18 @@ static void print_usage_and_exit(const char *prog_name)
  */
 static double parse_double(const char *str)
 {
+    // Plain decimals take the fast path; anything it rejects is converted
+    // again below, so that strtod decides the errors as it always has.
+    double value;
+    if (parse_decimal(str, str + strlen(str), &value) == 0)
+    {
+        return value;
+    }
+
     char *endptr;
     errno = 0; // Reset errno before the call.
 
-    const double value = strtod(str, &endptr);
+    value = strtod(str, &endptr);
 
     // Check for various conversion errors.
     if (endptr == str)
@@ -154,3 +570,3589 @@ static double calculate(double num1, char op, double num2)
         exit(EXIT_FAILURE);
     }
 }
+
+/**
+ * @brief Compiles and evaluates an expression, then prints its result.
+ *
+ * @param expression The expression to evaluate.
+ * @param binding_count The number of `name=value` bindings.
+ * @param bindings The bindings for the variables of the expression.
+ * @return 0 on success, -1 on error (after printing a message).
+ */
+static int evaluate_expression(const char *expression, int binding_count, char *bindings[])
+{
+    const char *names[EXPR_MAX_VARIABLES];
+    double values[EXPR_MAX_VARIABLES];
+    if (parse_bindings(binding_count, bindings, names, values) != 0)
+    {
+        return -1;
+    }
+
+    Program program;
+    if (program_compile(&program, expression, names, binding_count, 0) != 0)
+    {
+        return -1; // Error message printed by the compiler
+    }
+    double result;
+    const int status = program_run(&program, values, &result);
+    program_free(&program);
+    if (status == EVAL_DIVISION_BY_ZERO)
+    {
+        fprintf(stderr, "Error: Division by zero is not allowed.\n");
+        return -1;
+    }
+    char text[NUMBER_MAX_TEXT];
+    format_double(result, text);
+    printf("Result: %s = %s\n", expression, text);
+    return 0;
+}
+
+/**
+ * @brief Splits `name=value` arguments into variable names and values.
+ *
+ * @param count The number of bindings; at most EXPR_MAX_VARIABLES.
+ * @return 0 on success, -1 on error (after printing a message).
+ */
+static int parse_bindings(int count, char *bindings[], const char **names, double *values)
+{
+    if (count > EXPR_MAX_VARIABLES)
+    {
+        fprintf(stderr, "Error: Too many variables; at most %d can be bound.\n", EXPR_MAX_VARIABLES);
+        return -1;
+    }
+    for (int i = 0; i < count; ++i)
+    {
+        char *equals = strchr(bindings[i], '=');
+        if (equals == NULL || equals == bindings[i])
+        {
+            fprintf(stderr, "Error: Invalid binding '%s'. Expected name=value.\n", bindings[i]);
+            return -1;
+        }
+        *equals = '\0';
+        names[i] = bindings[i];
+        values[i] = parse_double(equals + 1);
+    }
+    return 0;
+}
+
+// --- Expression Compiler ---
+
+/**
+ * @brief Prints a compile error pointing at the parser's current position.
+ * @return -1, for the caller to return.
+ */
+static int parse_error(const Parser *parser, const char *message)
+{
+    const size_t column = (size_t)(parser->cursor - parser->source);
+    fprintf(stderr, "Error: %s at position %zu of the expression.\n", message, column + 1);
+    fprintf(stderr, "  %s\n  %*s^\n", parser->source, (int)column, "");
+    return -1;
+}
+
+static void skip_spaces(Parser *parser)
+{
+    while (isspace((unsigned char)*parser->cursor))
+        parser->cursor++;
+}
+
+/**
+ * @brief Appends an instruction and tracks the stack depth it leaves.
+ * @param effect How many operands the instruction adds to the stack.
+ */
+static int emit(Parser *parser, Opcode op, uint16_t arg, int effect)
+{
+    Program *program = parser->program;
+    if (program->length == program->capacity)
+    {
+        const size_t capacity = program->capacity ? program->capacity * 2 : 16;
+        Instruction *code = (Instruction *)realloc(program->code, capacity * sizeof(Instruction));
+        if (code == NULL)
+        {
+            perror("Failed to allocate memory for the expression");
+            return -1;
+        }
+        program->code = code;
+        program->capacity = capacity;
+    }
+    program->code[program->length++] = (Instruction){(uint16_t)op, arg};
+    parser->depth += effect;
+    if (parser->depth > EXPR_MAX_STACK)
+        return parse_error(parser, "Expression is too complex");
+    if (parser->depth > program->max_depth)
+        program->max_depth = parser->depth;
+    return 0;
+}
+
+/**
+ * @brief Adds a constant to the pool and pushes it.
+ * @param text The constant as written, which exact programs evaluate.
+ */
+static int emit_constant(Parser *parser, double value, const char *text, size_t length)
+{
+    Program *program = parser->program;
+    if (program->constant_count == UINT16_MAX + 1u)
+        return parse_error(parser, "Too many numbers");
+    if (program->constant_count == program->constant_capacity)
+    {
+        const size_t capacity = program->constant_capacity ? program->constant_capacity * 2 : 8;
+        double *constants = (double *)realloc(program->constants, capacity * sizeof(double));
+        if (constants == NULL)
+        {
+            perror("Failed to allocate memory for the expression");
+            return -1;
+        }
+        program->constants = constants;
+        if (program->exact)
+        {
+            TextSpan *spans = (TextSpan *)realloc(program->constant_text, capacity * sizeof(TextSpan));
+            if (spans == NULL)
+            {
+                perror("Failed to allocate memory for the expression");
+                return -1;
+            }
+            program->constant_text = spans;
+        }
+        program->constant_capacity = capacity;
+    }
+    program->constants[program->constant_count] = value;
+    if (program->exact)
+        program->constant_text[program->constant_count] = (TextSpan){(uint32_t)(text - parser->source), (uint32_t)length};
+    return emit(parser, OP_CONST, (uint16_t)program->constant_count++, 1);
+}
+
+/**
+ * @brief Scans a decimal literal such as `12`, `.5` or `6.02e23` and adds
+ * its value to the constant pool.
+ *
+ * Exact programs take literals of any length: they keep only the text,
+ * which program_run_exact reads straight into a BigInt, so results can be
+ * fed back in. Literals for double evaluation are capped at EXPR_MAX_NUMBER.
+ */
+static int parse_number(Parser *parser)
+{
+    const char *start = parser->cursor, *p = start;
+    while (isdigit((unsigned char)*p))
+        p++;
+    if (*p == '.')
+    {
+        p++;
+        while (isdigit((unsigned char)*p))
+            p++;
+    }
+    if (p == start + 1 && *start == '.')
+        return parse_error(parser, "Invalid number");
+    if ((*p == 'e' || *p == 'E') &&
+        (isdigit((unsigned char)p[1]) || ((p[1] == '+' || p[1] == '-') && isdigit((unsigned char)p[2]))))
+    {
+        p += 2;
+        while (isdigit((unsigned char)*p))
+            p++;
+    }
+    const size_t length = (size_t)(p - start);
+    double value = 0.0; // Exact programs never read it
+    if (!parser->program->exact)
+    {
+        if (length >= EXPR_MAX_NUMBER)
+            return parse_error(parser, "Number is too long");
+        if (parse_decimal(start, p, &value) == BULK_ERROR_RANGE)
+        {
+            fprintf(stderr, "Error: Number '%.*s' is out of the representable range.\n", (int)length, start);
+            return -1;
+        }
+    }
+    parser->cursor = p;
+    return emit_constant(parser, value, start, length);
+}
+
+/**
+ * @brief Parses a variable, a named constant, or a function call.
+ */
+static int parse_name(Parser *parser)
+{
+    const char *start = parser->cursor;
+    while (isalnum((unsigned char)*parser->cursor) || *parser->cursor == '_')
+        parser->cursor++;
+    const size_t length = (size_t)(parser->cursor - start);
+
+    for (int i = 0; i < parser->variable_count; ++i)
+    {
+        if (strlen(parser->variables[i]) == length && strncmp(parser->variables[i], start, length) == 0)
+        {
+            parser->program->variables_used |= (uint64_t)1 << i;
+            return emit(parser, OP_VAR, (uint16_t)i, 1);
+        }
+    }
+    const int is_pi = length == 2 && strncmp(start, "pi", 2) == 0;
+    if ((is_pi || (length == 1 && *start == 'e')) && parser->program->exact)
+    {
+        parser->cursor = start;
+        return parse_error(parser, "Constant has no exact value");
+    }
+    if (is_pi)
+        return emit_constant(parser, 3.14159265358979323846, NULL, 0);
+    if (length == 1 && *start == 'e')
+        return emit_constant(parser, 2.71828182845904523536, NULL, 0);
+
+    for (size_t f = 0; f < sizeof(FUNCTIONS) / sizeof(FUNCTIONS[0]); ++f)
+    {
+        if (strlen(FUNCTIONS[f].name) != length || strncmp(FUNCTIONS[f].name, start, length) != 0)
+            continue;
+        if (parser->program->exact && FUNCTIONS[f].op != OP_SQRT && FUNCTIONS[f].op != OP_ABS)
+        {
+            parser->cursor = start;
+            return parse_error(parser, "Function has no exact value");
+        }
+        skip_spaces(parser);
+        if (*parser->cursor != '(')
+            return parse_error(parser, "Expected '(' after function name");
+        parser->cursor++;
+        if (parse_expression(parser, 0) != 0)
+            return -1;
+        skip_spaces(parser);
+        if (*parser->cursor != ')')
+            return parse_error(parser, "Expected ')'");
+        parser->cursor++;
+        return emit(parser, FUNCTIONS[f].op, 0, 0);
+    }
+
+    parser->cursor = start;
+    fprintf(stderr, "Error: Unknown variable or function '%.*s'.\n", (int)length, start);
+    return -1;
+}
+
+/**
+ * @brief Parses a number, name, parenthesised expression or unary sign.
+ */
+static int parse_operand(Parser *parser)
+{
+    skip_spaces(parser);
+    const char c = *parser->cursor;
+    if (isdigit((unsigned char)c) || c == '.')
+        return parse_number(parser);
+    if (isalpha((unsigned char)c) || c == '_')
+        return parse_name(parser);
+    if (c == '(')
+    {
+        parser->cursor++;
+        if (parse_expression(parser, 0) != 0)
+            return -1;
+        skip_spaces(parser);
+        if (*parser->cursor != ')')
+            return parse_error(parser, "Expected ')'");
+        parser->cursor++;
+        return 0;
+    }
+    if (c == '-' || c == '+')
+    {
+        // Binds looser than `^`, so -2^2 is -(2^2), but tighter than `*`.
+        parser->cursor++;
+        if (parse_expression(parser, 30) != 0)
+            return -1;
+        return c == '-' ? emit(parser, OP_NEG, 0, 0) : 0;
+    }
+    return parse_error(parser, c == '\0' ? "Unexpected end" : "Unexpected character");
+}
+
+/**
+ * @brief Parses operators binding tighter than `min_power` (Pratt parsing),
+ * emitting the bytecode for the operands before each operator.
+ */
+static int parse_expression(Parser *parser, int min_power)
+{
+    if (++parser->nesting > EXPR_MAX_NESTING)
+        return parse_error(parser, "Expression is nested too deeply");
+    if (parse_operand(parser) != 0)
+        return -1;
+    for (;;)
+    {
+        skip_spaces(parser);
+        Opcode op;
+        int left, right; // Binding powers: left < right for left-associative operators
+        switch (*parser->cursor)
+        {
+        case '+':
+            op = OP_ADD, left = 10, right = 11;
+            break;
+        case '-':
+            op = OP_SUB, left = 10, right = 11;
+            break;
+        case '*':
+            op = OP_MUL, left = 20, right = 21;
+            break;
+        case '/':
+            op = OP_DIV, left = 20, right = 21;
+            break;
+        case '^':
+            op = OP_POW, left = 40, right = 39;
+            break;
+        default:
+            parser->nesting--;
+            return 0;
+        }
+        if (left < min_power)
+        {
+            parser->nesting--;
+            return 0;
+        }
+        parser->cursor++;
+        if (parse_expression(parser, right) != 0 || emit(parser, op, 0, -1) != 0)
+            return -1;
+    }
+}
+
+/**
+ * @brief Compiles `source` into bytecode.
+ *
+ * @param variables The names of the variables the expression may use; the
+ * bytecode refers to them by their index in this array.
+ * @param exact Compile for program_run_exact: keep each number's text,
+ * allow numbers outside double range and reject inexact functions.
+ * @return 0 on success, -1 on error (after printing a message).
+ */
+static int program_compile(Program *program, const char *source, const char *const *variables, int variable_count, int exact)
+{
+    memset(program, 0, sizeof(*program));
+    program->exact = exact;
+    if (variable_count > EXPR_MAX_VARIABLES)
+    {
+        fprintf(stderr, "Error: Too many variables; at most %d are supported.\n", EXPR_MAX_VARIABLES);
+        return -1;
+    }
+    Parser parser = {source, source, program, variables, variable_count, 0, 0};
+    if (parse_expression(&parser, 0) != 0)
+    {
+        program_free(program);
+        return -1;
+    }
+    skip_spaces(&parser);
+    if (*parser.cursor != '\0')
+    {
+        parse_error(&parser, "Unexpected character");
+        program_free(program);
+        return -1;
+    }
+    return 0;
+}
+
+static void program_free(Program *program)
+{
+    free(program->code);
+    free(program->constants);
+    free(program->constant_text);
+    memset(program, 0, sizeof(*program));
+}
+
+// --- Bytecode Interpreter ---
+
+/**
+ * @brief Runs a compiled expression.
+ *
+ * @param variables The values of the variables, by index.
+ * @param result Receives the value of the expression.
+ * @return EVAL_OK, or EVAL_DIVISION_BY_ZERO if a divisor was zero.
+ */
+static int program_run(const Program *program, const double *variables, double *result)
+{
+    double stack[EXPR_MAX_STACK];
+    double *top = stack - 1; // The compiler guarantees the stack never under- or overflows
+    const double *constants = program->constants;
+    const Instruction *end = program->code + program->length;
+    for (const Instruction *ip = program->code; ip != end; ++ip)
+    {
+        switch ((Opcode)ip->op)
+        {
+        case OP_CONST:
+            *++top = constants[ip->arg];
+            break;
+        case OP_VAR:
+            *++top = variables[ip->arg];
+            break;
+        case OP_ADD:
+            top[-1] += top[0];
+            top--;
+            break;
+        case OP_SUB:
+            top[-1] -= top[0];
+            top--;
+            break;
+        case OP_MUL:
+            top[-1] *= top[0];
+            top--;
+            break;
+        case OP_DIV:
+            if (top[0] == 0)
+                return EVAL_DIVISION_BY_ZERO;
+            top[-1] /= top[0];
+            top--;
+            break;
+        case OP_POW:
+            top[-1] = pow(top[-1], top[0]);
+            top--;
+            break;
+        case OP_NEG:
+            top[0] = -top[0];
+            break;
+        case OP_SQRT:
+            top[0] = sqrt(top[0]);
+            break;
+        case OP_LOG:
+            top[0] = log(top[0]);
+            break;
+        case OP_LOG10:
+            top[0] = log10(top[0]);
+            break;
+        case OP_EXP:
+            top[0] = exp(top[0]);
+            break;
+        case OP_SIN:
+            top[0] = sin(top[0]);
+            break;
+        case OP_COS:
+            top[0] = cos(top[0]);
+            break;
+        case OP_TAN:
+            top[0] = tan(top[0]);
+            break;
+        case OP_ABS:
+            top[0] = fabs(top[0]);
+            break;
+        }
+    }
+    *result = top[0];
+    return EVAL_OK;
+}
+
+/**
+ * @brief Runs a compiled expression over `count` rows (at most BULK_BLOCK)
+ * at once, one operation at a time, so that each step is a simple loop the
+ * compiler can vectorize.
+ *
+ * @param columns Per variable, its values for these rows, or NULL to use
+ * the variable's entry in `scalars` for every row.
+ * @param stack Scratch space for max_depth * BULK_BLOCK values.
+ * @param out Receives the value of the expression for each row.
+ * @return EVAL_OK, or EVAL_DIVISION_BY_ZERO if a divisor was zero in any row.
+ */
+static int program_run_block(const Program *program, const double *const *columns, const double *scalars,
+                             size_t count, double *stack, double *out)
+{
+    double *top = stack - BULK_BLOCK;
+    const Instruction *end = program->code + program->length;
+    for (const Instruction *ip = program->code; ip != end; ++ip)
+    {
+        double *restrict a = top - BULK_BLOCK; // Left operand of a binary operation
+        double *restrict b = top;
+        switch ((Opcode)ip->op)
+        {
+        case OP_CONST:
+        case OP_VAR:
+        {
+            top += BULK_BLOCK;
+            const double *column = ip->op == OP_VAR ? columns[ip->arg] : NULL;
+            if (column != NULL)
+            {
+                memcpy(top, column, count * sizeof(double));
+            }
+            else
+            {
+                const double value = ip->op == OP_VAR ? scalars[ip->arg] : program->constants[ip->arg];
+                for (size_t i = 0; i < count; ++i)
+                    top[i] = value;
+            }
+            continue;
+        }
+        case OP_ADD:
+            for (size_t i = 0; i < count; ++i)
+                a[i] += b[i];
+            break;
+        case OP_SUB:
+            for (size_t i = 0; i < count; ++i)
+                a[i] -= b[i];
+            break;
+        case OP_MUL:
+            for (size_t i = 0; i < count; ++i)
+                a[i] *= b[i];
+            break;
+        case OP_DIV:
+        {
+            int zero = 0;
+            for (size_t i = 0; i < count; ++i)
+                zero |= b[i] == 0;
+            if (zero)
+                return EVAL_DIVISION_BY_ZERO;
+            for (size_t i = 0; i < count; ++i)
+                a[i] /= b[i];
+            break;
+        }
+        case OP_POW:
+            for (size_t i = 0; i < count; ++i)
+                a[i] = pow(a[i], b[i]);
+            break;
+        case OP_NEG:
+            for (size_t i = 0; i < count; ++i)
+                b[i] = -b[i];
+            continue;
+        case OP_SQRT:
+            for (size_t i = 0; i < count; ++i)
+                b[i] = sqrt(b[i]);
+            continue;
+        case OP_LOG:
+            for (size_t i = 0; i < count; ++i)
+                b[i] = log(b[i]);
+            continue;
+        case OP_LOG10:
+            for (size_t i = 0; i < count; ++i)
+                b[i] = log10(b[i]);
+            continue;
+        case OP_EXP:
+            for (size_t i = 0; i < count; ++i)
+                b[i] = exp(b[i]);
+            continue;
+        case OP_SIN:
+            for (size_t i = 0; i < count; ++i)
+                b[i] = sin(b[i]);
+            continue;
+        case OP_COS:
+            for (size_t i = 0; i < count; ++i)
+                b[i] = cos(b[i]);
+            continue;
+        case OP_TAN:
+            for (size_t i = 0; i < count; ++i)
+                b[i] = tan(b[i]);
+            continue;
+        case OP_ABS:
+            for (size_t i = 0; i < count; ++i)
+                b[i] = fabs(b[i]);
+            continue;
+        }
+        top -= BULK_BLOCK; // A binary operation consumed its right operand
+    }
+    memcpy(out, top, count * sizeof(double));
+    return EVAL_OK;
+}
+
+// --- Native Code Generation ---
+
+/*
+ * With `-e --jit`, the bytecode is translated once into an x86-64 function
+ * that evaluates several rows per instruction: four with AVX when the CPU
+ * has it, otherwise two with SSE2, and the last few rows one at a time. The
+ * evaluation stack lives in registers, constants and bindings in a pool
+ * after the code, and the library functions are called a lane at a time.
+ * A division ORs a zero test of its divisor into rbp, so that the function
+ * reports EVAL_DIVISION_BY_ZERO exactly when program_run_block would, and
+ * the caller finds the failing row the same way.
+ */
+#if defined(__x86_64__)
+
+enum
+{
+    RAX = 0,
+    RCX = 1,
+    RDX = 2,
+    RBX = 3, // Current row
+    RSP = 4,
+    RBP = 5, // Zero-divisor flags
+    RSI = 6,
+    RDI = 7,
+    R12 = 12, // The column pointers
+    R13 = 13, // The output
+    R14 = 14  // The row count
+};
+
+// Set to 0 to use SSE2 even where AVX is available, to exercise or time both.
+static int jit_use_avx = 1;
+
+static void jit_byte(JitAssembler *as, unsigned value)
+{
+    if (as->code != NULL)
+        as->code[as->length] = (uint8_t)value;
+    as->length++;
+}
+
+static void jit_u32(JitAssembler *as, uint32_t value)
+{
+    for (int i = 0; i < 32; i += 8)
+        jit_byte(as, (value >> i) & 0xFF);
+}
+
+static void jit_u64(JitAssembler *as, uint64_t value)
+{
+    jit_u32(as, (uint32_t)value);
+    jit_u32(as, (uint32_t)(value >> 32));
+}
+
+/**
+ * @brief The REX.R, REX.X and REX.B bits (VEX stores them inverted) for
+ * register `reg` and register `rm` or memory operand `mem`.
+ */
+static unsigned jit_extension(int reg, int rm, const JitMemory *mem)
+{
+    const int index = mem != NULL && mem->index >= 0 ? mem->index : 0;
+    const int base = mem != NULL ? (mem->base == JIT_RIP ? 0 : mem->base) : rm;
+    return (unsigned)((reg >> 3) << 2 | (index >> 3) << 1 | base >> 3);
+}
+
+/**
+ * @brief Emits the ModRM byte, and any SIB byte and displacement, for
+ * register `reg` and register `rm` or memory operand `mem`. Instructions
+ * that address the pool must end with the displacement.
+ */
+static void jit_operand(JitAssembler *as, int reg, int rm, const JitMemory *mem)
+{
+    reg &= 7;
+    if (mem == NULL)
+    {
+        jit_byte(as, 0xC0 | (unsigned)reg << 3 | (rm & 7));
+        return;
+    }
+    if (mem->base == JIT_RIP)
+    {
+        jit_byte(as, 0x05 | (unsigned)reg << 3);
+        const size_t target = as->pool + (size_t)mem->disp * JIT_SLOT;
+        jit_u32(as, (uint32_t)(target - (as->length + 4)));
+        return;
+    }
+    if (mem->index >= 0 || (mem->base & 7) == RSP)
+    {
+        jit_byte(as, 0x84 | (unsigned)reg << 3);
+        jit_byte(as, (mem->index >= 0 ? 3u << 6 | (unsigned)(mem->index & 7) << 3 : 4u << 3) | (mem->base & 7));
+    }
+    else
+    {
+        jit_byte(as, 0x80 | (unsigned)reg << 3 | (mem->base & 7));
+    }
+    jit_u32(as, (uint32_t)mem->disp);
+}
+
+/**
+ * @brief Emits a 64-bit integer instruction `opcode` with operands `reg`
+ * and `rm` (or `mem`). For the group opcodes, `reg` is the extension.
+ */
+static void jit_integer(JitAssembler *as, unsigned opcode, int reg, int rm, const JitMemory *mem)
+{
+    jit_byte(as, 0x48 | jit_extension(reg, rm, mem));
+    jit_byte(as, opcode);
+    jit_operand(as, reg, rm, mem);
+}
+
+/**
+ * @brief Emits the SSE2 or AVX instruction 0F `opcode` with the mandatory
+ * `prefix` (0x66 for packed, 0xF2 for scalar double).
+ *
+ * `source` is the first source of the three-operand AVX form and must equal
+ * `reg` for SSE2; pass 0 where the instruction has none. `wide` selects
+ * 256-bit registers under AVX.
+ */
+static void jit_vector(JitAssembler *as, unsigned prefix, unsigned opcode, int reg, int source, int rm,
+                       const JitMemory *mem, int wide)
+{
+    const unsigned extension = jit_extension(reg, rm, mem);
+    if (as->avx)
+    {
+        const unsigned pp = prefix == 0x66 ? 1 : 3;
+        jit_byte(as, 0xC4);
+        jit_byte(as, (~extension & 7) << 5 | 0x01);
+        jit_byte(as, (~(unsigned)source & 15) << 3 | (wide ? 1u << 2 : 0) | pp);
+    }
+    else
+    {
+        jit_byte(as, prefix);
+        if (extension != 0)
+            jit_byte(as, 0x40 | extension);
+        jit_byte(as, 0x0F);
+    }
+    jit_byte(as, opcode);
+    jit_operand(as, reg, rm, mem);
+}
+
+static void jit_load(JitAssembler *as, int reg, const JitMemory *mem)
+{
+    jit_vector(as, as->lanes > 1 ? 0x66 : 0xF2, 0x10, reg, 0, 0, mem, as->lanes == 4);
+}
+
+static void jit_store(JitAssembler *as, int reg, const JitMemory *mem)
+{
+    jit_vector(as, as->lanes > 1 ? 0x66 : 0xF2, 0x11, reg, 0, 0, mem, as->lanes == 4);
+}
+
+/**
+ * @brief Emits reg = reg `opcode` rm for an arithmetic opcode (add, sub,
+ * mul, div), on as many lanes as the current pass handles.
+ */
+static void jit_arithmetic(JitAssembler *as, unsigned opcode, int reg, int rm)
+{
+    jit_vector(as, as->lanes > 1 ? 0x66 : 0xF2, opcode, reg, reg, rm, NULL, as->lanes == 4);
+}
+
+/**
+ * @brief Emits reg = reg `opcode` rm for a bitwise opcode (and, or, xor),
+ * which has no scalar form; the unused lanes of the tail do not matter.
+ */
+static void jit_bitwise(JitAssembler *as, unsigned opcode, int reg, int rm)
+{
+    jit_vector(as, 0x66, opcode, reg, reg, rm, NULL, as->lanes == 4);
+}
+
+static void jit_vzeroupper(JitAssembler *as)
+{
+    if (as->avx)
+    {
+        jit_byte(as, 0xC5);
+        jit_byte(as, 0xF8);
+        jit_byte(as, 0x77);
+    }
+}
+
+/**
+ * @brief Emits a jump (`condition` 0 for unconditional) and returns the
+ * offset of its displacement, for jit_patch.
+ */
+static size_t jit_jump(JitAssembler *as, unsigned condition)
+{
+    if (condition != 0)
+    {
+        jit_byte(as, 0x0F);
+        jit_byte(as, condition);
+    }
+    else
+    {
+        jit_byte(as, 0xE9);
+    }
+    jit_u32(as, 0);
+    return as->length - 4;
+}
+
+static void jit_patch(JitAssembler *as, size_t at, size_t target)
+{
+    if (as->code != NULL)
+    {
+        const uint32_t displacement = (uint32_t)(target - (at + 4));
+        memcpy(as->code + at, &displacement, sizeof(displacement));
+    }
+}
+
+/**
+ * @brief Emits a call of `function` on each lane of the `arity` operands
+ * on top of a stack `depth` deep, leaving the results in their place.
+ *
+ * The calls clobber every vector register, so the whole stack goes through
+ * the spill area on the way.
+ */
+static void jit_call(JitAssembler *as, uintptr_t function, int depth, int arity)
+{
+    const int first = depth - arity;
+    for (int slot = 0; slot < depth; ++slot)
+        jit_store(as, slot, &(JitMemory){RSP, -1, slot * JIT_SLOT});
+    jit_vzeroupper(as); // The library is compiled for SSE
+    const int lanes = as->lanes;
+    as->lanes = 1;
+    for (int lane = 0; lane < lanes; ++lane)
+    {
+        for (int a = 0; a < arity; ++a)
+            jit_load(as, a, &(JitMemory){RSP, -1, (first + a) * JIT_SLOT + lane * 8});
+        jit_byte(as, 0x48); // mov rax, function
+        jit_byte(as, 0xB8);
+        jit_u64(as, (uint64_t)function);
+        jit_byte(as, 0xFF); // call rax
+        jit_byte(as, 0xD0);
+        jit_store(as, 0, &(JitMemory){RSP, -1, first * JIT_SLOT + lane * 8});
+    }
+    as->lanes = lanes;
+    for (int slot = 0; slot <= first; ++slot)
+        jit_load(as, slot, &(JitMemory){RSP, -1, slot * JIT_SLOT});
+}
+
+/**
+ * @brief Emits the evaluation of one group of `as->lanes` rows, from row
+ * rbx, leaving the results in xmm0.
+ */
+static void jit_body(JitAssembler *as, const Program *program, int column_count)
+{
+    const int pool_scalars = (int)program->constant_count;
+    const int pool_sign = pool_scalars + EXPR_MAX_VARIABLES;
+    const int pool_magnitude = pool_sign + 1;
+    int depth = 0;
+    for (size_t i = 0; i < program->length; ++i)
+    {
+        const Instruction *ip = &program->code[i];
+        const int top = depth - 1;
+        switch ((Opcode)ip->op)
+        {
+        case OP_CONST:
+            jit_load(as, depth++, &(JitMemory){JIT_RIP, -1, ip->arg});
+            break;
+        case OP_VAR:
+            if (ip->arg < column_count)
+            {
+                jit_integer(as, 0x8B, RAX, 0, &(JitMemory){R12, -1, ip->arg * 8}); // mov rax, columns[arg]
+                jit_load(as, depth++, &(JitMemory){RAX, RBX, 0});
+            }
+            else
+            {
+                jit_load(as, depth++, &(JitMemory){JIT_RIP, -1, pool_scalars + ip->arg});
+            }
+            break;
+        case OP_ADD:
+            jit_arithmetic(as, 0x58, top - 1, top);
+            depth--;
+            break;
+        case OP_SUB:
+            jit_arithmetic(as, 0x5C, top - 1, top);
+            depth--;
+            break;
+        case OP_MUL:
+            jit_arithmetic(as, 0x59, top - 1, top);
+            depth--;
+            break;
+        case OP_DIV:
+            // scratch = (divisor == 0); rbp |= its sign bits.
+            jit_bitwise(as, 0x57, JIT_SCRATCH, JIT_SCRATCH);
+            jit_vector(as, as->lanes > 1 ? 0x66 : 0xF2, 0xC2, JIT_SCRATCH, JIT_SCRATCH, top, NULL, as->lanes == 4);
+            jit_byte(as, 0x00); // Equal, ordered
+            jit_vector(as, 0x66, 0x50, RAX, 0, JIT_SCRATCH, NULL, as->lanes == 4);
+            jit_integer(as, 0x09, RAX, RBP, NULL);
+            jit_arithmetic(as, 0x5E, top - 1, top);
+            depth--;
+            break;
+        case OP_POW:
+            jit_call(as, (uintptr_t)pow, depth, 2);
+            depth--;
+            break;
+        case OP_NEG:
+            jit_load(as, JIT_SCRATCH, &(JitMemory){JIT_RIP, -1, pool_sign});
+            jit_bitwise(as, 0x57, top, JIT_SCRATCH);
+            break;
+        case OP_ABS:
+            jit_load(as, JIT_SCRATCH, &(JitMemory){JIT_RIP, -1, pool_magnitude});
+            jit_bitwise(as, 0x54, top, JIT_SCRATCH);
+            break;
+        case OP_SQRT:
+            if (as->lanes > 1)
+                jit_vector(as, 0x66, 0x51, top, 0, top, NULL, as->lanes == 4);
+            else
+                jit_arithmetic(as, 0x51, top, top);
+            break;
+        case OP_LOG:
+            jit_call(as, (uintptr_t)log, depth, 1);
+            break;
+        case OP_LOG10:
+            jit_call(as, (uintptr_t)log10, depth, 1);
+            break;
+        case OP_EXP:
+            jit_call(as, (uintptr_t)exp, depth, 1);
+            break;
+        case OP_SIN:
+            jit_call(as, (uintptr_t)sin, depth, 1);
+            break;
+        case OP_COS:
+            jit_call(as, (uintptr_t)cos, depth, 1);
+            break;
+        case OP_TAN:
+            jit_call(as, (uintptr_t)tan, depth, 1);
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Emits the whole JitFunction: a loop over groups of rows, a loop
+ * over the rows left, and the zero-divisor verdict.
+ */
+static void jit_function(JitAssembler *as, const Program *program, int column_count)
+{
+    static const unsigned saved[] = {RBX, RBP, R12, R13, R14};
+    for (size_t i = 0; i < sizeof(saved) / sizeof(saved[0]); ++i)
+    {
+        if (saved[i] >= 8)
+            jit_byte(as, 0x41);
+        jit_byte(as, 0x50 | (saved[i] & 7)); // push
+    }
+    jit_integer(as, 0x81, 5, RSP, NULL); // sub rsp, JIT_FRAME
+    jit_u32(as, JIT_FRAME);
+    jit_integer(as, 0x89, RDI, R12, NULL); // mov r12, rdi
+    jit_integer(as, 0x89, RSI, R14, NULL); // mov r14, rsi
+    jit_integer(as, 0x89, RDX, R13, NULL); // mov r13, rdx
+    jit_integer(as, 0x31, RBX, RBX, NULL); // xor rbx, rbx
+    jit_integer(as, 0x31, RBP, RBP, NULL); // xor rbp, rbp
+
+    const int lanes = as->lanes;
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        const size_t loop = as->length;
+        size_t exit;
+        if (as->lanes > 1)
+        {
+            jit_integer(as, 0x89, RBX, RAX, NULL); // mov rax, rbx
+            jit_integer(as, 0x83, 0, RAX, NULL);   // add rax, lanes
+            jit_byte(as, (unsigned)as->lanes);
+            jit_integer(as, 0x39, R14, RAX, NULL); // cmp rax, r14
+            exit = jit_jump(as, 0x87);             // ja
+        }
+        else
+        {
+            jit_integer(as, 0x39, R14, RBX, NULL); // cmp rbx, r14
+            exit = jit_jump(as, 0x83);             // jae
+        }
+        jit_body(as, program, column_count);
+        jit_store(as, 0, &(JitMemory){R13, RBX, 0});
+        jit_integer(as, 0x83, 0, RBX, NULL); // add rbx, lanes
+        jit_byte(as, (unsigned)as->lanes);
+        jit_patch(as, jit_jump(as, 0), loop);
+        jit_patch(as, exit, as->length);
+        if (as->lanes == 1)
+            break;
+        as->lanes = 1;
+    }
+    as->lanes = lanes;
+
+    jit_byte(as, 0x31); // xor eax, eax
+    jit_byte(as, 0xC0);
+    jit_integer(as, 0x85, RBP, RBP, NULL); // test rbp, rbp
+    jit_byte(as, 0x0F);                    // setnz al: EVAL_DIVISION_BY_ZERO
+    jit_byte(as, 0x95);
+    jit_byte(as, 0xC0);
+    jit_vzeroupper(as);
+    jit_integer(as, 0x81, 0, RSP, NULL); // add rsp, JIT_FRAME
+    jit_u32(as, JIT_FRAME);
+    for (size_t i = sizeof(saved) / sizeof(saved[0]); i-- > 0;)
+    {
+        if (saved[i] >= 8)
+            jit_byte(as, 0x41);
+        jit_byte(as, 0x58 | (saved[i] & 7)); // pop
+    }
+    jit_byte(as, 0xC3); // ret
+}
+
+#endif
+
+/**
+ * @brief Compiles a program into native code for bulk evaluation.
+ *
+ * Variables below `column_count` are read from the columns; the others are
+ * bindings whose values are built into the code.
+ * @return 0 on success, or -1 if the expression must run in the
+ * interpreter: on other processors, or when its stack outgrows the
+ * registers.
+ */
+static int jit_compile(JitCode *jit, const Program *program, int column_count, const double *scalars)
+{
+    memset(jit, 0, sizeof(*jit));
+#if defined(__x86_64__)
+    if (program->max_depth > JIT_REGISTERS)
+        return -1;
+    JitAssembler as = {NULL, 0, 0, 2, 0};
+    if (jit_use_avx && __builtin_cpu_supports("avx"))
+    {
+        as.lanes = 4;
+        as.avx = 1;
+    }
+    jit_function(&as, program, column_count);
+
+    // The pool: per entry, a value repeated for every lane.
+    const size_t pool = (as.length + JIT_SLOT - 1) & ~(size_t)(JIT_SLOT - 1);
+    const size_t entries = program->constant_count + EXPR_MAX_VARIABLES + 2;
+    jit->size = pool + entries * JIT_SLOT;
+    jit->memory = mmap(NULL, jit->size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (jit->memory == MAP_FAILED)
+    {
+        perror("Failed to map memory for native code");
+        jit->memory = NULL;
+        return -1;
+    }
+    as.code = (uint8_t *)jit->memory;
+    as.length = 0;
+    as.pool = pool;
+    jit_function(&as, program, column_count);
+
+    double *values = (double *)(as.code + pool);
+    const uint64_t masks[2] = {UINT64_C(0x8000000000000000), UINT64_C(0x7FFFFFFFFFFFFFFF)};
+    for (size_t entry = 0; entry < entries; ++entry)
+    {
+        double value = 0;
+        if (entry < program->constant_count)
+            value = program->constants[entry];
+        else if (entry < program->constant_count + EXPR_MAX_VARIABLES)
+            value = scalars[entry - program->constant_count];
+        else
+            memcpy(&value, &masks[entry - program->constant_count - EXPR_MAX_VARIABLES], sizeof(value));
+        for (int lane = 0; lane < 4; ++lane)
+            values[entry * 4 + lane] = value;
+    }
+
+    // Never writable and executable at once.
+    if (mprotect(jit->memory, jit->size, PROT_READ | PROT_EXEC) != 0)
+    {
+        perror("Failed to make native code executable");
+        jit_free(jit);
+        return -1;
+    }
+    jit->run = (JitFunction)jit->memory;
+    return 0;
+#else
+    (void)program;
+    (void)column_count;
+    (void)scalars;
+    return -1;
+#endif
+}
+
+static void jit_free(JitCode *jit)
+{
+    if (jit->memory != NULL)
+        munmap(jit->memory, jit->size);
+    memset(jit, 0, sizeof(*jit));
+}
+
+// --- Number Conversion ---
+
+static const double POWERS_OF_TEN[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+/*
+ * 5^q for q from POWER_OF_FIVE_MIN to POWER_OF_FIVE_MAX, normalized to 128
+ * bits and stored high word first: truncated for q >= 0, rounded up for
+ * q < 0. The parser multiplies by them (Eisel-Lemire), and the printer
+ * takes its cached powers of ten from their high words (Grisu).
+ */
+static const uint64_t POWERS_OF_FIVE[][2] = {
+    {0xEEF453D6923BD65A, 0x113FAA2906A13B3F}, {0x9558B4661B6565F8, 0x4AC7CA59A424C507},
+    {0xBAAEE17FA23EBF76, 0x5D79BCF00D2DF649}, {0xE95A99DF8ACE6F53, 0xF4D82C2C107973DC},
+    {0x91D8A02BB6C10594, 0x79071B9B8A4BE869}, {0xB64EC836A47146F9, 0x9748E2826CDEE284},
+    {0xE3E27A444D8D98B7, 0xFD1B1B2308169B25}, {0x8E6D8C6AB0787F72, 0xFE30F0F5E50E20F7},
+    {0xB208EF855C969F4F, 0xBDBD2D335E51A935}, {0xDE8B2B66B3BC4723, 0xAD2C788035E61382},
+    {0x8B16FB203055AC76, 0x4C3BCB5021AFCC31}, {0xADDCB9E83C6B1793, 0xDF4ABE242A1BBF3D},
+    {0xD953E8624B85DD78, 0xD71D6DAD34A2AF0D}, {0x87D4713D6F33AA6B, 0x8672648C40E5AD68},
+    {0xA9C98D8CCB009506, 0x680EFDAF511F18C2}, {0xD43BF0EFFDC0BA48, 0x0212BD1B2566DEF2},
+    {0x84A57695FE98746D, 0x014BB630F7604B57}, {0xA5CED43B7E3E9188, 0x419EA3BD35385E2D},
+    {0xCF42894A5DCE35EA, 0x52064CAC828675B9}, {0x818995CE7AA0E1B2, 0x7343EFEBD1940993},
+    {0xA1EBFB4219491A1F, 0x1014EBE6C5F90BF8}, {0xCA66FA129F9B60A6, 0xD41A26E077774EF6},
+    {0xFD00B897478238D0, 0x8920B098955522B4}, {0x9E20735E8CB16382, 0x55B46E5F5D5535B0},
+    {0xC5A890362FDDBC62, 0xEB2189F734AA831D}, {0xF712B443BBD52B7B, 0xA5E9EC7501D523E4},
+    {0x9A6BB0AA55653B2D, 0x47B233C92125366E}, {0xC1069CD4EABE89F8, 0x999EC0BB696E840A},
+    {0xF148440A256E2C76, 0xC00670EA43CA250D}, {0x96CD2A865764DBCA, 0x380406926A5E5728},
+    {0xBC807527ED3E12BC, 0xC605083704F5ECF2}, {0xEBA09271E88D976B, 0xF7864A44C633682E},
+    {0x93445B8731587EA3, 0x7AB3EE6AFBE0211D}, {0xB8157268FDAE9E4C, 0x5960EA05BAD82964},
+    {0xE61ACF033D1A45DF, 0x6FB92487298E33BD}, {0x8FD0C16206306BAB, 0xA5D3B6D479F8E056},
+    {0xB3C4F1BA87BC8696, 0x8F48A4899877186C}, {0xE0B62E2929ABA83C, 0x331ACDABFE94DE87},
+    {0x8C71DCD9BA0B4925, 0x9FF0C08B7F1D0B14}, {0xAF8E5410288E1B6F, 0x07ECF0AE5EE44DD9},
+    {0xDB71E91432B1A24A, 0xC9E82CD9F69D6150}, {0x892731AC9FAF056E, 0xBE311C083A225CD2},
+    {0xAB70FE17C79AC6CA, 0x6DBD630A48AAF406}, {0xD64D3D9DB981787D, 0x092CBBCCDAD5B108},
+    {0x85F0468293F0EB4E, 0x25BBF56008C58EA5}, {0xA76C582338ED2621, 0xAF2AF2B80AF6F24E},
+    {0xD1476E2C07286FAA, 0x1AF5AF660DB4AEE1}, {0x82CCA4DB847945CA, 0x50D98D9FC890ED4D},
+    {0xA37FCE126597973C, 0xE50FF107BAB528A0}, {0xCC5FC196FEFD7D0C, 0x1E53ED49A96272C8},
+    {0xFF77B1FCBEBCDC4F, 0x25E8E89C13BB0F7A}, {0x9FAACF3DF73609B1, 0x77B191618C54E9AC},
+    {0xC795830D75038C1D, 0xD59DF5B9EF6A2417}, {0xF97AE3D0D2446F25, 0x4B0573286B44AD1D},
+    {0x9BECCE62836AC577, 0x4EE367F9430AEC32}, {0xC2E801FB244576D5, 0x229C41F793CDA73F},
+    {0xF3A20279ED56D48A, 0x6B43527578C1110F}, {0x9845418C345644D6, 0x830A13896B78AAA9},
+    {0xBE5691EF416BD60C, 0x23CC986BC656D553}, {0xEDEC366B11C6CB8F, 0x2CBFBE86B7EC8AA8},
+    {0x94B3A202EB1C3F39, 0x7BF7D71432F3D6A9}, {0xB9E08A83A5E34F07, 0xDAF5CCD93FB0CC53},
+    {0xE858AD248F5C22C9, 0xD1B3400F8F9CFF68}, {0x91376C36D99995BE, 0x23100809B9C21FA1},
+    {0xB58547448FFFFB2D, 0xABD40A0C2832A78A}, {0xE2E69915B3FFF9F9, 0x16C90C8F323F516C},
+    {0x8DD01FAD907FFC3B, 0xAE3DA7D97F6792E3}, {0xB1442798F49FFB4A, 0x99CD11CFDF41779C},
+    {0xDD95317F31C7FA1D, 0x40405643D711D583}, {0x8A7D3EEF7F1CFC52, 0x482835EA666B2572},
+    {0xAD1C8EAB5EE43B66, 0xDA3243650005EECF}, {0xD863B256369D4A40, 0x90BED43E40076A82},
+    {0x873E4F75E2224E68, 0x5A7744A6E804A291}, {0xA90DE3535AAAE202, 0x711515D0A205CB36},
+    {0xD3515C2831559A83, 0x0D5A5B44CA873E03}, {0x8412D9991ED58091, 0xE858790AFE9486C2},
+    {0xA5178FFF668AE0B6, 0x626E974DBE39A872}, {0xCE5D73FF402D98E3, 0xFB0A3D212DC8128F},
+    {0x80FA687F881C7F8E, 0x7CE66634BC9D0B99}, {0xA139029F6A239F72, 0x1C1FFFC1EBC44E80},
+    {0xC987434744AC874E, 0xA327FFB266B56220}, {0xFBE9141915D7A922, 0x4BF1FF9F0062BAA8},
+    {0x9D71AC8FADA6C9B5, 0x6F773FC3603DB4A9}, {0xC4CE17B399107C22, 0xCB550FB4384D21D3},
+    {0xF6019DA07F549B2B, 0x7E2A53A146606A48}, {0x99C102844F94E0FB, 0x2EDA7444CBFC426D},
+    {0xC0314325637A1939, 0xFA911155FEFB5308}, {0xF03D93EEBC589F88, 0x793555AB7EBA27CA},
+    {0x96267C7535B763B5, 0x4BC1558B2F3458DE}, {0xBBB01B9283253CA2, 0x9EB1AAEDFB016F16},
+    {0xEA9C227723EE8BCB, 0x465E15A979C1CADC}, {0x92A1958A7675175F, 0x0BFACD89EC191EC9},
+    {0xB749FAED14125D36, 0xCEF980EC671F667B}, {0xE51C79A85916F484, 0x82B7E12780E7401A},
+    {0x8F31CC0937AE58D2, 0xD1B2ECB8B0908810}, {0xB2FE3F0B8599EF07, 0x861FA7E6DCB4AA15},
+    {0xDFBDCECE67006AC9, 0x67A791E093E1D49A}, {0x8BD6A141006042BD, 0xE0C8BB2C5C6D24E0},
+    {0xAECC49914078536D, 0x58FAE9F773886E18}, {0xDA7F5BF590966848, 0xAF39A475506A899E},
+    {0x888F99797A5E012D, 0x6D8406C952429603}, {0xAAB37FD7D8F58178, 0xC8E5087BA6D33B83},
+    {0xD5605FCDCF32E1D6, 0xFB1E4A9A90880A64}, {0x855C3BE0A17FCD26, 0x5CF2EEA09A55067F},
+    {0xA6B34AD8C9DFC06F, 0xF42FAA48C0EA481E}, {0xD0601D8EFC57B08B, 0xF13B94DAF124DA26},
+    {0x823C12795DB6CE57, 0x76C53D08D6B70858}, {0xA2CB1717B52481ED, 0x54768C4B0C64CA6E},
+    {0xCB7DDCDDA26DA268, 0xA9942F5DCF7DFD09}, {0xFE5D54150B090B02, 0xD3F93B35435D7C4C},
+    {0x9EFA548D26E5A6E1, 0xC47BC5014A1A6DAF}, {0xC6B8E9B0709F109A, 0x359AB6419CA1091B},
+    {0xF867241C8CC6D4C0, 0xC30163D203C94B62}, {0x9B407691D7FC44F8, 0x79E0DE63425DCF1D},
+    {0xC21094364DFB5636, 0x985915FC12F542E4}, {0xF294B943E17A2BC4, 0x3E6F5B7B17B2939D},
+    {0x979CF3CA6CEC5B5A, 0xA705992CEECF9C42}, {0xBD8430BD08277231, 0x50C6FF782A838353},
+    {0xECE53CEC4A314EBD, 0xA4F8BF5635246428}, {0x940F4613AE5ED136, 0x871B7795E136BE99},
+    {0xB913179899F68584, 0x28E2557B59846E3F}, {0xE757DD7EC07426E5, 0x331AEADA2FE589CF},
+    {0x9096EA6F3848984F, 0x3FF0D2C85DEF7621}, {0xB4BCA50B065ABE63, 0x0FED077A756B53A9},
+    {0xE1EBCE4DC7F16DFB, 0xD3E8495912C62894}, {0x8D3360F09CF6E4BD, 0x64712DD7ABBBD95C},
+    {0xB080392CC4349DEC, 0xBD8D794D96AACFB3}, {0xDCA04777F541C567, 0xECF0D7A0FC5583A0},
+    {0x89E42CAAF9491B60, 0xF41686C49DB57244}, {0xAC5D37D5B79B6239, 0x311C2875C522CED5},
+    {0xD77485CB25823AC7, 0x7D633293366B828B}, {0x86A8D39EF77164BC, 0xAE5DFF9C02033197},
+    {0xA8530886B54DBDEB, 0xD9F57F830283FDFC}, {0xD267CAA862A12D66, 0xD072DF63C324FD7B},
+    {0x8380DEA93DA4BC60, 0x4247CB9E59F71E6D}, {0xA46116538D0DEB78, 0x52D9BE85F074E608},
+    {0xCD795BE870516656, 0x67902E276C921F8B}, {0x806BD9714632DFF6, 0x00BA1CD8A3DB53B6},
+    {0xA086CFCD97BF97F3, 0x80E8A40ECCD228A4}, {0xC8A883C0FDAF7DF0, 0x6122CD128006B2CD},
+    {0xFAD2A4B13D1B5D6C, 0x796B805720085F81}, {0x9CC3A6EEC6311A63, 0xCBE3303674053BB0},
+    {0xC3F490AA77BD60FC, 0xBEDBFC4411068A9C}, {0xF4F1B4D515ACB93B, 0xEE92FB5515482D44},
+    {0x991711052D8BF3C5, 0x751BDD152D4D1C4A}, {0xBF5CD54678EEF0B6, 0xD262D45A78A0635D},
+    {0xEF340A98172AACE4, 0x86FB897116C87C34}, {0x9580869F0E7AAC0E, 0xD45D35E6AE3D4DA0},
+    {0xBAE0A846D2195712, 0x8974836059CCA109}, {0xE998D258869FACD7, 0x2BD1A438703FC94B},
+    {0x91FF83775423CC06, 0x7B6306A34627DDCF}, {0xB67F6455292CBF08, 0x1A3BC84C17B1D542},
+    {0xE41F3D6A7377EECA, 0x20CABA5F1D9E4A93}, {0x8E938662882AF53E, 0x547EB47B7282EE9C},
+    {0xB23867FB2A35B28D, 0xE99E619A4F23AA43}, {0xDEC681F9F4C31F31, 0x6405FA00E2EC94D4},
+    {0x8B3C113C38F9F37E, 0xDE83BC408DD3DD04}, {0xAE0B158B4738705E, 0x9624AB50B148D445},
+    {0xD98DDAEE19068C76, 0x3BADD624DD9B0957}, {0x87F8A8D4CFA417C9, 0xE54CA5D70A80E5D6},
+    {0xA9F6D30A038D1DBC, 0x5E9FCF4CCD211F4C}, {0xD47487CC8470652B, 0x7647C3200069671F},
+    {0x84C8D4DFD2C63F3B, 0x29ECD9F40041E073}, {0xA5FB0A17C777CF09, 0xF468107100525890},
+    {0xCF79CC9DB955C2CC, 0x7182148D4066EEB4}, {0x81AC1FE293D599BF, 0xC6F14CD848405530},
+    {0xA21727DB38CB002F, 0xB8ADA00E5A506A7C}, {0xCA9CF1D206FDC03B, 0xA6D90811F0E4851C},
+    {0xFD442E4688BD304A, 0x908F4A166D1DA663}, {0x9E4A9CEC15763E2E, 0x9A598E4E043287FE},
+    {0xC5DD44271AD3CDBA, 0x40EFF1E1853F29FD}, {0xF7549530E188C128, 0xD12BEE59E68EF47C},
+    {0x9A94DD3E8CF578B9, 0x82BB74F8301958CE}, {0xC13A148E3032D6E7, 0xE36A52363C1FAF01},
+    {0xF18899B1BC3F8CA1, 0xDC44E6C3CB279AC1}, {0x96F5600F15A7B7E5, 0x29AB103A5EF8C0B9},
+    {0xBCB2B812DB11A5DE, 0x7415D448F6B6F0E7}, {0xEBDF661791D60F56, 0x111B495B3464AD21},
+    {0x936B9FCEBB25C995, 0xCAB10DD900BEEC34}, {0xB84687C269EF3BFB, 0x3D5D514F40EEA742},
+    {0xE65829B3046B0AFA, 0x0CB4A5A3112A5112}, {0x8FF71A0FE2C2E6DC, 0x47F0E785EABA72AB},
+    {0xB3F4E093DB73A093, 0x59ED216765690F56}, {0xE0F218B8D25088B8, 0x306869C13EC3532C},
+    {0x8C974F7383725573, 0x1E414218C73A13FB}, {0xAFBD2350644EEACF, 0xE5D1929EF90898FA},
+    {0xDBAC6C247D62A583, 0xDF45F746B74ABF39}, {0x894BC396CE5DA772, 0x6B8BBA8C328EB783},
+    {0xAB9EB47C81F5114F, 0x066EA92F3F326564}, {0xD686619BA27255A2, 0xC80A537B0EFEFEBD},
+    {0x8613FD0145877585, 0xBD06742CE95F5F36}, {0xA798FC4196E952E7, 0x2C48113823B73704},
+    {0xD17F3B51FCA3A7A0, 0xF75A15862CA504C5}, {0x82EF85133DE648C4, 0x9A984D73DBE722FB},
+    {0xA3AB66580D5FDAF5, 0xC13E60D0D2E0EBBA}, {0xCC963FEE10B7D1B3, 0x318DF905079926A8},
+    {0xFFBBCFE994E5C61F, 0xFDF17746497F7052}, {0x9FD561F1FD0F9BD3, 0xFEB6EA8BEDEFA633},
+    {0xC7CABA6E7C5382C8, 0xFE64A52EE96B8FC0}, {0xF9BD690A1B68637B, 0x3DFDCE7AA3C673B0},
+    {0x9C1661A651213E2D, 0x06BEA10CA65C084E}, {0xC31BFA0FE5698DB8, 0x486E494FCFF30A62},
+    {0xF3E2F893DEC3F126, 0x5A89DBA3C3EFCCFA}, {0x986DDB5C6B3A76B7, 0xF89629465A75E01C},
+    {0xBE89523386091465, 0xF6BBB397F1135823}, {0xEE2BA6C0678B597F, 0x746AA07DED582E2C},
+    {0x94DB483840B717EF, 0xA8C2A44EB4571CDC}, {0xBA121A4650E4DDEB, 0x92F34D62616CE413},
+    {0xE896A0D7E51E1566, 0x77B020BAF9C81D17}, {0x915E2486EF32CD60, 0x0ACE1474DC1D122E},
+    {0xB5B5ADA8AAFF80B8, 0x0D819992132456BA}, {0xE3231912D5BF60E6, 0x10E1FFF697ED6C69},
+    {0x8DF5EFABC5979C8F, 0xCA8D3FFA1EF463C1}, {0xB1736B96B6FD83B3, 0xBD308FF8A6B17CB2},
+    {0xDDD0467C64BCE4A0, 0xAC7CB3F6D05DDBDE}, {0x8AA22C0DBEF60EE4, 0x6BCDF07A423AA96B},
+    {0xAD4AB7112EB3929D, 0x86C16C98D2C953C6}, {0xD89D64D57A607744, 0xE871C7BF077BA8B7},
+    {0x87625F056C7C4A8B, 0x11471CD764AD4972}, {0xA93AF6C6C79B5D2D, 0xD598E40D3DD89BCF},
+    {0xD389B47879823479, 0x4AFF1D108D4EC2C3}, {0x843610CB4BF160CB, 0xCEDF722A585139BA},
+    {0xA54394FE1EEDB8FE, 0xC2974EB4EE658828}, {0xCE947A3DA6A9273E, 0x733D226229FEEA32},
+    {0x811CCC668829B887, 0x0806357D5A3F525F}, {0xA163FF802A3426A8, 0xCA07C2DCB0CF26F7},
+    {0xC9BCFF6034C13052, 0xFC89B393DD02F0B5}, {0xFC2C3F3841F17C67, 0xBBAC2078D443ACE2},
+    {0x9D9BA7832936EDC0, 0xD54B944B84AA4C0D}, {0xC5029163F384A931, 0x0A9E795E65D4DF11},
+    {0xF64335BCF065D37D, 0x4D4617B5FF4A16D5}, {0x99EA0196163FA42E, 0x504BCED1BF8E4E45},
+    {0xC06481FB9BCF8D39, 0xE45EC2862F71E1D6}, {0xF07DA27A82C37088, 0x5D767327BB4E5A4C},
+    {0x964E858C91BA2655, 0x3A6A07F8D510F86F}, {0xBBE226EFB628AFEA, 0x890489F70A55368B},
+    {0xEADAB0ABA3B2DBE5, 0x2B45AC74CCEA842E}, {0x92C8AE6B464FC96F, 0x3B0B8BC90012929D},
+    {0xB77ADA0617E3BBCB, 0x09CE6EBB40173744}, {0xE55990879DDCAABD, 0xCC420A6A101D0515},
+    {0x8F57FA54C2A9EAB6, 0x9FA946824A12232D}, {0xB32DF8E9F3546564, 0x47939822DC96ABF9},
+    {0xDFF9772470297EBD, 0x59787E2B93BC56F7}, {0x8BFBEA76C619EF36, 0x57EB4EDB3C55B65A},
+    {0xAEFAE51477A06B03, 0xEDE622920B6B23F1}, {0xDAB99E59958885C4, 0xE95FAB368E45ECED},
+    {0x88B402F7FD75539B, 0x11DBCB0218EBB414}, {0xAAE103B5FCD2A881, 0xD652BDC29F26A119},
+    {0xD59944A37C0752A2, 0x4BE76D3346F0495F}, {0x857FCAE62D8493A5, 0x6F70A4400C562DDB},
+    {0xA6DFBD9FB8E5B88E, 0xCB4CCD500F6BB952}, {0xD097AD07A71F26B2, 0x7E2000A41346A7A7},
+    {0x825ECC24C873782F, 0x8ED400668C0C28C8}, {0xA2F67F2DFA90563B, 0x728900802F0F32FA},
+    {0xCBB41EF979346BCA, 0x4F2B40A03AD2FFB9}, {0xFEA126B7D78186BC, 0xE2F610C84987BFA8},
+    {0x9F24B832E6B0F436, 0x0DD9CA7D2DF4D7C9}, {0xC6EDE63FA05D3143, 0x91503D1C79720DBB},
+    {0xF8A95FCF88747D94, 0x75A44C6397CE912A}, {0x9B69DBE1B548CE7C, 0xC986AFBE3EE11ABA},
+    {0xC24452DA229B021B, 0xFBE85BADCE996168}, {0xF2D56790AB41C2A2, 0xFAE27299423FB9C3},
+    {0x97C560BA6B0919A5, 0xDCCD879FC967D41A}, {0xBDB6B8E905CB600F, 0x5400E987BBC1C920},
+    {0xED246723473E3813, 0x290123E9AAB23B68}, {0x9436C0760C86E30B, 0xF9A0B6720AAF6521},
+    {0xB94470938FA89BCE, 0xF808E40E8D5B3E69}, {0xE7958CB87392C2C2, 0xB60B1D1230B20E04},
+    {0x90BD77F3483BB9B9, 0xB1C6F22B5E6F48C2}, {0xB4ECD5F01A4AA828, 0x1E38AEB6360B1AF3},
+    {0xE2280B6C20DD5232, 0x25C6DA63C38DE1B0}, {0x8D590723948A535F, 0x579C487E5A38AD0E},
+    {0xB0AF48EC79ACE837, 0x2D835A9DF0C6D851}, {0xDCDB1B2798182244, 0xF8E431456CF88E65},
+    {0x8A08F0F8BF0F156B, 0x1B8E9ECB641B58FF}, {0xAC8B2D36EED2DAC5, 0xE272467E3D222F3F},
+    {0xD7ADF884AA879177, 0x5B0ED81DCC6ABB0F}, {0x86CCBB52EA94BAEA, 0x98E947129FC2B4E9},
+    {0xA87FEA27A539E9A5, 0x3F2398D747B36224}, {0xD29FE4B18E88640E, 0x8EEC7F0D19A03AAD},
+    {0x83A3EEEEF9153E89, 0x1953CF68300424AC}, {0xA48CEAAAB75A8E2B, 0x5FA8C3423C052DD7},
+    {0xCDB02555653131B6, 0x3792F412CB06794D}, {0x808E17555F3EBF11, 0xE2BBD88BBEE40BD0},
+    {0xA0B19D2AB70E6ED6, 0x5B6ACEAEAE9D0EC4}, {0xC8DE047564D20A8B, 0xF245825A5A445275},
+    {0xFB158592BE068D2E, 0xEED6E2F0F0D56712}, {0x9CED737BB6C4183D, 0x55464DD69685606B},
+    {0xC428D05AA4751E4C, 0xAA97E14C3C26B886}, {0xF53304714D9265DF, 0xD53DD99F4B3066A8},
+    {0x993FE2C6D07B7FAB, 0xE546A8038EFE4029}, {0xBF8FDB78849A5F96, 0xDE98520472BDD033},
+    {0xEF73D256A5C0F77C, 0x963E66858F6D4440}, {0x95A8637627989AAD, 0xDDE7001379A44AA8},
+    {0xBB127C53B17EC159, 0x5560C018580D5D52}, {0xE9D71B689DDE71AF, 0xAAB8F01E6E10B4A6},
+    {0x9226712162AB070D, 0xCAB3961304CA70E8}, {0xB6B00D69BB55C8D1, 0x3D607B97C5FD0D22},
+    {0xE45C10C42A2B3B05, 0x8CB89A7DB77C506A}, {0x8EB98A7A9A5B04E3, 0x77F3608E92ADB242},
+    {0xB267ED1940F1C61C, 0x55F038B237591ED3}, {0xDF01E85F912E37A3, 0x6B6C46DEC52F6688},
+    {0x8B61313BBABCE2C6, 0x2323AC4B3B3DA015}, {0xAE397D8AA96C1B77, 0xABEC975E0A0D081A},
+    {0xD9C7DCED53C72255, 0x96E7BD358C904A21}, {0x881CEA14545C7575, 0x7E50D64177DA2E54},
+    {0xAA242499697392D2, 0xDDE50BD1D5D0B9E9}, {0xD4AD2DBFC3D07787, 0x955E4EC64B44E864},
+    {0x84EC3C97DA624AB4, 0xBD5AF13BEF0B113E}, {0xA6274BBDD0FADD61, 0xECB1AD8AEACDD58E},
+    {0xCFB11EAD453994BA, 0x67DE18EDA5814AF2}, {0x81CEB32C4B43FCF4, 0x80EACF948770CED7},
+    {0xA2425FF75E14FC31, 0xA1258379A94D028D}, {0xCAD2F7F5359A3B3E, 0x096EE45813A04330},
+    {0xFD87B5F28300CA0D, 0x8BCA9D6E188853FC}, {0x9E74D1B791E07E48, 0x775EA264CF55347E},
+    {0xC612062576589DDA, 0x95364AFE032A819E}, {0xF79687AED3EEC551, 0x3A83DDBD83F52205},
+    {0x9ABE14CD44753B52, 0xC4926A9672793543}, {0xC16D9A0095928A27, 0x75B7053C0F178294},
+    {0xF1C90080BAF72CB1, 0x5324C68B12DD6339}, {0x971DA05074DA7BEE, 0xD3F6FC16EBCA5E04},
+    {0xBCE5086492111AEA, 0x88F4BB1CA6BCF585}, {0xEC1E4A7DB69561A5, 0x2B31E9E3D06C32E6},
+    {0x9392EE8E921D5D07, 0x3AFF322E62439FD0}, {0xB877AA3236A4B449, 0x09BEFEB9FAD487C3},
+    {0xE69594BEC44DE15B, 0x4C2EBE687989A9B4}, {0x901D7CF73AB0ACD9, 0x0F9D37014BF60A11},
+    {0xB424DC35095CD80F, 0x538484C19EF38C95}, {0xE12E13424BB40E13, 0x2865A5F206B06FBA},
+    {0x8CBCCC096F5088CB, 0xF93F87B7442E45D4}, {0xAFEBFF0BCB24AAFE, 0xF78F69A51539D749},
+    {0xDBE6FECEBDEDD5BE, 0xB573440E5A884D1C}, {0x89705F4136B4A597, 0x31680A88F8953031},
+    {0xABCC77118461CEFC, 0xFDC20D2B36BA7C3E}, {0xD6BF94D5E57A42BC, 0x3D32907604691B4D},
+    {0x8637BD05AF6C69B5, 0xA63F9A49C2C1B110}, {0xA7C5AC471B478423, 0x0FCF80DC33721D54},
+    {0xD1B71758E219652B, 0xD3C36113404EA4A9}, {0x83126E978D4FDF3B, 0x645A1CAC083126EA},
+    {0xA3D70A3D70A3D70A, 0x3D70A3D70A3D70A4}, {0xCCCCCCCCCCCCCCCC, 0xCCCCCCCCCCCCCCCD},
+    {0x8000000000000000, 0x0000000000000000}, {0xA000000000000000, 0x0000000000000000},
+    {0xC800000000000000, 0x0000000000000000}, {0xFA00000000000000, 0x0000000000000000},
+    {0x9C40000000000000, 0x0000000000000000}, {0xC350000000000000, 0x0000000000000000},
+    {0xF424000000000000, 0x0000000000000000}, {0x9896800000000000, 0x0000000000000000},
+    {0xBEBC200000000000, 0x0000000000000000}, {0xEE6B280000000000, 0x0000000000000000},
+    {0x9502F90000000000, 0x0000000000000000}, {0xBA43B74000000000, 0x0000000000000000},
+    {0xE8D4A51000000000, 0x0000000000000000}, {0x9184E72A00000000, 0x0000000000000000},
+    {0xB5E620F480000000, 0x0000000000000000}, {0xE35FA931A0000000, 0x0000000000000000},
+    {0x8E1BC9BF04000000, 0x0000000000000000}, {0xB1A2BC2EC5000000, 0x0000000000000000},
+    {0xDE0B6B3A76400000, 0x0000000000000000}, {0x8AC7230489E80000, 0x0000000000000000},
+    {0xAD78EBC5AC620000, 0x0000000000000000}, {0xD8D726B7177A8000, 0x0000000000000000},
+    {0x878678326EAC9000, 0x0000000000000000}, {0xA968163F0A57B400, 0x0000000000000000},
+    {0xD3C21BCECCEDA100, 0x0000000000000000}, {0x84595161401484A0, 0x0000000000000000},
+    {0xA56FA5B99019A5C8, 0x0000000000000000}, {0xCECB8F27F4200F3A, 0x0000000000000000},
+    {0x813F3978F8940984, 0x4000000000000000}, {0xA18F07D736B90BE5, 0x5000000000000000},
+    {0xC9F2C9CD04674EDE, 0xA400000000000000}, {0xFC6F7C4045812296, 0x4D00000000000000},
+    {0x9DC5ADA82B70B59D, 0xF020000000000000}, {0xC5371912364CE305, 0x6C28000000000000},
+    {0xF684DF56C3E01BC6, 0xC732000000000000}, {0x9A130B963A6C115C, 0x3C7F400000000000},
+    {0xC097CE7BC90715B3, 0x4B9F100000000000}, {0xF0BDC21ABB48DB20, 0x1E86D40000000000},
+    {0x96769950B50D88F4, 0x1314448000000000}, {0xBC143FA4E250EB31, 0x17D955A000000000},
+    {0xEB194F8E1AE525FD, 0x5DCFAB0800000000}, {0x92EFD1B8D0CF37BE, 0x5AA1CAE500000000},
+    {0xB7ABC627050305AD, 0xF14A3D9E40000000}, {0xE596B7B0C643C719, 0x6D9CCD05D0000000},
+    {0x8F7E32CE7BEA5C6F, 0xE4820023A2000000}, {0xB35DBF821AE4F38B, 0xDDA2802C8A800000},
+    {0xE0352F62A19E306E, 0xD50B2037AD200000}, {0x8C213D9DA502DE45, 0x4526F422CC340000},
+    {0xAF298D050E4395D6, 0x9670B12B7F410000}, {0xDAF3F04651D47B4C, 0x3C0CDD765F114000},
+    {0x88D8762BF324CD0F, 0xA5880A69FB6AC800}, {0xAB0E93B6EFEE0053, 0x8EEA0D047A457A00},
+    {0xD5D238A4ABE98068, 0x72A4904598D6D880}, {0x85A36366EB71F041, 0x47A6DA2B7F864750},
+    {0xA70C3C40A64E6C51, 0x999090B65F67D924}, {0xD0CF4B50CFE20765, 0xFFF4B4E3F741CF6D},
+    {0x82818F1281ED449F, 0xBFF8F10E7A8921A4}, {0xA321F2D7226895C7, 0xAFF72D52192B6A0D},
+    {0xCBEA6F8CEB02BB39, 0x9BF4F8A69F764490}, {0xFEE50B7025C36A08, 0x02F236D04753D5B4},
+    {0x9F4F2726179A2245, 0x01D762422C946590}, {0xC722F0EF9D80AAD6, 0x424D3AD2B7B97EF5},
+    {0xF8EBAD2B84E0D58B, 0xD2E0898765A7DEB2}, {0x9B934C3B330C8577, 0x63CC55F49F88EB2F},
+    {0xC2781F49FFCFA6D5, 0x3CBF6B71C76B25FB}, {0xF316271C7FC3908A, 0x8BEF464E3945EF7A},
+    {0x97EDD871CFDA3A56, 0x97758BF0E3CBB5AC}, {0xBDE94E8E43D0C8EC, 0x3D52EEED1CBEA317},
+    {0xED63A231D4C4FB27, 0x4CA7AAA863EE4BDD}, {0x945E455F24FB1CF8, 0x8FE8CAA93E74EF6A},
+    {0xB975D6B6EE39E436, 0xB3E2FD538E122B44}, {0xE7D34C64A9C85D44, 0x60DBBCA87196B616},
+    {0x90E40FBEEA1D3A4A, 0xBC8955E946FE31CD}, {0xB51D13AEA4A488DD, 0x6BABAB6398BDBE41},
+    {0xE264589A4DCDAB14, 0xC696963C7EED2DD1}, {0x8D7EB76070A08AEC, 0xFC1E1DE5CF543CA2},
+    {0xB0DE65388CC8ADA8, 0x3B25A55F43294BCB}, {0xDD15FE86AFFAD912, 0x49EF0EB713F39EBE},
+    {0x8A2DBF142DFCC7AB, 0x6E3569326C784337}, {0xACB92ED9397BF996, 0x49C2C37F07965404},
+    {0xD7E77A8F87DAF7FB, 0xDC33745EC97BE906}, {0x86F0AC99B4E8DAFD, 0x69A028BB3DED71A3},
+    {0xA8ACD7C0222311BC, 0xC40832EA0D68CE0C}, {0xD2D80DB02AABD62B, 0xF50A3FA490C30190},
+    {0x83C7088E1AAB65DB, 0x792667C6DA79E0FA}, {0xA4B8CAB1A1563F52, 0x577001B891185938},
+    {0xCDE6FD5E09ABCF26, 0xED4C0226B55E6F86}, {0x80B05E5AC60B6178, 0x544F8158315B05B4},
+    {0xA0DC75F1778E39D6, 0x696361AE3DB1C721}, {0xC913936DD571C84C, 0x03BC3A19CD1E38E9},
+    {0xFB5878494ACE3A5F, 0x04AB48A04065C723}, {0x9D174B2DCEC0E47B, 0x62EB0D64283F9C76},
+    {0xC45D1DF942711D9A, 0x3BA5D0BD324F8394}, {0xF5746577930D6500, 0xCA8F44EC7EE36479},
+    {0x9968BF6ABBE85F20, 0x7E998B13CF4E1ECB}, {0xBFC2EF456AE276E8, 0x9E3FEDD8C321A67E},
+    {0xEFB3AB16C59B14A2, 0xC5CFE94EF3EA101E}, {0x95D04AEE3B80ECE5, 0xBBA1F1D158724A12},
+    {0xBB445DA9CA61281F, 0x2A8A6E45AE8EDC97}, {0xEA1575143CF97226, 0xF52D09D71A3293BD},
+    {0x924D692CA61BE758, 0x593C2626705F9C56}, {0xB6E0C377CFA2E12E, 0x6F8B2FB00C77836C},
+    {0xE498F455C38B997A, 0x0B6DFB9C0F956447}, {0x8EDF98B59A373FEC, 0x4724BD4189BD5EAC},
+    {0xB2977EE300C50FE7, 0x58EDEC91EC2CB657}, {0xDF3D5E9BC0F653E1, 0x2F2967B66737E3ED},
+    {0x8B865B215899F46C, 0xBD79E0D20082EE74}, {0xAE67F1E9AEC07187, 0xECD8590680A3AA11},
+    {0xDA01EE641A708DE9, 0xE80E6F4820CC9495}, {0x884134FE908658B2, 0x3109058D147FDCDD},
+    {0xAA51823E34A7EEDE, 0xBD4B46F0599FD415}, {0xD4E5E2CDC1D1EA96, 0x6C9E18AC7007C91A},
+    {0x850FADC09923329E, 0x03E2CF6BC604DDB0}, {0xA6539930BF6BFF45, 0x84DB8346B786151C},
+    {0xCFE87F7CEF46FF16, 0xE612641865679A63}, {0x81F14FAE158C5F6E, 0x4FCB7E8F3F60C07E},
+    {0xA26DA3999AEF7749, 0xE3BE5E330F38F09D}, {0xCB090C8001AB551C, 0x5CADF5BFD3072CC5},
+    {0xFDCB4FA002162A63, 0x73D9732FC7C8F7F6}, {0x9E9F11C4014DDA7E, 0x2867E7FDDCDD9AFA},
+    {0xC646D63501A1511D, 0xB281E1FD541501B8}, {0xF7D88BC24209A565, 0x1F225A7CA91A4226},
+    {0x9AE757596946075F, 0x3375788DE9B06958}, {0xC1A12D2FC3978937, 0x0052D6B1641C83AE},
+    {0xF209787BB47D6B84, 0xC0678C5DBD23A49A}, {0x9745EB4D50CE6332, 0xF840B7BA963646E0},
+    {0xBD176620A501FBFF, 0xB650E5A93BC3D898}, {0xEC5D3FA8CE427AFF, 0xA3E51F138AB4CEBE},
+    {0x93BA47C980E98CDF, 0xC66F336C36B10137}, {0xB8A8D9BBE123F017, 0xB80B0047445D4184},
+    {0xE6D3102AD96CEC1D, 0xA60DC059157491E5}, {0x9043EA1AC7E41392, 0x87C89837AD68DB2F},
+    {0xB454E4A179DD1877, 0x29BABE4598C311FB}, {0xE16A1DC9D8545E94, 0xF4296DD6FEF3D67A},
+    {0x8CE2529E2734BB1D, 0x1899E4A65F58660C}, {0xB01AE745B101E9E4, 0x5EC05DCFF72E7F8F},
+    {0xDC21A1171D42645D, 0x76707543F4FA1F73}, {0x899504AE72497EBA, 0x6A06494A791C53A8},
+    {0xABFA45DA0EDBDE69, 0x0487DB9D17636892}, {0xD6F8D7509292D603, 0x45A9D2845D3C42B6},
+    {0x865B86925B9BC5C2, 0x0B8A2392BA45A9B2}, {0xA7F26836F282B732, 0x8E6CAC7768D7141E},
+    {0xD1EF0244AF2364FF, 0x3207D795430CD926}, {0x8335616AED761F1F, 0x7F44E6BD49E807B8},
+    {0xA402B9C5A8D3A6E7, 0x5F16206C9C6209A6}, {0xCD036837130890A1, 0x36DBA887C37A8C0F},
+    {0x802221226BE55A64, 0xC2494954DA2C9789}, {0xA02AA96B06DEB0FD, 0xF2DB9BAA10B7BD6C},
+    {0xC83553C5C8965D3D, 0x6F92829494E5ACC7}, {0xFA42A8B73ABBF48C, 0xCB772339BA1F17F9},
+    {0x9C69A97284B578D7, 0xFF2A760414536EFB}, {0xC38413CF25E2D70D, 0xFEF5138519684ABA},
+    {0xF46518C2EF5B8CD1, 0x7EB258665FC25D69}, {0x98BF2F79D5993802, 0xEF2F773FFBD97A61},
+    {0xBEEEFB584AFF8603, 0xAAFB550FFACFD8FA}, {0xEEAABA2E5DBF6784, 0x95BA2A53F983CF38},
+    {0x952AB45CFA97A0B2, 0xDD945A747BF26183}, {0xBA756174393D88DF, 0x94F971119AEEF9E4},
+    {0xE912B9D1478CEB17, 0x7A37CD5601AAB85D}, {0x91ABB422CCB812EE, 0xAC62E055C10AB33A},
+    {0xB616A12B7FE617AA, 0x577B986B314D6009}, {0xE39C49765FDF9D94, 0xED5A7E85FDA0B80B},
+    {0x8E41ADE9FBEBC27D, 0x14588F13BE847307}, {0xB1D219647AE6B31C, 0x596EB2D8AE258FC8},
+    {0xDE469FBD99A05FE3, 0x6FCA5F8ED9AEF3BB}, {0x8AEC23D680043BEE, 0x25DE7BB9480D5854},
+    {0xADA72CCC20054AE9, 0xAF561AA79A10AE6A}, {0xD910F7FF28069DA4, 0x1B2BA1518094DA04},
+    {0x87AA9AFF79042286, 0x90FB44D2F05D0842}, {0xA99541BF57452B28, 0x353A1607AC744A53},
+    {0xD3FA922F2D1675F2, 0x42889B8997915CE8}, {0x847C9B5D7C2E09B7, 0x69956135FEBADA11},
+    {0xA59BC234DB398C25, 0x43FAB9837E699095}, {0xCF02B2C21207EF2E, 0x94F967E45E03F4BB},
+    {0x8161AFB94B44F57D, 0x1D1BE0EEBAC278F5}, {0xA1BA1BA79E1632DC, 0x6462D92A69731732},
+    {0xCA28A291859BBF93, 0x7D7B8F7503CFDCFE}, {0xFCB2CB35E702AF78, 0x5CDA735244C3D43E},
+    {0x9DEFBF01B061ADAB, 0x3A0888136AFA64A7}, {0xC56BAEC21C7A1916, 0x088AAA1845B8FDD0},
+    {0xF6C69A72A3989F5B, 0x8AAD549E57273D45}, {0x9A3C2087A63F6399, 0x36AC54E2F678864B},
+    {0xC0CB28A98FCF3C7F, 0x84576A1BB416A7DD}, {0xF0FDF2D3F3C30B9F, 0x656D44A2A11C51D5},
+    {0x969EB7C47859E743, 0x9F644AE5A4B1B325}, {0xBC4665B596706114, 0x873D5D9F0DDE1FEE},
+    {0xEB57FF22FC0C7959, 0xA90CB506D155A7EA}, {0x9316FF75DD87CBD8, 0x09A7F12442D588F2},
+    {0xB7DCBF5354E9BECE, 0x0C11ED6D538AEB2F}, {0xE5D3EF282A242E81, 0x8F1668C8A86DA5FA},
+    {0x8FA475791A569D10, 0xF96E017D694487BC}, {0xB38D92D760EC4455, 0x37C981DCC395A9AC},
+    {0xE070F78D3927556A, 0x85BBE253F47B1417}, {0x8C469AB843B89562, 0x93956D7478CCEC8E},
+    {0xAF58416654A6BABB, 0x387AC8D1970027B2}, {0xDB2E51BFE9D0696A, 0x06997B05FCC0319E},
+    {0x88FCF317F22241E2, 0x441FECE3BDF81F03}, {0xAB3C2FDDEEAAD25A, 0xD527E81CAD7626C3},
+    {0xD60B3BD56A5586F1, 0x8A71E223D8D3B074}, {0x85C7056562757456, 0xF6872D5667844E49},
+    {0xA738C6BEBB12D16C, 0xB428F8AC016561DB}, {0xD106F86E69D785C7, 0xE13336D701BEBA52},
+    {0x82A45B450226B39C, 0xECC0024661173473}, {0xA34D721642B06084, 0x27F002D7F95D0190},
+    {0xCC20CE9BD35C78A5, 0x31EC038DF7B441F4}, {0xFF290242C83396CE, 0x7E67047175A15271},
+    {0x9F79A169BD203E41, 0x0F0062C6E984D386}, {0xC75809C42C684DD1, 0x52C07B78A3E60868},
+    {0xF92E0C3537826145, 0xA7709A56CCDF8A82}, {0x9BBCC7A142B17CCB, 0x88A66076400BB691},
+    {0xC2ABF989935DDBFE, 0x6ACFF893D00EA435}, {0xF356F7EBF83552FE, 0x0583F6B8C4124D43},
+    {0x98165AF37B2153DE, 0xC3727A337A8B704A}, {0xBE1BF1B059E9A8D6, 0x744F18C0592E4C5C},
+    {0xEDA2EE1C7064130C, 0x1162DEF06F79DF73}, {0x9485D4D1C63E8BE7, 0x8ADDCB5645AC2BA8},
+    {0xB9A74A0637CE2EE1, 0x6D953E2BD7173692}, {0xE8111C87C5C1BA99, 0xC8FA8DB6CCDD0437},
+    {0x910AB1D4DB9914A0, 0x1D9C9892400A22A2}, {0xB54D5E4A127F59C8, 0x2503BEB6D00CAB4B},
+    {0xE2A0B5DC971F303A, 0x2E44AE64840FD61D}, {0x8DA471A9DE737E24, 0x5CEAECFED289E5D2},
+    {0xB10D8E1456105DAD, 0x7425A83E872C5F47}, {0xDD50F1996B947518, 0xD12F124E28F77719},
+    {0x8A5296FFE33CC92F, 0x82BD6B70D99AAA6F}, {0xACE73CBFDC0BFB7B, 0x636CC64D1001550B},
+    {0xD8210BEFD30EFA5A, 0x3C47F7E05401AA4E}, {0x8714A775E3E95C78, 0x65ACFAEC34810A71},
+    {0xA8D9D1535CE3B396, 0x7F1839A741A14D0D}, {0xD31045A8341CA07C, 0x1EDE48111209A050},
+    {0x83EA2B892091E44D, 0x934AED0AAB460432}, {0xA4E4B66B68B65D60, 0xF81DA84D5617853F},
+    {0xCE1DE40642E3F4B9, 0x36251260AB9D668E}, {0x80D2AE83E9CE78F3, 0xC1D72B7C6B426019},
+    {0xA1075A24E4421730, 0xB24CF65B8612F81F}, {0xC94930AE1D529CFC, 0xDEE033F26797B627},
+    {0xFB9B7CD9A4A7443C, 0x169840EF017DA3B1}, {0x9D412E0806E88AA5, 0x8E1F289560EE864E},
+    {0xC491798A08A2AD4E, 0xF1A6F2BAB92A27E2}, {0xF5B5D7EC8ACB58A2, 0xAE10AF696774B1DB},
+    {0x9991A6F3D6BF1765, 0xACCA6DA1E0A8EF29}, {0xBFF610B0CC6EDD3F, 0x17FD090A58D32AF3},
+    {0xEFF394DCFF8A948E, 0xDDFC4B4CEF07F5B0}, {0x95F83D0A1FB69CD9, 0x4ABDAF101564F98E},
+    {0xBB764C4CA7A4440F, 0x9D6D1AD41ABE37F1}, {0xEA53DF5FD18D5513, 0x84C86189216DC5ED},
+    {0x92746B9BE2F8552C, 0x32FD3CF5B4E49BB4}, {0xB7118682DBB66A77, 0x3FBC8C33221DC2A1},
+    {0xE4D5E82392A40515, 0x0FABAF3FEAA5334A}, {0x8F05B1163BA6832D, 0x29CB4D87F2A7400E},
+    {0xB2C71D5BCA9023F8, 0x743E20E9EF511012}, {0xDF78E4B2BD342CF6, 0x914DA9246B255416},
+    {0x8BAB8EEFB6409C1A, 0x1AD089B6C2F7548E}, {0xAE9672ABA3D0C320, 0xA184AC2473B529B1},
+    {0xDA3C0F568CC4F3E8, 0xC9E5D72D90A2741E}, {0x8865899617FB1871, 0x7E2FA67C7A658892},
+    {0xAA7EEBFB9DF9DE8D, 0xDDBB901B98FEEAB7}, {0xD51EA6FA85785631, 0x552A74227F3EA565},
+    {0x8533285C936B35DE, 0xD53A88958F87275F}, {0xA67FF273B8460356, 0x8A892ABAF368F137},
+    {0xD01FEF10A657842C, 0x2D2B7569B0432D85}, {0x8213F56A67F6B29B, 0x9C3B29620E29FC73},
+    {0xA298F2C501F45F42, 0x8349F3BA91B47B8F}, {0xCB3F2F7642717713, 0x241C70A936219A73},
+    {0xFE0EFB53D30DD4D7, 0xED238CD383AA0110}, {0x9EC95D1463E8A506, 0xF4363804324A40AA},
+    {0xC67BB4597CE2CE48, 0xB143C6053EDCD0D5}, {0xF81AA16FDC1B81DA, 0xDD94B7868E94050A},
+    {0x9B10A4E5E9913128, 0xCA7CF2B4191C8326}, {0xC1D4CE1F63F57D72, 0xFD1C2F611F63A3F0},
+    {0xF24A01A73CF2DCCF, 0xBC633B39673C8CEC}, {0x976E41088617CA01, 0xD5BE0503E085D813},
+    {0xBD49D14AA79DBC82, 0x4B2D8644D8A74E18}, {0xEC9C459D51852BA2, 0xDDF8E7D60ED1219E},
+    {0x93E1AB8252F33B45, 0xCABB90E5C942B503}, {0xB8DA1662E7B00A17, 0x3D6A751F3B936243},
+    {0xE7109BFBA19C0C9D, 0x0CC512670A783AD4}, {0x906A617D450187E2, 0x27FB2B80668B24C5},
+    {0xB484F9DC9641E9DA, 0xB1F9F660802DEDF6}, {0xE1A63853BBD26451, 0x5E7873F8A0396973},
+    {0x8D07E33455637EB2, 0xDB0B487B6423E1E8}, {0xB049DC016ABC5E5F, 0x91CE1A9A3D2CDA62},
+    {0xDC5C5301C56B75F7, 0x7641A140CC7810FB}, {0x89B9B3E11B6329BA, 0xA9E904C87FCB0A9D},
+    {0xAC2820D9623BF429, 0x546345FA9FBDCD44}, {0xD732290FBACAF133, 0xA97C177947AD4095},
+    {0x867F59A9D4BED6C0, 0x49ED8EABCCCC485D}, {0xA81F301449EE8C70, 0x5C68F256BFFF5A74},
+    {0xD226FC195C6A2F8C, 0x73832EEC6FFF3111}, {0x83585D8FD9C25DB7, 0xC831FD53C5FF7EAB},
+    {0xA42E74F3D032F525, 0xBA3E7CA8B77F5E55}, {0xCD3A1230C43FB26F, 0x28CE1BD2E55F35EB},
+    {0x80444B5E7AA7CF85, 0x7980D163CF5B81B3}, {0xA0555E361951C366, 0xD7E105BCC332621F},
+    {0xC86AB5C39FA63440, 0x8DD9472BF3FEFAA7}, {0xFA856334878FC150, 0xB14F98F6F0FEB951},
+    {0x9C935E00D4B9D8D2, 0x6ED1BF9A569F33D3}, {0xC3B8358109E84F07, 0x0A862F80EC4700C8},
+    {0xF4A642E14C6262C8, 0xCD27BB612758C0FA}, {0x98E7E9CCCFBD7DBD, 0x8038D51CB897789C},
+    {0xBF21E44003ACDD2C, 0xE0470A63E6BD56C3}, {0xEEEA5D5004981478, 0x1858CCFCE06CAC74},
+    {0x95527A5202DF0CCB, 0x0F37801E0C43EBC8}, {0xBAA718E68396CFFD, 0xD30560258F54E6BA},
+    {0xE950DF20247C83FD, 0x47C6B82EF32A2069}, {0x91D28B7416CDD27E, 0x4CDC331D57FA5441},
+    {0xB6472E511C81471D, 0xE0133FE4ADF8E952}, {0xE3D8F9E563A198E5, 0x58180FDDD97723A6},
+    {0x8E679C2F5E44FF8F, 0x570F09EAA7EA7648}, {0xB201833B35D63F73, 0x2CD2CC6551E513DA},
+    {0xDE81E40A034BCF4F, 0xF8077F7EA65E58D1}, {0x8B112E86420F6191, 0xFB04AFAF27FAF782},
+    {0xADD57A27D29339F6, 0x79C5DB9AF1F9B563}, {0xD94AD8B1C7380874, 0x18375281AE7822BC},
+    {0x87CEC76F1C830548, 0x8F2293910D0B15B5}, {0xA9C2794AE3A3C69A, 0xB2EB3875504DDB22},
+    {0xD433179D9C8CB841, 0x5FA60692A46151EB}, {0x849FEEC281D7F328, 0xDBC7C41BA6BCD333},
+    {0xA5C7EA73224DEFF3, 0x12B9B522906C0800}, {0xCF39E50FEAE16BEF, 0xD768226B34870A00},
+    {0x81842F29F2CCE375, 0xE6A1158300D46640}, {0xA1E53AF46F801C53, 0x60495AE3C1097FD0},
+    {0xCA5E89B18B602368, 0x385BB19CB14BDFC4}, {0xFCF62C1DEE382C42, 0x46729E03DD9ED7B5},
+    {0x9E19DB92B4E31BA9, 0x6C07A2C26A8346D1},
+};
+
+/**
+ * @brief Returns the high 64 bits of a * b and stores the low 64 in *low.
+ */
+static uint64_t multiply_high(uint64_t a, uint64_t b, uint64_t *low)
+{
+#if defined(__SIZEOF_INT128__)
+    const unsigned __int128 product = (unsigned __int128)a * b;
+    *low = (uint64_t)product;
+    return (uint64_t)(product >> 64);
+#else
+    const uint64_t a_low = (uint32_t)a, a_high = a >> 32, b_low = (uint32_t)b, b_high = b >> 32;
+    const uint64_t cross = (a_low * b_low >> 32) + (uint32_t)(a_high * b_low) + a_low * b_high;
+    *low = cross << 32 | (uint32_t)(a_low * b_low);
+    return a_high * b_high + (a_high * b_low >> 32) + (cross >> 32);
+#endif
+}
+
+/**
+ * @brief Returns floor(q * log2(10)), for |q| up to a few thousand.
+ */
+static int floor_log2_pow10(int q)
+{
+    return (217706 * q) >> 16;
+}
+
+/**
+ * @brief Converts w * 10^q to the nearest double with the Eisel-Lemire
+ * algorithm: the product of w and a 128-bit power of five settles the
+ * rounding in all but vanishingly rare cases.
+ * @return 0 on success, or -1 if strtod must decide: the product was
+ * inconclusive, or the result is subnormal or out of range.
+ */
+static int eisel_lemire(uint64_t w, int q, int negative, double *value)
+{
+    if (w == 0)
+    {
+        *value = negative ? -0.0 : 0.0;
+        return 0;
+    }
+    if (q < POWER_OF_FIVE_MIN || q > DBL_MAX_10_EXP)
+        return -1;
+    const uint64_t *power = POWERS_OF_FIVE[q - POWER_OF_FIVE_MIN];
+    const int shift = __builtin_clzll(w);
+    w <<= shift;
+    uint64_t low;
+    uint64_t high = multiply_high(w, power[0], &low);
+    if ((high & 0x1FF) == 0x1FF)
+    {
+        // The bits that decide the rounding may still change; bring in the
+        // power's low word.
+        uint64_t unused;
+        const uint64_t carry = multiply_high(w, power[1], &unused);
+        low += carry;
+        high += low < carry;
+        if ((high & 0x1FF) == 0x1FF && low == UINT64_MAX)
+            return -1;
+    }
+    const int upper = (int)(high >> 63);
+    uint64_t mantissa = high >> (upper + 9); // 54 bits: the double's 53 and a rounding bit
+    int exponent = floor_log2_pow10(q) + 63 + upper - shift + 1023;
+    if (exponent <= 0)
+        return -1;
+    // Only small powers of ten can land exactly halfway; those round to even.
+    if (low <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1 && mantissa << (upper + 9) == high)
+        mantissa &= ~(uint64_t)1;
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if (mantissa >= (uint64_t)2 << 52)
+    {
+        mantissa = (uint64_t)1 << 52;
+        exponent++;
+    }
+    if (exponent >= 0x7FF)
+        return -1;
+    const uint64_t bits = (mantissa & (((uint64_t)1 << 52) - 1)) | (uint64_t)exponent << 52 | (uint64_t)negative << 63;
+    memcpy(value, &bits, sizeof(bits));
+    return 0;
+}
+
+/**
+ * @brief Converts the decimal number in [begin, end) to a double.
+ *
+ * Numbers with at most 15 significant digits and a small exponent, which
+ * is nearly all data, are converted exactly with one multiplication or
+ * division (Clinger's fast path): both operands are exact doubles, so the
+ * single rounding is correct. Other plain decimals go through Eisel-Lemire,
+ * and anything left, including every malformed or out-of-range number,
+ * through strtod.
+ * @return 0 on success, BULK_ERROR_NUMBER or BULK_ERROR_RANGE otherwise.
+ */
+static int parse_decimal(const char *begin, const char *end, double *value)
+{
+    const char *p = begin;
+    const int negative = p != end && *p == '-';
+    if (p != end && (*p == '-' || *p == '+'))
+        p++;
+    uint64_t mantissa = 0;
+    int significant = 0, exponent = 0, seen_digit = 0, seen_point = 0;
+    for (; p != end; ++p)
+    {
+        if (*p == '.' && !seen_point)
+        {
+            seen_point = 1;
+            continue;
+        }
+        if ((unsigned)(*p - '0') >= 10)
+            break;
+        seen_digit = 1;
+        significant += significant > 0 || *p != '0';
+        if (significant <= 19)
+        {
+            mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+            exponent -= seen_point;
+        }
+        else
+        {
+            exponent += !seen_point; // A dropped digit; only the slow path uses these
+        }
+    }
+    if (seen_digit && p != end && (*p == 'e' || *p == 'E'))
+    {
+        const char *e = p + 1;
+        const int exp_negative = e != end && *e == '-';
+        if (e != end && (*e == '-' || *e == '+'))
+            e++;
+        int exp_value = 0;
+        const char *exp_start = e;
+        for (; e != end && (unsigned)(*e - '0') < 10; ++e)
+        {
+            if (exp_value < 100000)
+                exp_value = exp_value * 10 + (*e - '0');
+        }
+        if (e != exp_start)
+        {
+            exponent += exp_negative ? -exp_value : exp_value;
+            p = e;
+        }
+    }
+    if (seen_digit && p == end)
+    {
+        if (significant <= 15 && exponent >= -22 && exponent <= 22)
+        {
+            double result = (double)mantissa;
+            result = exponent < 0 ? result / POWERS_OF_TEN[-exponent] : result * POWERS_OF_TEN[exponent];
+            *value = negative ? -result : result;
+            return 0;
+        }
+        // With digits dropped, the number lies between mantissa and
+        // mantissa + 1 (times 10^exponent); if both convert alike, so does it.
+        double above;
+        if (eisel_lemire(mantissa, exponent, negative, value) == 0 &&
+            (significant <= 19 || (eisel_lemire(mantissa + 1, exponent, negative, &above) == 0 && above == *value)))
+            return 0;
+    }
+
+    // The slow path, with parse_double's rules: the whole field must be a
+    // number and it must be in range.
+    const size_t length = (size_t)(end - begin);
+    if (length == 0 || length >= BULK_MAX_FIELD)
+        return BULK_ERROR_NUMBER;
+    char text[BULK_MAX_FIELD];
+    memcpy(text, begin, length);
+    text[length] = '\0';
+    char *text_end;
+    errno = 0;
+    *value = strtod(text, &text_end);
+    if (text_end == text || *text_end != '\0')
+        return BULK_ERROR_NUMBER;
+    return errno == ERANGE ? BULK_ERROR_RANGE : 0;
+}
+
+static DiyFp diy_normalize(DiyFp x)
+{
+    const int shift = __builtin_clzll(x.f);
+    return (DiyFp){x.f << shift, x.e - shift};
+}
+
+/**
+ * @brief Returns a * b rounded to 64 bits; the error is at most half a unit.
+ */
+static DiyFp diy_multiply(DiyFp a, DiyFp b)
+{
+    uint64_t low;
+    const uint64_t high = multiply_high(a.f, b.f, &low);
+    return (DiyFp){high + (low >> 63), a.e + b.e + 64};
+}
+
+/**
+ * @brief Nudges the last digit down towards w while the digits stay inside
+ * the safe interval, then checks that the result is provably the closest.
+ *
+ * All quantities are in units of the scaled values: `distance` from the
+ * digits' upper bound to w, `unsafe` the width of the interval, `rest` what
+ * the digits leave out, `ten_kappa` the weight of the last digit and `unit`
+ * the error bound of the scaling.
+ * @return 1 if the digits are the correctly rounded shortest ones, else 0.
+ */
+static int grisu_round_weed(char *digits, int length, uint64_t distance, uint64_t unsafe, uint64_t rest,
+                            uint64_t ten_kappa, uint64_t unit)
+{
+    const uint64_t small_distance = distance - unit;
+    const uint64_t big_distance = distance + unit;
+    while (rest < small_distance && unsafe - rest >= ten_kappa &&
+           (rest + ten_kappa < small_distance || small_distance - rest >= rest + ten_kappa - small_distance))
+    {
+        digits[length - 1]--;
+        rest += ten_kappa;
+    }
+    if (rest < big_distance && unsafe - rest >= ten_kappa &&
+        (rest + ten_kappa < big_distance || big_distance - rest > rest + ten_kappa - big_distance))
+        return 0;
+    return 2 * unit <= rest && rest <= unsafe - 4 * unit;
+}
+
+/**
+ * @brief Generates the digits of the scaled boundaries until they separate.
+ *
+ * `low` and `high` are the scaled rounding boundaries of w, each off by up
+ * to one unit, so only the interval narrowed by that much is certain.
+ * @return The number of digits, with *kappa set so that the scaled value is
+ * digits * 10^kappa, or 0 if the digits cannot be proven right.
+ */
+static int grisu_digits(DiyFp low, DiyFp w, DiyFp high, char *digits, int *kappa)
+{
+    uint64_t unit = 1;
+    const uint64_t too_high = high.f + unit;
+    uint64_t unsafe = too_high - (low.f - unit);
+    const int shift = -w.e;
+    const uint64_t one = (uint64_t)1 << shift;
+    uint32_t integrals = (uint32_t)(too_high >> shift);
+    uint64_t fractionals = too_high & (one - 1);
+
+    uint32_t divisor = 1;
+    *kappa = 1;
+    while (integrals / 10 >= divisor)
+    {
+        divisor *= 10;
+        (*kappa)++;
+    }
+    int length = 0;
+    while (*kappa > 0)
+    {
+        digits[length++] = (char)('0' + integrals / divisor);
+        integrals %= divisor;
+        (*kappa)--;
+        const uint64_t rest = ((uint64_t)integrals << shift) + fractionals;
+        if (rest < unsafe)
+            return grisu_round_weed(digits, length, too_high - w.f, unsafe, rest, (uint64_t)divisor << shift, unit) ? length : 0;
+        divisor /= 10;
+    }
+    for (;;)
+    {
+        fractionals *= 10;
+        unit *= 10;
+        unsafe *= 10;
+        digits[length++] = (char)('0' + (fractionals >> shift));
+        fractionals &= one - 1;
+        (*kappa)--;
+        if (fractionals < unsafe)
+            return grisu_round_weed(digits, length, (too_high - w.f) * unit, unsafe, fractionals, one, unit) ? length : 0;
+    }
+}
+
+/**
+ * @brief Finds the shortest digits that read back as `value` (finite and
+ * positive) with Grisu3.
+ *
+ * The value and the boundaries halfway to its neighbours are scaled by a
+ * power of ten into a range where their integer parts fit in 32 bits, and
+ * digits are generated until the boundaries differ.
+ * @return The number of digits, with *exponent10 set so that the value is
+ * digits * 10^exponent10, or 0 for the few values (about 0.5%) where
+ * Grisu3 cannot prove its digits shortest and closest.
+ */
+static int grisu3(double value, char *digits, int *exponent10)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    const uint64_t fraction = bits & (((uint64_t)1 << 52) - 1);
+    const int biased = (int)(bits >> 52) & 0x7FF;
+    const DiyFp v = biased == 0 ? (DiyFp){fraction, -1074} : (DiyFp){fraction | (uint64_t)1 << 52, biased - 1075};
+
+    // The lower boundary is closer when the value is a power of two.
+    const DiyFp plus = diy_normalize((DiyFp){(v.f << 1) + 1, v.e - 1});
+    DiyFp minus = fraction == 0 && biased > 1 ? (DiyFp){(v.f << 2) - 1, v.e - 2} : (DiyFp){(v.f << 1) - 1, v.e - 1};
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+    const DiyFp w = diy_normalize(v);
+
+    // 10^k brings the scaled exponent into [-60, -57].
+    const int k = (int)ceil((-61 - w.e) * 0.30102999566398114);
+    const uint64_t *power = POWERS_OF_FIVE[k - POWER_OF_FIVE_MIN];
+    DiyFp ten_k = {power[0] + (power[1] >> 63), floor_log2_pow10(k) - 63};
+    if (ten_k.f == 0) // Rounded up past 2^64
+        ten_k = (DiyFp){(uint64_t)1 << 63, ten_k.e + 1};
+
+    int kappa;
+    const int length = grisu_digits(diy_multiply(minus, ten_k), diy_multiply(w, ten_k), diy_multiply(plus, ten_k),
+                                    digits, &kappa);
+    *exponent10 = kappa - k;
+    return length;
+}
+
+/**
+ * @brief Writes the shortest text that reads back as `value`, laid out as
+ * "%.17g" lays it out, and returns a pointer to its terminating NUL. `out`
+ * needs room for NUMBER_MAX_TEXT characters.
+ *
+ * Grisu3 finds the digits; for the values it rejects, printf's correctly
+ * rounded digits are tried at increasing precision instead.
+ */
+static char *format_double(double value, char *out)
+{
+    if (!isfinite(value) || value == 0)
+        return out + sprintf(out, "%g", value);
+
+    const double magnitude = fabs(value);
+    char digits[NUMBER_MAX_TEXT];
+    int exponent10; // The value is digits * 10^exponent10
+    int length = grisu3(magnitude, digits, &exponent10);
+    if (length == 0)
+    {
+        char text[NUMBER_MAX_TEXT];
+        for (int precision = 0; precision <= 16; ++precision)
+        {
+            snprintf(text, sizeof(text), "%.*e", precision, magnitude);
+            if (strtod(text, NULL) == magnitude)
+                break;
+        }
+        const char *p = text;
+        for (; *p != 'e'; ++p)
+        {
+            if (*p != '.')
+                digits[length++] = *p;
+        }
+        exponent10 = atoi(p + 1) - (length - 1);
+    }
+    while (length > 1 && digits[length - 1] == '0')
+    {
+        length--;
+        exponent10++;
+    }
+
+    char *p = out;
+    if (value < 0)
+        *p++ = '-';
+    const int exponent = exponent10 + length - 1; // Of the first digit
+    if (exponent < -4 || exponent >= 17)
+    {
+        *p++ = digits[0];
+        if (length > 1)
+        {
+            *p++ = '.';
+            memcpy(p, digits + 1, (size_t)length - 1);
+            p += length - 1;
+        }
+        const int magnitude10 = exponent < 0 ? -exponent : exponent;
+        *p++ = 'e';
+        *p++ = exponent < 0 ? '-' : '+';
+        if (magnitude10 >= 100)
+            *p++ = (char)('0' + magnitude10 / 100);
+        *p++ = (char)('0' + magnitude10 / 10 % 10);
+        *p++ = (char)('0' + magnitude10 % 10);
+    }
+    else if (exponent < 0)
+    {
+        *p++ = '0';
+        *p++ = '.';
+        memset(p, '0', (size_t)(-exponent - 1));
+        p += -exponent - 1;
+        memcpy(p, digits, (size_t)length);
+        p += length;
+    }
+    else if (length <= exponent + 1)
+    {
+        memcpy(p, digits, (size_t)length);
+        p += length;
+        memset(p, '0', (size_t)(exponent + 1 - length));
+        p += exponent + 1 - length;
+    }
+    else
+    {
+        memcpy(p, digits, (size_t)exponent + 1);
+        p += exponent + 1;
+        *p++ = '.';
+        memcpy(p, digits + exponent + 1, (size_t)(length - exponent - 1));
+        p += length - exponent - 1;
+    }
+    *p = '\0';
+    return p;
+}
+
+// --- Bulk Evaluation ---
+
+/**
+ * @brief Returns the end of the line starting at `p`, before any CR.
+ */
+static const char *line_end(const char *p, const char *end, const char **next)
+{
+    const char *newline = (const char *)memchr(p, '\n', (size_t)(end - p));
+    *next = newline != NULL ? newline + 1 : end;
+    const char *stop = newline != NULL ? newline : end;
+    return stop > p && stop[-1] == '\r' ? stop - 1 : stop;
+}
+
+/**
+ * @brief Trims spaces and one pair of surrounding quotes from a field.
+ */
+static void trim_field(const char **begin, const char **end)
+{
+    while (*begin < *end && (**begin == ' ' || **begin == '\t'))
+        (*begin)++;
+    while (*end > *begin && ((*end)[-1] == ' ' || (*end)[-1] == '\t'))
+        (*end)--;
+    if (*end - *begin >= 2 && **begin == '"' && (*end)[-1] == '"')
+    {
+        (*begin)++;
+        (*end)--;
+    }
+}
+
+static void bulk_count_rows(void *arg)
+{
+    BulkTask *task = (BulkTask *)arg;
+    task->rows = 0;
+    for (const char *p = task->begin, *next; p < task->end; p = next)
+    {
+        if (line_end(p, task->end, &next) != p)
+            task->rows++; // Blank lines are skipped
+    }
+}
+
+static void bulk_fail(BulkTask *task, size_t row, int error, int column, const char *field, size_t length)
+{
+    task->error_row = row;
+    task->error = error;
+    task->error_column = column;
+    task->error_field = field;
+    task->error_length = length;
+}
+
+/**
+ * @brief Parses a chunk's fields into the columns, evaluates its rows a
+ * block at a time, and formats the results into the task's text.
+ *
+ * A block runs in the job's native code if it has any, else in the
+ * interpreter; with JIT_VERIFY, in both, and their results must match bit
+ * for bit.
+ */
+static void bulk_run_chunk(void *arg)
+{
+    BulkTask *task = (BulkTask *)arg;
+    const BulkJob *job = task->job;
+    const Program *program = job->program;
+
+    size_t row = task->first_row;
+    for (const char *p = task->begin, *next; p < task->end; p = next)
+    {
+        const char *stop = line_end(p, task->end, &next);
+        if (stop == p)
+            continue;
+        const char *field = p;
+        for (int column = 0; column < job->column_count; ++column)
+        {
+            if (field > stop)
+            {
+                bulk_fail(task, row, BULK_ERROR_MISSING, column, NULL, 0);
+                return;
+            }
+            const char *comma = (const char *)memchr(field, ',', (size_t)(stop - field));
+            const char *field_end = comma != NULL ? comma : stop;
+            const int variable = job->field_map[column];
+            if (variable >= 0)
+            {
+                const char *begin = field, *end = field_end;
+                trim_field(&begin, &end);
+                const int rc = parse_decimal(begin, end, &job->columns[variable][row]);
+                if (rc != 0)
+                {
+                    bulk_fail(task, row, rc, column, begin, (size_t)(end - begin));
+                    return;
+                }
+            }
+            field = field_end + 1;
+        }
+        row++;
+    }
+
+    double *stack = (double *)malloc(((size_t)program->max_depth + 1) * BULK_BLOCK * sizeof(double));
+    double *results = (double *)malloc(2 * BULK_BLOCK * sizeof(double));
+    double *expected = results + BULK_BLOCK; // The interpreter's results, when verifying
+    task->text = (char *)malloc(task->rows * 25 + 1); // format_double needs at most 24 characters
+    if (stack == NULL || results == NULL || task->text == NULL)
+    {
+        bulk_fail(task, task->first_row, BULK_ERROR_MEMORY, 0, NULL, 0);
+        free(stack);
+        free(results);
+        return;
+    }
+    const double *columns[EXPR_MAX_VARIABLES];
+    for (size_t done = 0; done < task->rows; done += BULK_BLOCK)
+    {
+        const size_t count = task->rows - done < BULK_BLOCK ? task->rows - done : BULK_BLOCK;
+        const size_t first = task->first_row + done;
+        for (int v = 0; v < EXPR_MAX_VARIABLES; ++v)
+            columns[v] = job->columns[v] != NULL ? job->columns[v] + first : NULL;
+        const int status = job->jit.run != NULL ? job->jit.run(columns, count, results)
+                                                : program_run_block(program, columns, job->scalars, count, stack, results);
+        if (job->jit_mode == JIT_VERIFY && job->jit.run != NULL)
+        {
+            // The first row that differs; when both fail, the rows are checked below.
+            size_t i = 0;
+            if (program_run_block(program, columns, job->scalars, count, stack, expected) == status)
+            {
+                i = status == EVAL_OK ? 0 : count;
+                while (i < count && memcmp(&results[i], &expected[i], sizeof(double)) == 0)
+                    i++;
+            }
+            if (i < count)
+            {
+                bulk_fail(task, first + i, BULK_ERROR_JIT, 0, NULL, 0);
+                break;
+            }
+        }
+        if (status != EVAL_OK)
+        {
+            // Find the first failing row the way evaluating it alone would.
+            double variables[EXPR_MAX_VARIABLES], unused;
+            for (size_t i = 0; i < count; ++i)
+            {
+                for (int v = 0; v < EXPR_MAX_VARIABLES; ++v)
+                    variables[v] = columns[v] != NULL ? columns[v][i] : job->scalars[v];
+                if (program_run(program, variables, &unused) != EVAL_OK)
+                {
+                    bulk_fail(task, first + i, BULK_ERROR_DIVISION, 0, NULL, 0);
+                    break;
+                }
+            }
+            break;
+        }
+        char *text = task->text + task->text_length;
+        for (size_t i = 0; i < count; ++i)
+        {
+            text = format_double(results[i], text);
+            *text++ = '\n';
+        }
+        task->text_length = (size_t)(text - task->text);
+    }
+    free(stack);
+    free(results);
+}
+
+/**
+ * @brief Runs `fn` on every task, the first on this thread and the rest on
+ * the pool's workers, or all on this thread when there is no pool.
+ */
+static void run_tasks(ThreadPool *pool, PoolTask fn, BulkTask *tasks, int count)
+{
+    for (int i = 1; i < count; ++i)
+    {
+        if (pool == NULL || pool_submit(pool, fn, &tasks[i]) != 0)
+            fn(&tasks[i]); // Could not hand it off: do its share here
+    }
+    if (count > 0)
+        fn(&tasks[0]);
+    if (pool != NULL)
+        pool_wait(pool);
+}
+
+/**
+ * @brief Reads a whole input, mapping regular files and reading anything
+ * else (such as a pipe) into memory.
+ * @return The contents, or NULL on error (after printing a message).
+ */
+static char *read_input(const char *path, size_t *length, int *mapped)
+{
+    const int fd = path != NULL ? open(path, O_RDONLY) : STDIN_FILENO;
+    if (fd < 0)
+    {
+        fprintf(stderr, "Error: Could not open '%s': %s\n", path, strerror(errno));
+        return NULL;
+    }
+    struct stat st;
+    *mapped = 0;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+    {
+        void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED)
+        {
+            posix_madvise(data, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+            if (fd != STDIN_FILENO)
+                close(fd);
+            *length = (size_t)st.st_size;
+            *mapped = 1;
+            return (char *)data;
+        }
+    }
+    size_t capacity = 1 << 20, used = 0;
+    char *data = (char *)malloc(capacity);
+    for (ssize_t n = 1; data != NULL && n > 0;)
+    {
+        if (used == capacity)
+        {
+            char *grown = (char *)realloc(data, capacity * 2);
+            if (grown == NULL)
+            {
+                free(data);
+                data = NULL;
+                break;
+            }
+            data = grown;
+            capacity *= 2;
+        }
+        n = read(fd, data + used, capacity - used);
+        if (n < 0 && errno == EINTR)
+            n = 1;
+        else if (n < 0)
+        {
+            perror("Error reading input");
+            free(data);
+            data = NULL;
+        }
+        else
+            used += (size_t)n;
+    }
+    if (fd != STDIN_FILENO)
+        close(fd);
+    *length = used;
+    return data;
+}
+
+/**
+ * @brief Parses the header row into variable names, one per column.
+ * @param header A writable copy of the header line; the names point into it.
+ * @return The number of columns, or -1 on error (after printing a message).
+ */
+static int parse_header(char *header, int max_columns, const char **names, const char *display)
+{
+    int count = 0;
+    for (char *field = header; *header != '\0';)
+    {
+        char *comma = strchr(field, ',');
+        if (comma != NULL)
+            *comma = '\0';
+        if (count == max_columns)
+        {
+            fprintf(stderr, "Error: '%s' has too many columns; at most %d are supported.\n", display, max_columns);
+            return -1;
+        }
+        const char *name = field, *name_end = field + strlen(field);
+        trim_field(&name, &name_end);
+        *(char *)name_end = '\0';
+        names[count++] = name;
+        if (comma == NULL)
+            break;
+        field = comma + 1;
+    }
+    if (count == 0)
+    {
+        fprintf(stderr, "Error: '%s' has no header row naming its columns.\n", display);
+        return -1;
+    }
+    return count;
+}
+
+/**
+ * @brief Prints the error of the first failing row, whichever thread found it.
+ * @return 0 if no row failed, -1 otherwise.
+ */
+static int bulk_report(const BulkTask *tasks, int task_count, const char *const *names, const char *display)
+{
+    const BulkTask *failed = NULL;
+    for (int t = 0; t < task_count; ++t)
+    {
+        if (tasks[t].error != BULK_ERROR_NONE && (failed == NULL || tasks[t].error_row < failed->error_row))
+            failed = &tasks[t];
+    }
+    if (failed == NULL)
+        return 0;
+    const size_t row = failed->error_row + 1;
+    const char *column = names[failed->error_column];
+    switch (failed->error)
+    {
+    case BULK_ERROR_NUMBER:
+        fprintf(stderr, "Error: Row %zu of '%s': '%.*s' in column '%s' is not a valid number.\n", row, display,
+                (int)failed->error_length, failed->error_field, column);
+        break;
+    case BULK_ERROR_RANGE:
+        fprintf(stderr, "Error: Row %zu of '%s': '%.*s' in column '%s' is out of the representable range.\n", row,
+                display, (int)failed->error_length, failed->error_field, column);
+        break;
+    case BULK_ERROR_MISSING:
+        fprintf(stderr, "Error: Row %zu of '%s' has no value for column '%s'.\n", row, display, column);
+        break;
+    case BULK_ERROR_DIVISION:
+        fprintf(stderr, "Error: Division by zero is not allowed (row %zu of '%s').\n", row, display);
+        break;
+    case BULK_ERROR_JIT:
+        fprintf(stderr, "Error: Native code and the interpreter disagree on row %zu of '%s'.\n", row, display);
+        break;
+    default:
+        fprintf(stderr, "Error: Failed to allocate memory for the results.\n");
+        break;
+    }
+    return -1;
+}
+
+/**
+ * @brief Splits the rows in [body, end) into chunks of whole lines, one per
+ * thread, parses and evaluates them, and writes the results in order.
+ * @return 0 on success, -1 on error (after printing a message).
+ */
+static int bulk_run(BulkJob *job, const char *body, const char *end, int thread_count, const char *const *names, const char *display)
+{
+    if (thread_count == 0)
+    {
+        const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_count = cpus < 1 ? 1 : (cpus > BULK_MAX_THREADS ? BULK_MAX_THREADS : (int)cpus);
+        const size_t useful = (size_t)(end - body) / BULK_MIN_CHUNK + 1;
+        if ((size_t)thread_count > useful)
+            thread_count = (int)useful;
+    }
+    BulkTask tasks[BULK_MAX_THREADS];
+    int task_count = 0;
+    for (const char *p = body; task_count < thread_count && p < end;)
+    {
+        const char *stop = p + (size_t)(end - p) / (size_t)(thread_count - task_count);
+        const char *newline = stop < end ? (const char *)memchr(stop, '\n', (size_t)(end - stop)) : NULL;
+        stop = newline != NULL ? newline + 1 : end;
+        tasks[task_count++] = (BulkTask){job, p, stop, 0, 0, SIZE_MAX, BULK_ERROR_NONE, 0, NULL, 0, NULL, 0};
+        p = stop;
+    }
+    // The pool is shared by both passes; without one, the work runs serially.
+    ThreadPool *pool = task_count > 1 ? pool_create(task_count - 1) : NULL;
+    run_tasks(pool, bulk_count_rows, tasks, task_count);
+    size_t rows = 0;
+    for (int t = 0; t < task_count; ++t)
+    {
+        tasks[t].first_row = rows;
+        rows += tasks[t].rows;
+    }
+
+    int rc = 0;
+    for (int column = 0; column < job->column_count; ++column)
+    {
+        job->field_map[column] = -1;
+        if (rc == 0 && (job->program->variables_used & ((uint64_t)1 << column)))
+        {
+            job->field_map[column] = column;
+            job->columns[column] = (double *)malloc((rows ? rows : 1) * sizeof(double));
+            if (job->columns[column] == NULL)
+            {
+                perror("Failed to allocate memory for the input columns");
+                rc = -1;
+            }
+        }
+    }
+    if (rc == 0)
+    {
+        run_tasks(pool, bulk_run_chunk, tasks, task_count);
+        rc = bulk_report(tasks, task_count, names, display);
+    }
+    if (rc == 0)
+    {
+        static char output_buffer[BULK_OUTPUT_BUFFER];
+        setvbuf(stdout, output_buffer, _IOFBF, sizeof(output_buffer));
+        for (int t = 0; t < task_count; ++t)
+            fwrite(tasks[t].text, 1, tasks[t].text_length, stdout);
+        if (fflush(stdout) != 0)
+        {
+            perror("Error writing results");
+            rc = -1;
+        }
+    }
+    pool_destroy(pool);
+    for (int t = 0; t < task_count; ++t)
+        free(tasks[t].text);
+    for (int column = 0; column < job->column_count; ++column)
+        free(job->columns[column]);
+    return rc;
+}
+
+/**
+ * @brief Evaluates `expression` for every row of a CSV input and prints
+ * one result per line.
+ *
+ * @param input The CSV file to read, or NULL for stdin.
+ * @param thread_count Threads to use, or 0 for one per online CPU.
+ * @param jit_mode JIT_OFF, JIT_ON or JIT_VERIFY.
+ * @return 0 on success, -1 on error (after printing a message).
+ */
+static int bulk_evaluate(const char *expression, const char *input, int thread_count, int jit_mode, int binding_count,
+                         char *bindings[])
+{
+    const char *names[EXPR_MAX_VARIABLES];
+    double values[EXPR_MAX_VARIABLES];
+    if (parse_bindings(binding_count, bindings, names, values) != 0)
+        return -1;
+    size_t length;
+    int mapped;
+    char *data = read_input(input, &length, &mapped);
+    if (data == NULL)
+        return -1;
+    const char *display = input != NULL ? input : "stdin";
+
+    // The header names the columns; the bindings follow them as variables,
+    // so that a name bound on the command line hides a column.
+    const char *body;
+    const char *header_end = line_end(data, data + length, &body);
+    char *header = (char *)malloc((size_t)(header_end - data) + 1);
+    const char *all_names[EXPR_MAX_VARIABLES];
+    BulkJob job;
+    memset(&job, 0, sizeof(job));
+    Program program;
+    int rc = -1;
+    if (header == NULL)
+    {
+        perror("Failed to allocate memory");
+    }
+    else
+    {
+        memcpy(header, data, (size_t)(header_end - data));
+        header[header_end - data] = '\0';
+        job.column_count = parse_header(header, EXPR_MAX_VARIABLES - binding_count, all_names, display);
+    }
+    if (job.column_count > 0)
+    {
+        for (int i = 0; i < binding_count; ++i)
+        {
+            all_names[job.column_count + i] = names[i];
+            job.scalars[job.column_count + i] = values[i];
+        }
+        if (program_compile(&program, expression, all_names, job.column_count + binding_count, 0) == 0)
+        {
+            job.program = &program;
+            job.jit_mode = jit_mode;
+            if (jit_mode != JIT_OFF && jit_compile(&job.jit, &program, job.column_count, job.scalars) != 0)
+                fprintf(stderr, "Note: No native code for this expression; using the interpreter.\n");
+            rc = bulk_run(&job, body, data + length, thread_count, all_names, display);
+            jit_free(&job.jit);
+            program_free(&program);
+        }
+    }
+    free(header);
+    if (mapped)
+        munmap(data, length);
+    else
+        free(data);
+    return rc;
+}
+
+// --- Exact Arithmetic ---
+
+/*
+ * The sizes, in limbs, from which multiplication and division switch to
+ * their asymptotically faster algorithms. The defaults are the crossovers
+ * `make bench` measures; they are variables only so that the benchmark can
+ * move them.
+ */
+static size_t karatsuba_threshold = BIG_KARATSUBA_THRESHOLD;
+static size_t toom3_threshold = BIG_TOOM3_THRESHOLD;
+static size_t newton_threshold = BIG_NEWTON_THRESHOLD;
+
+/**
+ * @brief Allocates `count` limbs, exiting if memory runs out.
+ */
+static uint32_t *big_alloc(size_t count)
+{
+    uint32_t *limbs = (uint32_t *)malloc((count ? count : 1) * sizeof(uint32_t));
+    if (limbs == NULL)
+    {
+        perror("Failed to allocate memory for a number");
+        exit(EXIT_FAILURE);
+    }
+    return limbs;
+}
+
+static void big_init(BigInt *x)
+{
+    memset(x, 0, sizeof(*x));
+}
+
+static void big_free(BigInt *x)
+{
+    free(x->limbs);
+    big_init(x);
+}
+
+/**
+ * @brief Makes room for `capacity` limbs, exiting if memory runs out.
+ */
+static void big_reserve(BigInt *x, size_t capacity)
+{
+    if (capacity <= x->capacity)
+        return;
+    uint32_t *limbs = (uint32_t *)realloc(x->limbs, capacity * sizeof(uint32_t));
+    if (limbs == NULL)
+    {
+        perror("Failed to allocate memory for a number");
+        exit(EXIT_FAILURE);
+    }
+    x->limbs = limbs;
+    x->capacity = capacity;
+}
+
+/**
+ * @brief Drops leading zero limbs; zero is never negative.
+ */
+static void big_trim(BigInt *x)
+{
+    while (x->length > 0 && x->limbs[x->length - 1] == 0)
+        x->length--;
+    if (x->length == 0)
+        x->negative = 0;
+}
+
+static void big_set_u32(BigInt *x, uint32_t value)
+{
+    big_reserve(x, 1);
+    x->limbs[0] = value;
+    x->length = 1;
+    x->negative = 0;
+    big_trim(x);
+}
+
+static void big_set_limbs(BigInt *x, const uint32_t *limbs, size_t count)
+{
+    big_reserve(x, count);
+    memcpy(x->limbs, limbs, count * sizeof(uint32_t));
+    x->length = count;
+    x->negative = 0;
+    big_trim(x);
+}
+
+static void big_copy(BigInt *dst, const BigInt *src)
+{
+    if (dst == src)
+        return;
+    big_reserve(dst, src->length);
+    if (src->length != 0)
+        memcpy(dst->limbs, src->limbs, src->length * sizeof(uint32_t));
+    dst->length = src->length;
+    dst->negative = src->negative;
+}
+
+static void big_swap(BigInt *a, BigInt *b)
+{
+    const BigInt t = *a;
+    *a = *b;
+    *b = t;
+}
+
+/**
+ * @brief Returns a read-only view of |x|, sharing its limbs.
+ */
+static BigInt big_magnitude(const BigInt *x)
+{
+    BigInt view = *x;
+    view.negative = 0;
+    return view;
+}
+
+static size_t big_bit_length(const BigInt *x)
+{
+    if (x->length == 0)
+        return 0;
+    size_t bits = (x->length - 1) * 32;
+    for (uint32_t top = x->limbs[x->length - 1]; top != 0; top >>= 1)
+        bits++;
+    return bits;
+}
+
+/**
+ * @brief Compares two trimmed magnitudes.
+ * @return Negative, zero or positive, as for memcmp.
+ */
+static int mpn_compare(const uint32_t *a, size_t an, const uint32_t *b, size_t bn)
+{
+    if (an != bn)
+        return an < bn ? -1 : 1;
+    while (an-- > 0)
+    {
+        if (a[an] != b[an])
+            return a[an] < b[an] ? -1 : 1;
+    }
+    return 0;
+}
+
+static int big_compare_magnitude(const BigInt *a, const BigInt *b)
+{
+    return mpn_compare(a->limbs, a->length, b->limbs, b->length);
+}
+
+/**
+ * @brief r = a + b, for an >= bn; r may be a.
+ * @return The carry out of the top limb.
+ */
+static uint32_t mpn_add(uint32_t *r, const uint32_t *a, size_t an, const uint32_t *b, size_t bn)
+{
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < bn; ++i)
+    {
+        carry += (uint64_t)a[i] + b[i];
+        r[i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    for (; i < an && carry != 0; ++i)
+    {
+        carry += a[i];
+        r[i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    if (r != a && i < an)
+        memcpy(r + i, a + i, (an - i) * sizeof(uint32_t));
+    return (uint32_t)carry;
+}
+
+/**
+ * @brief r = a - b, for an >= bn; r may be a.
+ * @return The borrow out of the top limb.
+ */
+static uint32_t mpn_sub(uint32_t *r, const uint32_t *a, size_t an, const uint32_t *b, size_t bn)
+{
+    uint32_t borrow = 0;
+    size_t i = 0;
+    for (; i < bn; ++i)
+    {
+        const uint64_t difference = (uint64_t)a[i] - b[i] - borrow;
+        r[i] = (uint32_t)difference;
+        borrow = (uint32_t)(difference >> 63);
+    }
+    for (; i < an && borrow != 0; ++i)
+    {
+        borrow = a[i] == 0;
+        r[i] = a[i] - 1;
+    }
+    if (r != a && i < an)
+        memcpy(r + i, a + i, (an - i) * sizeof(uint32_t));
+    return borrow;
+}
+
+/**
+ * @brief r = a * b by the schoolbook method, which is fastest for small
+ * operands. r holds an + bn limbs and must not overlap a or b.
+ */
+static void mpn_mul_basecase(uint32_t *r, const uint32_t *a, size_t an, const uint32_t *b, size_t bn)
+{
+    memset(r, 0, (an + bn) * sizeof(uint32_t));
+    for (size_t j = 0; j < bn; ++j)
+    {
+        const uint64_t digit = b[j];
+        uint64_t carry = 0;
+        for (size_t i = 0; i < an; ++i)
+        {
+            carry += a[i] * digit + r[i + j];
+            r[i + j] = (uint32_t)carry;
+            carry >>= 32;
+        }
+        r[an + j] = (uint32_t)carry;
+    }
+}
+
+/**
+ * @brief r = a * b for two n-limb numbers by Karatsuba's method: three
+ * half-size products, (a0 + a1)(b0 + b1) standing in for a0 b1 + a1 b0.
+ */
+static void mpn_mul_karatsuba(uint32_t *r, const uint32_t *a, const uint32_t *b, size_t n)
+{
+    const size_t low = (n + 1) / 2, high = n - low;
+    uint32_t *sum_a = big_alloc(4 * (low + 1));
+    uint32_t *sum_b = sum_a + low + 1;
+    uint32_t *middle = sum_b + low + 1; // 2 * (low + 1) limbs
+
+    sum_a[low] = mpn_add(sum_a, a, low, a + low, high);
+    sum_b[low] = mpn_add(sum_b, b, low, b + low, high);
+    mpn_mul_n(r, a, b, low);
+    mpn_mul_n(r + 2 * low, a + low, b + low, high);
+    mpn_mul_n(middle, sum_a, sum_b, low + 1);
+    mpn_sub(middle, middle, 2 * low + 2, r, 2 * low);
+    mpn_sub(middle, middle, 2 * low + 2, r + 2 * low, 2 * high);
+
+    // a0 b1 + a1 b0 fits in n + 1 limbs, so any limbs past the end are zero.
+    const size_t span = 2 * n - low;
+    mpn_add(r + low, r + low, span, middle, 2 * low + 2 < span ? 2 * low + 2 : span);
+    free(sum_a);
+}
+
+/**
+ * @brief Sets p[0..4] to the polynomial x0 + x1 t + x2 t^2 at t = 0, 1,
+ * -1, -2 and infinity.
+ */
+static void toom3_evaluate(BigInt p[5], const BigInt *x0, const BigInt *x1, const BigInt *x2)
+{
+    big_copy(&p[0], x0);
+    big_add(&p[1], x0, x2);
+    big_sub(&p[2], &p[1], x1);
+    big_add(&p[1], &p[1], x1);
+    big_add(&p[3], &p[2], x2);
+    big_shift_left(&p[3], &p[3], 1);
+    big_sub(&p[3], &p[3], x0);
+    big_copy(&p[4], x2);
+}
+
+/**
+ * @brief r = a * b for two n-limb numbers by Toom-Cook 3-way splitting:
+ * five third-size products at the points of toom3_evaluate, interpolated
+ * back with Bodrato's sequence.
+ */
+static void mpn_mul_toom3(uint32_t *r, const uint32_t *a, const uint32_t *b, size_t n)
+{
+    const size_t k = (n + 2) / 3;
+    BigInt pieces[6], p[5], q[5], v[5], t;
+    for (int i = 0; i < 6; ++i)
+        big_init(&pieces[i]);
+    for (int i = 0; i < 5; ++i)
+    {
+        big_init(&p[i]);
+        big_init(&q[i]);
+        big_init(&v[i]);
+    }
+    big_init(&t);
+
+    big_set_limbs(&pieces[0], a, k);
+    big_set_limbs(&pieces[1], a + k, k);
+    big_set_limbs(&pieces[2], a + 2 * k, n - 2 * k);
+    big_set_limbs(&pieces[3], b, k);
+    big_set_limbs(&pieces[4], b + k, k);
+    big_set_limbs(&pieces[5], b + 2 * k, n - 2 * k);
+    toom3_evaluate(p, &pieces[0], &pieces[1], &pieces[2]);
+    toom3_evaluate(q, &pieces[3], &pieces[4], &pieces[5]);
+    for (int i = 0; i < 5; ++i)
+        big_mul(&v[i], &p[i], &q[i]);
+
+    // v = r(0), r(1), r(-1), r(-2), r(inf); the divisions are exact.
+    BigInt *r0 = &v[0], *r1 = &v[1], *r2 = &v[2], *r3 = &v[3], *r4 = &v[4];
+    big_sub(r3, r3, r1);
+    big_div_small(r3, 3);
+    big_sub(r1, r1, r2);
+    big_shift_right(r1, r1, 1);
+    big_sub(r2, r2, r0);
+    big_sub(r3, r2, r3);
+    big_shift_right(r3, r3, 1);
+    big_shift_left(&t, r4, 1);
+    big_add(r3, r3, &t);
+    big_add(r2, r2, r1);
+    big_sub(r2, r2, r4);
+    big_sub(r1, r1, r3);
+
+    // Horner's rule in t = 2^(32k).
+    big_copy(&t, r4);
+    for (int i = 3; i >= 0; --i)
+    {
+        big_shift_left(&t, &t, 32 * k);
+        big_add(&t, &t, &v[i]);
+    }
+    memcpy(r, t.limbs, t.length * sizeof(uint32_t));
+    memset(r + t.length, 0, (2 * n - t.length) * sizeof(uint32_t));
+
+    for (int i = 0; i < 6; ++i)
+        big_free(&pieces[i]);
+    for (int i = 0; i < 5; ++i)
+    {
+        big_free(&p[i]);
+        big_free(&q[i]);
+        big_free(&v[i]);
+    }
+    big_free(&t);
+}
+
+/**
+ * @brief r = a * b for two n-limb numbers, by whichever method is fastest
+ * at that size.
+ */
+static void mpn_mul_n(uint32_t *r, const uint32_t *a, const uint32_t *b, size_t n)
+{
+    if (n < karatsuba_threshold)
+        mpn_mul_basecase(r, a, n, b, n);
+    else if (n < toom3_threshold)
+        mpn_mul_karatsuba(r, a, b, n);
+    else
+        mpn_mul_toom3(r, a, b, n);
+}
+
+/**
+ * @brief r = a * b for an >= bn. A much longer a is multiplied in bn-limb
+ * slices so that the fast methods still see balanced operands.
+ */
+static void mpn_mul(uint32_t *r, const uint32_t *a, size_t an, const uint32_t *b, size_t bn)
+{
+    if (bn < karatsuba_threshold)
+    {
+        mpn_mul_basecase(r, a, an, b, bn);
+        return;
+    }
+    if (an == bn)
+    {
+        mpn_mul_n(r, a, b, bn);
+        return;
+    }
+    memset(r, 0, (an + bn) * sizeof(uint32_t));
+    uint32_t *slice = big_alloc(2 * bn);
+    for (size_t offset = 0; offset < an; offset += bn)
+    {
+        const size_t count = an - offset < bn ? an - offset : bn;
+        if (count == bn)
+            mpn_mul_n(slice, a + offset, b, bn);
+        else
+            mpn_mul(slice, b, bn, a + offset, count);
+        mpn_add(r + offset, r + offset, an + bn - offset, slice, count + bn);
+    }
+    free(slice);
+}
+
+/**
+ * @brief r = a + b with b's sign taken as `b_negative`.
+ */
+static void big_add_signed(BigInt *r, const BigInt *a, const BigInt *b, int b_negative)
+{
+    BigInt sum;
+    big_init(&sum);
+    const BigInt *x = a, *y = b;
+    if (a->negative == b_negative)
+    {
+        if (x->length < y->length)
+            x = b, y = a;
+        big_reserve(&sum, x->length + 1);
+        sum.limbs[x->length] = mpn_add(sum.limbs, x->limbs, x->length, y->limbs, y->length);
+        sum.length = x->length + 1;
+        sum.negative = a->negative;
+    }
+    else
+    {
+        sum.negative = a->negative;
+        if (big_compare_magnitude(a, b) < 0)
+        {
+            x = b, y = a;
+            sum.negative = b_negative;
+        }
+        big_reserve(&sum, x->length + 1);
+        mpn_sub(sum.limbs, x->limbs, x->length, y->limbs, y->length);
+        sum.length = x->length;
+    }
+    big_trim(&sum);
+    big_swap(r, &sum);
+    big_free(&sum);
+}
+
+static void big_add(BigInt *r, const BigInt *a, const BigInt *b)
+{
+    big_add_signed(r, a, b, b->negative);
+}
+
+static void big_sub(BigInt *r, const BigInt *a, const BigInt *b)
+{
+    big_add_signed(r, a, b, !b->negative);
+}
+
+/**
+ * @brief r = a + delta for a small signed delta.
+ */
+static void big_add_small(BigInt *r, const BigInt *a, int delta)
+{
+    uint32_t limb = (uint32_t)(delta < 0 ? -delta : delta);
+    const BigInt small = {&limb, 1, 1, delta < 0};
+    big_add(r, a, &small);
+}
+
+static void big_mul(BigInt *r, const BigInt *a, const BigInt *b)
+{
+    if (a->length == 0 || b->length == 0)
+    {
+        r->length = 0;
+        r->negative = 0;
+        return;
+    }
+    BigInt product;
+    big_init(&product);
+    big_reserve(&product, a->length + b->length);
+    if (a->length >= b->length)
+        mpn_mul(product.limbs, a->limbs, a->length, b->limbs, b->length);
+    else
+        mpn_mul(product.limbs, b->limbs, b->length, a->limbs, a->length);
+    product.length = a->length + b->length;
+    product.negative = a->negative != b->negative;
+    big_trim(&product);
+    big_swap(r, &product);
+    big_free(&product);
+}
+
+/**
+ * @brief x = x * factor + addend, for x >= 0.
+ */
+static void big_mul_small(BigInt *x, uint32_t factor, uint32_t addend)
+{
+    uint64_t carry = addend;
+    for (size_t i = 0; i < x->length; ++i)
+    {
+        carry += (uint64_t)x->limbs[i] * factor;
+        x->limbs[i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    if (carry != 0)
+    {
+        big_reserve(x, x->length + 1);
+        x->limbs[x->length++] = (uint32_t)carry;
+    }
+}
+
+/**
+ * @brief Divides |x| by `divisor` in place, keeping x's sign.
+ * @return The remainder.
+ */
+static uint32_t big_div_small(BigInt *x, uint32_t divisor)
+{
+    uint64_t remainder = 0;
+    for (size_t i = x->length; i-- > 0;)
+    {
+        remainder = remainder << 32 | x->limbs[i];
+        x->limbs[i] = (uint32_t)(remainder / divisor);
+        remainder %= divisor;
+    }
+    big_trim(x);
+    return (uint32_t)remainder;
+}
+
+/**
+ * @brief r = a * 2^bits, keeping a's sign.
+ */
+static void big_shift_left(BigInt *r, const BigInt *a, size_t bits)
+{
+    if (a->length == 0)
+    {
+        r->length = 0;
+        r->negative = 0;
+        return;
+    }
+    const size_t limbs = bits / 32;
+    const unsigned shift = bits % 32;
+    BigInt out;
+    big_init(&out);
+    big_reserve(&out, a->length + limbs + 1);
+    memset(out.limbs, 0, limbs * sizeof(uint32_t));
+    uint32_t carry = 0;
+    for (size_t i = 0; i < a->length; ++i)
+    {
+        out.limbs[limbs + i] = a->limbs[i] << shift | carry;
+        carry = shift ? a->limbs[i] >> (32 - shift) : 0;
+    }
+    out.limbs[limbs + a->length] = carry;
+    out.length = a->length + limbs + 1;
+    out.negative = a->negative;
+    big_trim(&out);
+    big_swap(r, &out);
+    big_free(&out);
+}
+
+/**
+ * @brief r = |a| / 2^bits, truncated, keeping a's sign.
+ */
+static void big_shift_right(BigInt *r, const BigInt *a, size_t bits)
+{
+    const size_t limbs = bits / 32;
+    const unsigned shift = bits % 32;
+    if (limbs >= a->length)
+    {
+        r->length = 0;
+        r->negative = 0;
+        return;
+    }
+    BigInt out;
+    big_init(&out);
+    const size_t length = a->length - limbs;
+    big_reserve(&out, length);
+    for (size_t i = 0; i < length; ++i)
+    {
+        uint64_t value = a->limbs[limbs + i] >> shift;
+        if (shift != 0 && i + 1 < length)
+            value |= (uint64_t)a->limbs[limbs + i + 1] << (32 - shift);
+        out.limbs[i] = (uint32_t)value;
+    }
+    out.length = length;
+    out.negative = a->negative;
+    big_trim(&out);
+    big_swap(r, &out);
+    big_free(&out);
+}
+
+/**
+ * @brief Schoolbook long division of magnitudes (Knuth's algorithm D),
+ * for a >= b. Either output may be NULL.
+ */
+static void big_divmod_basecase(BigInt *quotient, BigInt *remainder, const BigInt *a, const BigInt *b)
+{
+    const size_t n = b->length, m = a->length - n;
+    BigInt q;
+    big_init(&q);
+    if (n == 1)
+    {
+        big_copy(&q, a);
+        const uint32_t rest = big_div_small(&q, b->limbs[0]);
+        if (remainder != NULL)
+            big_set_u32(remainder, rest);
+        if (quotient != NULL)
+            big_swap(quotient, &q);
+        big_free(&q);
+        return;
+    }
+
+    // Shift both so that the divisor's top bit is set, which keeps each
+    // estimated quotient digit at most two too large.
+    unsigned shift = 0;
+    while ((b->limbs[n - 1] << shift & 0x80000000u) == 0)
+        shift++;
+    uint32_t *vn = big_alloc(n), *un = big_alloc(a->length + 1);
+    for (size_t i = n - 1; i > 0; --i)
+        vn[i] = b->limbs[i] << shift | (shift ? b->limbs[i - 1] >> (32 - shift) : 0);
+    vn[0] = b->limbs[0] << shift;
+    un[a->length] = shift ? a->limbs[a->length - 1] >> (32 - shift) : 0;
+    for (size_t i = a->length - 1; i > 0; --i)
+        un[i] = a->limbs[i] << shift | (shift ? a->limbs[i - 1] >> (32 - shift) : 0);
+    un[0] = a->limbs[0] << shift;
+
+    big_reserve(&q, m + 1);
+    q.length = m + 1;
+    for (size_t j = m + 1; j-- > 0;)
+    {
+        const uint64_t numerator = (uint64_t)un[j + n] << 32 | un[j + n - 1];
+        uint64_t qhat = numerator / vn[n - 1], rhat = numerator % vn[n - 1];
+        while (qhat > UINT32_MAX || qhat * vn[n - 2] > (rhat << 32 | un[j + n - 2]))
+        {
+            qhat--;
+            rhat += vn[n - 1];
+            if (rhat > UINT32_MAX)
+                break;
+        }
+        // un[j..j+n] -= qhat * vn
+        int64_t borrow = 0, t;
+        for (size_t i = 0; i < n; ++i)
+        {
+            const uint64_t product = qhat * vn[i];
+            t = (int64_t)un[i + j] - borrow - (int64_t)(product & UINT32_MAX);
+            un[i + j] = (uint32_t)t;
+            borrow = (int64_t)(product >> 32) - (t >> 32);
+        }
+        t = (int64_t)un[j + n] - borrow;
+        un[j + n] = (uint32_t)t;
+        if (t < 0) // qhat was one too large: add a divisor back
+        {
+            qhat--;
+            uint64_t carry = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                carry += (uint64_t)un[i + j] + vn[i];
+                un[i + j] = (uint32_t)carry;
+                carry >>= 32;
+            }
+            un[j + n] += (uint32_t)carry;
+        }
+        q.limbs[j] = (uint32_t)qhat;
+    }
+    big_trim(&q);
+
+    if (remainder != NULL)
+    {
+        big_reserve(remainder, n);
+        for (size_t i = 0; i < n; ++i)
+            remainder->limbs[i] = un[i] >> shift | (shift ? un[i + 1] << (32 - shift) : 0);
+        remainder->length = n;
+        remainder->negative = 0;
+        big_trim(remainder);
+    }
+    if (quotient != NULL)
+        big_swap(quotient, &q);
+    big_free(&q);
+    free(vn);
+    free(un);
+}
+
+/**
+ * @brief x = floor(2^(2k) / d) for a d of exactly k bits, by Newton's
+ * iteration x' = 2x - d x^2 / 2^(2k) from the reciprocal of d's top half,
+ * so each step doubles the precision at the cost of a few multiplications
+ * of the current size.
+ */
+static void big_reciprocal(BigInt *x, const BigInt *d, size_t k)
+{
+    BigInt power, t;
+    big_init(&power);
+    big_init(&t);
+    big_set_u32(&power, 1);
+    big_shift_left(&power, &power, 2 * k);
+    if (k < 32 * newton_threshold)
+    {
+        big_divmod_basecase(x, NULL, &power, d);
+        big_free(&power);
+        return;
+    }
+
+    const size_t h = (k + 1) / 2;
+    BigInt top, inverse;
+    big_init(&top);
+    big_init(&inverse);
+    big_shift_right(&top, d, k - h);
+    big_reciprocal(&inverse, &top, h);
+    big_mul(&t, &inverse, &inverse);
+    big_mul(&t, &t, d);
+    big_shift_right(&t, &t, 2 * h);
+    big_shift_left(x, &inverse, k - h + 1);
+    big_sub(x, x, &t);
+
+    // The step leaves x within a few units of the answer; settle it
+    // against the exact remainder 2^(2k) - d x.
+    big_mul(&t, d, x);
+    big_sub(&t, &power, &t);
+    while (t.negative)
+    {
+        big_add_small(x, x, -1);
+        big_add(&t, &t, d);
+    }
+    while (big_compare_magnitude(&t, d) >= 0)
+    {
+        big_add_small(x, x, 1);
+        big_sub(&t, &t, d);
+    }
+    big_free(&top);
+    big_free(&inverse);
+    big_free(&power);
+    big_free(&t);
+}
+
+/**
+ * @brief Division of magnitudes, for a >= b, by multiplying with a Newton
+ * reciprocal of the divisor.
+ */
+static void big_divmod_newton(BigInt *quotient, BigInt *remainder, const BigInt *a, const BigInt *b)
+{
+    const size_t n = big_bit_length(a), m = big_bit_length(b), quotient_bits = n - m + 1;
+    BigInt numerator, divisor, inverse, q, r;
+    big_init(&numerator);
+    big_init(&divisor);
+    big_init(&inverse);
+    big_init(&q);
+    big_init(&r);
+
+    // Scale the operands so that the numerator has at most twice the
+    // divisor's bits: a long divisor only needs its leading bits to find a
+    // short quotient, and a short one is widened to the quotient's size.
+    if (m > quotient_bits + 32)
+    {
+        big_shift_right(&numerator, a, m - quotient_bits - 32);
+        big_shift_right(&divisor, b, m - quotient_bits - 32);
+    }
+    else
+    {
+        const size_t shift = n > 2 * m ? n - 2 * m : 0;
+        big_shift_left(&numerator, a, shift);
+        big_shift_left(&divisor, b, shift);
+    }
+    const size_t k = big_bit_length(&divisor);
+    big_reciprocal(&inverse, &divisor, k);
+    big_mul(&q, &numerator, &inverse);
+    big_shift_right(&q, &q, 2 * k);
+
+    big_mul(&r, &q, b);
+    big_sub(&r, a, &r);
+    while (r.negative)
+    {
+        big_add_small(&q, &q, -1);
+        big_add(&r, &r, b);
+    }
+    while (big_compare_magnitude(&r, b) >= 0)
+    {
+        big_add_small(&q, &q, 1);
+        big_sub(&r, &r, b);
+    }
+    if (quotient != NULL)
+        big_swap(quotient, &q);
+    if (remainder != NULL)
+        big_swap(remainder, &r);
+    big_free(&numerator);
+    big_free(&divisor);
+    big_free(&inverse);
+    big_free(&q);
+    big_free(&r);
+}
+
+/**
+ * @brief Divides a by a nonzero b, truncating toward zero as C does; the
+ * remainder takes a's sign. Either output may be NULL or alias an input.
+ */
+static void big_divmod(BigInt *quotient, BigInt *remainder, const BigInt *a, const BigInt *b)
+{
+    const BigInt ua = big_magnitude(a), ub = big_magnitude(b);
+    const int quotient_negative = a->negative != b->negative, remainder_negative = a->negative;
+    BigInt q, r;
+    big_init(&q);
+    big_init(&r);
+    if (big_compare_magnitude(&ua, &ub) < 0)
+        big_copy(&r, &ua);
+    else if (ub.length < newton_threshold || ua.length - ub.length < newton_threshold)
+        big_divmod_basecase(&q, &r, &ua, &ub);
+    else
+        big_divmod_newton(&q, &r, &ua, &ub);
+    q.negative = quotient_negative && q.length != 0;
+    r.negative = remainder_negative && r.length != 0;
+    if (quotient != NULL)
+        big_swap(quotient, &q);
+    if (remainder != NULL)
+        big_swap(remainder, &r);
+    big_free(&q);
+    big_free(&r);
+}
+
+/**
+ * @brief r = base^exponent by repeated squaring.
+ */
+static void big_pow(BigInt *r, const BigInt *base, uint64_t exponent)
+{
+    BigInt result, square;
+    big_init(&result);
+    big_init(&square);
+    big_set_u32(&result, 1);
+    big_copy(&square, base);
+    while (exponent != 0)
+    {
+        if (exponent & 1)
+            big_mul(&result, &result, &square);
+        exponent >>= 1;
+        if (exponent != 0)
+            big_mul(&square, &square, &square);
+    }
+    big_swap(r, &result);
+    big_free(&result);
+    big_free(&square);
+}
+
+static void big_pow10(BigInt *r, uint64_t exponent)
+{
+    BigInt ten;
+    big_init(&ten);
+    big_set_u32(&ten, 10);
+    big_pow(r, &ten, exponent);
+    big_free(&ten);
+}
+
+/**
+ * @brief r = floor(sqrt(n)) for n >= 0, by Newton's iteration from above.
+ */
+static void big_isqrt(BigInt *r, const BigInt *n)
+{
+    BigInt x, y;
+    big_init(&x);
+    big_init(&y);
+    if (n->length != 0)
+    {
+        big_set_u32(&x, 1);
+        big_shift_left(&x, &x, (big_bit_length(n) + 1) / 2);
+        for (;;)
+        {
+            big_divmod(&y, NULL, n, &x);
+            big_add(&y, &y, &x);
+            big_shift_right(&y, &y, 1);
+            if (big_compare_magnitude(&y, &x) >= 0)
+                break;
+            big_swap(&x, &y);
+        }
+    }
+    big_swap(r, &x);
+    big_free(&x);
+    big_free(&y);
+}
+
+/**
+ * @brief r = the decimal digits [digits, digits + count). Long numbers are
+ * split in half and joined with one multiplication, so the conversion
+ * costs about as much as the multiplications do.
+ */
+static void big_from_digits(BigInt *r, const char *digits, size_t count)
+{
+    if (count <= BIG_DIGITS_BASECASE)
+    {
+        r->length = 0;
+        r->negative = 0;
+        size_t i = 0;
+        while (i < count)
+        {
+            const size_t chunk = i == 0 && count % 9 != 0 ? count % 9 : 9;
+            uint32_t value = 0, scale = 1;
+            for (size_t j = 0; j < chunk; ++j, ++i)
+            {
+                value = value * 10 + (uint32_t)(digits[i] - '0');
+                scale *= 10;
+            }
+            big_mul_small(r, scale, value);
+        }
+        big_trim(r);
+        return;
+    }
+    const size_t low = count / 2;
+    BigInt high, rest, scale;
+    big_init(&high);
+    big_init(&rest);
+    big_init(&scale);
+    big_from_digits(&high, digits, count - low);
+    big_from_digits(&rest, digits + count - low, low);
+    big_pow10(&scale, low);
+    big_mul(&high, &high, &scale);
+    big_add(r, &high, &rest);
+    big_free(&high);
+    big_free(&rest);
+    big_free(&scale);
+}
+
+/**
+ * @brief Writes the decimal digits of |x|, zero-padded to at least `width`,
+ * splitting long numbers in half by a power of ten as big_from_digits does.
+ * @return The end of the digits written.
+ */
+static char *big_to_digits(const BigInt *x, size_t width, char *out)
+{
+    if (x->length <= BIG_DIGITS_BASECASE / 9)
+    {
+        char reversed[2 * BIG_DIGITS_BASECASE + 18];
+        size_t count = 0;
+        BigInt t;
+        big_init(&t);
+        big_copy(&t, x);
+        while (t.length != 0)
+        {
+            uint32_t chunk = big_div_small(&t, 1000000000u);
+            for (int j = 0; j < 9; ++j, chunk /= 10)
+                reversed[count++] = (char)('0' + chunk % 10);
+        }
+        big_free(&t);
+        while (count > 0 && reversed[count - 1] == '0')
+            count--;
+        for (size_t i = count; i < width; ++i)
+            *out++ = '0';
+        while (count > 0)
+            *out++ = reversed[--count];
+        return out;
+    }
+    const size_t low = (size_t)((double)big_bit_length(x) * 0.30102999566398120) / 2;
+    const BigInt magnitude = big_magnitude(x);
+    BigInt high, rest, scale;
+    big_init(&high);
+    big_init(&rest);
+    big_init(&scale);
+    big_pow10(&scale, low);
+    big_divmod(&high, &rest, &magnitude, &scale);
+    out = big_to_digits(&high, width > low ? width - low : 0, out);
+    out = big_to_digits(&rest, low, out);
+    big_free(&high);
+    big_free(&rest);
+    big_free(&scale);
+    return out;
+}
+
+// --- Exact Evaluation ---
+
+/**
+ * @brief Counts the decimal places a number in strtod's syntax needs to be
+ * held exactly: 2 for `0.125e1`, 0 for `1.5e3` or `2.50e1`.
+ * @return The count, or 0 for text that is not a number (which
+ * exact_parse then rejects).
+ */
+static long long exact_decimals(const char *begin, const char *end)
+{
+    const char *p = begin;
+    if (p != end && (*p == '-' || *p == '+'))
+        p++;
+    long long fraction = 0, trailing_zeros = 0;
+    int seen_point = 0, seen_nonzero = 0;
+    for (; p != end; ++p)
+    {
+        if (*p == '.' && !seen_point)
+        {
+            seen_point = 1;
+            continue;
+        }
+        if ((unsigned)(*p - '0') >= 10)
+            break;
+        fraction += seen_point;
+        trailing_zeros = *p == '0' ? trailing_zeros + 1 : 0;
+        seen_nonzero |= *p != '0';
+    }
+    long long exponent = 0;
+    if (p != end && (*p == 'e' || *p == 'E'))
+    {
+        const char *e = p + 1;
+        const int exp_negative = e != end && *e == '-';
+        if (e != end && (*e == '-' || *e == '+'))
+            e++;
+        for (; e != end && (unsigned)(*e - '0') < 10; ++e)
+        {
+            if (exponent < BIG_MAX_BITS)
+                exponent = exponent * 10 + (*e - '0');
+        }
+        exponent = exp_negative ? -exponent : exponent;
+    }
+    const long long decimals = fraction - trailing_zeros - exponent;
+    return seen_nonzero && decimals > 0 ? decimals : 0;
+}
+
+/**
+ * @brief Converts a decimal number in strtod's syntax, such as `-12.5e3`,
+ * to fixed point: an integer counting units of 10^-scale, with any further
+ * digits truncated.
+ * @return EVAL_OK, EVAL_INVALID_NUMBER or EVAL_TOO_LARGE.
+ */
+static int exact_parse(BigInt *r, const char *begin, const char *end, int scale)
+{
+    const char *p = begin;
+    const int negative = p != end && *p == '-';
+    if (p != end && (*p == '-' || *p == '+'))
+        p++;
+    char *digits = (char *)malloc((size_t)(end - p) + 1);
+    if (digits == NULL)
+    {
+        perror("Failed to allocate memory for a number");
+        exit(EXIT_FAILURE);
+    }
+    size_t count = 0;
+    long long exponent = 0;
+    int seen_digit = 0, seen_point = 0;
+    for (; p != end; ++p)
+    {
+        if (*p == '.' && !seen_point)
+        {
+            seen_point = 1;
+            continue;
+        }
+        if ((unsigned)(*p - '0') >= 10)
+            break;
+        seen_digit = 1;
+        if (count > 0 || *p != '0')
+            digits[count++] = *p;
+        exponent -= seen_point;
+    }
+    if (seen_digit && p != end && (*p == 'e' || *p == 'E'))
+    {
+        const char *e = p + 1;
+        const int exp_negative = e != end && *e == '-';
+        if (e != end && (*e == '-' || *e == '+'))
+            e++;
+        long long exp_value = 0;
+        const char *exp_start = e;
+        for (; e != end && (unsigned)(*e - '0') < 10; ++e)
+        {
+            if (exp_value < BIG_MAX_BITS)
+                exp_value = exp_value * 10 + (*e - '0');
+        }
+        if (e != exp_start)
+        {
+            exponent += exp_negative ? -exp_value : exp_value;
+            p = e;
+        }
+    }
+
+    int status = EVAL_OK;
+    const long long shift = exponent + scale;
+    if (!seen_digit || p != end)
+        status = EVAL_INVALID_NUMBER;
+    else if (count == 0 || shift <= -(long long)count)
+        big_set_u32(r, 0);
+    else if ((double)((long long)count + shift) * 3.3219280948873623 > BIG_MAX_BITS)
+        status = EVAL_TOO_LARGE;
+    else
+    {
+        BigInt power;
+        big_init(&power);
+        big_from_digits(r, digits, count);
+        big_pow10(&power, (uint64_t)(shift < 0 ? -shift : shift));
+        if (shift < 0)
+            big_divmod(r, NULL, r, &power);
+        else
+            big_mul(r, r, &power);
+        r->negative = negative && r->length != 0;
+        big_free(&power);
+    }
+    free(digits);
+    return status;
+}
+
+/**
+ * @brief Formats a fixed-point value with `scale` decimal places, dropping
+ * trailing zeros of the fraction.
+ * @return A string the caller frees.
+ */
+static char *exact_format(const BigInt *x, int scale)
+{
+    const size_t capacity = (size_t)((double)big_bit_length(x) * 0.30102999566398120) + (size_t)scale + 6;
+    char *text = (char *)malloc(capacity);
+    if (text == NULL)
+    {
+        perror("Failed to allocate memory for the result");
+        exit(EXIT_FAILURE);
+    }
+    char *p = text;
+    if (x->negative)
+        *p++ = '-';
+    char *end = big_to_digits(x, (size_t)scale + 1, p);
+    if (scale > 0)
+    {
+        memmove(end - scale + 1, end - scale, (size_t)scale);
+        end[-scale] = '.';
+        end++;
+        while (end[-1] == '0')
+            end--;
+        if (end[-1] == '.')
+            end--;
+    }
+    *end = '\0';
+    return text;
+}
+
+/**
+ * @brief Checks that a value of about `bits` bits may be computed.
+ */
+static int exact_fits(double bits)
+{
+    return bits <= BIG_MAX_BITS ? EVAL_OK : EVAL_TOO_LARGE;
+}
+
+/**
+ * @brief x = x * y in fixed point, truncated to the scale.
+ */
+static int exact_multiply(BigInt *x, const BigInt *y, const BigInt *one)
+{
+    if (exact_fits((double)big_bit_length(x) + (double)big_bit_length(y)) != EVAL_OK)
+        return EVAL_TOO_LARGE;
+    big_mul(x, x, y);
+    big_divmod(x, NULL, x, one);
+    return EVAL_OK;
+}
+
+/**
+ * @brief x = x / y in fixed point, truncated to the scale.
+ */
+static int exact_divide(BigInt *x, const BigInt *y, const BigInt *one)
+{
+    if (y->length == 0)
+        return EVAL_DIVISION_BY_ZERO;
+    if (exact_fits((double)big_bit_length(x) + (double)big_bit_length(one)) != EVAL_OK)
+        return EVAL_TOO_LARGE;
+    big_mul(x, x, one);
+    big_divmod(x, NULL, x, y);
+    return EVAL_OK;
+}
+
+/**
+ * @brief x = x ^ y in fixed point, for a whole y, truncated to the scale.
+ *
+ * The power is taken of the scaled integer and then scaled back in one
+ * exact division, so only the last digit is ever truncated.
+ */
+static int exact_power(BigInt *x, const BigInt *y, const BigInt *one, int scale)
+{
+    BigInt exponent, rest, power;
+    big_init(&exponent);
+    big_init(&rest);
+    big_init(&power);
+    big_divmod(&exponent, &rest, y, one);
+    const BigInt magnitude = big_magnitude(x);
+    const int odd = exponent.length != 0 && (exponent.limbs[0] & 1);
+
+    int status = EVAL_OK;
+    if (rest.length != 0)
+        status = EVAL_FRACTIONAL_POWER;
+    else if (exponent.length == 0)
+        big_copy(x, one);
+    else if (x->length == 0)
+        status = exponent.negative ? EVAL_DIVISION_BY_ZERO : EVAL_OK;
+    else if (big_compare_magnitude(&magnitude, one) == 0) // +-1 to any power
+        x->negative = x->negative && odd;
+    else if (exponent.length > 1)
+        status = EVAL_TOO_LARGE;
+    else
+    {
+        const uint64_t n = exponent.limbs[0];
+        status = exact_fits((double)big_bit_length(x) * (double)n + 3.33 * scale * ((double)n + 1));
+        if (status == EVAL_OK)
+        {
+            big_pow(&power, x, n);
+            if (exponent.negative)
+            {
+                big_pow10(&rest, (uint64_t)scale * (n + 1));
+                big_divmod(x, NULL, &rest, &power);
+            }
+            else
+            {
+                big_pow10(&rest, (uint64_t)scale * (n - 1));
+                big_divmod(x, NULL, &power, &rest);
+            }
+        }
+    }
+    big_free(&exponent);
+    big_free(&rest);
+    big_free(&power);
+    return status;
+}
+
+/**
+ * @brief x = sqrt(x) in fixed point, truncated to the scale.
+ */
+static int exact_sqrt(BigInt *x, const BigInt *one)
+{
+    if (x->negative)
+        return EVAL_NEGATIVE_ROOT;
+    if (exact_fits((double)big_bit_length(x) + (double)big_bit_length(one)) != EVAL_OK)
+        return EVAL_TOO_LARGE;
+    big_mul(x, x, one);
+    big_isqrt(x, x);
+    return EVAL_OK;
+}
+
+/**
+ * @brief Runs a program compiled with `exact` over fixed-point values with
+ * `scale` decimal places.
+ *
+ * @param source The expression the program was compiled from, whose
+ * numbers are converted from their text.
+ * @param variables The fixed-point values of the variables, by index.
+ * @return EVAL_OK or the EVAL_* code of the first failure.
+ */
+static int program_run_exact(const Program *program, const char *source, const BigInt *variables, int scale, BigInt *result)
+{
+    BigInt stack[EXPR_MAX_STACK], one;
+    for (int i = 0; i < program->max_depth; ++i)
+        big_init(&stack[i]);
+    big_init(&one);
+    big_pow10(&one, (uint64_t)scale);
+
+    int status = EVAL_OK, top = -1;
+    for (size_t i = 0; i < program->length && status == EVAL_OK; ++i)
+    {
+        const Instruction *ip = &program->code[i];
+        BigInt *x = top >= 1 ? &stack[top - 1] : NULL, *y = top >= 0 ? &stack[top] : NULL;
+        switch ((Opcode)ip->op)
+        {
+        case OP_CONST:
+        {
+            const char *text = source + program->constant_text[ip->arg].offset;
+            status = exact_parse(&stack[++top], text, text + program->constant_text[ip->arg].length, scale);
+            break;
+        }
+        case OP_VAR:
+            big_copy(&stack[++top], &variables[ip->arg]);
+            break;
+        case OP_ADD:
+            big_add(x, x, y);
+            top--;
+            break;
+        case OP_SUB:
+            big_sub(x, x, y);
+            top--;
+            break;
+        case OP_MUL:
+            status = exact_multiply(x, y, &one);
+            top--;
+            break;
+        case OP_DIV:
+            status = exact_divide(x, y, &one);
+            top--;
+            break;
+        case OP_POW:
+            status = exact_power(x, y, &one, scale);
+            top--;
+            break;
+        case OP_NEG:
+            y->negative = !y->negative && y->length != 0;
+            break;
+        case OP_ABS:
+            y->negative = 0;
+            break;
+        case OP_SQRT:
+            status = exact_sqrt(y, &one);
+            break;
+        default: // The compiler rejects the rest in exact programs
+            status = EVAL_INVALID_NUMBER;
+            break;
+        }
+    }
+    if (status == EVAL_OK)
+        big_swap(result, &stack[0]);
+    for (int i = 0; i < program->max_depth; ++i)
+        big_free(&stack[i]);
+    big_free(&one);
+    return status;
+}
+
+/**
+ * @brief Compiles and evaluates an expression exactly, with `scale`
+ * decimal places, then prints its result.
+ *
+ * Numbers with more decimal places than `scale` are not cut short: the
+ * whole evaluation carries as many places as the longest of them needs,
+ * and only the result is truncated to `scale`.
+ *
+ * @return 0 on success, -1 on error (after printing a message).
+ */
+static int evaluate_exact(const char *expression, int scale, int binding_count, char *bindings[])
+{
+    if (binding_count > EXPR_MAX_VARIABLES)
+    {
+        fprintf(stderr, "Error: Too many variables; at most %d can be bound.\n", EXPR_MAX_VARIABLES);
+        return -1;
+    }
+    const char *names[EXPR_MAX_VARIABLES] = {NULL};
+    const char *texts[EXPR_MAX_VARIABLES] = {NULL};
+    BigInt values[EXPR_MAX_VARIABLES], result;
+    big_init(&result);
+    for (int i = 0; i < binding_count; ++i)
+        big_init(&values[i]);
+    int rc = 0;
+    for (int i = 0; i < binding_count && rc == 0; ++i)
+    {
+        char *equals = strchr(bindings[i], '=');
+        if (equals == NULL || equals == bindings[i])
+        {
+            fprintf(stderr, "Error: Invalid binding '%s'. Expected name=value.\n", bindings[i]);
+            rc = -1;
+            continue;
+        }
+        *equals = '\0';
+        names[i] = bindings[i];
+        texts[i] = equals + 1;
+    }
+
+    Program program;
+    if (rc == 0)
+        rc = program_compile(&program, expression, names, binding_count, 1);
+    if (rc != 0)
+    {
+        for (int i = 0; i < binding_count; ++i)
+            big_free(&values[i]);
+        big_free(&result);
+        return -1;
+    }
+
+    long long working = scale;
+    for (size_t i = 0; i < program.constant_count; ++i)
+    {
+        const char *text = expression + program.constant_text[i].offset;
+        const long long decimals = exact_decimals(text, text + program.constant_text[i].length);
+        working = decimals > working ? decimals : working;
+    }
+    for (int i = 0; i < binding_count; ++i)
+    {
+        const long long decimals = exact_decimals(texts[i], texts[i] + strlen(texts[i]));
+        working = decimals > working ? decimals : working;
+    }
+    if (working > BIG_MAX_PRECISION)
+    {
+        fprintf(stderr, "Error: Numbers may have at most %d decimal places with --precision.\n", BIG_MAX_PRECISION);
+        rc = -1;
+    }
+
+    for (int i = 0; i < binding_count && rc == 0; ++i)
+    {
+        const int status = exact_parse(&values[i], texts[i], texts[i] + strlen(texts[i]), (int)working);
+        if (status == EVAL_INVALID_NUMBER)
+            fprintf(stderr, "Error: Invalid number provided. '%s' is not a valid number.\n", texts[i]);
+        else if (status == EVAL_TOO_LARGE)
+            fprintf(stderr, "Error: Number '%s' is too large to compute with exactly.\n", texts[i]);
+        rc = status == EVAL_OK ? 0 : -1;
+    }
+    if (rc == 0)
+    {
+        const int status = program_run_exact(&program, expression, values, (int)working, &result);
+        if (status == EVAL_DIVISION_BY_ZERO)
+            fprintf(stderr, "Error: Division by zero is not allowed.\n");
+        else if (status == EVAL_FRACTIONAL_POWER)
+            fprintf(stderr, "Error: Exponents must be whole numbers with --precision.\n");
+        else if (status == EVAL_NEGATIVE_ROOT)
+            fprintf(stderr, "Error: Cannot take the square root of a negative number.\n");
+        else if (status == EVAL_TOO_LARGE)
+            fprintf(stderr, "Error: The result is too large to compute exactly.\n");
+        rc = status == EVAL_OK ? 0 : -1;
+    }
+    program_free(&program);
+    if (rc == 0)
+    {
+        if (working > scale)
+        {
+            BigInt cut;
+            big_init(&cut);
+            big_pow10(&cut, (uint64_t)(working - scale));
+            big_divmod(&result, NULL, &result, &cut);
+            big_free(&cut);
+        }
+        char *text = exact_format(&result, scale);
+        printf("Result: %s = %s\n", expression, text);
+        free(text);
+    }
+
+    for (int i = 0; i < binding_count; ++i)
+        big_free(&values[i]);
+    big_free(&result);
+    return rc;
+}
@@ -4,33 +4,136 @@
  *
  * This program allows users to manage a list of contacts (name, phone, email)
  * which is stored in a CSV file. It supports adding, listing, finding, and
- * deleting contacts.
+ * deleting contacts. CSV files follow RFC 4180: fields holding commas,
+ * quotes or line breaks are quoted, and rows may be of any length.
+ *
+ * Books can also be kept in a binary file that is memory-mapped instead of
+ * parsed: a header, a fixed-width record table and a string heap. Records
+ * are added and deleted in place, with deleted slots kept on a free list.
+ * The `import` and `export` commands convert between the two formats.
+ *
+ * Changes to a CSV book are appended to a checksummed write-ahead log that
+ * is replayed on load. Once the log grows past a threshold it is folded
+ * back into a fresh snapshot, written to a temporary file and renamed into
+ * place, so a crash can never leave a truncated book behind.
+ *
+ * Exact lookups by name or email go through open-addressing hash indexes
+ * that are built the first time `get` or `delete` needs them. For binary
+ * books, `index` persists a trigram index of names and emails that `find`
+ * uses to narrow its substring search to a few candidates. Without one,
+ * `find` scans a packed column of case-folded names and emails with SIMD.
+ * `find --fuzzy` tolerates typos in names through a BK-tree, and `complete`
+ * lists names by prefix from a sorted array.
+ *
+ * `batch` runs commands read from stdin against one loaded book, syncing
+ * its log once at the end, and `shell` does the same interactively, so the
+ * book and its indexes stay resident across commands.
+ *
+ * `serve` keeps the book loaded behind a Unix socket. While it runs, other
+ * invocations in the same directory send their commands to it instead of
+ * loading the book themselves. Searches read a versioned snapshot without
+ * taking a lock; a change publishes a new version of it in place, and the
+ * snapshot is only rebuilt after many changes.
  *
  * @example
  *   ./contact-book add "John Doe" "555-1234" "john.doe@email.com"
  *   ./contact-book list
  *   ./contact-book find "John"
+ *   ./contact-book find --fuzzy --limit 5 "Jhon"
+ *   ./contact-book complete "Jo"
+ *   ./contact-book batch < commands.txt
+ *   ./contact-book get "John Doe"
  *   ./contact-book delete "John Doe"
+ *   ./contact-book import contacts.csv
+ *   ./contact-book index
+ *   ./contact-book export backup.csv
  *
  * @author Gemini
  * @date 2025-07-04
  *
  ******************************************************************************/
 
+#define _POSIX_C_SOURCE 200809L // For fileno, ftruncate, getline and open_memstream
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 #include <errno.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <arpa/inet.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "arena.h"
+#include "bufio.h"
+#include "hashmap.h"
+#include "vector.h"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#define HAVE_SSE2 1
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_AVX2_DISPATCH 1 // Compiled with a target attribute, picked at runtime
+#endif
+#endif
 
 // --- Constants and Type Definitions ---
 
 #define CSV_FILENAME "contacts.csv"
-#define MAX_LINE_LENGTH 1024
-#define CSV_DELIMITERS ","
+#define CSV_READ_BUFFER (1024 * 1024)
+#define CSV_WRITE_BUFFER (1024 * 1024)
+#define CSV_MAX_FIELDS 16 // Fields beyond these are counted and dropped
+#define CSV_MAX_REPORTED 10 // Skipped lines reported one by one; the rest are only counted
+
+#define SESSION_MAX_ARGS 16 // Words on one `batch` or `shell` line, command included
+#define SHELL_PROMPT "contact-book> "
+
+#define SERVE_SOCKET "contacts.sock"
+#define SERVE_MAX_REQUEST (1024 * 1024)
+#define SERVE_MIN_CHANGES 256    // Changes a snapshot takes in place before it is rebuilt...
+#define SERVE_CHANGES_PER_ROOT 4 // ...or this many per square root of its size, if more
+#define SERVE_FUZZY 1            // The indexes a snapshot builds when first asked for them
+#define SERVE_NAMES 2
+#define SERVE_ORDERS 4
+
+#define OUTPUT_BUFFER (1024 * 1024) // Bytes `list` formats before each write
+
+#define BOOK_FILENAME "contacts.cbk"
+#define BOOK_MAGIC "CBOOK\r\n\032" // Catches text-mode mangling, like PNG's signature
+#define BOOK_VERSION 1
+#define BOOK_TABLE_OFFSET 128 // Record table starts after the header, 64-byte aligned
+#define BOOK_MIN_RECORDS 1024
+#define BOOK_MIN_HEAP (64 * 1024)
+#define BOOK_RECORD_LIVE 0x1u
+#define BOOK_NO_FREE_SLOT UINT32_MAX
+#define BOOK_FILE_FULL 1
+
+#define LOG_FILENAME "contacts.log"
+#define LOG_MAGIC "CBLOG\r\n\032"
+#define LOG_VERSION 1
+#define LOG_OP_ADD 1
+#define LOG_OP_DELETE 2
+#define LOG_COMPACT_MIN_BYTES (64 * 1024)        // Never compact a log smaller than this...
+#define LOG_COMPACT_RATIO 2                      // ...unless it is half the snapshot's size...
+#define LOG_COMPACT_MAX_BYTES (16 * 1024 * 1024) // ...or has grown this large regardless.
 
 /**
  * @brief Represents a single contact with name, phone, and email.
+ *
+ * The strings are owned by the arena of the ContactArray holding the contact,
+ * or by the mapped binary book. A deleted contact has all fields set to NULL.
  */
 typedef struct
 {
@@ -40,23 +143,561 @@ typedef struct
 } Contact;
 
 /**
- * @brief A generic singly linked list node.
+ * @brief A growable, contiguous array of contacts.
+ *
+ * Contacts are stored by value so that a full scan walks memory linearly.
+ * Iterate with `for (Contact *c = array_begin(a); c != array_end(a); ++c)`
+ * and skip entries for which contact_is_live is false: deleting a contact
+ * leaves a tombstone so that positions held by indexes stay valid.
+ */
+typedef struct
+{
+    Contact *items;
+    size_t size; // Entries in use, tombstones included
+    size_t live; // Entries that are not tombstones
+    size_t capacity;
+    Arena strings;
+} ContactArray;
+
+/**
+ * @brief A growable list of positions in a ContactArray: a Vector of
+ * size_t, read through positions_data().
+ */
+typedef Vector PositionList;
+
+/**
+ * @brief One slot of a HashIndex.
+ */
+typedef struct
+{
+    uint32_t hash;
+    uint32_t pos; // Position in the ContactArray plus one, 0 for an empty slot
+} IndexSlot;
+
+/**
+ * @brief An open-addressing (linear probing) hash index over one string
+ * field of the contacts, located by `key_offset` within Contact.
+ *
+ * Duplicate keys are stored as separate slots along the same probe run, so a
+ * lookup finds all of them before reaching an empty slot. Removal uses
+ * backward-shift deletion, so no tombstones accumulate in the table.
+ */
+typedef struct
+{
+    IndexSlot *slots;
+    size_t capacity; // Always a power of two
+    size_t count;
+    size_t key_offset;
+} HashIndex;
+
+#define INDEX_MIN_CAPACITY 64
+
+/**
+ * @brief A posting list: ascending contact positions, stored as LEB128
+ * varints of the gap to the previous position.
+ */
+typedef struct
+{
+    uint8_t *data;
+    size_t length;
+    size_t capacity;
+    uint32_t count;
+    uint32_t last; // The largest position in the list
+} PostingList;
+
+/**
+ * @brief A read-only view of an encoded posting list, in memory or mapped.
+ */
+typedef struct
+{
+    const uint8_t *data;
+    size_t length;
+    uint32_t count;
+} PostingView;
+
+/**
+ * @brief An inverted index from case-folded trigrams of each contact's name
+ * and email to the positions of the contacts containing them.
+ *
+ * Postings are a superset of the true matches: deleted contacts are not
+ * removed, so every candidate is confirmed against the contact itself.
+ */
+typedef struct
+{
+    uint32_t *keys; // Trigram bytes packed into 24 bits, 0 for an empty slot
+    PostingList *lists;
+    size_t capacity; // Always a power of two
+    size_t count;
+} TrigramIndex;
+
+#define TRIGRAM_MIN_CAPACITY 1024
+#define TRIGRAM_MEMORY_MIN_CONTACTS 4096 // CSV books smaller than this are always scanned
+#define TRIGRAM_MEMORY_BUILD_SCANS 400   // Building in memory costs about this many scans
+
+/**
+ * @brief Case-folded copies of every contact's name and email packed into
+ * one buffer, each followed by a NUL, for brute-force substring scans.
+ *
+ * A search term never contains a NUL, so a match cannot span two fields.
+ * Contact `pos` occupies [starts[pos], starts[pos + 1]); deleted contacts
+ * keep their bytes and are filtered out when matches are reported.
+ */
+typedef struct
+{
+    char *data;
+    size_t length;
+    size_t capacity;
+    size_t *starts; // `count + 1` offsets, the last one equal to `length`
+    size_t count;
+    size_t starts_capacity;
+} SearchColumn;
+
+/**
+ * @brief One node of a FuzzyIndex: a distinct key and the contacts that
+ * carry it.
+ */
+typedef struct
+{
+    size_t key;            // Offset of the NUL-terminated key in `keys`
+    uint32_t key_length;
+    uint32_t edge;         // Edit distance to the parent node
+    uint32_t max_edge;     // Largest edge among the children
+    uint32_t first_child;  // Node index, 0 for none (the root is nobody's child)
+    uint32_t next_sibling; // Node index, 0 for none
+    uint32_t postings;     // Index of the newest posting plus one, 0 for none
+} FuzzyNode;
+
+/**
+ * @brief A contact position in the posting chain of a FuzzyNode.
+ */
+typedef struct
+{
+    uint32_t pos;
+    uint32_t next; // Index of the next posting plus one, 0 at the end
+} FuzzyPosting;
+
+/**
+ * @brief A BK-tree over the case-folded words of the contacts' names, for
+ * typo-tolerant search.
+ *
+ * Children hang off a node by their edit distance to it. When a query is at
+ * distance d from a node, the triangle inequality bounds any match within k
+ * edits to the children at distances d - k through d + k, so most of the
+ * tree is never visited. That bound needs a true metric, which is why the
+ * distance is unrestricted Damerau-Levenshtein rather than the restricted
+ * "optimal string alignment" variant. Deleted contacts stay in the chains
+ * and are filtered out of the results.
+ *
+ * Most words recur across many contacts, so a hash table maps each key to
+ * its node and only a word seen for the first time walks the tree.
  */
-typedef struct Node
+typedef struct
 {
-    void *data;
-    struct Node *next;
-} Node;
+    FuzzyNode *nodes;
+    size_t node_count;
+    size_t node_capacity;
+    FuzzyPosting *postings;
+    size_t posting_count;
+    size_t posting_capacity;
+    char *keys;
+    size_t keys_length;
+    size_t keys_capacity;
+    uint32_t *lookup; // Node index plus one, 0 for an empty slot
+    size_t lookup_capacity; // Always a power of two
+} FuzzyIndex;
+
+#define FUZZY_MAX_KEY 63       // Longer words are truncated
+#define FUZZY_DEFAULT_LIMIT 10 // Results shown by `find --fuzzy` and `complete`
 
 /**
- * @brief A generic singly linked list.
+ * @brief A contact matched by a fuzzy search and its edit distance.
  */
 typedef struct
 {
-    Node *head;
-    Node *tail;
+    size_t pos;
+    int distance;
+} FuzzyMatch;
+
+typedef struct
+{
+    FuzzyMatch *items;
     size_t size;
-} LinkedList;
+    size_t capacity;
+} FuzzyMatchList;
+
+/**
+ * @brief A contact's case-folded name, as kept in a NameIndex.
+ */
+typedef struct
+{
+    const char *key;
+    size_t pos;
+} NameEntry;
+
+/**
+ * @brief Every contact's case-folded name in sorted order, so the names
+ * sharing a prefix form one contiguous run found by binary search.
+ */
+typedef struct
+{
+    NameEntry *entries;
+    size_t count;
+    size_t capacity;
+    Arena keys;
+} NameIndex;
+
+#define ARRAY_INITIAL_CAPACITY 16
+
+/**
+ * @brief The header at the start of a binary contact book file.
+ *
+ * The file is laid out as the header, a table of `record_capacity` records
+ * at BOOK_TABLE_OFFSET and a string heap of `heap_capacity` bytes at
+ * `heap_offset`. All integers are stored in host byte order.
+ */
+typedef struct
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t record_count;    // Slots ever used, live or free
+    uint64_t record_capacity; // Slots available in the record table
+    uint64_t live_count;
+    uint64_t heap_offset;
+    uint64_t heap_used;
+    uint64_t heap_capacity;
+    uint32_t free_head;  // First slot on the free list, or BOOK_NO_FREE_SLOT
+    uint32_t generation; // Changes whenever the book is rewritten and slots move
+} BookHeader;
+
+/**
+ * @brief A fixed-width record pointing at NUL-terminated strings in the heap.
+ */
+typedef struct
+{
+    uint64_t name;
+    uint64_t phone;
+    uint64_t email;
+    uint32_t flags;
+    uint32_t next_free; // Next slot on the free list when not live
+} BookRecord;
+
+#define TRIGRAM_FILENAME "contacts.tri"
+#define TRIGRAM_MAGIC "CBTRI\r\n\032"
+#define TRIGRAM_VERSION 1
+#define TRIGRAM_DIRTY_OFFSET(end) (((end) + 3) & ~(uint64_t)3) // Dirty slots are uint32-aligned
+
+/**
+ * @brief The header of a persisted trigram index for a binary book.
+ *
+ * It is followed by `term_count` TrigramTerms sorted by trigram, the encoded
+ * postings, and from `dirty_offset` to the end of the file an append-only
+ * list of uint32 slots that were reused by adds after the index was built.
+ */
+typedef struct
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t generation;      // BookHeader.generation of the indexed book
+    uint64_t indexed_records; // Slots [0, indexed_records) are covered
+    uint64_t term_count;
+    uint64_t postings_offset;
+    uint64_t postings_size;
+    uint64_t dirty_offset;
+} TrigramHeader;
+
+/**
+ * @brief One trigram of a persisted index and the location of its postings.
+ */
+typedef struct
+{
+    uint32_t trigram;
+    uint32_t count;
+    uint64_t offset; // Relative to postings_offset
+    uint64_t length;
+} TrigramTerm;
+
+/**
+ * @brief A persisted trigram index mapped into memory.
+ */
+typedef struct
+{
+    size_t length;
+    unsigned char *base;
+} TrigramFile;
+
+#define ORDER_FILENAME "contacts.ord"
+#define ORDER_MAGIC "CBORD\r\n\032"
+#define ORDER_VERSION 1
+
+// Persisted indexes are rebuilt once more contacts than INDEX_FILE_MIN_DELTA,
+// or 1/INDEX_FILE_DELTA_RATIO of the indexed ones, are missing from them.
+#define INDEX_FILE_MIN_DELTA 4096
+#define INDEX_FILE_DELTA_RATIO 8
+
+/**
+ * @brief The keys `list` can sort by.
+ */
+typedef enum
+{
+    ORDER_INSERTION = -1, // Not sorted: the order contacts were added in
+    ORDER_BY_NAME,
+    ORDER_BY_EMAIL,
+    ORDER_KEYS
+} OrderKey;
+
+/**
+ * @brief The header of the persisted sort orders of a binary book.
+ *
+ * It is followed by `count` uint32 slots sorted by name, `count` sorted by
+ * email, and from `dirty_offset` to the end of the file the append-only list
+ * of slots reused since, as in a TrigramHeader.
+ */
+typedef struct
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t generation;      // BookHeader.generation of the sorted book
+    uint64_t indexed_records; // Slots [0, indexed_records) are covered
+    uint64_t count;           // Live contacts when the orders were written
+    uint64_t dirty_offset;
+} OrderHeader;
+
+/**
+ * @brief Persisted sort orders mapped into memory.
+ */
+typedef struct
+{
+    size_t length;
+    unsigned char *base;
+} OrderFile;
+
+/**
+ * @brief A contact's position with the first 16 bytes of its case-folded
+ * sort key packed big-endian, so most comparisons while sorting are integer
+ * compares that never touch the contact.
+ */
+typedef struct
+{
+    uint64_t prefix[2];
+    size_t pos;
+} OrderEntry;
+
+_Static_assert(sizeof(BookHeader) <= BOOK_TABLE_OFFSET, "BookHeader must fit before the record table");
+_Static_assert(sizeof(TrigramHeader) == 56, "TrigramHeader must be fixed-width");
+_Static_assert(sizeof(TrigramTerm) == 24, "TrigramTerm must be fixed-width");
+_Static_assert(sizeof(OrderHeader) == 40, "OrderHeader must be fixed-width");
+_Static_assert(sizeof(BookRecord) == 32, "BookRecord must be fixed-width");
+
+/**
+ * @brief A binary contact book mapped into memory.
+ */
+typedef struct
+{
+    int fd;
+    int writable;
+    size_t length;
+    unsigned char *base;
+} BookFile;
+
+/**
+ * @brief The size and CRC-32 of a snapshot file's contents.
+ */
+typedef struct
+{
+    uint64_t size;
+    uint32_t crc;
+} FileDigest;
+
+/**
+ * @brief The header at the start of the write-ahead log.
+ *
+ * `base` identifies the snapshot the log applies to. A log whose base does
+ * not match the current snapshot was already folded into it by a compaction
+ * that crashed before resetting the log, and is discarded.
+ */
+typedef struct
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t base_crc;
+    uint64_t base_size;
+} LogHeader;
+
+/**
+ * @brief The header of one log entry, followed by `length` bytes of payload.
+ *
+ * The payload is the NUL-terminated name, phone and email for LOG_OP_ADD and
+ * the NUL-terminated name for LOG_OP_DELETE. `crc` covers every byte of the
+ * entry after itself, so torn or corrupted entries are detected on replay.
+ */
+typedef struct
+{
+    uint32_t crc;
+    uint32_t length;
+    uint8_t op;
+    uint8_t reserved[3];
+} LogEntryHeader;
+
+_Static_assert(sizeof(LogHeader) == 24, "LogHeader must be fixed-width");
+_Static_assert(sizeof(LogEntryHeader) == 12, "LogEntryHeader must be fixed-width");
+
+/**
+ * @brief The append side of the write-ahead log of a CSV book.
+ *
+ * Each entry is synced as it is appended unless `deferred` is set, in which
+ * case log_sync makes every entry since the last sync durable at once.
+ */
+typedef struct
+{
+    int fd;          // Opened on the first logged change, -1 until then
+    uint64_t size;   // Bytes of valid log, header included, 0 if none
+    FileDigest base; // The snapshot new entries apply to
+    int deferred;    // Whether appends leave syncing to log_sync
+    int unsynced;    // Whether entries were appended since the last sync
+} BookLog;
+
+typedef size_t (*CsvScanFn)(const char *data, size_t n);
+
+/**
+ * @brief A streaming RFC 4180 CSV reader over a file descriptor.
+ *
+ * The file is read in large blocks by a BufReader and each record's fields
+ * are unquoted into `fields`, NUL-terminated, so a record may span any
+ * number of blocks.
+ */
+typedef struct
+{
+    BufReader input;
+    const char *filename;
+    const char *block; // The block being parsed, a view into `input`
+    size_t start;      // Unconsumed bytes are block[start, end)
+    size_t end;
+    int error;
+    CsvScanFn scan; // Finds the next comma, quote or line break
+    char *fields;
+    size_t fields_length;
+    size_t fields_capacity;
+    size_t offsets[CSV_MAX_FIELDS]; // Where each field of the record starts
+    size_t field_count;             // Fields in the record, including dropped ones
+    size_t line;                    // Line of the next unconsumed byte, from 1
+    size_t record_line;             // Line the last record started on
+    uint64_t size;                  // Bytes read so far
+    int checksum;                   // Whether to maintain `crc`
+    uint32_t crc;                   // CRC-32 of the bytes read so far
+} CsvReader;
+
+/**
+ * @brief What one version of a ServeSnapshot holds.
+ */
+typedef struct
+{
+    size_t count; // Contacts [0, count) exist, less those deleted by this version
+    size_t live;
+} ServeVersion;
+
+/**
+ * @brief The copy of the contacts that `serve` answers searches from.
+ *
+ * A snapshot owns its strings, so it stays valid however the book changes
+ * after it was taken. It starts with the book's live contacts, indexed and
+ * laid out in a search column; later adds and deletes are published as new
+ * versions without copying it again. An add is appended past the contacts
+ * that readers of older versions can see, and a delete stamps the contact
+ * with the version that removed it, so a reader sees one consistent version
+ * for the whole request. The contacts added since the snapshot was built
+ * are not indexed and are scanned instead, so after `max_changes` changes
+ * the snapshot is rebuilt.
+ *
+ * The fuzzy index, name index and sort orders cost more to build and not
+ * every daemon needs them, so each is built the first time a reader asks
+ * for it, under `build_lock` rather than the server's write lock.
+ */
+typedef struct
+{
+    ContactArray contacts;  // With room for `max_changes` adds, whose strings its arena holds
+    char *strings;          // The strings of the first `base_count` contacts
+    size_t *origins;        // Each contact's position in the book; ascending up to base_count
+    atomic_uint *deleted;   // The version that deleted each contact, or 0
+    ServeVersion *versions; // Indexed by version, up to max_changes
+    atomic_uint version;    // The newest version, which readers pin
+    size_t base_count;      // Contacts covered by the column and the indexes
+    size_t changes;         // Adds and deletes applied since the snapshot was built
+    size_t max_changes;
+    SearchColumn column;
+    int column_built;
+    HashIndex by_name; // For `get`, as in the book
+    HashIndex by_email;
+    int indexed;
+    pthread_mutex_t build_lock;      // Held while the indexes below are built
+    atomic_int built;                // SERVE_* flags of the ones readers may use
+    FuzzyIndex fuzzy;                // For `find --fuzzy`
+    NameIndex names;                 // For `complete`
+    PositionList orders[ORDER_KEYS]; // For sorted `list`
+} ServeSnapshot;
+
+/**
+ * @brief A contact the book added or deleted, recorded for `serve`.
+ */
+typedef struct
+{
+    size_t pos; // Position in the book's ContactArray
+    int added;  // 1 for an add, 0 for a delete
+} BookChange;
+
+/**
+ * @brief The open contact book, backed by either the CSV or the binary file.
+ *
+ * `contacts` always holds every live contact. For binary books its strings
+ * point straight into the mapping; for CSV books they live in its arena.
+ */
+typedef struct
+{
+    ContactArray *contacts;
+    BookFile file; // `base` is NULL for CSV-backed books
+    BookLog log;   // Only used by CSV-backed books
+    int indexed;   // Whether the hash indexes below have been built
+    HashIndex by_name;
+    HashIndex by_email;
+    int trigrams_built;   // Whether `trigrams` covers every contact
+    TrigramIndex trigrams;
+    size_t finds;         // Finds a trigram index could have served, for CSV books
+    int column_built;     // Whether `column` covers every contact
+    SearchColumn column;
+    int fuzzy_built;      // Whether `fuzzy` covers every contact
+    FuzzyIndex fuzzy;
+    int names_built;      // Whether `names` covers every contact
+    NameIndex names;
+    int orders_built;     // Whether `orders` covers every contact
+    PositionList orders[ORDER_KEYS];
+    Vector *changes;      // If set, adds and deletes append a BookChange here
+    int changes_lost;     // Set when `changes` no longer describes them, as positions moved
+} ContactBook;
+
+/**
+ * @brief The state shared by the threads of `serve`.
+ */
+typedef struct
+{
+    ContactBook *book;          // Guarded by write_lock
+    pthread_mutex_t write_lock; // Serializes commands that use `book`, and publishing
+    Vector changes;             // What the book changed since the last publish
+    _Atomic(ServeSnapshot *) current;
+    atomic_uint epoch;          // Advanced each time a snapshot is retired
+    atomic_size_t readers[2];   // Readers of the current snapshot, by the parity of their epoch
+    atomic_int wanted;          // SERVE_* flags readers have asked for, built ahead on new snapshots
+    char *prog_name;
+} Server;
+
+/**
+ * @brief Collects command output into one large buffer between writes.
+ */
+typedef struct
+{
+    FILE *file;
+    char *data; // NULL if the buffer could not be allocated: write through
+    size_t used;
+} OutputBuffer;
 
 /**
  * @brief Enumeration for the different commands the application can perform.
@@ -66,7 +707,15 @@ typedef enum
     CMD_ADD,
     CMD_LIST,
     CMD_FIND,
+    CMD_GET,
     CMD_DELETE,
+    CMD_IMPORT,
+    CMD_EXPORT,
+    CMD_INDEX,
+    CMD_COMPLETE,
+    CMD_BATCH,
+    CMD_SHELL,
+    CMD_SERVE,
     CMD_UNKNOWN
 } Command;
 
@@ -75,28 +724,147 @@ typedef enum
 // Command Handling
 static Command parse_command(const char *cmd_str);
 static void print_usage(const char *prog_name);
-static void handle_add(LinkedList *list, int argc, char *argv[]);
-static void handle_list(const LinkedList *list);
-static void handle_find(const LinkedList *list, int argc, char *argv[]);
-static void handle_delete(LinkedList *list, int argc, char *argv[]);
+static void handle_add(ContactBook *book, int argc, char *argv[]);
+static void handle_list(ContactBook *book, int argc, char *argv[]);
+static void handle_find(ContactBook *book, int argc, char *argv[]);
+static void handle_get(ContactBook *book, int argc, char *argv[]);
+static void handle_delete(ContactBook *book, int argc, char *argv[]);
+static int handle_import(ContactBook *book, int argc, char *argv[]);
+static void handle_export(const ContactBook *book, int argc, char *argv[]);
+static void handle_index(ContactBook *book);
+static void handle_complete(ContactBook *book, int argc, char *argv[]);
+static void handle_session(ContactBook *book, int daemon_fd, int interactive, char *prog_name);
+static int run_command(ContactBook *book, int argc, char *argv[]);
+static int split_command_line(char *line, char **words, int max_words);
+static int parse_limit(const char *arg, size_t *limit);
+static int parse_count(const char *arg, size_t *count);
+static int parse_list_args(int argc, char *argv[], OrderKey *order, size_t *offset, size_t *limit);
+static void print_contact_list(const ContactArray *array, const PositionList *page, size_t offset, size_t limit);
+static FILE *out_stream(void);
+static FILE *err_stream(void);
+
+// Daemon
+static void handle_serve(ContactBook *book, char *prog_name);
+static int client_connect(void);
+static int client_run(int fd, int argc, char *argv[]);
+
+// Contact Book
+static int book_open(ContactBook *book);
+static void book_close(ContactBook *book);
+static int book_add(ContactBook *book, const char *name, const char *phone, const char *email);
+static size_t book_delete(ContactBook *book, const char *name);
+static int book_write_binary(ContactBook *book);
+static int book_compact(ContactBook *book);
+static int book_lookup(ContactBook *book, HashIndex *index, const char *key, PositionList *out);
+static void book_record_change(ContactBook *book, size_t pos, int added);
+static int book_build_indexes(ContactBook *book);
+static void book_drop_indexes(ContactBook *book);
+static int book_find_candidates(ContactBook *book, const char *term, PositionList *out);
+static int book_write_trigrams(ContactBook *book);
+static int book_scan(ContactBook *book, const char *term, PositionList *out);
+static int book_fuzzy_find(ContactBook *book, const char *term, size_t limit, FuzzyMatchList *out);
+static int book_complete(ContactBook *book, const char *prefix, size_t limit, PositionList *out);
+static int book_write_orders(ContactBook *book);
+static int book_order_page(ContactBook *book, OrderKey key, size_t offset, size_t limit, PositionList *out);
 
 // Contact Management
-static Contact *contact_create(const char *name, const char *phone, const char *email);
-static void contact_free(void *data);
+static int contact_init(Contact *contact, Arena *arena, const char *name, const char *phone, const char *email);
+static int contact_name_equals(const Contact *contact, const void *name);
+static inline int contact_is_live(const Contact *contact);
 
 // CSV I/O
-static int load_contacts_from_csv(LinkedList *list, const char *filename);
-static int save_contacts_to_csv(const LinkedList *list, const char *filename);
-static char *get_csv_field(char **line, const char *delimiters);
+static int load_contacts_from_csv(ContactArray *array, const char *filename, FileDigest *digest, size_t *skipped);
+static int save_contacts_to_csv(const ContactArray *array, const char *filename, FileDigest *digest);
+static int csv_reader_open(CsvReader *reader, const char *filename);
+static int csv_read_record(CsvReader *reader);
+static void csv_reader_close(CsvReader *reader);
+static void csv_write_bytes(FILE *file, const char *data, size_t n, uint64_t *size, uint32_t *crc);
+static void csv_write_field(FILE *file, const char *field, uint64_t *size, uint32_t *crc);
+
+// Binary Storage
+static inline BookHeader *book_header(const BookFile *file);
+static int book_file_open(BookFile *file, const char *filename);
+static void book_file_close(BookFile *file);
+static int book_file_load(const BookFile *file, ContactArray *array);
+static int book_file_write(const ContactArray *array, const char *filename);
+static int book_file_append(BookFile *file, const char *name, const char *phone, const char *email, size_t *slot, Contact *out);
+static int book_file_free(BookFile *file, size_t slot);
+
+// Write-Ahead Log
+static int log_replay(BookLog *log, ContactArray *array);
+static int log_append(BookLog *log, uint8_t op, const char *const *fields, int field_count);
+static int log_reset(BookLog *log, const FileDigest *base);
+static void log_close(BookLog *log);
+static int log_sync(BookLog *log);
+static int log_should_compact(const BookLog *log);
+
+// Hash Index
+static int index_build(HashIndex *index, const ContactArray *array, size_t key_offset);
+static void index_free(HashIndex *index);
+static int index_insert(HashIndex *index, const ContactArray *array, size_t pos);
+static int index_find(const HashIndex *index, const ContactArray *array, const char *key, PositionList *out);
+static void index_remove(HashIndex *index, const ContactArray *array, size_t pos);
+static int positions_push(PositionList *list, size_t pos);
+static inline size_t *positions_data(const PositionList *list);
+
+// Trigram Index
+static int trigram_index_add(TrigramIndex *index, const Contact *contact, size_t pos);
+static void trigram_index_free(TrigramIndex *index);
+static int trigram_index_candidates(const TrigramIndex *index, const char *term, PositionList *out);
+static int trigram_index_write(const TrigramIndex *index, uint32_t generation, uint64_t indexed_records, const char *filename);
+static int trigram_file_open(TrigramFile *file, const char *filename);
+static void trigram_file_close(TrigramFile *file);
+static int trigram_file_candidates(const TrigramFile *file, const char *term, PositionList *out);
+static int index_file_mark_dirty(const char *filename, size_t slot);
+static int index_file_stale(const BookFile *book, uint32_t generation, uint64_t indexed_records, size_t dirty_count);
+
+// Search Column
+static int column_build(SearchColumn *column, const ContactArray *array);
+static int column_append(SearchColumn *column, const Contact *contact);
+static void column_free(SearchColumn *column);
+static int column_scan(const SearchColumn *column, const ContactArray *array, const char *term, PositionList *out);
+
+// Fuzzy Index
+static int fuzzy_index_build(FuzzyIndex *index, const ContactArray *array);
+static int fuzzy_index_add(FuzzyIndex *index, const Contact *contact, size_t pos);
+static void fuzzy_index_free(FuzzyIndex *index);
+static int fuzzy_index_search(const FuzzyIndex *index, const char *key, size_t length, int max_distance, FuzzyMatchList *out);
+static int fuzzy_scan(const ContactArray *array, size_t first, const char *word, size_t length, int max_distance,
+                      FuzzyMatchList *out);
+static size_t fuzzy_next_word(const char **cursor, char *word);
+static int edit_distance(const char *a, size_t m, const char *b, size_t n, int limit);
+
+// Name Index
+static int name_index_build(NameIndex *index, const ContactArray *array);
+static int name_index_insert(NameIndex *index, const Contact *contact, size_t pos);
+static void name_index_free(NameIndex *index);
+static int name_index_prefix(const NameIndex *index, const ContactArray *array, const char *prefix, size_t limit, PositionList *out);
 
-// Linked List Operations
-static LinkedList *list_create(void);
-static void list_destroy(LinkedList *list, void (*free_func)(void *));
-static int list_append(LinkedList *list, void *data);
-static void *list_get(const LinkedList *list, size_t index);
-static int list_remove(LinkedList *list, size_t index, void (*free_func)(void *));
+// Sorted Orders
+static int order_build(PositionList *out, const ContactArray *array, OrderKey key);
+static int order_sort(PositionList *positions, const ContactArray *array, OrderKey key);
+static int order_compare(const ContactArray *array, OrderKey key, size_t a, size_t b);
+static int order_file_write(const PositionList orders[ORDER_KEYS], uint32_t generation, uint64_t indexed_records, const char *filename);
+static int order_file_open(OrderFile *file, const char *filename);
+static void order_file_close(OrderFile *file);
+
+// Contact Array Operations
+static ContactArray *array_create(void);
+static void array_destroy(ContactArray *array);
+static int array_reserve(ContactArray *array, size_t min_capacity);
+static Contact *array_push(ContactArray *array);
+static Contact *array_claim(ContactArray *array, size_t pos);
+static void array_pop(ContactArray *array);
+static void array_tombstone(ContactArray *array, size_t pos);
+static void array_clear(ContactArray *array);
+static size_t array_remove_if(ContactArray *array, int (*pred)(const Contact *, const void *), const void *ctx);
+static void array_compact(ContactArray *array);
+static inline Contact *array_begin(const ContactArray *array);
+static inline Contact *array_end(const ContactArray *array);
 
 // Utility
+static uint32_t crc32_update(uint32_t crc, const void *data, size_t len);
+static uint32_t hash_string(const char *str);
 static char *str_trim(char *str);
 static char *str_case_str(const char *haystack, const char *needle);
 
@@ -110,389 +878,5281 @@ int main(int argc, char *argv[])
         return EXIT_FAILURE;
     }
 
-    LinkedList *contact_list = list_create();
-    if (contact_list == NULL)
+    const Command cmd = parse_command(argv[1]);
+    const int daemon_fd = client_connect();
+    if (daemon_fd >= 0)
+    {
+        // A daemon holds the book; hand the command to it.
+        int rc = 0;
+        if (cmd == CMD_SERVE)
+        {
+            fprintf(stderr, "Error: A contact book daemon is already serving '%s'.\n", SERVE_SOCKET);
+            rc = -1;
+        }
+        else if (cmd == CMD_BATCH || cmd == CMD_SHELL)
+        {
+            handle_session(NULL, daemon_fd, cmd == CMD_SHELL, argv[0]);
+        }
+        else
+        {
+            rc = client_run(daemon_fd, argc, argv);
+        }
+        close(daemon_fd);
+        return rc == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    ContactBook book;
+    int rc = 0;
+    if (book_open(&book) != 0)
     {
-        return EXIT_FAILURE; // Error message printed in list_create
+        return EXIT_FAILURE; // Error message printed in book_open
     }
 
-    if (load_contacts_from_csv(contact_list, CSV_FILENAME) != 0)
+    if (cmd == CMD_BATCH || cmd == CMD_SHELL)
     {
-        // This is not a fatal error, maybe the file doesn't exist yet.
-        fprintf(stderr, "Info: Could not load contacts from '%s'. Starting with an empty list.\n", CSV_FILENAME);
+        handle_session(&book, -1, cmd == CMD_SHELL, argv[0]);
+    }
+    else if (cmd == CMD_SERVE)
+    {
+        handle_serve(&book, argv[0]);
+    }
+    else
+    {
+        rc = run_command(&book, argc, argv);
     }
 
-    const Command cmd = parse_command(argv[1]);
-    int needs_save = 0;
+    book_close(&book);
+    return rc == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// --- Command Handling Implementation ---
+
+// Where commands print: stdout and stderr, unless the daemon has pointed
+// them at buffers for the request the current thread is serving.
+static _Thread_local FILE *command_out;
+static _Thread_local FILE *command_err;
 
-    switch (cmd)
+static FILE *out_stream(void)
+{
+    return command_out != NULL ? command_out : stdout;
+}
+
+static FILE *err_stream(void)
+{
+    return command_err != NULL ? command_err : stderr;
+}
+
+/**
+ * @brief Runs one command against an open book; `argv[1]` is the command.
+ * @return 0, or -1 if the command failed in a way its exit status reports.
+ */
+static int run_command(ContactBook *book, int argc, char *argv[])
+{
+    int rc = 0;
+    switch (parse_command(argv[1]))
     {
     case CMD_ADD:
-        handle_add(contact_list, argc, argv);
-        needs_save = 1;
+        handle_add(book, argc, argv);
         break;
     case CMD_LIST:
-        handle_list(contact_list);
+        handle_list(book, argc, argv);
         break;
     case CMD_FIND:
-        handle_find(contact_list, argc, argv);
+        handle_find(book, argc, argv);
+        break;
+    case CMD_GET:
+        handle_get(book, argc, argv);
         break;
     case CMD_DELETE:
-        handle_delete(contact_list, argc, argv);
-        needs_save = 1;
+        handle_delete(book, argc, argv);
+        break;
+    case CMD_IMPORT:
+        rc = handle_import(book, argc, argv);
+        break;
+    case CMD_EXPORT:
+        handle_export(book, argc, argv);
+        break;
+    case CMD_INDEX:
+        handle_index(book);
+        break;
+    case CMD_COMPLETE:
+        handle_complete(book, argc, argv);
+        break;
+    case CMD_BATCH:
+    case CMD_SHELL:
+    case CMD_SERVE:
+        fprintf(err_stream(), "Error: '%s' cannot be run from inside a session.\n", argv[1]);
         break;
     default:
-        fprintf(stderr, "Error: Unknown command '%s'.\n", argv[1]);
+        fprintf(err_stream(), "Error: Unknown command '%s'.\n", argv[1]);
         print_usage(argv[0]);
         break;
     }
+    return rc;
+}
 
-    if (needs_save)
+static Command parse_command(const char *cmd_str)
+{
+    if (strcmp(cmd_str, "add") == 0)
+        return CMD_ADD;
+    if (strcmp(cmd_str, "list") == 0)
+        return CMD_LIST;
+    if (strcmp(cmd_str, "find") == 0)
+        return CMD_FIND;
+    if (strcmp(cmd_str, "get") == 0)
+        return CMD_GET;
+    if (strcmp(cmd_str, "delete") == 0)
+        return CMD_DELETE;
+    if (strcmp(cmd_str, "import") == 0)
+        return CMD_IMPORT;
+    if (strcmp(cmd_str, "export") == 0)
+        return CMD_EXPORT;
+    if (strcmp(cmd_str, "index") == 0)
+        return CMD_INDEX;
+    if (strcmp(cmd_str, "complete") == 0)
+        return CMD_COMPLETE;
+    if (strcmp(cmd_str, "batch") == 0)
+        return CMD_BATCH;
+    if (strcmp(cmd_str, "shell") == 0)
+        return CMD_SHELL;
+    if (strcmp(cmd_str, "serve") == 0)
+        return CMD_SERVE;
+    return CMD_UNKNOWN;
+}
+
+static void print_usage(const char *prog_name)
+{
+    fprintf(err_stream(), "Contact Book - A simple command-line contact manager.\n\n");
+    fprintf(err_stream(), "Usage: %s <command> [options]\n\n", prog_name);
+    fprintf(err_stream(), "Commands:\n");
+    fprintf(err_stream(), "  add <name> <phone> <email>    Add a new contact.\n");
+    fprintf(err_stream(), "  list [--sort=name|email]        List contacts, in the order added or sorted.\n");
+    fprintf(err_stream(), "  find <term>                     Find contacts by case-insensitive name or email.\n");
+    fprintf(err_stream(), "  find --fuzzy <term>             Find contacts by the words of their name, allowing for typos.\n");
+    fprintf(err_stream(), "  complete <prefix>               List contacts whose name starts with a prefix.\n");
+    fprintf(err_stream(), "  get <name|email>                Show contacts by exact name or email match.\n");
+    fprintf(err_stream(), "  delete <name>                   Delete a contact by exact name match.\n");
+    fprintf(err_stream(), "  import <file>                   Import a CSV file into the binary book.\n");
+    fprintf(err_stream(), "  export <file>                   Export all contacts to a CSV file.\n");
+    fprintf(err_stream(), "  index                           Build a persistent search index for a binary book.\n");
+    fprintf(err_stream(), "  batch                           Run commands read from stdin, one per line.\n");
+    fprintf(err_stream(), "  shell                           Run commands interactively until 'quit'.\n");
+    fprintf(err_stream(), "  serve                           Keep the book loaded and answer other invocations.\n\n");
+    fprintf(err_stream(), "'find' and 'complete' accept '--limit N' to show at most N results, ranked\n");
+    fprintf(err_stream(), "by edit distance for fuzzy searches and by name for completions. 'list' accepts\n");
+    fprintf(err_stream(), "'--offset N' and '--limit N' to show one page of contacts.\n\n");
+    fprintf(err_stream(), "Data is stored in '%s' in the current directory, or in '%s' once\n", CSV_FILENAME, BOOK_FILENAME);
+    fprintf(err_stream(), "contacts have been imported into the binary format. While 'serve' runs in that\n");
+    fprintf(err_stream(), "directory, commands are sent to it over '%s'.\n", SERVE_SOCKET);
+}
+
+static void handle_add(ContactBook *book, int argc, char *argv[])
+{
+    if (argc != 5)
+    {
+        fprintf(err_stream(), "Error: Incorrect arguments for 'add' command.\n");
+        print_usage(argv[0]);
+        return;
+    }
+    if (book_add(book, argv[2], argv[3], argv[4]) != 0)
+    {
+        fprintf(err_stream(), "Error: Could not add contact to the book.\n");
+        return;
+    }
+    fprintf(out_stream(), "Contact '%s' added successfully.\n", argv[2]);
+}
+
+static void handle_list(ContactBook *book, int argc, char *argv[])
+{
+    OrderKey order;
+    size_t offset, limit;
+    if (parse_list_args(argc, argv, &order, &offset, &limit) != 0)
+        return;
+    if (order == ORDER_INSERTION)
+    {
+        print_contact_list(book->contacts, NULL, offset, limit);
+        return;
+    }
+    PositionList page = VECTOR_INIT(size_t);
+    if (book_order_page(book, order, offset, limit, &page) != 0)
+        fprintf(err_stream(), "Error: Could not sort the contact book.\n");
+    else
+        print_contact_list(book->contacts, &page, offset, limit);
+    vector_free(&page);
+}
+
+/**
+ * @brief Parses `list [--sort=name|email] [--offset N] [--limit N]`.
+ * @return 0 on success, -1 after printing an error and the usage.
+ */
+static int parse_list_args(int argc, char *argv[], OrderKey *order, size_t *offset, size_t *limit)
+{
+    *order = ORDER_INSERTION;
+    *offset = 0;
+    *limit = SIZE_MAX;
+    int ok = 1;
+    for (int i = 2; ok && i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--sort=name") == 0)
+            *order = ORDER_BY_NAME;
+        else if (strcmp(argv[i], "--sort=email") == 0)
+            *order = ORDER_BY_EMAIL;
+        else if (strcmp(argv[i], "--offset") == 0)
+            ok = i + 1 < argc && parse_count(argv[++i], offset) == 0;
+        else if (strcmp(argv[i], "--limit") == 0)
+            ok = i + 1 < argc && parse_limit(argv[++i], limit) == 0;
+        else
+            ok = 0;
+    }
+    if (!ok)
+    {
+        fprintf(err_stream(), "Error: Incorrect arguments for 'list' command.\n");
+        print_usage(argv[0]);
+        return -1;
+    }
+    return 0;
+}
+
+static void output_flush(OutputBuffer *out)
+{
+    if (out->used > 0)
+        fwrite(out->data, 1, out->used, out->file);
+    out->used = 0;
+}
+
+static void output_bytes(OutputBuffer *out, const char *data, size_t n)
+{
+    if (out->data == NULL || n > OUTPUT_BUFFER - out->used)
+    {
+        if (out->data != NULL)
+            output_flush(out);
+        if (out->data == NULL || n > OUTPUT_BUFFER)
+        {
+            fwrite(data, 1, n, out->file);
+            return;
+        }
+    }
+    memcpy(out->data + out->used, data, n);
+    out->used += n;
+}
+
+static void output_string(OutputBuffer *out, const char *str)
+{
+    output_bytes(out, str, strlen(str));
+}
+
+/**
+ * @brief Appends `value` in decimal, right-aligned to at least `width`.
+ */
+static void output_number(OutputBuffer *out, size_t value, int width)
+{
+    char digits[24];
+    int n = 0;
+    do
+    {
+        digits[sizeof(digits) - 1 - n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (n < width)
+        digits[sizeof(digits) - 1 - n++] = ' ';
+    output_bytes(out, digits + sizeof(digits) - n, (size_t)n);
+}
+
+static void output_contact(OutputBuffer *out, const Contact *c, size_t number, int separator)
+{
+    if (separator)
+        output_string(out, "     ---\n");
+    output_number(out, number, 2);
+    output_string(out, ". Name:  ");
+    output_string(out, c->name);
+    output_string(out, "\n     Phone: ");
+    output_string(out, c->phone);
+    output_string(out, "\n     Email: ");
+    output_string(out, c->email);
+    output_string(out, "\n");
+}
+
+/**
+ * @brief Prints one page of the contact list: `page` holds the positions of
+ * contacts offset+1.. of the chosen order, or is NULL to print live contacts
+ * in the order they were added, skipping the first `offset`.
+ */
+static void print_contact_list(const ContactArray *array, const PositionList *page, size_t offset, size_t limit)
+{
+    if (array->live == 0)
+    {
+        fprintf(out_stream(), "The contact book is empty.\n");
+        return;
+    }
+    const size_t remaining = offset < array->live ? array->live - offset : 0;
+    const size_t shown = page != NULL ? page->length : (remaining < limit ? remaining : limit);
+    if (shown == array->live)
+        fprintf(out_stream(), "--- Contact List (%zu contacts) ---\n", array->live);
+    else if (shown == 0)
+        fprintf(out_stream(), "--- Contact List (none of %zu contacts) ---\n", array->live);
+    else if (shown == 1)
+        fprintf(out_stream(), "--- Contact List (%zu of %zu contacts) ---\n", offset + 1, array->live);
+    else
+        fprintf(out_stream(), "--- Contact List (%zu-%zu of %zu contacts) ---\n", offset + 1, offset + shown, array->live);
+
+    OutputBuffer out = {out_stream(), (char *)malloc(OUTPUT_BUFFER), 0};
+    if (page != NULL)
+    {
+        for (size_t i = 0; i < page->length; ++i)
+            output_contact(&out, &array->items[positions_data(page)[i]], offset + i + 1, i > 0);
+    }
+    else
+    {
+        size_t skipped = 0, i = 0;
+        for (const Contact *c = array_begin(array); c != array_end(array) && i < shown; ++c)
+        {
+            if (!contact_is_live(c))
+                continue;
+            if (skipped < offset)
+            {
+                skipped++;
+                continue;
+            }
+            output_contact(&out, c, offset + i + 1, i > 0);
+            i++;
+        }
+    }
+    output_flush(&out);
+    free(out.data);
+    fprintf(out_stream(), "------------------------------------\n");
+}
+
+static void print_find_result(const Contact *c, int *found_count)
+{
+    if (*found_count > 0)
+        fprintf(out_stream(), "     ---\n");
+    fprintf(out_stream(), "  Name:  %s\n  Phone: %s\n  Email: %s\n", c->name, c->phone, c->email);
+    (*found_count)++;
+}
+
+static void print_find_match(const Contact *c, const char *search_term, int *found_count)
+{
+    if (!contact_is_live(c))
+        return;
+    if (str_case_str(c->name, search_term) != NULL ||
+        str_case_str(c->email, search_term) != NULL)
+    {
+        print_find_result(c, found_count);
+    }
+}
+
+/**
+ * @brief Parses a non-negative count, such as the offset of a page.
+ * @return 0 on success, -1 (after printing an error) otherwise.
+ */
+static int parse_count(const char *arg, size_t *count)
+{
+    char *end;
+    errno = 0;
+    const unsigned long long value = strtoull(arg, &end, 10);
+    if (arg[0] < '0' || arg[0] > '9' || *end != '\0' || errno == ERANGE || value > SIZE_MAX)
+    {
+        fprintf(err_stream(), "Error: Invalid count '%s'. Expected a non-negative integer.\n", arg);
+        return -1;
+    }
+    *count = (size_t)value;
+    return 0;
+}
+
+/**
+ * @brief Parses a `--limit` value, which must be a positive integer.
+ * @return 0 on success, -1 (after printing an error) otherwise.
+ */
+static int parse_limit(const char *arg, size_t *limit)
+{
+    char *end;
+    errno = 0;
+    const unsigned long long value = strtoull(arg, &end, 10);
+    if (arg[0] < '0' || arg[0] > '9' || *end != '\0' || errno == ERANGE || value == 0 || value > SIZE_MAX)
+    {
+        fprintf(err_stream(), "Error: Invalid limit '%s'. Expected a positive integer.\n", arg);
+        return -1;
+    }
+    *limit = (size_t)value;
+    return 0;
+}
+
+/**
+ * @brief Splits the arguments of `find` or `complete` into the search term
+ * and the `--fuzzy` and `--limit N` options, which may come in any order.
+ * @return 0 on success, -1 (after printing an error) otherwise.
+ */
+static int parse_search_args(int argc, char *argv[], int allow_fuzzy, const char **term, int *fuzzy, size_t *limit)
+{
+    *term = NULL;
+    for (int i = 2; i < argc; ++i)
+    {
+        if (allow_fuzzy && strcmp(argv[i], "--fuzzy") == 0)
+        {
+            *fuzzy = 1;
+        }
+        else if (strcmp(argv[i], "--limit") == 0)
+        {
+            if (i + 1 == argc || parse_limit(argv[++i], limit) != 0)
+                return -1;
+        }
+        else if (*term == NULL)
+        {
+            *term = argv[i];
+        }
+        else
+        {
+            return -1;
+        }
+    }
+    return *term == NULL ? -1 : 0;
+}
+
+/**
+ * @brief Prints the contacts at `positions` that match `term`, at most `limit`.
+ * @param positions The positions to print, or NULL to check every contact.
+ * @param confirm Whether each position is only a candidate to check first.
+ * @return The number of contacts printed.
+ */
+static int print_matches(const ContactArray *array, const char *term, const PositionList *positions, int confirm, size_t limit)
+{
+    int found_count = 0;
+    if (positions == NULL)
+    {
+        for (const Contact *c = array_begin(array); c != array_end(array) && (size_t)found_count < limit; ++c)
+        {
+            print_find_match(c, term, &found_count);
+        }
+        return found_count;
+    }
+    for (size_t i = 0; i < positions->length && (size_t)found_count < limit; ++i)
+    {
+        const Contact *c = &array->items[positions_data(positions)[i]];
+        if (confirm)
+            print_find_match(c, term, &found_count);
+        else
+            print_find_result(c, &found_count);
+    }
+    return found_count;
+}
+
+/**
+ * @brief Prints the results of a fuzzy find with each one's edit count.
+ */
+static void print_fuzzy_results(const ContactArray *array, const char *term, const FuzzyMatchList *matches)
+{
+    fprintf(out_stream(), "--- Fuzzy Results for '%s' ---\n", term);
+    int found_count = 0;
+    for (size_t i = 0; i < matches->size; ++i)
+    {
+        print_find_result(&array->items[matches->items[i].pos], &found_count);
+        fprintf(out_stream(), "  Edits: %d\n", matches->items[i].distance);
+    }
+    if (found_count == 0)
+    {
+        fprintf(out_stream(), "No contacts found matching that term.\n");
+    }
+    fprintf(out_stream(), "------------------------------------\n");
+}
+
+static void handle_find(ContactBook *book, int argc, char *argv[])
+{
+    const char *search_term;
+    int fuzzy = 0;
+    size_t limit = SIZE_MAX; // Unlimited unless `--limit` is given
+    if (parse_search_args(argc, argv, 1, &search_term, &fuzzy, &limit) != 0)
+    {
+        fprintf(err_stream(), "Error: Incorrect arguments for 'find' command.\n");
+        print_usage(argv[0]);
+        return;
+    }
+    const ContactArray *array = book->contacts;
+    if (fuzzy)
+    {
+        FuzzyMatchList matches = {0};
+        if (book_fuzzy_find(book, search_term, limit != SIZE_MAX ? limit : FUZZY_DEFAULT_LIMIT, &matches) != 0)
+            fprintf(err_stream(), "Error: Could not search the contact book.\n");
+        print_fuzzy_results(array, search_term, &matches);
+        free(matches.items);
+        return;
+    }
+    fprintf(out_stream(), "--- Search Results for '%s' ---\n", search_term);
+    int found_count;
+    PositionList candidates = VECTOR_INIT(size_t);
+    if (book_find_candidates(book, search_term, &candidates) == 0)
+    {
+        // The index only narrows the search; each candidate is still confirmed.
+        found_count = print_matches(array, search_term, &candidates, 1, limit);
+    }
+    else if (book_scan(book, search_term, &candidates) == 0)
+    {
+        found_count = print_matches(array, search_term, &candidates, 0, limit);
+    }
+    else
+    {
+        found_count = print_matches(array, search_term, NULL, 1, limit);
+    }
+    vector_free(&candidates);
+    if (found_count == 0)
+    {
+        fprintf(out_stream(), "No contacts found matching that term.\n");
+    }
+    fprintf(out_stream(), "------------------------------------\n");
+}
+
+/**
+ * @brief Prints the contacts whose name or email is exactly `key`.
+ */
+static void print_exact_matches(const ContactArray *array, const char *key, const PositionList *by_name, const PositionList *by_email)
+{
+    fprintf(out_stream(), "--- Exact Matches for '%s' ---\n", key);
+    int found_count = 0;
+    const PositionList *lists[2] = {by_name, by_email};
+    for (int l = 0; l < 2; ++l)
+    {
+        for (size_t i = 0; i < lists[l]->length; ++i)
+        {
+            const Contact *c = &array->items[positions_data(lists[l])[i]];
+            if (l == 1 && strcmp(c->name, key) == 0)
+                continue; // Already printed as a name match
+            if (found_count > 0)
+                fprintf(out_stream(), "     ---\n");
+            fprintf(out_stream(), "  Name:  %s\n  Phone: %s\n  Email: %s\n", c->name, c->phone, c->email);
+            found_count++;
+        }
+    }
+    if (found_count == 0)
+    {
+        fprintf(out_stream(), "No contact found with the exact name or email '%s'.\n", key);
+    }
+    fprintf(out_stream(), "------------------------------------\n");
+}
+
+static void handle_get(ContactBook *book, int argc, char *argv[])
+{
+    if (argc != 3)
+    {
+        fprintf(err_stream(), "Error: Incorrect arguments for 'get' command.\n");
+        print_usage(argv[0]);
+        return;
+    }
+    const char *key = argv[2];
+    PositionList by_name = VECTOR_INIT(size_t), by_email = VECTOR_INIT(size_t);
+    if (book_lookup(book, &book->by_name, key, &by_name) != 0 ||
+        book_lookup(book, &book->by_email, key, &by_email) != 0)
+    {
+        fprintf(err_stream(), "Error: Could not look up '%s'.\n", key);
+        vector_free(&by_name);
+        vector_free(&by_email);
+        return;
+    }
+    print_exact_matches(book->contacts, key, &by_name, &by_email);
+    vector_free(&by_name);
+    vector_free(&by_email);
+}
+
+static void handle_delete(ContactBook *book, int argc, char *argv[])
+{
+    if (argc != 3)
+    {
+        fprintf(err_stream(), "Error: Incorrect arguments for 'delete' command.\n");
+        print_usage(argv[0]);
+        return;
+    }
+    const char *name_to_delete = argv[2];
+    const size_t deleted_count = book_delete(book, name_to_delete);
+    if (deleted_count > 0)
+    {
+        fprintf(out_stream(), "Successfully deleted %zu contact(s) named '%s'.\n", deleted_count, name_to_delete);
+    }
+    else
+    {
+        fprintf(out_stream(), "No contact found with the exact name '%s'.\n", name_to_delete);
+    }
+}
+
+/**
+ * @brief Imports a CSV file into the binary book, creating it if needed.
+ *
+ * Malformed rows are reported and skipped. If the file cannot be read to
+ * the end, nothing is imported and the command fails.
+ * @return 0 on success, -1 on failure.
+ */
+static int handle_import(ContactBook *book, int argc, char *argv[])
+{
+    if (argc != 3)
+    {
+        fprintf(err_stream(), "Error: Incorrect arguments for 'import' command.\n");
+        print_usage(argv[0]);
+        return -1;
+    }
+    ContactArray *array = book->contacts;
+    const size_t size = array->size, live = array->live;
+    size_t skipped = 0;
+    if (load_contacts_from_csv(array, argv[2], NULL, &skipped) != 0)
+    {
+        array->size = size; // Drop the contacts read before the failure
+        array->live = live;
+        fprintf(err_stream(), "Error: Could not read contacts from '%s'; nothing was imported.\n", argv[2]);
+        return -1;
+    }
+    const size_t imported = array->live - live;
+    if (book->file.base == NULL)
+    {
+        // Importing creates the binary book; it does not merge the CSV book.
+        memmove(array->items, array->items + size, (array->size - size) * sizeof(Contact));
+        array->size -= size;
+        array->live = imported;
+        book_drop_indexes(book); // They cover the CSV book's positions
+    }
+    if (book_write_binary(book) != 0)
+    {
+        fprintf(err_stream(), "Error: Failed to write '%s'.\n", BOOK_FILENAME);
+        return -1;
+    }
+    fprintf(out_stream(), "Imported %zu contact(s) from '%s' into '%s'.\n", imported, argv[2], BOOK_FILENAME);
+    if (skipped > 0)
+        fprintf(out_stream(), "Skipped %zu malformed row(s).\n", skipped);
+    return 0;
+}
+
+static void handle_export(const ContactBook *book, int argc, char *argv[])
+{
+    if (argc != 3)
+    {
+        fprintf(err_stream(), "Error: Incorrect arguments for 'export' command.\n");
+        print_usage(argv[0]);
+        return;
+    }
+    if (save_contacts_to_csv(book->contacts, argv[2], NULL) != 0)
+    {
+        fprintf(err_stream(), "Error: Failed to export contacts to '%s'.\n", argv[2]);
+        return;
+    }
+    fprintf(out_stream(), "Exported %zu contact(s) to '%s'.\n", book->contacts->live, argv[2]);
+}
+
+static void handle_index(ContactBook *book)
+{
+    if (book->file.base == NULL)
+    {
+        fprintf(err_stream(), "Error: Search indexes can only be saved for binary books; run 'import' first.\n");
+        return;
+    }
+    if (book_write_trigrams(book) != 0)
+    {
+        fprintf(err_stream(), "Error: Failed to write '%s'.\n", TRIGRAM_FILENAME);
+        return;
+    }
+    if (book_write_orders(book) != 0)
+    {
+        fprintf(err_stream(), "Error: Failed to write '%s'.\n", ORDER_FILENAME);
+        return;
+    }
+    fprintf(out_stream(), "Indexed %zu contact(s) into '%s' (%zu trigrams) and '%s'.\n", book->contacts->live, TRIGRAM_FILENAME,
+            book->trigrams.count, ORDER_FILENAME);
+}
+
+/**
+ * @brief Prints each completion as its name and email.
+ */
+static void print_completions(const ContactArray *array, const char *prefix, const PositionList *matches)
+{
+    if (matches->length == 0)
+    {
+        fprintf(out_stream(), "No contacts found starting with '%s'.\n", prefix);
+    }
+    for (size_t i = 0; i < matches->length; ++i)
+    {
+        const Contact *c = &array->items[positions_data(matches)[i]];
+        fprintf(out_stream(), "%s <%s>\n", c->name, c->email);
+    }
+}
+
+static void handle_complete(ContactBook *book, int argc, char *argv[])
+{
+    const char *prefix;
+    int fuzzy = 0;
+    size_t limit = FUZZY_DEFAULT_LIMIT;
+    if (parse_search_args(argc, argv, 0, &prefix, &fuzzy, &limit) != 0)
+    {
+        fprintf(err_stream(), "Error: Incorrect arguments for 'complete' command.\n");
+        print_usage(argv[0]);
+        return;
+    }
+    PositionList matches = VECTOR_INIT(size_t);
+    if (book_complete(book, prefix, limit, &matches) != 0)
+        fprintf(err_stream(), "Error: Could not search the contact book.\n");
+    else
+        print_completions(book->contacts, prefix, &matches);
+    vector_free(&matches);
+}
+
+/**
+ * @brief Runs commands from stdin, one per line, against the open book.
+ *
+ * Lines are split into words like a shell would, so arguments holding
+ * spaces can be quoted; blank lines and lines starting with '#' are
+ * skipped. A batch defers syncing the log to a single sync at the end,
+ * while an interactive shell syncs every change as usual, prompts when
+ * stdin is a terminal, and stops at 'quit' or 'exit'.
+ * @param book The open book, or NULL to send every command to the daemon
+ * connected on `daemon_fd`.
+ */
+static void handle_session(ContactBook *book, int daemon_fd, int interactive, char *prog_name)
+{
+    if (book != NULL)
+        book->log.deferred = !interactive;
+    const int prompt = interactive && isatty(STDIN_FILENO);
+    char *line = NULL;
+    size_t line_capacity = 0;
+    size_t line_number = 0;
+    for (;;)
+    {
+        if (prompt)
+        {
+            fprintf(out_stream(), SHELL_PROMPT);
+            fflush(stdout);
+        }
+        if (getline(&line, &line_capacity, stdin) < 0)
+        {
+            if (prompt)
+                fprintf(out_stream(), "\n");
+            break;
+        }
+        line_number++;
+        char *words[SESSION_MAX_ARGS + 1];
+        words[0] = prog_name;
+        const int count = split_command_line(line, words + 1, SESSION_MAX_ARGS);
+        if (count < 0)
+        {
+            fprintf(err_stream(), "Error: Line %zu has an unterminated quote or too many arguments.\n", line_number);
+            continue;
+        }
+        if (count == 0 || words[1][0] == '#')
+            continue;
+        if (interactive && (strcmp(words[1], "quit") == 0 || strcmp(words[1], "exit") == 0))
+            break;
+        if (interactive && strcmp(words[1], "help") == 0)
+        {
+            print_usage(prog_name);
+            continue;
+        }
+        words[count + 1] = NULL;
+        if (book == NULL)
+        {
+            if (client_run(daemon_fd, count + 1, words) < 0)
+                break; // The daemon went away
+        }
+        else
+        {
+            run_command(book, count + 1, words);
+        }
+        if (interactive)
+            fflush(stdout);
+    }
+    free(line);
+    if (book == NULL)
+        return;
+    if (log_sync(&book->log) != 0)
+    {
+        fprintf(err_stream(), "Error: Could not sync '%s'.\n", LOG_FILENAME);
+    }
+    book->log.deferred = 0;
+}
+
+/**
+ * @brief Splits a line into words in place. Words are separated by
+ * whitespace; double quotes group words and allow \" and \\ escapes,
+ * single quotes group words literally.
+ * @return The number of words, or -1 for an unterminated quote or more than
+ * `max_words` words.
+ */
+static int split_command_line(char *line, char **words, int max_words)
+{
+    int count = 0;
+    char *in = line;
+    for (;;)
+    {
+        while (isspace((unsigned char)*in))
+            in++;
+        if (*in == '\0')
+            return count;
+        if (count == max_words)
+            return -1;
+        char *out = in;
+        words[count++] = out;
+        while (*in != '\0' && !isspace((unsigned char)*in))
+        {
+            if (*in == '"' || *in == '\'')
+            {
+                const char quote = *in++;
+                while (*in != quote)
+                {
+                    if (*in == '\0')
+                        return -1;
+                    if (quote == '"' && *in == '\\' && (in[1] == '"' || in[1] == '\\'))
+                        in++;
+                    *out++ = *in++;
+                }
+                in++;
+            }
+            else
+            {
+                *out++ = *in++;
+            }
+        }
+        // The terminator may overwrite the separator just read past.
+        const int at_end = *in == '\0';
+        *out = '\0';
+        if (at_end)
+            return count;
+        in++;
+    }
+}
+
+// --- Contact Book Implementation ---
+
+/**
+ * @brief Opens the binary book if one exists, falling back to the CSV file.
+ * @return 0 on success, -1 if the book could not be opened at all.
+ */
+static int book_open(ContactBook *book)
+{
+    memset(book, 0, sizeof(*book));
+    book->file.fd = -1;
+    book->log.fd = -1;
+    book->contacts = array_create();
+    if (book->contacts == NULL)
+    {
+        return -1; // Error message printed in array_create
+    }
+
+    if (book_file_open(&book->file, BOOK_FILENAME) == 0)
+    {
+        if (book_file_load(&book->file, book->contacts) != 0)
+        {
+            book_close(book);
+            return -1;
+        }
+        return 0;
+    }
+    if (errno != ENOENT)
+    {
+        book_close(book); // Error message printed in book_file_open
+        return -1;
+    }
+
+    const int loaded = load_contacts_from_csv(book->contacts, CSV_FILENAME, &book->log.base, NULL) == 0;
+    if (log_replay(&book->log, book->contacts) != 0)
+    {
+        book_close(book); // Error message printed in log_replay
+        return -1;
+    }
+    if (!loaded && book->log.size == 0 && book->contacts->size == 0)
+    {
+        // This is not a fatal error, maybe the file doesn't exist yet.
+        fprintf(stderr, "Info: Could not load contacts from '%s'. Starting with an empty list.\n", CSV_FILENAME);
+    }
+    return 0;
+}
+
+static void book_close(ContactBook *book)
+{
+    if (book->file.base == NULL && log_should_compact(&book->log))
+    {
+        if (book_compact(book) != 0)
+        {
+            fprintf(stderr, "Warning: Could not compact '%s'; changes remain in '%s'.\n", CSV_FILENAME, LOG_FILENAME);
+        }
+    }
+    book_drop_indexes(book);
+    log_close(&book->log);
+    book_file_close(&book->file);
+    array_destroy(book->contacts);
+    book->contacts = NULL;
+}
+
+static int book_add(ContactBook *book, const char *name, const char *phone, const char *email)
+{
+    Contact *contact = NULL;
+    int reused_slot = 0;
+    if (book->file.base != NULL)
+    {
+        Contact mapped;
+        size_t slot;
+        const int rc = book_file_append(&book->file, name, phone, email, &slot, &mapped);
+        if (rc < 0)
+            return -1;
+        if (rc == BOOK_FILE_FULL)
+        {
+            // Stage the contact in memory and rewrite the book with room to grow.
+            contact = array_push(book->contacts);
+            if (contact == NULL)
+                return -1;
+            if (contact_init(contact, &book->contacts->strings, name, phone, email) != 0)
+            {
+                array_pop(book->contacts);
+                return -1;
+            }
+            return book_write_binary(book);
+        }
+        // Positions in a binary book's array match its record slots.
+        reused_slot = slot < book->contacts->size;
+        contact = array_claim(book->contacts, slot);
+        if (contact == NULL)
+            return -1;
+        *contact = mapped;
+    }
+    else
+    {
+        contact = array_push(book->contacts);
+        if (contact == NULL)
+            return -1;
+        const char *fields[3] = {name, phone, email};
+        if (contact_init(contact, &book->contacts->strings, name, phone, email) != 0 ||
+            log_append(&book->log, LOG_OP_ADD, fields, 3) != 0)
+        {
+            array_pop(book->contacts);
+            return -1;
+        }
+    }
+
+    const size_t pos = (size_t)(contact - book->contacts->items);
+    if (book->indexed)
+    {
+        if (index_insert(&book->by_name, book->contacts, pos) != 0 ||
+            index_insert(&book->by_email, book->contacts, pos) != 0)
+            book_drop_indexes(book); // Rebuilt on the next lookup
+    }
+    if (book->trigrams_built && trigram_index_add(&book->trigrams, contact, pos) != 0)
+        book_drop_indexes(book);
+    if (book->column_built && (pos != book->column.count || column_append(&book->column, contact) != 0))
+    {
+        column_free(&book->column); // Rebuilt on the next scan
+        book->column_built = 0;
+    }
+    // A reused slot would leave the old contact's keys pointing at the new one.
+    if (book->fuzzy_built && (reused_slot || fuzzy_index_add(&book->fuzzy, contact, pos) != 0))
+    {
+        fuzzy_index_free(&book->fuzzy);
+        book->fuzzy_built = 0;
+    }
+    if (book->names_built && (reused_slot || name_index_insert(&book->names, contact, pos) != 0))
+    {
+        name_index_free(&book->names);
+        book->names_built = 0;
+    }
+    if (book->orders_built)
+    {
+        for (int k = 0; k < ORDER_KEYS; ++k)
+            vector_free(&book->orders[k]);
+        book->orders_built = 0; // Resorted by the next sorted listing
+    }
+    if (reused_slot)
+    {
+        // Persisted indexes cover a reused slot under its old contact, so
+        // record the slot for them to look up afresh.
+        index_file_mark_dirty(TRIGRAM_FILENAME, pos);
+        index_file_mark_dirty(ORDER_FILENAME, pos);
+    }
+    book_record_change(book, pos, 1);
+    return 0;
+}
+
+/**
+ * @brief Deletes every contact whose name matches exactly, using the name index.
+ * @return The number of contacts deleted.
+ */
+static size_t book_delete(ContactBook *book, const char *name)
+{
+    PositionList matches = VECTOR_INIT(size_t);
+    if (book_lookup(book, &book->by_name, name, &matches) != 0 || matches.length == 0)
+    {
+        vector_free(&matches);
+        return 0;
+    }
+    if (book->file.base != NULL)
+    {
+        if (!book->file.writable)
+        {
+            fprintf(stderr, "Error: The contact book is read-only.\n");
+            vector_free(&matches);
+            return 0;
+        }
+    }
+    else if (log_append(&book->log, LOG_OP_DELETE, &name, 1) != 0)
+    {
+        // Log first: a delete that is not durable must not be reported.
+        vector_free(&matches);
+        return 0;
+    }
+
+    for (size_t i = 0; i < matches.length; ++i)
+    {
+        const size_t pos = positions_data(&matches)[i];
+        if (book->file.base != NULL)
+            book_file_free(&book->file, pos);
+        index_remove(&book->by_name, book->contacts, pos);
+        index_remove(&book->by_email, book->contacts, pos);
+        array_tombstone(book->contacts, pos);
+        book_record_change(book, pos, 0);
+    }
+    const size_t deleted = matches.length;
+    vector_free(&matches);
+    return deleted;
+}
+
+/**
+ * @brief Records an add or delete at `pos` for `serve`, if it is listening.
+ */
+static void book_record_change(ContactBook *book, size_t pos, int added)
+{
+    if (book->changes == NULL)
+        return;
+    const BookChange change = {pos, added};
+    if (vector_append(book->changes, &change) != 0)
+        book->changes_lost = 1; // The daemon rebuilds its snapshot instead
+}
+
+/**
+ * @brief Collects the positions of all live contacts whose indexed field
+ * equals `key`, building the indexes on first use.
+ */
+static int book_lookup(ContactBook *book, HashIndex *index, const char *key, PositionList *out)
+{
+    if (!book->indexed && book_build_indexes(book) != 0)
+        return -1;
+    return index_find(index, book->contacts, key, out);
+}
+
+static int book_build_indexes(ContactBook *book)
+{
+    if (index_build(&book->by_name, book->contacts, offsetof(Contact, name)) != 0 ||
+        index_build(&book->by_email, book->contacts, offsetof(Contact, email)) != 0)
+    {
+        book_drop_indexes(book);
+        return -1;
+    }
+    book->indexed = 1;
+    return 0;
+}
+
+/**
+ * @brief Frees the indexes; they must be dropped whenever positions change.
+ * Recorded changes name positions too, so they are marked lost.
+ */
+static void book_drop_indexes(ContactBook *book)
+{
+    book->changes_lost = 1;
+    index_free(&book->by_name);
+    index_free(&book->by_email);
+    book->indexed = 0;
+    trigram_index_free(&book->trigrams);
+    book->trigrams_built = 0;
+    column_free(&book->column);
+    book->column_built = 0;
+    fuzzy_index_free(&book->fuzzy);
+    book->fuzzy_built = 0;
+    name_index_free(&book->names);
+    book->names_built = 0;
+    for (int k = 0; k < ORDER_KEYS; ++k)
+        vector_free(&book->orders[k]);
+    book->orders_built = 0;
+}
+
+/**
+ * @brief Finds every live contact whose name or email contains `term`,
+ * ignoring ASCII case, by scanning the search column.
+ * @return 0 on success, -1 if the column could not be built.
+ */
+static int book_scan(ContactBook *book, const char *term, PositionList *out)
+{
+    if (!book->column_built)
+    {
+        if (column_build(&book->column, book->contacts) != 0)
+            return -1;
+        book->column_built = 1;
+    }
+    return column_scan(&book->column, book->contacts, term, out);
+}
+
+static int compare_match_pos(const void *a, const void *b)
+{
+    const FuzzyMatch *x = (const FuzzyMatch *)a, *y = (const FuzzyMatch *)b;
+    if (x->pos != y->pos)
+        return x->pos < y->pos ? -1 : 1;
+    return x->distance - y->distance;
+}
+
+static _Thread_local const ContactArray *rank_contacts; // Context for compare_match_rank
+static _Thread_local const size_t *tie_origins; // Book positions of the serve snapshot being read, or NULL
+
+/**
+ * @brief Orders two contacts that sort alike by their book positions: a
+ * serve snapshot's own positions do not follow the book's for the contacts
+ * added to a binary book since it was built.
+ */
+static inline int compare_ties(size_t a, size_t b)
+{
+    if (tie_origins != NULL)
+    {
+        a = tie_origins[a];
+        b = tie_origins[b];
+    }
+    return a < b ? -1 : (a > b);
+}
+
+static int compare_match_rank(const void *a, const void *b)
+{
+    const FuzzyMatch *x = (const FuzzyMatch *)a, *y = (const FuzzyMatch *)b;
+    if (x->distance != y->distance)
+        return x->distance - y->distance;
+    const int order = strcmp(rank_contacts->items[x->pos].name, rank_contacts->items[y->pos].name);
+    if (order != 0)
+        return order;
+    return compare_ties(x->pos, y->pos);
+}
+
+/**
+ * @brief Sorts matches by position, keeping each contact's nearest match.
+ */
+static void fuzzy_matches_by_pos(FuzzyMatchList *list)
+{
+    if (list->size > 1)
+        qsort(list->items, list->size, sizeof(FuzzyMatch), compare_match_pos);
+    size_t kept = 0;
+    for (size_t i = 0; i < list->size; ++i)
+    {
+        if (kept == 0 || list->items[kept - 1].pos != list->items[i].pos)
+            list->items[kept++] = list->items[i];
+    }
+    list->size = kept;
+}
+
+/**
+ * @brief Finds the contacts whose name has, for every word of `term`, a
+ * word within a few edits of it, summing their edits, in position order.
+ * `index` covers the contacts below `unindexed`; the rest are scanned.
+ * Deleted contacts may be among the results.
+ *
+ * Words of up to four characters tolerate one edit and longer ones two; any
+ * more and nearly every short name would match.
+ */
+static int fuzzy_match_words(const FuzzyIndex *index, const ContactArray *array, size_t unindexed, const char *term,
+                             FuzzyMatchList *out)
+{
+    char word[FUZZY_MAX_KEY + 1];
+    size_t length;
+    int first = 1;
+    FuzzyMatchList hits = {0};
+    while ((length = fuzzy_next_word(&term, word)) > 0)
+    {
+        hits.size = 0;
+        const int max_distance = length <= 4 ? 1 : 2;
+        if (fuzzy_index_search(index, word, length, max_distance, &hits) != 0 ||
+            fuzzy_scan(array, unindexed, word, length, max_distance, &hits) != 0)
+        {
+            free(hits.items);
+            return -1;
+        }
+        fuzzy_matches_by_pos(&hits);
+        if (first)
+        {
+            FuzzyMatchList swap = *out;
+            *out = hits;
+            hits = swap;
+            first = 0;
+            continue;
+        }
+        // Keep the contacts matching every word so far, summing their edits.
+        size_t kept = 0;
+        for (size_t i = 0, h = 0; i < out->size; ++i)
+        {
+            while (h < hits.size && hits.items[h].pos < out->items[i].pos)
+                h++;
+            if (h < hits.size && hits.items[h].pos == out->items[i].pos)
+                out->items[kept++] = (FuzzyMatch){out->items[i].pos, out->items[i].distance + hits.items[h].distance};
+        }
+        out->size = kept;
+    }
+    free(hits.items);
+    return 0;
+}
+
+/**
+ * @brief Ranks matches by total edits, then by name, and keeps at most
+ * `limit` of them.
+ */
+static void fuzzy_rank(const ContactArray *array, FuzzyMatchList *matches, size_t limit)
+{
+    rank_contacts = array;
+    if (matches->size > 1)
+        qsort(matches->items, matches->size, sizeof(FuzzyMatch), compare_match_rank);
+    if (matches->size > limit)
+        matches->size = limit;
+}
+
+/**
+ * @brief Finds the live contacts whose name has, for every word of `term`, a
+ * word within a few edits of it, as fuzzy_match_words, ranked by fuzzy_rank.
+ */
+static int book_fuzzy_find(ContactBook *book, const char *term, size_t limit, FuzzyMatchList *out)
+{
+    const ContactArray *array = book->contacts;
+    if (!book->fuzzy_built)
+    {
+        if (fuzzy_index_build(&book->fuzzy, array) != 0)
+            return -1;
+        book->fuzzy_built = 1;
+    }
+    if (fuzzy_match_words(&book->fuzzy, array, array->size, term, out) != 0)
+        return -1;
+    size_t kept = 0;
+    for (size_t i = 0; i < out->size; ++i)
+    {
+        if (contact_is_live(&array->items[out->items[i].pos]))
+            out->items[kept++] = out->items[i];
+    }
+    out->size = kept;
+    fuzzy_rank(array, out, limit);
+    return 0;
+}
+
+/**
+ * @brief Finds up to `limit` live contacts whose name starts with `prefix`,
+ * ignoring ASCII case, in name order.
+ */
+static int book_complete(ContactBook *book, const char *prefix, size_t limit, PositionList *out)
+{
+    if (!book->names_built)
+    {
+        if (name_index_build(&book->names, book->contacts) != 0)
+            return -1;
+        book->names_built = 1;
+    }
+    return name_index_prefix(&book->names, book->contacts, prefix, limit, out);
+}
+
+static int book_build_trigrams(ContactBook *book)
+{
+    trigram_index_free(&book->trigrams);
+    const ContactArray *array = book->contacts;
+    for (size_t pos = 0; pos < array->size; ++pos)
+    {
+        if (contact_is_live(&array->items[pos]) && trigram_index_add(&book->trigrams, &array->items[pos], pos) != 0)
+        {
+            trigram_index_free(&book->trigrams);
+            return -1;
+        }
+    }
+    book->trigrams_built = 1;
+    return 0;
+}
+
+/**
+ * @brief Builds the trigram index over the whole book and persists it.
+ */
+static int book_write_trigrams(ContactBook *book)
+{
+    if (book_build_trigrams(book) != 0)
+        return -1;
+    const BookHeader *h = book_header(&book->file);
+    return trigram_index_write(&book->trigrams, h->generation, h->record_count, TRIGRAM_FILENAME);
+}
+
+/**
+ * @brief Collects, in ascending order, the positions of contacts that may
+ * contain `term`, from the in-memory or the persisted trigram index.
+ *
+ * A persisted index is combined with a small in-memory index of the slots
+ * added or reused since it was built. If that delta has grown too large,
+ * or the book was rewritten since, the persisted index is rebuilt.
+ *
+ * CSV books have no persisted index. Building one in memory costs about
+ * TRIGRAM_MEMORY_BUILD_SCANS scans, so a large book is scanned until its
+ * session has issued that many finds and indexed from then on. Long
+ * `batch` and `shell` sessions then pay at most twice what the better of
+ * the two would have cost; a single find always scans.
+ * @return 0 on success, 1 if no index can serve the term, -1 on error.
+ */
+static int book_find_candidates(ContactBook *book, const char *term, PositionList *out)
+{
+    if (strlen(term) < 3)
+        return 1;
+    if (book->trigrams_built)
+        return trigram_index_candidates(&book->trigrams, term, out);
+    if (book->file.base == NULL)
+    {
+        if (++book->finds < TRIGRAM_MEMORY_BUILD_SCANS || book->contacts->live < TRIGRAM_MEMORY_MIN_CONTACTS ||
+            book_build_trigrams(book) != 0)
+            return 1;
+        return trigram_index_candidates(&book->trigrams, term, out);
+    }
+
+    TrigramFile file = {0};
+    if (trigram_file_open(&file, TRIGRAM_FILENAME) != 0)
+        return 1;
+    const TrigramHeader *th = (const TrigramHeader *)file.base;
+    const uint32_t *dirty = (const uint32_t *)(file.base + th->dirty_offset);
+    const size_t dirty_count = (file.length - th->dirty_offset) / sizeof(uint32_t);
+    const uint64_t indexed = th->indexed_records;
+    if (index_file_stale(&book->file, th->generation, indexed, dirty_count))
+    {
+        trigram_file_close(&file);
+        if (!book->file.writable || book_write_trigrams(book) != 0)
+            return 1;
+        return trigram_index_candidates(&book->trigrams, term, out);
+    }
+
+    TrigramIndex recent = {0};
+    PositionList persisted = VECTOR_INIT(size_t), fresh = VECTOR_INIT(size_t);
+    int rc = trigram_file_candidates(&file, term, &persisted);
+    for (size_t i = 0; rc == 0 && i < dirty_count; ++i)
+    {
+        if (dirty[i] < book->contacts->size && contact_is_live(&book->contacts->items[dirty[i]]))
+            rc = trigram_index_add(&recent, &book->contacts->items[dirty[i]], dirty[i]);
+    }
+    for (uint64_t pos = indexed; rc == 0 && pos < book->contacts->size; ++pos)
+    {
+        if (contact_is_live(&book->contacts->items[pos]))
+            rc = trigram_index_add(&recent, &book->contacts->items[pos], pos);
+    }
+    if (rc == 0 && recent.count > 0)
+        rc = trigram_index_candidates(&recent, term, &fresh);
+
+    // Merge the two ascending lists, dropping duplicates.
+    size_t i = 0, j = 0;
+    while (rc == 0 && (i < persisted.length || j < fresh.length))
+    {
+        size_t next;
+        if (j == fresh.length || (i < persisted.length && positions_data(&persisted)[i] < positions_data(&fresh)[j]))
+            next = positions_data(&persisted)[i++];
+        else if (i == persisted.length || positions_data(&fresh)[j] < positions_data(&persisted)[i])
+            next = positions_data(&fresh)[j++];
+        else
+            next = (j++, positions_data(&persisted)[i++]);
+        if (next < book->contacts->size)
+            rc = positions_push(out, next);
+    }
+    vector_free(&persisted);
+    vector_free(&fresh);
+    trigram_index_free(&recent);
+    trigram_file_close(&file);
+    return rc;
+}
+
+static int book_build_orders(ContactBook *book)
+{
+    for (int k = 0; k < ORDER_KEYS; ++k)
+    {
+        if (order_build(&book->orders[k], book->contacts, (OrderKey)k) != 0)
+        {
+            book_drop_indexes(book);
+            return -1;
+        }
+    }
+    book->orders_built = 1;
+    return 0;
+}
+
+/**
+ * @brief Sorts the whole book by every key and persists the orders.
+ */
+static int book_write_orders(ContactBook *book)
+{
+    if (!book->orders_built && book_build_orders(book) != 0)
+        return -1;
+    const BookHeader *h = book_header(&book->file);
+    return order_file_write(book->orders, h->generation, h->record_count, ORDER_FILENAME);
+}
+
+static int compare_slots(const void *a, const void *b)
+{
+    const uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Collects the positions of contacts offset+1..offset+limit when the
+ * book is sorted by `key`.
+ *
+ * A binary book reads its persisted order, which only needs each contact's
+ * live flag to skip past the offset. It is written on first use, and
+ * contacts added or moved into reused slots since are sorted on their own
+ * and merged in; once there are too many of them, it is rewritten. CSV
+ * books sort in memory on first use.
+ */
+static int book_order_page(ContactBook *book, OrderKey key, size_t offset, size_t limit, PositionList *out)
+{
+    const ContactArray *array = book->contacts;
+    OrderFile file = {0};
+    if (!book->orders_built && book->file.base != NULL)
+    {
+        if (order_file_open(&file, ORDER_FILENAME) == 0)
+        {
+            const OrderHeader *h = (const OrderHeader *)file.base;
+            const size_t dirty_count = (file.length - h->dirty_offset) / sizeof(uint32_t);
+            if (index_file_stale(&book->file, h->generation, h->indexed_records, dirty_count))
+                order_file_close(&file);
+        }
+        if (file.base == NULL && book->file.writable)
+            book_write_orders(book); // On failure, sorted in memory below
+    }
+    if (file.base == NULL)
+    {
+        if (!book->orders_built && book_build_orders(book) != 0)
+            return -1;
+        const PositionList *order = &book->orders[key];
+        size_t rank = 0;
+        for (size_t i = 0; i < order->length && out->length < limit; ++i)
+        {
+            if (contact_is_live(&array->items[positions_data(order)[i]]) && rank++ >= offset &&
+                positions_push(out, positions_data(order)[i]) != 0)
+                return -1;
+        }
+        return 0;
+    }
+
+    const OrderHeader *h = (const OrderHeader *)file.base;
+    const uint32_t *slots = (const uint32_t *)(file.base + sizeof(*h)) + (size_t)key * h->count;
+    const size_t dirty_count = (file.length - h->dirty_offset) / sizeof(uint32_t);
+    uint32_t *dirty = (uint32_t *)malloc((dirty_count ? dirty_count : 1) * sizeof(uint32_t));
+    PositionList fresh = VECTOR_INIT(size_t);
+    int rc = dirty == NULL ? -1 : 0;
+    if (rc == 0)
+    {
+        memcpy(dirty, file.base + h->dirty_offset, dirty_count * sizeof(uint32_t));
+        qsort(dirty, dirty_count, sizeof(uint32_t), compare_slots);
+    }
+    for (size_t i = 0; rc == 0 && i < dirty_count; ++i)
+    {
+        if ((i == 0 || dirty[i] != dirty[i - 1]) && dirty[i] < h->indexed_records && dirty[i] < array->size &&
+            contact_is_live(&array->items[dirty[i]]))
+            rc = positions_push(&fresh, dirty[i]);
+    }
+    for (size_t pos = h->indexed_records; rc == 0 && pos < array->size; ++pos)
+    {
+        if (contact_is_live(&array->items[pos]))
+            rc = positions_push(&fresh, pos);
+    }
+    if (rc == 0)
+        rc = order_sort(&fresh, array, key);
+
+    // Merge the persisted order with the fresh contacts, skipping persisted
+    // slots that were deleted or reused since.
+    size_t i = 0, j = 0, rank = 0;
+    while (rc == 0 && out->length < limit)
+    {
+        while (i < h->count && (slots[i] >= array->size || !contact_is_live(&array->items[slots[i]]) ||
+                                (dirty_count > 0 && bsearch(&slots[i], dirty, dirty_count, sizeof(uint32_t), compare_slots) != NULL)))
+            i++;
+        size_t next;
+        if (i == h->count && j == fresh.length)
+            break;
+        if (j == fresh.length || (i < h->count && order_compare(array, key, slots[i], positions_data(&fresh)[j]) < 0))
+            next = slots[i++];
+        else
+            next = positions_data(&fresh)[j++];
+        if (rank++ >= offset)
+            rc = positions_push(out, next);
+    }
+    free(dirty);
+    vector_free(&fresh);
+    order_file_close(&file);
+    return rc;
+}
+
+/**
+ * @brief Rewrites every contact into a fresh binary book and maps it.
+ *
+ * Used by `import` and whenever the mapped book runs out of record or heap
+ * space. The rewrite also drops the heap bytes of deleted contacts.
+ * @return 0 on success, -1 on failure (the current book stays usable).
+ */
+static int book_write_binary(ContactBook *book)
+{
+    // Write before unmapping: the contacts may still point into the old mapping.
+    if (book_file_write(book->contacts, BOOK_FILENAME) != 0)
+        return -1;
+    book_drop_indexes(book);
+    book_file_close(&book->file);
+    array_clear(book->contacts);
+    if (book_file_open(&book->file, BOOK_FILENAME) != 0)
+        return -1;
+    return book_file_load(&book->file, book->contacts);
+}
+
+/**
+ * @brief Folds the log into a new CSV snapshot and starts an empty log.
+ *
+ * The snapshot is replaced atomically by save_contacts_to_csv. If we crash
+ * before the log is reset, the log's base no longer matches the snapshot
+ * and it is discarded on the next load instead of being applied twice.
+ */
+static int book_compact(ContactBook *book)
+{
+    FileDigest digest;
+    if (save_contacts_to_csv(book->contacts, CSV_FILENAME, &digest) != 0)
+        return -1;
+    if (book->contacts->live < book->contacts->size)
+    {
+        book_drop_indexes(book);
+        array_compact(book->contacts);
+    }
+    return log_reset(&book->log, &digest);
+}
+
+// --- Contact Management Implementation ---
+
+static int contact_init(Contact *contact, Arena *arena, const char *name, const char *phone, const char *email)
+{
+    contact->name = arena_strdup(arena, name);
+    contact->phone = arena_strdup(arena, phone);
+    contact->email = arena_strdup(arena, email);
+
+    if (contact->name == NULL || contact->phone == NULL || contact->email == NULL)
+    {
+        perror("Failed to allocate memory for contact details");
+        return -1; // Partially copied strings stay in the arena until release
+    }
+    return 0;
+}
+
+static int contact_name_equals(const Contact *contact, const void *name)
+{
+    return strcmp(contact->name, (const char *)name) == 0;
+}
+
+static inline int contact_is_live(const Contact *contact)
+{
+    return contact->name != NULL;
+}
+
+// --- CSV I/O Implementation ---
+
+/**
+ * @brief Reports a record that was skipped, by the line it started on.
+ * Past CSV_MAX_REPORTED the records are only counted.
+ */
+static void csv_report_skipped(const CsvReader *reader, size_t skipped, const char *reason)
+{
+    if (skipped <= CSV_MAX_REPORTED)
+        fprintf(err_stream(), "Warning: Skipped line %zu of '%s': %s.\n", reader->record_line, reader->filename, reason);
+}
+
+/**
+ * @brief Appends the contacts in a CSV file to `array`. Fields are trimmed
+ * of surrounding whitespace. Blank lines are ignored; records without
+ * exactly three fields or with no name are reported and skipped.
+ * @param digest If not NULL, receives the size and CRC-32 of the file.
+ * @param skipped If not NULL, receives the number of records skipped.
+ * @return 0 on success, -1 if the file could not be read to the end. The
+ * contacts read before the failure are left in `array`.
+ */
+static int load_contacts_from_csv(ContactArray *array, const char *filename, FileDigest *digest, size_t *skipped)
+{
+    CsvReader reader;
+    if (csv_reader_open(&reader, filename) != 0)
+    {
+        if (errno != ENOENT)
+        {
+            perror("Error opening contacts file for reading");
+        }
+        return -1;
+    }
+
+    // Unquoting only ever shrinks a field and every field ends at a comma,
+    // line break or the end of the file, so the file size bounds the string
+    // bytes and the whole book fits in one arena block.
+    struct stat st;
+    if (fstat(reader.input.fd, &st) == 0 && st.st_size > 0)
+    {
+        arena_reserve(&array->strings, (size_t)st.st_size + 1);
+    }
+
+    reader.checksum = digest != NULL;
+    size_t bad = 0;
+    int rc;
+    while ((rc = csv_read_record(&reader)) > 0)
+    {
+        if (reader.field_count == 1 && reader.fields[0] == '\0')
+            continue; // A blank line
+        if (reader.field_count != 3)
+        {
+            csv_report_skipped(&reader, ++bad, reader.field_count < 3 ? "too few fields" : "too many fields");
+            continue;
+        }
+        char *name = str_trim(reader.fields + reader.offsets[0]);
+        char *phone = str_trim(reader.fields + reader.offsets[1]);
+        char *email = str_trim(reader.fields + reader.offsets[2]);
+        if (name[0] == '\0')
+        {
+            csv_report_skipped(&reader, ++bad, "no name");
+            continue;
+        }
+        Contact *contact = array_push(array);
+        if (contact && contact_init(contact, &array->strings, name, phone, email) != 0)
+        {
+            array_pop(array); // Drop the slot if the contact could not be built
+        }
+    }
+    if (bad > CSV_MAX_REPORTED)
+        fprintf(err_stream(), "Warning: Skipped %zu more malformed line(s) of '%s'.\n", bad - CSV_MAX_REPORTED, filename);
+    if (skipped != NULL)
+        *skipped = bad;
+    if (digest != NULL)
+    {
+        digest->size = reader.size;
+        digest->crc = reader.crc;
+    }
+    csv_reader_close(&reader);
+    return rc;
+}
+
+/**
+ * @brief Writes `array` to a CSV file, replacing it atomically.
+ *
+ * The contacts are written to a temporary file that is flushed to disk and
+ * then renamed over `filename`, so readers see either the old or new file.
+ * @param digest If not NULL, receives the size and CRC-32 of the new file.
+ */
+static int save_contacts_to_csv(const ContactArray *array, const char *filename, FileDigest *digest)
+{
+    char tmp_filename[256];
+    snprintf(tmp_filename, sizeof(tmp_filename), "%s.tmp", filename);
+    FILE *file = fopen(tmp_filename, "w");
+    if (file == NULL)
+    {
+        perror("Error opening contacts file for writing");
+        return -1;
+    }
+    setvbuf(file, NULL, _IOFBF, CSV_WRITE_BUFFER);
+    uint64_t size = 0;
+    uint32_t crc = 0;
+    for (const Contact *c = array_begin(array); c != array_end(array); ++c)
+    {
+        if (!contact_is_live(c))
+            continue;
+        csv_write_field(file, c->name, &size, &crc);
+        csv_write_bytes(file, ",", 1, &size, &crc);
+        csv_write_field(file, c->phone, &size, &crc);
+        csv_write_bytes(file, ",", 1, &size, &crc);
+        csv_write_field(file, c->email, &size, &crc);
+        csv_write_bytes(file, "\n", 1, &size, &crc);
+    }
+    int rc = 0;
+    if (fflush(file) != 0 || ferror(file) || fsync(fileno(file)) != 0)
+    {
+        perror("Error writing contacts file");
+        rc = -1;
+    }
+    if (fclose(file) != 0 && rc == 0)
+    {
+        perror("Error closing contacts file");
+        rc = -1;
+    }
+    if (rc == 0 && rename(tmp_filename, filename) != 0)
+    {
+        perror("Error replacing contacts file");
+        rc = -1;
+    }
+    if (rc != 0)
+    {
+        unlink(tmp_filename);
+        return -1;
+    }
+    if (digest != NULL)
+    {
+        digest->size = size;
+        digest->crc = crc;
+    }
+    return 0;
+}
+
+static size_t csv_scan_scalar(const char *data, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        const char c = data[i];
+        if (c == ',' || c == '"' || c == '\n' || c == '\r')
+            return i;
+    }
+    return n;
+}
+
+#ifdef HAVE_SSE2
+static size_t csv_scan_sse2(const char *data, size_t n)
+{
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i carriage = _mm_set1_epi8('\r');
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        const __m128i x = _mm_loadu_si128((const __m128i *)(data + i));
+        const __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, comma), _mm_cmpeq_epi8(x, quote)),
+                                          _mm_or_si128(_mm_cmpeq_epi8(x, newline), _mm_cmpeq_epi8(x, carriage)));
+        const unsigned mask = (unsigned)_mm_movemask_epi8(hits);
+        if (mask != 0)
+            return i + (unsigned)__builtin_ctz(mask);
+    }
+    return i + csv_scan_scalar(data + i, n - i);
+}
+#endif
+
+#ifdef HAVE_AVX2_DISPATCH
+__attribute__((target("avx2"))) static size_t csv_scan_avx2(const char *data, size_t n)
+{
+    const __m256i comma = _mm256_set1_epi8(',');
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i carriage = _mm256_set1_epi8('\r');
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        const __m256i x = _mm256_loadu_si256((const __m256i *)(data + i));
+        const __m256i hits = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(x, comma), _mm256_cmpeq_epi8(x, quote)),
+                                             _mm256_or_si256(_mm256_cmpeq_epi8(x, newline), _mm256_cmpeq_epi8(x, carriage)));
+        const unsigned mask = (unsigned)_mm256_movemask_epi8(hits);
+        if (mask != 0)
+            return i + (unsigned)__builtin_ctz(mask);
+    }
+    return i + csv_scan_sse2(data + i, n - i);
+}
+#endif
+
+static int csv_reader_open(CsvReader *reader, const char *filename)
+{
+    memset(reader, 0, sizeof(*reader));
+    reader->filename = filename;
+    reader->line = 1;
+    const int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return -1;
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    if (reader_init(&reader->input, fd, CSV_READ_BUFFER) != 0)
+    {
+        close(fd);
+        errno = ENOMEM;
+        return -1;
+    }
+#if defined(HAVE_AVX2_DISPATCH)
+    reader->scan = __builtin_cpu_supports("avx2") ? csv_scan_avx2 : csv_scan_sse2;
+#elif defined(HAVE_SSE2)
+    reader->scan = csv_scan_sse2;
+#else
+    reader->scan = csv_scan_scalar;
+#endif
+    return 0;
+}
+
+static void csv_reader_close(CsvReader *reader)
+{
+    close(reader->input.fd);
+    reader_free(&reader->input);
+    free(reader->fields);
+}
+
+/**
+ * @brief Makes sure at least one unconsumed byte is buffered.
+ * @return 1 if there is one, 0 at the end of the file or on error.
+ */
+static int csv_fill(CsvReader *reader)
+{
+    if (reader->start < reader->end)
+        return 1;
+    if (reader->error)
+        return 0;
+    size_t n = 0;
+    const int rc = reader_next(&reader->input, &reader->block, &n);
+    if (rc < 0)
+    {
+        perror("Error reading CSV file");
+        reader->error = 1;
+        return 0;
+    }
+    reader->start = 0;
+    reader->end = n;
+    reader->size += (uint64_t)n;
+    if (reader->checksum)
+        reader->crc = crc32_update(reader->crc, reader->block, n);
+    return rc > 0;
+}
+
+static void csv_append(CsvReader *reader, const char *data, size_t n)
+{
+    if (reader->fields_length + n + 1 > reader->fields_capacity)
+    {
+        size_t capacity = reader->fields_capacity ? reader->fields_capacity : 256;
+        while (capacity < reader->fields_length + n + 1)
+            capacity *= 2;
+        char *fields = (char *)realloc(reader->fields, capacity);
+        if (fields == NULL)
+        {
+            perror("Failed to allocate memory for CSV record");
+            reader->error = 1;
+            return;
+        }
+        reader->fields = fields;
+        reader->fields_capacity = capacity;
+    }
+    memcpy(reader->fields + reader->fields_length, data, n);
+    reader->fields_length += n;
+}
+
+static void csv_end_field(CsvReader *reader, size_t field_start)
+{
+    csv_append(reader, "", 0); // Makes room for the terminator
+    if (reader->error)
+        return;
+    reader->fields[reader->fields_length++] = '\0';
+    if (reader->field_count < CSV_MAX_FIELDS)
+        reader->offsets[reader->field_count] = field_start;
+    reader->field_count++;
+}
+
+/**
+ * @brief Counts the line breaks in quoted text: LF, CRLF or a lone CR.
+ * `*cr` carries a trailing CR over to the next piece of the same text.
+ */
+static size_t csv_count_lines(const char *data, size_t n, int *cr)
+{
+    size_t lines = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (data[i] == '\r' || (data[i] == '\n' && !*cr))
+            lines++;
+        *cr = data[i] == '\r';
+    }
+    return lines;
+}
+
+/**
+ * @brief Reads the next record, unquoting its fields.
+ *
+ * Records end at LF, CRLF or a lone CR. A field that starts with a quote
+ * runs to the matching closing quote, with "" standing for one quote, and
+ * may hold commas and line breaks. Malformed input is read leniently: a
+ * stray quote inside an unquoted field is kept as is and text after a
+ * closing quote is appended to the field. An unterminated quote, which
+ * would swallow the rest of the file, is an error reported with the line
+ * its record started on.
+ * @return 1 if a record was read, 0 at the end of the file, -1 on error.
+ */
+static int csv_read_record(CsvReader *reader)
+{
+    reader->fields_length = 0;
+    reader->field_count = 0;
+    reader->record_line = reader->line;
+    if (!csv_fill(reader))
+        return reader->error ? -1 : 0;
+    for (;;)
+    {
+        const size_t field_start = reader->fields_length;
+        if (csv_fill(reader) && reader->block[reader->start] == '"')
+        {
+            reader->start++;
+            int closed = 0, cr = 0;
+            while (!closed && csv_fill(reader))
+            {
+                const char *data = reader->block + reader->start;
+                const size_t available = reader->end - reader->start;
+                const char *quote = (const char *)memchr(data, '"', available);
+                const size_t n = quote != NULL ? (size_t)(quote - data) : available;
+                csv_append(reader, data, n);
+                reader->line += csv_count_lines(data, n, &cr);
+                reader->start += n;
+                if (quote == NULL)
+                    continue;
+                reader->start++;
+                cr = 0;
+                if (!csv_fill(reader) || reader->block[reader->start] != '"')
+                    closed = 1;
+                else
+                {
+                    csv_append(reader, "\"", 1);
+                    reader->start++;
+                }
+            }
+            if (!closed)
+            {
+                if (!reader->error)
+                    fprintf(err_stream(), "Error: Unterminated quote in '%s' in the record starting on line %zu.\n",
+                            reader->filename, reader->record_line);
+                reader->error = 1;
+                return -1;
+            }
+        }
+        for (;;)
+        {
+            if (!csv_fill(reader))
+            {
+                csv_end_field(reader, field_start); // The file ends the record
+                return reader->error ? -1 : 1;
+            }
+            const size_t n = reader->scan(reader->block + reader->start, reader->end - reader->start);
+            csv_append(reader, reader->block + reader->start, n);
+            reader->start += n;
+            if (reader->start == reader->end)
+                continue;
+            const char c = reader->block[reader->start++];
+            if (c == '"')
+            {
+                csv_append(reader, "\"", 1);
+                continue;
+            }
+            csv_end_field(reader, field_start);
+            if (c == ',')
+                break;
+            reader->line++;
+            if (c == '\r' && csv_fill(reader) && reader->block[reader->start] == '\n')
+                reader->start++;
+            return reader->error ? -1 : 1;
+        }
+    }
+}
+
+static void csv_write_bytes(FILE *file, const char *data, size_t n, uint64_t *size, uint32_t *crc)
+{
+    fwrite(data, 1, n, file);
+    *crc = crc32_update(*crc, data, n);
+    *size += n;
+}
+
+/**
+ * @brief Writes one field, quoting it if it holds a comma, quote or line
+ * break, and doubling any quotes inside it.
+ */
+static void csv_write_field(FILE *file, const char *field, uint64_t *size, uint32_t *crc)
+{
+    const size_t plain = strcspn(field, ",\"\r\n");
+    if (field[plain] == '\0')
+    {
+        csv_write_bytes(file, field, plain, size, crc);
+        return;
+    }
+    csv_write_bytes(file, "\"", 1, size, crc);
+    for (const char *p = field; *p != '\0';)
+    {
+        const char *quote = strchr(p, '"');
+        const size_t n = quote != NULL ? (size_t)(quote - p) + 1 : strlen(p);
+        csv_write_bytes(file, p, n, size, crc);
+        if (quote == NULL)
+            break;
+        csv_write_bytes(file, "\"", 1, size, crc); // Double the quote
+        p = quote + 1;
+    }
+    csv_write_bytes(file, "\"", 1, size, crc);
+}
+
+// --- Binary Storage Implementation ---
+
+static inline BookHeader *book_header(const BookFile *file)
+{
+    return (BookHeader *)file->base;
+}
+
+static inline BookRecord *book_records(const BookFile *file)
+{
+    return (BookRecord *)(file->base + BOOK_TABLE_OFFSET);
+}
+
+static inline char *book_heap(const BookFile *file)
+{
+    return (char *)file->base + book_header(file)->heap_offset;
+}
+
+static int book_file_valid(const BookFile *file)
+{
+    if (file->length < BOOK_TABLE_OFFSET)
+        return 0;
+    const BookHeader *h = book_header(file);
+    if (memcmp(h->magic, BOOK_MAGIC, sizeof(h->magic)) != 0 ||
+        h->version != BOOK_VERSION || h->record_size != sizeof(BookRecord))
+        return 0;
+    if (h->record_capacity > (file->length - BOOK_TABLE_OFFSET) / sizeof(BookRecord) ||
+        h->record_count > h->record_capacity || h->live_count > h->record_count ||
+        h->record_capacity > BOOK_NO_FREE_SLOT)
+        return 0;
+    if (h->heap_offset < BOOK_TABLE_OFFSET + h->record_capacity * sizeof(BookRecord) ||
+        h->heap_offset > file->length || h->heap_capacity > file->length - h->heap_offset ||
+        h->heap_used > h->heap_capacity)
+        return 0;
+    if (h->free_head != BOOK_NO_FREE_SLOT && h->free_head >= h->record_count)
+        return 0;
+    // A NUL as the last heap byte guarantees every in-bounds string terminates.
+    return h->heap_used == 0 || book_heap(file)[h->heap_used - 1] == '\0';
+}
+
+/**
+ * @brief Maps a binary book, read-write if possible and read-only otherwise.
+ * @return 0 on success, -1 on failure. errno is ENOENT if the file is absent.
+ */
+static int book_file_open(BookFile *file, const char *filename)
+{
+    file->writable = 1;
+    file->fd = open(filename, O_RDWR);
+    if (file->fd < 0 && (errno == EACCES || errno == EROFS))
+    {
+        file->writable = 0;
+        file->fd = open(filename, O_RDONLY);
+    }
+    if (file->fd < 0)
+    {
+        if (errno != ENOENT)
+            perror("Error opening contact book for reading");
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(file->fd, &st) != 0)
+    {
+        perror("Error reading contact book size");
+        book_file_close(file);
+        return -1;
+    }
+    file->length = (size_t)st.st_size;
+    if (file->length >= BOOK_TABLE_OFFSET)
+    {
+        const int prot = file->writable ? PROT_READ | PROT_WRITE : PROT_READ;
+        void *base = mmap(NULL, file->length, prot, MAP_SHARED, file->fd, 0);
+        if (base == MAP_FAILED)
+        {
+            perror("Error mapping contact book");
+            book_file_close(file);
+            return -1;
+        }
+        file->base = (unsigned char *)base;
+    }
+    if (file->base == NULL || !book_file_valid(file))
+    {
+        fprintf(stderr, "Error: '%s' is not a valid contact book file.\n", filename);
+        book_file_close(file);
+        errno = EINVAL;
+        return -1;
+    }
+    return 0;
+}
+
+static void book_file_close(BookFile *file)
+{
+    if (file->base != NULL)
+        munmap(file->base, file->length);
+    if (file->fd >= 0)
+        close(file->fd);
+    file->base = NULL;
+    file->fd = -1;
+    file->length = 0;
+}
+
+/**
+ * @brief Appends a view of every record to `array` without copying strings.
+ *
+ * Free slots become tombstones, so the array position of each contact is
+ * its record slot.
+ */
+static int book_file_load(const BookFile *file, ContactArray *array)
+{
+    const BookHeader *h = book_header(file);
+    const BookRecord *records = book_records(file);
+    char *heap = book_heap(file);
+    if (array_reserve(array, array->size + h->record_count) != 0)
+        return -1;
+    for (uint64_t slot = 0; slot < h->record_count; ++slot)
+    {
+        const BookRecord *r = &records[slot];
+        Contact *c = array_push(array);
+        if (!(r->flags & BOOK_RECORD_LIVE))
+        {
+            array_tombstone(array, array->size - 1);
+            continue;
+        }
+        if (r->name >= h->heap_used || r->phone >= h->heap_used || r->email >= h->heap_used)
+        {
+            fprintf(stderr, "Warning: Skipping corrupt record %llu in contact book.\n", (unsigned long long)slot);
+            array_tombstone(array, array->size - 1);
+            continue;
+        }
+        c->name = heap + r->name;
+        c->phone = heap + r->phone;
+        c->email = heap + r->email;
+    }
+    return 0;
+}
+
+/**
+ * @brief Writes `array` as a new binary book, replacing `filename` atomically.
+ *
+ * The record table and heap are sized at twice the current contents so that
+ * later appends can be done in place.
+ */
+static int book_file_write(const ContactArray *array, const char *filename)
+{
+    uint64_t heap_used = 0;
+    for (const Contact *c = array_begin(array); c != array_end(array); ++c)
+    {
+        if (contact_is_live(c))
+            heap_used += strlen(c->name) + strlen(c->phone) + strlen(c->email) + 3;
+    }
+    const uint64_t record_capacity = array->live * 2 > BOOK_MIN_RECORDS ? array->live * 2 : BOOK_MIN_RECORDS;
+    const uint64_t heap_capacity = heap_used * 2 > BOOK_MIN_HEAP ? heap_used * 2 : BOOK_MIN_HEAP;
+    if (record_capacity > BOOK_NO_FREE_SLOT)
+    {
+        fprintf(stderr, "Error: Too many contacts for the binary format.\n");
+        return -1;
+    }
+    const uint64_t heap_offset = BOOK_TABLE_OFFSET + record_capacity * sizeof(BookRecord);
+    const size_t length = (size_t)(heap_offset + heap_capacity);
+
+    char tmp_filename[256];
+    snprintf(tmp_filename, sizeof(tmp_filename), "%s.tmp", filename);
+    int fd = open(tmp_filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        perror("Error creating contact book");
+        return -1;
+    }
+    if (ftruncate(fd, (off_t)length) != 0)
+    {
+        perror("Error sizing contact book");
+        close(fd);
+        unlink(tmp_filename);
+        return -1;
+    }
+    unsigned char *base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED)
+    {
+        perror("Error mapping contact book");
+        close(fd);
+        unlink(tmp_filename);
+        return -1;
+    }
+
+    BookHeader *h = (BookHeader *)base;
+    memcpy(h->magic, BOOK_MAGIC, sizeof(h->magic));
+    h->version = BOOK_VERSION;
+    h->generation = (uint32_t)time(NULL) ^ ((uint32_t)getpid() << 16) ^ (uint32_t)clock();
+    h->record_size = sizeof(BookRecord);
+    h->record_count = array->live;
+    h->record_capacity = record_capacity;
+    h->live_count = array->live;
+    h->heap_offset = heap_offset;
+    h->heap_used = heap_used;
+    h->heap_capacity = heap_capacity;
+    h->free_head = BOOK_NO_FREE_SLOT;
+
+    BookRecord *r = (BookRecord *)(base + BOOK_TABLE_OFFSET);
+    char *heap = (char *)base + heap_offset;
+    uint64_t offset = 0;
+    for (const Contact *c = array_begin(array); c != array_end(array); ++c)
+    {
+        if (!contact_is_live(c))
+            continue;
+        const char *fields[3] = {c->name, c->phone, c->email};
+        uint64_t *offsets[3] = {&r->name, &r->phone, &r->email};
+        for (int f = 0; f < 3; ++f)
+        {
+            const size_t len = strlen(fields[f]) + 1;
+            memcpy(heap + offset, fields[f], len);
+            *offsets[f] = offset;
+            offset += len;
+        }
+        r->flags = BOOK_RECORD_LIVE;
+        r->next_free = BOOK_NO_FREE_SLOT;
+        r++;
+    }
+
+    int rc = 0;
+    if (munmap(base, length) != 0 || fsync(fd) != 0)
+    {
+        perror("Error flushing contact book");
+        rc = -1;
+    }
+    close(fd);
+    if (rc == 0 && rename(tmp_filename, filename) != 0)
+    {
+        perror("Error replacing contact book");
+        rc = -1;
+    }
+    if (rc != 0)
+        unlink(tmp_filename);
+    return rc;
+}
+
+/**
+ * @brief Adds a contact in place, reusing a free slot when one is available.
+ *
+ * The strings and record are written before the header is updated, so a
+ * crash part-way through leaves the previous state of the book intact.
+ * @param slot Receives the record slot used.
+ * @param out Receives a view of the new contact's strings in the mapping.
+ * @return 0 on success, BOOK_FILE_FULL if the file must grow, -1 on error.
+ */
+static int book_file_append(BookFile *file, const char *name, const char *phone, const char *email, size_t *slot, Contact *out)
+{
+    if (!file->writable)
+    {
+        fprintf(stderr, "Error: The contact book is read-only.\n");
+        return -1;
+    }
+    BookHeader *h = book_header(file);
+    const char *fields[3] = {name, phone, email};
+    size_t lens[3];
+    uint64_t needed = 0;
+    for (int f = 0; f < 3; ++f)
+    {
+        lens[f] = strlen(fields[f]) + 1;
+        needed += lens[f];
+    }
+    const int reuse = h->free_head != BOOK_NO_FREE_SLOT;
+    if (h->heap_capacity - h->heap_used < needed || (!reuse && h->record_count == h->record_capacity))
+        return BOOK_FILE_FULL;
+
+    *slot = reuse ? h->free_head : h->record_count;
+    BookRecord *r = &book_records(file)[*slot];
+    const uint32_t next_free = r->next_free;
+    char *heap = book_heap(file);
+    uint64_t offset = h->heap_used;
+    uint64_t *offsets[3] = {&r->name, &r->phone, &r->email};
+    char **views[3] = {&out->name, &out->phone, &out->email};
+    for (int f = 0; f < 3; ++f)
+    {
+        memcpy(heap + offset, fields[f], lens[f]);
+        *offsets[f] = offset;
+        *views[f] = heap + offset;
+        offset += lens[f];
+    }
+    r->next_free = BOOK_NO_FREE_SLOT;
+    r->flags = BOOK_RECORD_LIVE;
+
+    h->heap_used = offset;
+    if (reuse)
+        h->free_head = next_free;
+    else
+        h->record_count++;
+    h->live_count++;
+    return 0;
+}
+
+/**
+ * @brief Deletes the record in `slot`, pushing it onto the free list.
+ * Heap bytes are reclaimed by the next rewrite.
+ */
+static int book_file_free(BookFile *file, size_t slot)
+{
+    BookHeader *h = book_header(file);
+    if (!file->writable || slot >= h->record_count)
+        return -1;
+    BookRecord *r = &book_records(file)[slot];
+    if (!(r->flags & BOOK_RECORD_LIVE))
+        return -1;
+    r->flags = 0;
+    r->next_free = h->free_head;
+    h->free_head = (uint32_t)slot;
+    h->live_count--;
+    return 0;
+}
+
+// --- Write-Ahead Log Implementation ---
+
+static int log_write_all(int fd, const void *data, size_t len)
+{
+    const unsigned char *p = (const unsigned char *)data;
+    while (len > 0)
+    {
+        const ssize_t n = write(fd, p, len);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+/**
+ * @brief Checks that a payload holds exactly `count` NUL-terminated strings.
+ */
+static int log_payload_valid(const char *payload, uint32_t length, int count)
+{
+    int terminators = 0;
+    for (uint32_t i = 0; i < length; ++i)
+    {
+        if (payload[i] == '\0')
+            terminators++;
+    }
+    return length > 0 && payload[length - 1] == '\0' && terminators == count;
+}
+
+/**
+ * @brief Applies every intact log entry to `array`.
+ *
+ * Replay stops at the first torn or corrupt entry; the next append truncates
+ * the log back to the last good entry. A log written against a different
+ * snapshot is ignored.
+ * @return 0 on success (including when there is no log), -1 on I/O error.
+ */
+static int log_replay(BookLog *log, ContactArray *array)
+{
+    log->size = 0;
+    const int fd = open(LOG_FILENAME, O_RDONLY);
+    if (fd < 0)
+    {
+        if (errno == ENOENT)
+            return 0;
+        perror("Error opening contacts log");
+        return -1;
+    }
+    struct stat st;
+    unsigned char *data = NULL;
+    if (fstat(fd, &st) != 0 || (st.st_size > 0 && (data = malloc((size_t)st.st_size)) == NULL))
+    {
+        perror("Error reading contacts log");
+        close(fd);
+        return -1;
+    }
+    size_t length = 0;
+    while (length < (size_t)st.st_size)
+    {
+        const ssize_t n = read(fd, data + length, (size_t)st.st_size - length);
+        if (n <= 0)
+        {
+            if (n < 0 && errno == EINTR)
+                continue;
+            break;
+        }
+        length += (size_t)n;
+    }
+    close(fd);
+
+    LogHeader header;
+    if (length < sizeof(header))
+    {
+        free(data);
+        return 0; // Empty or torn before the header was written: nothing to replay.
+    }
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, LOG_MAGIC, sizeof(header.magic)) != 0 || header.version != LOG_VERSION)
+    {
+        fprintf(stderr, "Warning: Ignoring '%s', which is not a contacts log.\n", LOG_FILENAME);
+        free(data);
+        return 0;
+    }
+    if (header.base_size != log->base.size || header.base_crc != log->base.crc)
+    {
+        fprintf(stderr, "Info: Discarding '%s'; its changes are already in '%s'.\n", LOG_FILENAME, CSV_FILENAME);
+        free(data);
+        return 0;
+    }
+
+    size_t offset = sizeof(header);
+    while (length - offset >= sizeof(LogEntryHeader))
+    {
+        LogEntryHeader entry;
+        memcpy(&entry, data + offset, sizeof(entry));
+        if (entry.length > length - offset - sizeof(entry))
+            break;
+        const char *payload = (const char *)data + offset + sizeof(entry);
+        const uint32_t crc = crc32_update(0, data + offset + sizeof(entry.crc), sizeof(entry) - sizeof(entry.crc) + entry.length);
+        if (crc != entry.crc)
+            break;
+        if (entry.op == LOG_OP_ADD && log_payload_valid(payload, entry.length, 3))
+        {
+            const char *phone = payload + strlen(payload) + 1;
+            const char *email = phone + strlen(phone) + 1;
+            Contact *contact = array_push(array);
+            if (contact == NULL || contact_init(contact, &array->strings, payload, phone, email) != 0)
+            {
+                free(data);
+                return -1;
+            }
+        }
+        else if (entry.op == LOG_OP_DELETE && log_payload_valid(payload, entry.length, 1))
+        {
+            array_remove_if(array, contact_name_equals, payload);
+        }
+        else
+        {
+            break;
+        }
+        offset += sizeof(entry) + entry.length;
+    }
+    if (offset < length)
+    {
+        fprintf(stderr, "Warning: Ignoring a torn or corrupt tail of %zu byte(s) in '%s'.\n", length - offset, LOG_FILENAME);
+    }
+    log->size = offset;
+    free(data);
+    return 0;
+}
+
+/**
+ * @brief Opens the log for appending, dropping any torn tail and writing a
+ * fresh header if the log holds no valid entries.
+ */
+static int log_open_for_append(BookLog *log)
+{
+    log->fd = open(LOG_FILENAME, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (log->fd < 0)
+    {
+        perror("Error opening contacts log for writing");
+        return -1;
+    }
+    if (ftruncate(log->fd, (off_t)log->size) != 0)
+    {
+        perror("Error truncating contacts log");
+        log_close(log);
+        return -1;
+    }
+    if (log->size == 0)
+    {
+        LogHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, LOG_MAGIC, sizeof(header.magic));
+        header.version = LOG_VERSION;
+        header.base_crc = log->base.crc;
+        header.base_size = log->base.size;
+        if (log_write_all(log->fd, &header, sizeof(header)) != 0)
+        {
+            perror("Error writing contacts log");
+            log_close(log);
+            return -1;
+        }
+        log->size = sizeof(header);
+    }
+    return 0;
+}
+
+/**
+ * @brief Durably appends one entry to the log.
+ * @return 0 once the entry is on disk, -1 on error.
+ */
+static int log_append(BookLog *log, uint8_t op, const char *const *fields, int field_count)
+{
+    if (log->fd < 0 && log_open_for_append(log) != 0)
+        return -1;
+
+    size_t payload_len = 0;
+    for (int i = 0; i < field_count; ++i)
+    {
+        payload_len += strlen(fields[i]) + 1;
+    }
+    if (payload_len > UINT32_MAX)
+    {
+        fprintf(stderr, "Error: Contact is too large to log.\n");
+        return -1;
+    }
+    const size_t entry_len = sizeof(LogEntryHeader) + payload_len;
+    unsigned char *entry = malloc(entry_len);
+    if (entry == NULL)
+    {
+        perror("Failed to allocate memory for log entry");
+        return -1;
+    }
+    LogEntryHeader header;
+    memset(&header, 0, sizeof(header));
+    header.length = (uint32_t)payload_len;
+    header.op = op;
+    unsigned char *p = entry + sizeof(header);
+    for (int i = 0; i < field_count; ++i)
+    {
+        const size_t len = strlen(fields[i]) + 1;
+        memcpy(p, fields[i], len);
+        p += len;
+    }
+    memcpy(entry, &header, sizeof(header));
+    header.crc = crc32_update(0, entry + sizeof(header.crc), entry_len - sizeof(header.crc));
+    memcpy(entry, &header, sizeof(header));
+
+    int rc = 0;
+    if (log_write_all(log->fd, entry, entry_len) != 0 || (!log->deferred && fdatasync(log->fd) != 0))
+    {
+        perror("Error appending to contacts log");
+        rc = -1;
+        log_close(log); // Reopening truncates any partial entry.
+    }
+    else
+    {
+        log->size += entry_len;
+        log->unsynced = log->deferred;
+    }
+    free(entry);
+    return rc;
+}
+
+/**
+ * @brief Empties the log and rebases it on a newly written snapshot.
+ */
+static int log_reset(BookLog *log, const FileDigest *base)
+{
+    log_close(log);
+    log->base = *base;
+    log->size = 0;
+    return log_open_for_append(log);
+}
+
+/**
+ * @brief Makes the entries appended since the last sync durable.
+ */
+static int log_sync(BookLog *log)
+{
+    if (!log->unsynced || log->fd < 0)
+        return 0;
+    if (fdatasync(log->fd) != 0)
+    {
+        perror("Error syncing contacts log");
+        return -1;
+    }
+    log->unsynced = 0;
+    return 0;
+}
+
+static void log_close(BookLog *log)
+{
+    if (log->fd >= 0)
+        close(log->fd);
+    log->fd = -1;
+}
+
+static int log_should_compact(const BookLog *log)
+{
+    if (log->size < LOG_COMPACT_MIN_BYTES)
+        return 0;
+    return log->size >= LOG_COMPACT_MAX_BYTES || log->size * LOG_COMPACT_RATIO >= log->base.size;
+}
+
+// --- Hash Index Implementation ---
+
+static inline const char *index_key(const HashIndex *index, const Contact *contact)
+{
+    return *(char *const *)((const char *)contact + index->key_offset);
+}
+
+/**
+ * @brief Places an entry in the first empty slot of its probe run.
+ */
+static void index_place(HashIndex *index, uint32_t hash, uint32_t pos)
+{
+    const size_t mask = index->capacity - 1;
+    size_t i = hash & mask;
+    while (index->slots[i].pos != 0)
+    {
+        i = (i + 1) & mask;
+    }
+    index->slots[i].hash = hash;
+    index->slots[i].pos = pos;
+    index->count++;
+}
+
+/**
+ * @brief Resizes the table, rehashing from the stored hashes.
+ */
+static int index_resize(HashIndex *index, size_t capacity)
+{
+    IndexSlot *slots = (IndexSlot *)calloc(capacity, sizeof(IndexSlot));
+    if (slots == NULL)
+    {
+        perror("Failed to allocate memory for index");
+        return -1;
+    }
+    IndexSlot *old_slots = index->slots;
+    const size_t old_capacity = index->capacity;
+    index->slots = slots;
+    index->capacity = capacity;
+    index->count = 0;
+    for (size_t i = 0; i < old_capacity; ++i)
+    {
+        if (old_slots[i].pos != 0)
+            index_place(index, old_slots[i].hash, old_slots[i].pos);
+    }
+    free(old_slots);
+    return 0;
+}
+
+static int index_build(HashIndex *index, const ContactArray *array, size_t key_offset)
+{
+    memset(index, 0, sizeof(*index));
+    index->key_offset = key_offset;
+    if (array->size >= UINT32_MAX)
+    {
+        fprintf(stderr, "Error: Too many contacts to index.\n");
+        return -1;
+    }
+    size_t capacity = INDEX_MIN_CAPACITY;
+    while (capacity < array->live * 2) // Keep the load factor at or below 1/2
+    {
+        capacity *= 2;
+    }
+    if (index_resize(index, capacity) != 0)
+        return -1;
+    for (size_t pos = 0; pos < array->size; ++pos)
+    {
+        const Contact *c = &array->items[pos];
+        if (contact_is_live(c))
+            index_place(index, hash_string(index_key(index, c)), (uint32_t)(pos + 1));
+    }
+    return 0;
+}
+
+static void index_free(HashIndex *index)
+{
+    free(index->slots);
+    index->slots = NULL;
+    index->capacity = 0;
+    index->count = 0;
+}
+
+static int index_insert(HashIndex *index, const ContactArray *array, size_t pos)
+{
+    if (pos + 1 >= UINT32_MAX)
+        return -1;
+    if ((index->count + 1) * 4 > index->capacity * 3 && index_resize(index, index->capacity * 2) != 0)
+        return -1;
+    index_place(index, hash_string(index_key(index, &array->items[pos])), (uint32_t)(pos + 1));
+    return 0;
+}
+
+static int index_find(const HashIndex *index, const ContactArray *array, const char *key, PositionList *out)
+{
+    const uint32_t hash = hash_string(key);
+    const size_t mask = index->capacity - 1;
+    for (size_t i = hash & mask; index->slots[i].pos != 0; i = (i + 1) & mask)
+    {
+        const IndexSlot *slot = &index->slots[i];
+        if (slot->hash != hash)
+            continue;
+        const size_t pos = slot->pos - 1;
+        if (strcmp(index_key(index, &array->items[pos]), key) == 0 && positions_push(out, pos) != 0)
+            return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Removes the entry for the contact at `pos`, which must still be live.
+ */
+static void index_remove(HashIndex *index, const ContactArray *array, size_t pos)
+{
+    const uint32_t hash = hash_string(index_key(index, &array->items[pos]));
+    const size_t mask = index->capacity - 1;
+    size_t i = hash & mask;
+    while (index->slots[i].pos != pos + 1)
+    {
+        if (index->slots[i].pos == 0)
+            return; // Not indexed
+        i = (i + 1) & mask;
+    }
+    // Backward-shift deletion: pull later entries of the run into the hole
+    // unless their home slot lies cyclically within (hole, entry].
+    size_t j = i;
+    for (;;)
+    {
+        j = (j + 1) & mask;
+        if (index->slots[j].pos == 0)
+            break;
+        const size_t home = index->slots[j].hash & mask;
+        const int stays = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+        if (stays)
+            continue;
+        index->slots[i] = index->slots[j];
+        i = j;
+    }
+    index->slots[i].pos = 0;
+    index->count--;
+}
+
+static inline size_t *positions_data(const PositionList *list)
+{
+    return (size_t *)list->data;
+}
+
+static int positions_push(PositionList *list, size_t pos)
+{
+    if (vector_append(list, &pos) != 0)
+    {
+        perror("Failed to allocate memory for search results");
+        return -1;
+    }
+    return 0;
+}
+
+// --- Trigram Index Implementation ---
+
+static inline uint32_t fold_ascii(unsigned char c)
+{
+    return (c >= 'A' && c <= 'Z') ? (uint32_t)(c | 0x20) : c;
+}
+
+/**
+ * @brief Packs the case-folded trigram starting at `s` into 24 bits.
+ */
+static inline uint32_t trigram_at(const char *s)
+{
+    return fold_ascii((unsigned char)s[0]) << 16 | fold_ascii((unsigned char)s[1]) << 8 | fold_ascii((unsigned char)s[2]);
+}
+
+static int varint_append(PostingList *list, uint32_t value)
+{
+    if (list->capacity - list->length < 5)
+    {
+        const size_t capacity = list->capacity ? list->capacity * 2 : 16;
+        uint8_t *data = (uint8_t *)realloc(list->data, capacity);
+        if (data == NULL)
+            return -1;
+        list->data = data;
+        list->capacity = capacity;
+    }
+    while (value >= 0x80)
+    {
+        list->data[list->length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    list->data[list->length++] = (uint8_t)value;
+    return 0;
+}
+
+/**
+ * @brief Reads one varint at `*offset`, advancing it.
+ * @return 1 on success, 0 if the data is truncated or malformed.
+ */
+static inline int varint_read(const uint8_t *data, size_t length, size_t *offset, uint32_t *value)
+{
+    uint32_t result = 0;
+    for (int shift = 0; shift < 35 && *offset < length; shift += 7)
+    {
+        const uint8_t byte = data[(*offset)++];
+        result |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+        {
+            *value = result;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int posting_decode(const PostingView *view, PositionList *out)
+{
+    size_t offset = 0;
+    uint32_t pos = 0, gap;
+    while (offset < view->length)
+    {
+        if (!varint_read(view->data, view->length, &offset, &gap))
+            return -1;
+        pos += gap;
+        if (positions_push(out, pos) != 0)
+            return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Adds `pos` to a posting list, keeping it ascending and unique.
+ *
+ * Appends are O(1). Inserting below the largest position, which only
+ * happens when a binary book reuses a slot, re-encodes the list.
+ */
+static int posting_add(PostingList *list, uint32_t pos)
+{
+    if (list->count > 0 && pos <= list->last)
+    {
+        if (pos == list->last)
+            return 0;
+        PositionList decoded = VECTOR_INIT(size_t);
+        const PostingView view = {list->data, list->length, list->count};
+        if (posting_decode(&view, &decoded) != 0)
+        {
+            vector_free(&decoded);
+            return -1;
+        }
+        size_t at = 0;
+        while (at < decoded.length && positions_data(&decoded)[at] < pos)
+            at++;
+        int rc = 0;
+        if (at == decoded.length || positions_data(&decoded)[at] != pos)
+        {
+            list->length = 0;
+            list->count = 0;
+            uint32_t prev = 0;
+            for (size_t i = 0; rc == 0 && i <= decoded.length; ++i)
+            {
+                const uint32_t value = i < at ? (uint32_t)positions_data(&decoded)[i] : i == at ? pos : (uint32_t)positions_data(&decoded)[i - 1];
+                rc = varint_append(list, value - prev);
+                prev = value;
+                list->count++;
+            }
+        }
+        vector_free(&decoded);
+        return rc;
+    }
+    if (varint_append(list, list->count > 0 ? pos - list->last : pos) != 0)
+        return -1;
+    list->last = pos;
+    list->count++;
+    return 0;
+}
+
+static int trigram_index_resize(TrigramIndex *index, size_t capacity)
+{
+    uint32_t *keys = (uint32_t *)calloc(capacity, sizeof(uint32_t));
+    PostingList *lists = (PostingList *)calloc(capacity, sizeof(PostingList));
+    if (keys == NULL || lists == NULL)
+    {
+        perror("Failed to allocate memory for trigram index");
+        free(keys);
+        free(lists);
+        return -1;
+    }
+    const size_t mask = capacity - 1;
+    for (size_t i = 0; i < index->capacity; ++i)
+    {
+        if (index->keys[i] == 0)
+            continue;
+        size_t j = hash_string((const char *)&index->keys[i]) & mask;
+        while (keys[j] != 0)
+            j = (j + 1) & mask;
+        keys[j] = index->keys[i];
+        lists[j] = index->lists[i];
+    }
+    free(index->keys);
+    free(index->lists);
+    index->keys = keys;
+    index->lists = lists;
+    index->capacity = capacity;
+    return 0;
+}
+
+/**
+ * @brief Finds the slot for `trigram`, or the empty slot where it belongs.
+ */
+static size_t trigram_index_slot(const TrigramIndex *index, uint32_t trigram)
+{
+    const size_t mask = index->capacity - 1;
+    size_t i = hash_string((const char *)&trigram) & mask;
+    while (index->keys[i] != 0 && index->keys[i] != trigram)
+        i = (i + 1) & mask;
+    return i;
+}
+
+static int trigram_index_add_field(TrigramIndex *index, const char *field, uint32_t pos)
+{
+    const size_t len = strlen(field);
+    for (size_t k = 0; k + 3 <= len; ++k)
+    {
+        if ((index->count + 1) * 2 > index->capacity &&
+            trigram_index_resize(index, index->capacity ? index->capacity * 2 : TRIGRAM_MIN_CAPACITY) != 0)
+            return -1;
+        const uint32_t trigram = trigram_at(field + k);
+        const size_t slot = trigram_index_slot(index, trigram);
+        if (index->keys[slot] == 0)
+        {
+            index->keys[slot] = trigram;
+            index->count++;
+        }
+        if (posting_add(&index->lists[slot], pos) != 0)
+            return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Indexes every trigram of the contact's name and email under `pos`.
+ */
+static int trigram_index_add(TrigramIndex *index, const Contact *contact, size_t pos)
+{
+    if (pos >= UINT32_MAX)
+        return -1;
+    if (trigram_index_add_field(index, contact->name, (uint32_t)pos) != 0 ||
+        trigram_index_add_field(index, contact->email, (uint32_t)pos) != 0)
+        return -1;
+    return 0;
+}
+
+static void trigram_index_free(TrigramIndex *index)
+{
+    for (size_t i = 0; i < index->capacity; ++i)
+    {
+        free(index->lists[i].data);
+    }
+    free(index->keys);
+    free(index->lists);
+    memset(index, 0, sizeof(*index));
+}
+
+/**
+ * @brief Collects the distinct case-folded trigrams of a search term.
+ * @return The number of trigrams, or 0 if the term is too short.
+ */
+static size_t term_trigrams(const char *term, uint32_t **out)
+{
+    const size_t len = strlen(term);
+    if (len < 3)
+        return 0;
+    uint32_t *trigrams = (uint32_t *)malloc((len - 2) * sizeof(uint32_t));
+    if (trigrams == NULL)
+        return 0;
+    size_t count = 0;
+    for (size_t k = 0; k + 3 <= len; ++k)
+    {
+        const uint32_t t = trigram_at(term + k);
+        size_t i = 0;
+        while (i < count && trigrams[i] != t)
+            i++;
+        if (i == count)
+            trigrams[count++] = t;
+    }
+    *out = trigrams;
+    return count;
+}
+
+static int compare_views_by_count(const void *a, const void *b)
+{
+    const uint32_t ca = ((const PostingView *)a)->count, cb = ((const PostingView *)b)->count;
+    return (ca > cb) - (ca < cb);
+}
+
+/**
+ * @brief Intersects posting lists, shortest first, into ascending positions.
+ */
+static int postings_intersect(PostingView *views, size_t count, PositionList *out)
+{
+    qsort(views, count, sizeof(PostingView), compare_views_by_count);
+    PositionList result = VECTOR_INIT(size_t);
+    if (posting_decode(&views[0], &result) != 0)
+    {
+        vector_free(&result);
+        return -1;
+    }
+    for (size_t v = 1; v < count && result.length > 0; ++v)
+    {
+        size_t offset = 0, kept = 0, r = 0;
+        uint32_t pos = 0, gap;
+        while (r < result.length && offset < views[v].length)
+        {
+            if (!varint_read(views[v].data, views[v].length, &offset, &gap))
+            {
+                vector_free(&result);
+                return -1;
+            }
+            pos += gap;
+            while (r < result.length && positions_data(&result)[r] < pos)
+                r++;
+            if (r < result.length && positions_data(&result)[r] == pos)
+                positions_data(&result)[kept++] = positions_data(&result)[r++];
+        }
+        result.length = kept;
+    }
+    int rc = 0;
+    for (size_t i = 0; rc == 0 && i < result.length; ++i)
+        rc = positions_push(out, positions_data(&result)[i]);
+    vector_free(&result);
+    return rc;
+}
+
+static int trigram_index_candidates(const TrigramIndex *index, const char *term, PositionList *out)
+{
+    uint32_t *trigrams = NULL;
+    const size_t count = term_trigrams(term, &trigrams);
+    if (count == 0)
+        return 1;
+    PostingView *views = (PostingView *)malloc(count * sizeof(PostingView));
+    int rc = views == NULL ? -1 : 0;
+    for (size_t i = 0; rc == 0 && i < count; ++i)
+    {
+        if (index->capacity == 0)
+            break;
+        const size_t slot = trigram_index_slot(index, trigrams[i]);
+        if (index->keys[slot] == 0)
+            break; // A trigram no contact has: nothing can match.
+        views[i] = (PostingView){index->lists[slot].data, index->lists[slot].length, index->lists[slot].count};
+        if (i + 1 == count)
+            rc = postings_intersect(views, count, out);
+    }
+    free(views);
+    free(trigrams);
+    return rc;
+}
+
+static int compare_terms(const void *a, const void *b)
+{
+    const uint32_t ta = ((const TrigramTerm *)a)->trigram, tb = ((const TrigramTerm *)b)->trigram;
+    return (ta > tb) - (ta < tb);
+}
+
+/**
+ * @brief Writes the index as a TrigramHeader, sorted terms and postings,
+ * replacing `filename` atomically.
+ */
+static int trigram_index_write(const TrigramIndex *index, uint32_t generation, uint64_t indexed_records, const char *filename)
+{
+    TrigramTerm *terms = (TrigramTerm *)malloc((index->count ? index->count : 1) * sizeof(TrigramTerm));
+    if (terms == NULL)
+    {
+        perror("Failed to allocate memory for trigram index");
+        return -1;
+    }
+    size_t n = 0;
+    for (size_t i = 0; i < index->capacity; ++i)
+    {
+        if (index->keys[i] != 0)
+            terms[n++] = (TrigramTerm){index->keys[i], index->lists[i].count, i, index->lists[i].length};
+    }
+    qsort(terms, n, sizeof(TrigramTerm), compare_terms);
+
+    TrigramHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TRIGRAM_MAGIC, sizeof(header.magic));
+    header.version = TRIGRAM_VERSION;
+    header.generation = generation;
+    header.indexed_records = indexed_records;
+    header.term_count = n;
+    header.postings_offset = sizeof(header) + n * sizeof(TrigramTerm);
+
+    char tmp_filename[256];
+    snprintf(tmp_filename, sizeof(tmp_filename), "%s.tmp", filename);
+    FILE *file = fopen(tmp_filename, "wb");
+    if (file == NULL)
+    {
+        perror("Error creating trigram index");
+        free(terms);
+        return -1;
+    }
+    // The slot of each term doubles as the source of its postings until the
+    // offsets are assigned below.
+    uint64_t offset = 0;
+    fseek(file, (long)header.postings_offset, SEEK_SET);
+    for (size_t i = 0; i < n; ++i)
+    {
+        const PostingList *list = &index->lists[terms[i].offset];
+        fwrite(list->data, 1, list->length, file);
+        terms[i].offset = offset;
+        offset += list->length;
+    }
+    header.postings_size = offset;
+    header.dirty_offset = TRIGRAM_DIRTY_OFFSET(header.postings_offset + offset);
+    static const uint8_t padding[sizeof(uint32_t)] = {0};
+    fwrite(padding, 1, header.dirty_offset - header.postings_offset - offset, file);
+    rewind(file);
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(terms, sizeof(TrigramTerm), n, file);
+    free(terms);
+
+    int rc = 0;
+    if (fflush(file) != 0 || ferror(file) || fsync(fileno(file)) != 0)
+    {
+        perror("Error writing trigram index");
+        rc = -1;
+    }
+    if (fclose(file) != 0 && rc == 0)
+        rc = -1;
+    if (rc == 0 && rename(tmp_filename, filename) != 0)
+    {
+        perror("Error replacing trigram index");
+        rc = -1;
+    }
+    if (rc != 0)
+        unlink(tmp_filename);
+    return rc;
+}
+
+static int trigram_file_open(TrigramFile *file, const char *filename)
+{
+    const int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(TrigramHeader))
+    {
+        close(fd);
+        return -1;
+    }
+    file->length = (size_t)st.st_size;
+    void *base = mmap(NULL, file->length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+        return -1;
+    file->base = (unsigned char *)base;
+
+    const TrigramHeader *h = (const TrigramHeader *)file->base;
+    const int valid = memcmp(h->magic, TRIGRAM_MAGIC, sizeof(h->magic)) == 0 && h->version == TRIGRAM_VERSION &&
+                      h->term_count <= (file->length - sizeof(*h)) / sizeof(TrigramTerm) &&
+                      h->postings_offset == sizeof(*h) + h->term_count * sizeof(TrigramTerm) &&
+                      h->postings_size <= file->length - h->postings_offset &&
+                      h->dirty_offset == TRIGRAM_DIRTY_OFFSET(h->postings_offset + h->postings_size) &&
+                      h->dirty_offset <= file->length;
+    if (!valid)
+    {
+        fprintf(stderr, "Warning: Ignoring '%s', which is not a valid search index.\n", filename);
+        trigram_file_close(file);
+        return -1;
+    }
+    return 0;
+}
+
+static void trigram_file_close(TrigramFile *file)
+{
+    if (file->base != NULL)
+        munmap(file->base, file->length);
+    file->base = NULL;
+    file->length = 0;
+}
+
+static int trigram_file_candidates(const TrigramFile *file, const char *term, PositionList *out)
+{
+    const TrigramHeader *h = (const TrigramHeader *)file->base;
+    const TrigramTerm *terms = (const TrigramTerm *)(file->base + sizeof(*h));
+    const uint8_t *postings = file->base + h->postings_offset;
+    uint32_t *trigrams = NULL;
+    const size_t count = term_trigrams(term, &trigrams);
+    if (count == 0)
+        return 1;
+    PostingView *views = (PostingView *)malloc(count * sizeof(PostingView));
+    int rc = views == NULL ? -1 : 0;
+    for (size_t i = 0; rc == 0 && i < count; ++i)
+    {
+        size_t lo = 0, hi = h->term_count;
+        while (lo < hi)
+        {
+            const size_t mid = lo + (hi - lo) / 2;
+            if (terms[mid].trigram < trigrams[i])
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if (lo == h->term_count || terms[lo].trigram != trigrams[i])
+            break; // A trigram no contact has: nothing can match.
+        const TrigramTerm *t = &terms[lo];
+        if (t->offset > h->postings_size || t->length > h->postings_size - t->offset)
+        {
+            rc = -1;
+            break;
+        }
+        views[i] = (PostingView){postings + t->offset, t->length, t->count};
+        if (i + 1 == count)
+            rc = postings_intersect(views, count, out);
+    }
+    free(views);
+    free(trigrams);
+    return rc;
+}
+
+/**
+ * @brief Appends a reused slot to a persisted index's dirty list, if the
+ * index exists. The append is a single small write at the end of the file.
+ */
+static int index_file_mark_dirty(const char *filename, size_t slot)
+{
+    const int fd = open(filename, O_WRONLY | O_APPEND);
+    if (fd < 0)
+        return errno == ENOENT ? 0 : -1;
+    const uint32_t value = (uint32_t)slot;
+    const int rc = write(fd, &value, sizeof(value)) == (ssize_t)sizeof(value) ? 0 : -1;
+    close(fd);
+    return rc;
+}
+
+/**
+ * @brief Whether a persisted index of `book` must be rebuilt: the book was
+ * rewritten since, or too many contacts are missing from the index.
+ */
+static int index_file_stale(const BookFile *book, uint32_t generation, uint64_t indexed_records, size_t dirty_count)
+{
+    const BookHeader *h = book_header(book);
+    if (generation != h->generation || indexed_records > h->record_count)
+        return 1;
+    const uint64_t delta = dirty_count + (h->record_count - indexed_records);
+    const uint64_t max_delta = indexed_records / INDEX_FILE_DELTA_RATIO > INDEX_FILE_MIN_DELTA
+                                   ? indexed_records / INDEX_FILE_DELTA_RATIO
+                                   : INDEX_FILE_MIN_DELTA;
+    return delta > max_delta;
+}
+
+// --- Search Column Implementation ---
+
+static void fold_copy_scalar(char *dst, const char *src, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        dst[i] = (char)fold_ascii((unsigned char)src[i]);
+    }
+}
+
+static size_t fold_search_scalar(const char *hay, size_t n, const char *needle, size_t m, size_t from)
+{
+    for (size_t i = from; i + m <= n; ++i)
+    {
+        if (hay[i] == needle[0] && memcmp(hay + i + 1, needle + 1, m - 1) == 0)
+            return i;
+    }
+    return n;
+}
+
+#ifdef HAVE_SSE2
+// Adding 128 - 'A' maps 'A'..'Z' onto the 26 smallest signed bytes, so a
+// single signed compare finds the uppercase letters to fold.
+#define FOLD_SHIFT ((char)(128 - 'A'))
+#define FOLD_BOUND ((char)(-128 + 26))
+
+static void fold_copy_sse2(char *dst, const char *src, size_t n)
+{
+    const __m128i shift = _mm_set1_epi8(FOLD_SHIFT);
+    const __m128i bound = _mm_set1_epi8(FOLD_BOUND);
+    const __m128i bit = _mm_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        const __m128i x = _mm_loadu_si128((const __m128i *)(src + i));
+        const __m128i upper = _mm_cmplt_epi8(_mm_add_epi8(x, shift), bound);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_or_si128(x, _mm_and_si128(upper, bit)));
+    }
+    fold_copy_scalar(dst + i, src + i, n - i);
+}
+
+/**
+ * @brief Finds the first occurrence of a folded needle at or after `from`.
+ *
+ * Each step compares 16 positions against the needle's first and last
+ * bytes at once; only positions where both match are checked in full.
+ * @return The offset of the match, or `n` if there is none.
+ */
+static size_t fold_search_sse2(const char *hay, size_t n, const char *needle, size_t m, size_t from)
+{
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[m - 1]);
+    size_t i = from;
+    for (; i + m - 1 + 16 <= n; i += 16)
+    {
+        const __m128i block_first = _mm_loadu_si128((const __m128i *)(hay + i));
+        const __m128i block_last = _mm_loadu_si128((const __m128i *)(hay + i + m - 1));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last)));
+        while (mask != 0)
+        {
+            const unsigned bit = (unsigned)__builtin_ctz(mask);
+            if (m <= 2 || memcmp(hay + i + bit + 1, needle + 1, m - 2) == 0)
+                return i + bit;
+            mask &= mask - 1;
+        }
+    }
+    return fold_search_scalar(hay, n, needle, m, i);
+}
+#endif
+
+#ifdef HAVE_AVX2_DISPATCH
+__attribute__((target("avx2"))) static void fold_copy_avx2(char *dst, const char *src, size_t n)
+{
+    const __m256i shift = _mm256_set1_epi8(FOLD_SHIFT);
+    const __m256i bound = _mm256_set1_epi8(FOLD_BOUND);
+    const __m256i bit = _mm256_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        const __m256i x = _mm256_loadu_si256((const __m256i *)(src + i));
+        const __m256i upper = _mm256_cmpgt_epi8(bound, _mm256_add_epi8(x, shift));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_or_si256(x, _mm256_and_si256(upper, bit)));
+    }
+    fold_copy_sse2(dst + i, src + i, n - i);
+}
+
+__attribute__((target("avx2"))) static size_t fold_search_avx2(const char *hay, size_t n, const char *needle, size_t m, size_t from)
+{
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[m - 1]);
+    size_t i = from;
+    for (; i + m - 1 + 32 <= n; i += 32)
+    {
+        const __m256i block_first = _mm256_loadu_si256((const __m256i *)(hay + i));
+        const __m256i block_last = _mm256_loadu_si256((const __m256i *)(hay + i + m - 1));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(block_first, first), _mm256_cmpeq_epi8(block_last, last)));
+        while (mask != 0)
+        {
+            const unsigned bit = (unsigned)__builtin_ctz(mask);
+            if (m <= 2 || memcmp(hay + i + bit + 1, needle + 1, m - 2) == 0)
+                return i + bit;
+            mask &= mask - 1;
+        }
+    }
+    return fold_search_sse2(hay, n, needle, m, i);
+}
+#endif
+
+typedef void (*FoldCopyFn)(char *dst, const char *src, size_t n);
+typedef size_t (*FoldSearchFn)(const char *hay, size_t n, const char *needle, size_t m, size_t from);
+
+/**
+ * @brief Picks the widest kernels the CPU supports.
+ */
+static void fold_kernels(FoldCopyFn *copy, FoldSearchFn *search)
+{
+#if defined(HAVE_AVX2_DISPATCH)
+    if (__builtin_cpu_supports("avx2"))
+    {
+        *copy = fold_copy_avx2;
+        *search = fold_search_avx2;
+        return;
+    }
+#endif
+#if defined(HAVE_SSE2)
+    *copy = fold_copy_sse2;
+    *search = fold_search_sse2;
+#else
+    *copy = fold_copy_scalar;
+    *search = fold_search_scalar;
+#endif
+}
+
+static int column_reserve(SearchColumn *column, size_t bytes, size_t count)
+{
+    if (column->length + bytes > column->capacity)
+    {
+        size_t capacity = column->capacity ? column->capacity : 4096;
+        while (capacity < column->length + bytes)
+            capacity *= 2;
+        char *data = (char *)realloc(column->data, capacity);
+        if (data == NULL)
+            return -1;
+        column->data = data;
+        column->capacity = capacity;
+    }
+    if (count + 1 > column->starts_capacity)
+    {
+        size_t capacity = column->starts_capacity ? column->starts_capacity : 64;
+        while (capacity < count + 1)
+            capacity *= 2;
+        size_t *starts = (size_t *)realloc(column->starts, capacity * sizeof(size_t));
+        if (starts == NULL)
+            return -1;
+        column->starts = starts;
+        column->starts_capacity = capacity;
+    }
+    return 0;
+}
+
+/**
+ * @brief Appends the next contact; deleted contacts take up no bytes.
+ */
+static void column_put(SearchColumn *column, const Contact *contact, FoldCopyFn copy)
+{
+    if (contact_is_live(contact))
+    {
+        const char *fields[2] = {contact->name, contact->email};
+        for (int f = 0; f < 2; ++f)
+        {
+            const size_t len = strlen(fields[f]);
+            copy(column->data + column->length, fields[f], len);
+            column->length += len;
+            column->data[column->length++] = '\0';
+        }
+    }
+    column->starts[++column->count] = column->length;
+}
+
+static int column_build(SearchColumn *column, const ContactArray *array)
+{
+    FoldCopyFn copy;
+    FoldSearchFn search;
+    fold_kernels(&copy, &search);
+    size_t bytes = 0;
+    for (const Contact *c = array_begin(array); c != array_end(array); ++c)
+    {
+        if (contact_is_live(c))
+            bytes += strlen(c->name) + strlen(c->email) + 2;
+    }
+    memset(column, 0, sizeof(*column));
+    if (column_reserve(column, bytes, array->size) != 0)
+    {
+        perror("Failed to allocate memory for search column");
+        column_free(column);
+        return -1;
+    }
+    column->starts[0] = 0;
+    for (const Contact *c = array_begin(array); c != array_end(array); ++c)
+    {
+        column_put(column, c, copy);
+    }
+    return 0;
+}
+
+static int column_append(SearchColumn *column, const Contact *contact)
+{
+    FoldCopyFn copy;
+    FoldSearchFn search;
+    fold_kernels(&copy, &search);
+    if (column_reserve(column, strlen(contact->name) + strlen(contact->email) + 2, column->count + 1) != 0)
+        return -1;
+    column_put(column, contact, copy);
+    return 0;
+}
+
+static void column_free(SearchColumn *column)
+{
+    free(column->data);
+    free(column->starts);
+    memset(column, 0, sizeof(*column));
+}
+
+/**
+ * @brief Collects, in ascending order, the live contacts whose folded name
+ * or email contains the folded `term`.
+ */
+static int column_scan(const SearchColumn *column, const ContactArray *array, const char *term, PositionList *out)
+{
+    const size_t m = strlen(term);
+    if (m == 0)
+    {
+        // Like str_case_str, an empty term matches every contact.
+        for (size_t pos = 0; pos < column->count; ++pos)
+        {
+            if (contact_is_live(&array->items[pos]) && positions_push(out, pos) != 0)
+                return -1;
+        }
+        return 0;
+    }
+    char *needle = (char *)malloc(m);
+    if (needle == NULL)
+        return -1;
+    fold_copy_scalar(needle, term, m);
+
+    FoldCopyFn copy;
+    FoldSearchFn search;
+    fold_kernels(&copy, &search);
+    int rc = 0;
+    size_t offset = 0, pos = 0;
+    while (rc == 0 && (offset = search(column->data, column->length, needle, m, offset)) < column->length)
+    {
+        // Matches arrive in order, so the owning contact is found by walking
+        // forward; the walk is bounded by the length of the scan.
+        while (column->starts[pos + 1] <= offset)
+            pos++;
+        if (contact_is_live(&array->items[pos]))
+            rc = positions_push(out, pos);
+        offset = column->starts[pos + 1]; // One report per contact
+    }
+    free(needle);
+    return rc;
+}
+
+// --- Fuzzy Index Implementation ---
+
+static int fuzzy_grow(void **items, size_t *capacity, size_t needed, size_t item_size)
+{
+    if (needed <= *capacity)
+        return 0;
+    size_t new_capacity = *capacity ? *capacity * 2 : 256;
+    while (new_capacity < needed)
+        new_capacity *= 2;
+    void *grown = realloc(*items, new_capacity * item_size);
+    if (grown == NULL)
+    {
+        perror("Failed to allocate memory for fuzzy index");
+        return -1;
+    }
+    *items = grown;
+    *capacity = new_capacity;
+    return 0;
+}
+
+static int fuzzy_add_posting(FuzzyIndex *index, FuzzyNode *node, size_t pos)
+{
+    if (fuzzy_grow((void **)&index->postings, &index->posting_capacity, index->posting_count + 1, sizeof(FuzzyPosting)) != 0)
+        return -1;
+    index->postings[index->posting_count] = (FuzzyPosting){(uint32_t)pos, node->postings};
+    node->postings = (uint32_t)++index->posting_count;
+    return 0;
+}
+
+/**
+ * @brief Returns the lookup slot holding `key`, or the empty slot where it
+ * belongs.
+ */
+static size_t fuzzy_lookup_slot(const FuzzyIndex *index, const char *key)
+{
+    const size_t mask = index->lookup_capacity - 1;
+    size_t slot = hash_string(key) & mask;
+    while (index->lookup[slot] != 0 && strcmp(index->keys + index->nodes[index->lookup[slot] - 1].key, key) != 0)
+        slot = (slot + 1) & mask;
+    return slot;
+}
+
+static int fuzzy_lookup_grow(FuzzyIndex *index)
+{
+    const size_t capacity = index->lookup_capacity ? index->lookup_capacity * 2 : 1024;
+    uint32_t *old = index->lookup;
+    const size_t old_capacity = index->lookup_capacity;
+    index->lookup = (uint32_t *)calloc(capacity, sizeof(uint32_t));
+    if (index->lookup == NULL)
+    {
+        perror("Failed to allocate memory for fuzzy index");
+        index->lookup = old;
+        return -1;
+    }
+    index->lookup_capacity = capacity;
+    for (size_t i = 0; i < old_capacity; ++i)
+    {
+        if (old[i] != 0)
+            index->lookup[fuzzy_lookup_slot(index, index->keys + index->nodes[old[i] - 1].key)] = old[i];
+    }
+    free(old);
+    return 0;
+}
+
+static int fuzzy_new_node(FuzzyIndex *index, const char *key, size_t length, uint32_t edge, size_t pos)
+{
+    if ((index->node_count + 1) * 2 > index->lookup_capacity && fuzzy_lookup_grow(index) != 0)
+        return -1;
+    if (fuzzy_grow((void **)&index->nodes, &index->node_capacity, index->node_count + 1, sizeof(FuzzyNode)) != 0 ||
+        fuzzy_grow((void **)&index->keys, &index->keys_capacity, index->keys_length + length + 1, 1) != 0)
+        return -1;
+    FuzzyNode *node = &index->nodes[index->node_count];
+    *node = (FuzzyNode){index->keys_length, (uint32_t)length, edge, 0, 0, 0, 0};
+    memcpy(index->keys + index->keys_length, key, length);
+    index->keys[index->keys_length + length] = '\0';
+    index->lookup[fuzzy_lookup_slot(index, index->keys + node->key)] = (uint32_t)index->node_count + 1;
+    index->keys_length += length + 1;
+    index->node_count++;
+    return fuzzy_add_posting(index, node, pos);
+}
+
+/**
+ * @brief Files contact `pos` under `key`, creating the key's node if the
+ * tree does not hold it yet.
+ */
+static int fuzzy_insert(FuzzyIndex *index, const char *key, size_t length, size_t pos)
+{
+    if (index->node_count == 0)
+        return fuzzy_new_node(index, key, length, 0, pos);
+    const uint32_t known = index->lookup[fuzzy_lookup_slot(index, key)];
+    if (known != 0)
+        return fuzzy_add_posting(index, &index->nodes[known - 1], pos);
+    uint32_t current = 0;
+    for (;;)
+    {
+        FuzzyNode *node = &index->nodes[current];
+        const int distance = edit_distance(key, length, index->keys + node->key, node->key_length, INT_MAX);
+        if (distance == 0)
+            return fuzzy_add_posting(index, node, pos);
+        uint32_t child = node->first_child;
+        while (child != 0 && index->nodes[child].edge != (uint32_t)distance)
+            child = index->nodes[child].next_sibling;
+        if (child == 0)
+        {
+            const uint32_t created = (uint32_t)index->node_count;
+            if (fuzzy_new_node(index, key, length, (uint32_t)distance, pos) != 0)
+                return -1;
+            node = &index->nodes[current]; // The node array may have moved
+            index->nodes[created].next_sibling = node->first_child;
+            node->first_child = created;
+            if ((uint32_t)distance > node->max_edge)
+                node->max_edge = (uint32_t)distance;
+            return 0;
+        }
+        current = child;
+    }
+}
+
+/**
+ * @brief Whether `c` belongs to a word: an ASCII letter or digit, or any
+ * byte of a multi-byte UTF-8 character, so that accented letters stay
+ * inside their word.
+ */
+static inline int fuzzy_word_byte(unsigned char c)
+{
+    return c >= 0x80 || isalnum(c);
+}
+
+/**
+ * @brief Copies the next word at `*cursor` into `word`, case-folded and
+ * truncated to FUZZY_MAX_KEY, and advances the cursor. Words are split on
+ * whitespace and punctuation alike, so "Lee," is "lee" and "O'Brien-Smith"
+ * is "o", "brien" and "smith"; names and search terms both go through here.
+ * @return The length of the copied word, or 0 when there are no more words.
+ */
+static size_t fuzzy_next_word(const char **cursor, char *word)
+{
+    const char *p = *cursor;
+    while (*p != '\0' && !fuzzy_word_byte((unsigned char)*p))
+        p++;
+    size_t length = 0;
+    for (; fuzzy_word_byte((unsigned char)*p); ++p)
+    {
+        if (length < FUZZY_MAX_KEY)
+            word[length++] = (char)fold_ascii((unsigned char)*p);
+    }
+    word[length] = '\0';
+    *cursor = p;
+    return length;
+}
+
+/**
+ * @brief Indexes every live contact of `array`.
+ */
+static int fuzzy_index_build(FuzzyIndex *index, const ContactArray *array)
+{
+    for (size_t pos = 0; pos < array->size; ++pos)
+    {
+        if (contact_is_live(&array->items[pos]) && fuzzy_index_add(index, &array->items[pos], pos) != 0)
+        {
+            fuzzy_index_free(index);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Indexes a contact under each word of its name.
+ */
+static int fuzzy_index_add(FuzzyIndex *index, const Contact *contact, size_t pos)
+{
+    const char *cursor = contact->name;
+    char word[FUZZY_MAX_KEY + 1];
+    size_t length;
+    while ((length = fuzzy_next_word(&cursor, word)) > 0)
+    {
+        if (fuzzy_insert(index, word, length, pos) != 0)
+            return -1;
+    }
+    return 0;
+}
+
+static void fuzzy_index_free(FuzzyIndex *index)
+{
+    free(index->nodes);
+    free(index->postings);
+    free(index->keys);
+    free(index->lookup);
+    memset(index, 0, sizeof(*index));
+}
+
+/**
+ * @brief Collects every posting whose key is within `max_distance` edits of
+ * the folded `key`. A contact appears once per matching word.
+ */
+static int fuzzy_index_search(const FuzzyIndex *index, const char *key, size_t length, int max_distance, FuzzyMatchList *out)
+{
+    if (index->node_count == 0)
+        return 0;
+    uint32_t *stack = (uint32_t *)malloc(sizeof(uint32_t) * 64);
+    size_t depth = 0, stack_capacity = 64;
+    if (stack == NULL)
+        return -1;
+    stack[depth++] = 0;
+    int rc = 0;
+    while (depth > 0 && rc == 0)
+    {
+        const FuzzyNode *node = &index->nodes[stack[--depth]];
+        // Past this distance neither the node nor any of its children can match.
+        const int limit = max_distance + (int)node->max_edge;
+        const int distance = edit_distance(key, length, index->keys + node->key, node->key_length, limit);
+        if (distance > limit)
+            continue;
+        if (distance <= max_distance)
+        {
+            for (uint32_t p = node->postings; p != 0 && rc == 0; p = index->postings[p - 1].next)
+            {
+                if ((rc = fuzzy_grow((void **)&out->items, &out->capacity, out->size + 1, sizeof(FuzzyMatch))) == 0)
+                    out->items[out->size++] = (FuzzyMatch){index->postings[p - 1].pos, distance};
+            }
+        }
+        for (uint32_t child = node->first_child; child != 0 && rc == 0; child = index->nodes[child].next_sibling)
+        {
+            const int edge = (int)index->nodes[child].edge;
+            if (edge < distance - max_distance || edge > distance + max_distance)
+                continue;
+            if ((rc = fuzzy_grow((void **)&stack, &stack_capacity, depth + 1, sizeof(uint32_t))) == 0)
+                stack[depth++] = child;
+        }
+    }
+    free(stack);
+    return rc;
+}
+
+/**
+ * @brief Appends a match for each contact in [first, array->size) with a
+ * name word within `max_distance` edits of `word`, found by comparing
+ * against every word. This covers contacts a FuzzyIndex does not.
+ */
+static int fuzzy_scan(const ContactArray *array, size_t first, const char *word, size_t length, int max_distance,
+                      FuzzyMatchList *out)
+{
+    char name_word[FUZZY_MAX_KEY + 1];
+    size_t name_length;
+    for (size_t pos = first; pos < array->size; ++pos)
+    {
+        if (!contact_is_live(&array->items[pos]))
+            continue;
+        const char *cursor = array->items[pos].name;
+        int best = max_distance + 1;
+        while ((name_length = fuzzy_next_word(&cursor, name_word)) > 0)
+        {
+            const int distance = edit_distance(word, length, name_word, name_length, max_distance);
+            if (distance < best)
+                best = distance;
+        }
+        if (best <= max_distance)
+        {
+            if (fuzzy_grow((void **)&out->items, &out->capacity, out->size + 1, sizeof(FuzzyMatch)) != 0)
+                return -1;
+            out->items[out->size++] = (FuzzyMatch){pos, best};
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Computes the unrestricted Damerau-Levenshtein distance: the fewest
+ * insertions, deletions, substitutions and transpositions of adjacent
+ * characters turning one string into the other. Both lengths must be at
+ * most FUZZY_MAX_KEY.
+ *
+ * This is the Lowrance-Wagner algorithm; `last_row` records the last row in
+ * which each byte appeared in `a`, so a transposition can reach back past
+ * edits made in between. Once every path through the rows computed so far
+ * costs more than `limit`, it stops early.
+ * @return The distance, or some value above `limit` if it exceeds `limit`.
+ */
+static int edit_distance(const char *a, size_t m, const char *b, size_t n, int limit)
+{
+    int d[FUZZY_MAX_KEY + 2][FUZZY_MAX_KEY + 2];
+    int last_row[256]; // Only the entries for bytes of `a` and `b` are read
+    for (size_t i = 0; i < m; ++i)
+        last_row[(unsigned char)a[i]] = 0;
+    for (size_t j = 0; j < n; ++j)
+        last_row[(unsigned char)b[j]] = 0;
+    const int infinity = (int)(m + n);
+    d[0][0] = infinity;
+    for (size_t i = 0; i <= m; ++i)
+    {
+        d[i + 1][0] = infinity;
+        d[i + 1][1] = (int)i;
+    }
+    for (size_t j = 0; j <= n; ++j)
+    {
+        d[0][j + 1] = infinity;
+        d[1][j + 1] = (int)j;
+    }
+    // A path reaching a later row passes through this row, or jumps over it
+    // with a transposition from an earlier row at a cost of at least one
+    // per row skipped; `skipped_min` bounds the latter.
+    int previous_min = 0;
+    int skipped_min = INT_MAX - 1;
+    for (size_t i = 1; i <= m; ++i)
+    {
+        int row_min = (int)i;
+        size_t last_col = 0; // The last column in this row where a[i-1] matched
+        for (size_t j = 1; j <= n; ++j)
+        {
+            const size_t k = (size_t)last_row[(unsigned char)b[j - 1]];
+            const size_t l = last_col;
+            int cost = 1;
+            if (a[i - 1] == b[j - 1])
+            {
+                cost = 0;
+                last_col = j;
+            }
+            int best = d[i][j] + cost;
+            if (d[i + 1][j] + 1 < best)
+                best = d[i + 1][j] + 1;
+            if (d[i][j + 1] + 1 < best)
+                best = d[i][j + 1] + 1;
+            const int transpose = d[k][l] + (int)(i - k - 1) + 1 + (int)(j - l - 1);
+            if (transpose < best)
+                best = transpose;
+            d[i + 1][j + 1] = best;
+            if (best < row_min)
+                row_min = best;
+        }
+        last_row[(unsigned char)a[i - 1]] = (int)i;
+        skipped_min = (skipped_min < previous_min ? skipped_min : previous_min) + 1;
+        previous_min = row_min;
+        if (row_min > limit && skipped_min > limit)
+            return limit + 1;
+    }
+    return d[m + 1][n + 1];
+}
+
+// --- Name Index Implementation ---
+
+static int compare_name_entries(const void *a, const void *b)
+{
+    const NameEntry *x = (const NameEntry *)a, *y = (const NameEntry *)b;
+    const int order = strcmp(x->key, y->key);
+    if (order != 0)
+        return order;
+    return compare_ties(x->pos, y->pos);
+}
+
+static char *name_index_key(NameIndex *index, const char *name)
+{
+    char *key = arena_strdup(&index->keys, name);
+    if (key != NULL)
+    {
+        for (char *p = key; *p != '\0'; ++p)
+            *p = (char)fold_ascii((unsigned char)*p);
+    }
+    return key;
+}
+
+/**
+ * @brief Returns the first entry whose key is not less than `key`.
+ */
+static size_t name_index_lower_bound(const NameIndex *index, const char *key)
+{
+    size_t lo = 0, hi = index->count;
+    while (lo < hi)
+    {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (strcmp(index->entries[mid].key, key) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static int name_index_build(NameIndex *index, const ContactArray *array)
+{
+    memset(index, 0, sizeof(*index));
+    index->entries = (NameEntry *)malloc((array->live ? array->live : 1) * sizeof(NameEntry));
+    if (index->entries == NULL)
+    {
+        perror("Failed to allocate memory for name index");
+        return -1;
+    }
+    index->capacity = array->live ? array->live : 1;
+    for (size_t pos = 0; pos < array->size; ++pos)
+    {
+        if (!contact_is_live(&array->items[pos]))
+            continue;
+        char *key = name_index_key(index, array->items[pos].name);
+        if (key == NULL)
+        {
+            perror("Failed to allocate memory for name index");
+            name_index_free(index);
+            return -1;
+        }
+        index->entries[index->count++] = (NameEntry){key, pos};
+    }
+    qsort(index->entries, index->count, sizeof(NameEntry), compare_name_entries);
+    return 0;
+}
+
+static int name_index_insert(NameIndex *index, const Contact *contact, size_t pos)
+{
+    if (index->count == index->capacity)
+    {
+        const size_t capacity = index->capacity * 2;
+        NameEntry *entries = (NameEntry *)realloc(index->entries, capacity * sizeof(NameEntry));
+        if (entries == NULL)
+            return -1;
+        index->entries = entries;
+        index->capacity = capacity;
+    }
+    const NameEntry entry = {name_index_key(index, contact->name), pos};
+    if (entry.key == NULL)
+        return -1;
+    size_t at = name_index_lower_bound(index, entry.key);
+    while (at < index->count && compare_name_entries(&index->entries[at], &entry) < 0)
+        at++;
+    memmove(&index->entries[at + 1], &index->entries[at], (index->count - at) * sizeof(NameEntry));
+    index->entries[at] = entry;
+    index->count++;
+    return 0;
+}
+
+static void name_index_free(NameIndex *index)
+{
+    free(index->entries);
+    arena_release(&index->keys);
+    memset(index, 0, sizeof(*index));
+}
+
+static int name_index_prefix(const NameIndex *index, const ContactArray *array, const char *prefix, size_t limit, PositionList *out)
+{
+    const size_t length = strlen(prefix);
+    char *key = (char *)malloc(length + 1);
+    if (key == NULL)
+        return -1;
+    for (size_t i = 0; i <= length; ++i)
+        key[i] = (char)fold_ascii((unsigned char)prefix[i]);
+    int rc = 0;
+    for (size_t i = name_index_lower_bound(index, key);
+         i < index->count && out->length < limit && strncmp(index->entries[i].key, key, length) == 0 && rc == 0; ++i)
+    {
+        if (contact_is_live(&array->items[index->entries[i].pos]))
+            rc = positions_push(out, index->entries[i].pos);
+    }
+    free(key);
+    return rc;
+}
+
+// --- Sorted Order Implementation ---
+
+static inline const char *order_key(const Contact *contact, OrderKey key)
+{
+    return key == ORDER_BY_NAME ? contact->name : contact->email;
+}
+
+/**
+ * @brief Compares two strings ignoring ASCII case.
+ */
+static int compare_folded(const char *a, const char *b)
+{
+    const unsigned char *x = (const unsigned char *)a, *y = (const unsigned char *)b;
+    while (*x != '\0' && fold_ascii(*x) == fold_ascii(*y))
+    {
+        x++;
+        y++;
+    }
+    return (int)fold_ascii(*x) - (int)fold_ascii(*y);
+}
+
+/**
+ * @brief Orders two positions by their key ignoring case, then by the exact
+ * key, then by position, so that every order is total and stable.
+ */
+static int order_compare(const ContactArray *array, OrderKey key, size_t a, size_t b)
+{
+    const char *x = order_key(&array->items[a], key), *y = order_key(&array->items[b], key);
+    int order = compare_folded(x, y);
+    if (order == 0)
+        order = strcmp(x, y);
+    if (order == 0)
+        order = compare_ties(a, b);
+    return order;
+}
+
+/**
+ * @brief Packs the case-folded bytes of `str` from `from` (at most its
+ * length) into a big-endian word, padded with zeros.
+ */
+static uint64_t order_prefix(const char *str, size_t from, size_t *next)
+{
+    uint64_t prefix = 0;
+    int i = 0;
+    for (; i < 8 && str[from + i] != '\0'; ++i)
+        prefix = prefix << 8 | fold_ascii((unsigned char)str[from + i]);
+    *next = from + i;
+    return i == 0 ? 0 : prefix << (8 * (8 - i));
+}
+
+static _Thread_local const ContactArray *order_contacts; // Context for compare_order_entries
+static _Thread_local OrderKey order_by;
+
+static int compare_order_entries(const void *a, const void *b)
+{
+    const OrderEntry *x = (const OrderEntry *)a, *y = (const OrderEntry *)b;
+    for (int i = 0; i < 2; ++i)
+    {
+        if (x->prefix[i] != y->prefix[i])
+            return x->prefix[i] < y->prefix[i] ? -1 : 1;
+    }
+    return order_compare(order_contacts, order_by, x->pos, y->pos);
+}
+
+/**
+ * @brief Sorts `positions` in place by the contacts' `key`.
+ */
+static int order_sort(PositionList *positions, const ContactArray *array, OrderKey key)
+{
+    if (positions->length < 2)
+        return 0;
+    OrderEntry *entries = (OrderEntry *)malloc(positions->length * sizeof(OrderEntry));
+    if (entries == NULL)
+    {
+        perror("Failed to allocate memory for sorting");
+        return -1;
+    }
+    for (size_t i = 0; i < positions->length; ++i)
+    {
+        const char *str = order_key(&array->items[positions_data(positions)[i]], key);
+        size_t next;
+        entries[i].prefix[0] = order_prefix(str, 0, &next);
+        entries[i].prefix[1] = order_prefix(str, next, &next);
+        entries[i].pos = positions_data(positions)[i];
+    }
+    order_contacts = array;
+    order_by = key;
+    qsort(entries, positions->length, sizeof(OrderEntry), compare_order_entries);
+    for (size_t i = 0; i < positions->length; ++i)
+        positions_data(positions)[i] = entries[i].pos;
+    free(entries);
+    return 0;
+}
+
+/**
+ * @brief Collects the positions of all live contacts sorted by `key`.
+ */
+static int order_build(PositionList *out, const ContactArray *array, OrderKey key)
+{
+    vector_init(out, sizeof(size_t));
+    if (vector_reserve(out, array->live) != 0)
     {
-        if (save_contacts_to_csv(contact_list, CSV_FILENAME) != 0)
+        perror("Failed to allocate memory for sorting");
+        return -1;
+    }
+    for (size_t pos = 0; pos < array->size; ++pos)
+    {
+        if (contact_is_live(&array->items[pos]))
+            positions_data(out)[out->length++] = pos;
+    }
+    return order_sort(out, array, key);
+}
+
+/**
+ * @brief Writes the orders as an OrderHeader and their slots, replacing
+ * `filename` atomically.
+ */
+static int order_file_write(const PositionList orders[ORDER_KEYS], uint32_t generation, uint64_t indexed_records, const char *filename)
+{
+    OrderHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ORDER_MAGIC, sizeof(header.magic));
+    header.version = ORDER_VERSION;
+    header.generation = generation;
+    header.indexed_records = indexed_records;
+    header.count = orders[0].length;
+    header.dirty_offset = sizeof(header) + ORDER_KEYS * header.count * sizeof(uint32_t);
+
+    char tmp_filename[256];
+    snprintf(tmp_filename, sizeof(tmp_filename), "%s.tmp", filename);
+    FILE *file = fopen(tmp_filename, "wb");
+    if (file == NULL)
+    {
+        perror("Error creating sort index");
+        return -1;
+    }
+    fwrite(&header, sizeof(header), 1, file);
+    uint32_t chunk[4096];
+    for (int k = 0; k < ORDER_KEYS; ++k)
+    {
+        for (size_t i = 0; i < orders[k].length; i += sizeof(chunk) / sizeof(chunk[0]))
+        {
+            size_t n = orders[k].length - i < sizeof(chunk) / sizeof(chunk[0]) ? orders[k].length - i : sizeof(chunk) / sizeof(chunk[0]);
+            for (size_t c = 0; c < n; ++c)
+                chunk[c] = (uint32_t)positions_data(&orders[k])[i + c];
+            fwrite(chunk, sizeof(uint32_t), n, file);
+        }
+    }
+
+    int rc = 0;
+    if (fflush(file) != 0 || ferror(file) || fsync(fileno(file)) != 0)
+    {
+        perror("Error writing sort index");
+        rc = -1;
+    }
+    if (fclose(file) != 0 && rc == 0)
+        rc = -1;
+    if (rc == 0 && rename(tmp_filename, filename) != 0)
+    {
+        perror("Error replacing sort index");
+        rc = -1;
+    }
+    if (rc != 0)
+        unlink(tmp_filename);
+    return rc;
+}
+
+static int order_file_open(OrderFile *file, const char *filename)
+{
+    const int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(OrderHeader))
+    {
+        close(fd);
+        return -1;
+    }
+    file->length = (size_t)st.st_size;
+    void *base = mmap(NULL, file->length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+        return -1;
+    file->base = (unsigned char *)base;
+
+    const OrderHeader *h = (const OrderHeader *)file->base;
+    const int valid = memcmp(h->magic, ORDER_MAGIC, sizeof(h->magic)) == 0 && h->version == ORDER_VERSION &&
+                      h->count <= (file->length - sizeof(*h)) / (ORDER_KEYS * sizeof(uint32_t)) &&
+                      h->dirty_offset == sizeof(*h) + ORDER_KEYS * h->count * sizeof(uint32_t);
+    if (!valid)
+    {
+        fprintf(stderr, "Warning: Ignoring '%s', which is not a valid sort index.\n", filename);
+        order_file_close(file);
+        return -1;
+    }
+    return 0;
+}
+
+static void order_file_close(OrderFile *file)
+{
+    if (file->base != NULL)
+        munmap(file->base, file->length);
+    file->base = NULL;
+    file->length = 0;
+}
+
+// --- Daemon Implementation ---
+
+/**
+ * @brief Returns how many changes a snapshot of `live` contacts takes in
+ * place. Rebuilding costs O(n) and the contacts added since are scanned,
+ * so scaling the limit with the square root of n keeps both near O(sqrt n)
+ * per change.
+ */
+static size_t serve_max_changes(size_t live)
+{
+    size_t root = 1;
+    while (root * root < live)
+        root++;
+    const size_t changes = root * SERVE_CHANGES_PER_ROOT;
+    return changes > SERVE_MIN_CHANGES ? changes : SERVE_MIN_CHANGES;
+}
+
+static void serve_snapshot_free(ServeSnapshot *snapshot)
+{
+    column_free(&snapshot->column);
+    index_free(&snapshot->by_name);
+    index_free(&snapshot->by_email);
+    fuzzy_index_free(&snapshot->fuzzy);
+    name_index_free(&snapshot->names);
+    for (int k = 0; k < ORDER_KEYS; ++k)
+        vector_free(&snapshot->orders[k]);
+    pthread_mutex_destroy(&snapshot->build_lock);
+    arena_release(&snapshot->contacts.strings);
+    free(snapshot->contacts.items);
+    free(snapshot->strings);
+    free(snapshot->origins);
+    free(snapshot->deleted);
+    free(snapshot->versions);
+    free(snapshot);
+}
+
+/**
+ * @brief Copies the live contacts into a new snapshot with its own strings,
+ * search column and name and email indexes. The caller holds the server's
+ * write lock.
+ * @return The snapshot, at version 0, or NULL on error.
+ */
+static ServeSnapshot *serve_snapshot_create(const ContactArray *array)
+{
+    ServeSnapshot *snapshot = (ServeSnapshot *)calloc(1, sizeof(ServeSnapshot));
+    if (snapshot == NULL)
+        return NULL;
+    pthread_mutex_init(&snapshot->build_lock, NULL);
+    size_t bytes = 0;
+    for (const Contact *c = array_begin(array); c != array_end(array); ++c)
+    {
+        if (contact_is_live(c))
+            bytes += strlen(c->name) + strlen(c->phone) + strlen(c->email) + 3;
+    }
+    snapshot->max_changes = serve_max_changes(array->live);
+    const size_t capacity = array->live + snapshot->max_changes;
+    snapshot->contacts.items = (Contact *)malloc(capacity * sizeof(Contact));
+    snapshot->contacts.capacity = capacity;
+    snapshot->strings = (char *)malloc(bytes ? bytes : 1);
+    snapshot->origins = (size_t *)malloc(capacity * sizeof(size_t));
+    snapshot->deleted = (atomic_uint *)calloc(capacity, sizeof(atomic_uint));
+    snapshot->versions = (ServeVersion *)malloc((snapshot->max_changes + 1) * sizeof(ServeVersion));
+    if (snapshot->contacts.items == NULL || snapshot->strings == NULL || snapshot->origins == NULL ||
+        snapshot->deleted == NULL || snapshot->versions == NULL)
+    {
+        serve_snapshot_free(snapshot);
+        return NULL;
+    }
+    char *p = snapshot->strings;
+    for (const Contact *c = array_begin(array); c != array_end(array); ++c)
+    {
+        if (!contact_is_live(c))
+            continue;
+        snapshot->origins[snapshot->contacts.size] = (size_t)(c - array->items);
+        Contact *copy = &snapshot->contacts.items[snapshot->contacts.size++];
+        const char *fields[3] = {c->name, c->phone, c->email};
+        char **copies[3] = {&copy->name, &copy->phone, &copy->email};
+        for (int f = 0; f < 3; ++f)
+        {
+            const size_t len = strlen(fields[f]) + 1;
+            memcpy(p, fields[f], len);
+            *copies[f] = p;
+            p += len;
+        }
+    }
+    snapshot->contacts.live = snapshot->contacts.size;
+    snapshot->base_count = snapshot->contacts.size;
+    snapshot->versions[0] = (ServeVersion){snapshot->contacts.size, snapshot->contacts.live};
+    atomic_init(&snapshot->version, 0);
+    atomic_init(&snapshot->built, 0);
+    snapshot->column_built = column_build(&snapshot->column, &snapshot->contacts) == 0;
+    snapshot->indexed = index_build(&snapshot->by_name, &snapshot->contacts, offsetof(Contact, name)) == 0 &&
+                        index_build(&snapshot->by_email, &snapshot->contacts, offsetof(Contact, email)) == 0;
+    return snapshot;
+}
+
+/**
+ * @brief Whether the contact at `pos`, below the version's count, was not
+ * deleted by `version`.
+ */
+static inline int serve_visible(const ServeSnapshot *snapshot, unsigned version, size_t pos)
+{
+    const unsigned deleted = atomic_load_explicit(&snapshot->deleted[pos], memory_order_relaxed);
+    return deleted == 0 || deleted > version;
+}
+
+/**
+ * @brief Returns the snapshot position of the undeleted contact at book
+ * position `origin`, among the first `count`, or SIZE_MAX. Contacts added
+ * since the snapshot was built are not in book order, as a binary book
+ * reuses the slots of deleted contacts, so they are searched one by one.
+ */
+static size_t serve_find_origin(const ServeSnapshot *snapshot, size_t count, size_t origin)
+{
+    size_t low = 0, high = snapshot->base_count;
+    while (low < high)
+    {
+        const size_t mid = low + (high - low) / 2;
+        if (snapshot->origins[mid] < origin)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    if (low < snapshot->base_count && snapshot->origins[low] == origin &&
+        atomic_load_explicit(&snapshot->deleted[low], memory_order_relaxed) == 0)
+        return low;
+    for (size_t pos = snapshot->base_count; pos < count; ++pos)
+    {
+        if (snapshot->origins[pos] == origin && atomic_load_explicit(&snapshot->deleted[pos], memory_order_relaxed) == 0)
+            return pos;
+    }
+    return SIZE_MAX;
+}
+
+/**
+ * @brief Publishes the book's recorded changes as the snapshot's next
+ * version. Nothing a reader can see is modified: adds go past the current
+ * count and deletes are stamped with the new version, which readers only
+ * pin once it is complete. The caller holds the write lock.
+ * @return 0 on success, 1 if the snapshot must be rebuilt instead.
+ */
+static int serve_apply(ServeSnapshot *snapshot, const ContactBook *book)
+{
+    const size_t changes = book->changes->length;
+    if (book->changes_lost || snapshot->changes + changes > snapshot->max_changes)
+        return 1;
+    if (changes == 0)
+        return 0;
+    const unsigned version = atomic_load_explicit(&snapshot->version, memory_order_relaxed);
+    ServeVersion next = snapshot->versions[version];
+    const BookChange *change = (const BookChange *)book->changes->data;
+    for (size_t i = 0; i < changes; ++i)
+    {
+        const size_t pos = change[i].pos;
+        if (!change[i].added)
+        {
+            const size_t at = serve_find_origin(snapshot, next.count, pos);
+            if (at == SIZE_MAX)
+                return 1;
+            atomic_store_explicit(&snapshot->deleted[at], version + 1, memory_order_relaxed);
+            next.live--;
+            continue;
+        }
+        const Contact *c = &book->contacts->items[pos];
+        if (!contact_is_live(c))
+            return 1; // Deleted again since: rebuilding is simpler than matching it up
+        if (contact_init(&snapshot->contacts.items[next.count], &snapshot->contacts.strings, c->name, c->phone, c->email) != 0)
+            return 1;
+        snapshot->origins[next.count++] = pos;
+        next.live++;
+    }
+    snapshot->changes += changes;
+    snapshot->versions[version + 1] = next;
+    atomic_store_explicit(&snapshot->version, version + 1, memory_order_release);
+    return 0;
+}
+
+/**
+ * @brief Enters a read-side critical section and returns the current
+ * snapshot, without taking a lock.
+ *
+ * A reader counts itself under the epoch it saw and checks that the epoch
+ * did not move meanwhile; serve_retire advances the epoch before it waits
+ * for that count to drain.
+ * @return The snapshot, or NULL once the daemon is stopping. Either way the
+ * caller passes *slot to serve_unpin.
+ */
+static ServeSnapshot *serve_pin(Server *server, unsigned *slot)
+{
+    for (;;)
+    {
+        const unsigned epoch = atomic_load(&server->epoch);
+        *slot = epoch & 1;
+        atomic_fetch_add(&server->readers[*slot], 1);
+        if (atomic_load(&server->epoch) == epoch)
+            return atomic_load(&server->current);
+        atomic_fetch_sub(&server->readers[*slot], 1); // A retirement began; retry under its epoch
+    }
+}
+
+static void serve_unpin(Server *server, unsigned slot)
+{
+    atomic_fetch_sub(&server->readers[slot], 1);
+}
+
+/**
+ * @brief Frees a snapshot that is no longer current, after a grace period:
+ * readers that pin from now on count under the next epoch and cannot see
+ * it, so only the old epoch's readers are waited for. The caller holds the
+ * write lock.
+ */
+static void serve_retire(Server *server, ServeSnapshot *snapshot)
+{
+    const unsigned epoch = atomic_fetch_add(&server->epoch, 1);
+    while (atomic_load(&server->readers[epoch & 1]) != 0)
+        sched_yield();
+    serve_snapshot_free(snapshot);
+}
+
+/**
+ * @brief Brings the snapshot up to date with the book: the recorded changes
+ * become its next version, or, when they cannot, a rebuilt snapshot
+ * replaces it. The caller holds the write lock.
+ */
+static int serve_publish(Server *server)
+{
+    ContactBook *book = server->book;
+    ServeSnapshot *current = atomic_load(&server->current);
+    int rc = 0;
+    if (current == NULL || serve_apply(current, book) != 0)
+    {
+        ServeSnapshot *snapshot = serve_snapshot_create(book->contacts);
+        if (snapshot == NULL)
+        {
+            perror("Failed to allocate memory for a snapshot");
+            rc = -1;
+        }
+        else
+        {
+            atomic_store(&server->current, snapshot);
+            if (current != NULL)
+                serve_retire(server, current);
+        }
+    }
+    vector_clear(&server->changes);
+    book->changes_lost = rc != 0; // A failed rebuild is retried on the next change
+    return rc;
+}
+
+/**
+ * @brief Frees the snapshot, once no reader holds it, and stops the book
+ * recording changes. Readers that come later find no snapshot. The caller
+ * holds the write lock, or no other thread runs.
+ */
+static void serve_close(Server *server)
+{
+    ServeSnapshot *snapshot = atomic_exchange(&server->current, NULL);
+    if (snapshot != NULL)
+        serve_retire(server, snapshot);
+    server->book->changes = NULL;
+    vector_free(&server->changes);
+}
+
+/**
+ * @brief Makes sure the indexes named by `which`, SERVE_* flags, are built
+ * over the contacts the snapshot was built with. Readers asking at once
+ * wait on the snapshot's build lock for one of them to build each index;
+ * the write lock is never taken, so writes and other reads go on.
+ * @return 0 once they can be used, -1 if one could not be built.
+ */
+static int serve_require(Server *server, ServeSnapshot *snapshot, int which)
+{
+    atomic_fetch_or(&server->wanted, which);
+    if ((atomic_load_explicit(&snapshot->built, memory_order_acquire) & which) == which)
+        return 0;
+    pthread_mutex_lock(&snapshot->build_lock);
+    ContactArray base; // The contacts the snapshot was built with, none deleted
+    memset(&base, 0, sizeof(base));
+    base.items = snapshot->contacts.items;
+    base.size = base.capacity = base.live = snapshot->base_count;
+    int built = atomic_load_explicit(&snapshot->built, memory_order_relaxed);
+    const int missing = which & ~built;
+    if ((missing & SERVE_FUZZY) && fuzzy_index_build(&snapshot->fuzzy, &base) == 0)
+        built |= SERVE_FUZZY;
+    if ((missing & SERVE_NAMES) && name_index_build(&snapshot->names, &base) == 0)
+        built |= SERVE_NAMES;
+    if (missing & SERVE_ORDERS)
+    {
+        int k = 0;
+        while (k < ORDER_KEYS && order_build(&snapshot->orders[k], &base, (OrderKey)k) == 0)
+            k++;
+        if (k == ORDER_KEYS)
+        {
+            built |= SERVE_ORDERS;
+        }
+        else
         {
-            fprintf(stderr, "Error: Failed to save changes to '%s'.\n", CSV_FILENAME);
+            for (int i = 0; i <= k; ++i)
+                vector_free(&snapshot->orders[i]);
         }
     }
+    atomic_store_explicit(&snapshot->built, built, memory_order_release);
+    pthread_mutex_unlock(&snapshot->build_lock);
+    return (built & which) == which ? 0 : -1;
+}
 
-    list_destroy(contact_list, contact_free);
-    return EXIT_SUCCESS;
+/**
+ * @brief Builds the indexes readers have asked for on the current snapshot,
+ * if it is new, so that they need not wait for them. Called between
+ * requests, after the response has gone out.
+ */
+static void serve_prepare(Server *server)
+{
+    const int wanted = atomic_load(&server->wanted);
+    if (wanted == 0)
+        return;
+    unsigned slot;
+    ServeSnapshot *snapshot = serve_pin(server, &slot);
+    if (snapshot != NULL)
+        serve_require(server, snapshot, wanted);
+    serve_unpin(server, slot);
 }
 
-// --- Command Handling Implementation ---
+/**
+ * @brief Appends the positions in [first, count) that `version` can see.
+ */
+static int serve_collect(const ServeSnapshot *snapshot, unsigned version, size_t first, size_t count, PositionList *out)
+{
+    for (size_t pos = first; pos < count; ++pos)
+    {
+        if (serve_visible(snapshot, version, pos) && positions_push(out, pos) != 0)
+            return -1;
+    }
+    return 0;
+}
 
-static Command parse_command(const char *cmd_str)
+static int compare_origin_pairs(const void *a, const void *b)
 {
-    if (strcmp(cmd_str, "add") == 0)
-        return CMD_ADD;
-    if (strcmp(cmd_str, "list") == 0)
-        return CMD_LIST;
-    if (strcmp(cmd_str, "find") == 0)
-        return CMD_FIND;
-    if (strcmp(cmd_str, "delete") == 0)
-        return CMD_DELETE;
-    return CMD_UNKNOWN;
+    const size_t x = *(const size_t *)a, y = *(const size_t *)b;
+    return (x > y) - (x < y);
 }
 
-static void print_usage(const char *prog_name)
+/**
+ * @brief Puts the positions in `list` in book order, which the contacts
+ * added to a binary book since the snapshot was built need not follow.
+ */
+static int serve_sort(const ServeSnapshot *snapshot, PositionList *list)
 {
-    fprintf(stderr, "Contact Book - A simple command-line contact manager.\n\n");
-    fprintf(stderr, "Usage: %s <command> [options]\n\n", prog_name);
-    fprintf(stderr, "Commands:\n");
-    fprintf(stderr, "  add <name> <phone> <email>    Add a new contact.\n");
-    fprintf(stderr, "  list                            List all contacts.\n");
-    fprintf(stderr, "  find <term>                     Find contacts by case-insensitive name or email.\n");
-    fprintf(stderr, "  delete <name>                   Delete a contact by exact name match.\n\n");
-    fprintf(stderr, "Data is stored in '%s' in the current directory.\n", CSV_FILENAME);
+    size_t *positions = positions_data(list);
+    size_t sorted = 1;
+    while (sorted < list->length && snapshot->origins[positions[sorted - 1]] < snapshot->origins[positions[sorted]])
+        sorted++;
+    if (sorted >= list->length)
+        return 0; // Already in order, as always for CSV books
+    size_t (*pairs)[2] = malloc(list->length * sizeof(*pairs)); // Origin, then position
+    if (pairs == NULL)
+        return -1;
+    for (size_t i = 0; i < list->length; ++i)
+    {
+        pairs[i][0] = snapshot->origins[positions[i]];
+        pairs[i][1] = positions[i];
+    }
+    qsort(pairs, list->length, sizeof(*pairs), compare_origin_pairs);
+    for (size_t i = 0; i < list->length; ++i)
+        positions[i] = pairs[i][1];
+    free(pairs);
+    return 0;
 }
 
-static void handle_add(LinkedList *list, int argc, char *argv[])
+/**
+ * @brief Collects the positions of contacts offset+1..offset+limit of
+ * `version`, in book order: those the snapshot was built with are merged
+ * with those added since.
+ */
+static int serve_page(const ServeSnapshot *snapshot, unsigned version, size_t count, size_t offset, size_t limit,
+                      PositionList *out)
 {
-    if (argc != 5)
+    PositionList added = VECTOR_INIT(size_t);
+    if (serve_collect(snapshot, version, snapshot->base_count, count, &added) != 0 ||
+        serve_sort(snapshot, &added) != 0)
     {
-        fprintf(stderr, "Error: Incorrect arguments for 'add' command.\n");
-        print_usage(argv[0]);
-        return;
+        vector_free(&added);
+        return -1;
     }
-    Contact *contact = contact_create(argv[2], argv[3], argv[4]);
-    if (contact == NULL)
+    const size_t *later = positions_data(&added);
+    size_t base = 0, next = 0;
+    int rc = 0;
+    while (rc == 0 && out->length < limit)
     {
-        return; // Error message printed in contact_create
+        while (base < snapshot->base_count && !serve_visible(snapshot, version, base))
+            base++;
+        size_t pos;
+        if (base < snapshot->base_count &&
+            (next == added.length || snapshot->origins[base] < snapshot->origins[later[next]]))
+            pos = base++;
+        else if (next < added.length)
+            pos = later[next++];
+        else
+            break;
+        if (offset > 0)
+            offset--;
+        else
+            rc = positions_push(out, pos);
     }
-    if (list_append(list, contact) != 0)
+    vector_free(&added);
+    return rc;
+}
+
+/**
+ * @brief Drops the positions that `version` cannot see from `list`.
+ */
+static void serve_filter(const ServeSnapshot *snapshot, unsigned version, PositionList *list)
+{
+    size_t *positions = positions_data(list);
+    size_t kept = 0;
+    for (size_t i = 0; i < list->length; ++i)
     {
-        fprintf(stderr, "Error: Could not append contact to the list.\n");
-        contact_free(contact);
-        return;
+        if (serve_visible(snapshot, version, positions[i]))
+            positions[kept++] = positions[i];
     }
-    printf("Contact '%s' added successfully.\n", contact->name);
+    list->length = kept;
 }
 
-static void handle_list(const LinkedList *list)
+/**
+ * @brief Collects the positions of contacts offset+1..offset+limit of
+ * `version` sorted by `key`: the snapshot's sort order is merged with those
+ * added since, sorted for the request.
+ */
+static int serve_order_page(const ServeSnapshot *snapshot, const ContactArray *view, unsigned version, OrderKey key,
+                            size_t offset, size_t limit, PositionList *out)
 {
-    if (list->size == 0)
+    PositionList added = VECTOR_INIT(size_t);
+    if (serve_collect(snapshot, version, snapshot->base_count, view->size, &added) != 0 ||
+        order_sort(&added, view, key) != 0)
     {
-        printf("The contact book is empty.\n");
-        return;
+        vector_free(&added);
+        return -1;
     }
-    printf("--- Contact List (%zu contacts) ---\n", list->size);
-    for (size_t i = 0; i < list->size; ++i)
+    const PositionList *order = &snapshot->orders[key];
+    const size_t *base = positions_data(order), *later = positions_data(&added);
+    size_t i = 0, next = 0;
+    int rc = 0;
+    while (rc == 0 && out->length < limit)
     {
-        Contact *c = (Contact *)list_get(list, i);
-        printf("%2zu. Name:  %s\n", i + 1, c->name);
-        printf("     Phone: %s\n", c->phone);
-        printf("     Email: %s\n", c->email);
-        if (i < list->size - 1)
-        {
-            printf("     ---\n");
-        }
+        while (i < order->length && !serve_visible(snapshot, version, base[i]))
+            i++;
+        size_t pos;
+        if (i < order->length && (next == added.length || order_compare(view, key, base[i], later[next]) < 0))
+            pos = base[i++];
+        else if (next < added.length)
+            pos = later[next++];
+        else
+            break;
+        if (offset > 0)
+            offset--;
+        else
+            rc = positions_push(out, pos);
     }
-    printf("------------------------------------\n");
+    vector_free(&added);
+    return rc;
 }
 
-static void handle_find(const LinkedList *list, int argc, char *argv[])
+/**
+ * @brief Finds up to `limit` contacts of `version` whose name starts with
+ * `prefix`, ignoring ASCII case, in name order: the snapshot's name index
+ * is merged with a small one of the contacts added since.
+ */
+static int serve_complete(const ServeSnapshot *snapshot, const ContactArray *view, unsigned version, const char *prefix,
+                          size_t limit, PositionList *out)
 {
-    if (argc != 3)
-    {
-        fprintf(stderr, "Error: Incorrect arguments for 'find' command.\n");
-        print_usage(argv[0]);
-        return;
-    }
-    const char *search_term = argv[2];
-    printf("--- Search Results for '%s' ---\n", search_term);
-    int found_count = 0;
-    for (size_t i = 0; i < list->size; ++i)
+    NameIndex recent;
+    memset(&recent, 0, sizeof(recent));
+    recent.capacity = view->size - snapshot->base_count + 1;
+    recent.entries = (NameEntry *)malloc(recent.capacity * sizeof(NameEntry));
+    if (recent.entries == NULL)
+        return -1;
+    for (size_t pos = snapshot->base_count; pos < view->size; ++pos)
     {
-        Contact *c = (Contact *)list_get(list, i);
-        if (str_case_str(c->name, search_term) != NULL ||
-            str_case_str(c->email, search_term) != NULL)
+        if (!serve_visible(snapshot, version, pos))
+            continue;
+        const NameEntry entry = {name_index_key(&recent, view->items[pos].name), pos};
+        if (entry.key == NULL)
         {
-            if (found_count > 0)
-                printf("     ---\n");
-            printf("  Name:  %s\n  Phone: %s\n  Email: %s\n", c->name, c->phone, c->email);
-            found_count++;
+            name_index_free(&recent);
+            return -1;
         }
+        recent.entries[recent.count++] = entry;
     }
-    if (found_count == 0)
+    qsort(recent.entries, recent.count, sizeof(NameEntry), compare_name_entries);
+    const char *key = name_index_key(&recent, prefix);
+    if (key == NULL)
+    {
+        name_index_free(&recent);
+        return -1;
+    }
+    const size_t length = strlen(key);
+    const NameIndex *names = &snapshot->names;
+    size_t i = name_index_lower_bound(names, key), next = name_index_lower_bound(&recent, key);
+    int rc = 0;
+    while (rc == 0 && out->length < limit)
     {
-        printf("No contacts found matching that term.\n");
+        while (i < names->count && !serve_visible(snapshot, version, names->entries[i].pos))
+            i++;
+        const int in_base = i < names->count && strncmp(names->entries[i].key, key, length) == 0;
+        const int in_recent = next < recent.count && strncmp(recent.entries[next].key, key, length) == 0;
+        if (in_base && (!in_recent || compare_name_entries(&names->entries[i], &recent.entries[next]) < 0))
+            rc = positions_push(out, names->entries[i++].pos);
+        else if (in_recent)
+            rc = positions_push(out, recent.entries[next++].pos);
+        else
+            break;
     }
-    printf("------------------------------------\n");
+    name_index_free(&recent);
+    return rc;
 }
 
-static void handle_delete(LinkedList *list, int argc, char *argv[])
+/**
+ * @brief Answers `find`, `get`, `list` and `complete` from the newest
+ * version of the snapshot. The fuzzy index, name index and sort orders
+ * are built on the snapshot the first time they are needed.
+ * @return 1 if the command was answered, 0 if it needs the book itself.
+ */
+static int serve_read(Server *server, int argc, char *argv[])
 {
-    if (argc != 3)
+    const Command cmd = parse_command(argv[1]);
+    const char *term = NULL;
+    int fuzzy = 0;
+    size_t limit = SIZE_MAX;
+    OrderKey order = ORDER_INSERTION;
+    size_t offset = 0;
+    if (cmd == CMD_FIND || cmd == CMD_COMPLETE)
     {
-        fprintf(stderr, "Error: Incorrect arguments for 'delete' command.\n");
-        print_usage(argv[0]);
-        return;
+        if (cmd == CMD_COMPLETE)
+            limit = FUZZY_DEFAULT_LIMIT;
+        if (parse_search_args(argc, argv, cmd == CMD_FIND, &term, &fuzzy, &limit) != 0)
+            return 0; // Left to the command's handler to report
     }
-    const char *name_to_delete = argv[2];
-    int deleted_count = 0;
-    for (size_t i = 0; i < list->size;)
+    else if (cmd == CMD_LIST)
+    {
+        if (parse_list_args(argc, argv, &order, &offset, &limit) != 0)
+            return 1; // Reported already, as handle_list would
+    }
+    else if (cmd != CMD_GET || argc != 3)
+    {
+        return 0;
+    }
+
+    unsigned slot;
+    ServeSnapshot *snapshot = serve_pin(server, &slot);
+    if (snapshot == NULL)
+    {
+        serve_unpin(server, slot);
+        return 0; // Stopping: the write lock is held until the process exits
+    }
+    // The writer appends past this version's count meanwhile, so the
+    // version is read through a view of its own.
+    const unsigned version = atomic_load_explicit(&snapshot->version, memory_order_acquire);
+    ContactArray view;
+    memset(&view, 0, sizeof(view));
+    view.items = snapshot->contacts.items;
+    view.size = view.capacity = snapshot->versions[version].count;
+    view.live = snapshot->versions[version].live;
+    tie_origins = snapshot->origins;
+    if (cmd == CMD_LIST)
     {
-        Contact *c = (Contact *)list_get(list, i);
-        // Use case-sensitive comparison for deletion to be precise.
-        if (strcmp(c->name, name_to_delete) == 0)
+        PositionList page = VECTOR_INIT(size_t);
+        int rc;
+        if (order == ORDER_INSERTION)
+            rc = serve_page(snapshot, version, view.size, offset, limit, &page);
+        else
+            rc = serve_require(server, snapshot, SERVE_ORDERS) == 0 ?
+                     serve_order_page(snapshot, &view, version, order, offset, limit, &page) : -1;
+        if (rc != 0)
+            fprintf(err_stream(), "Error: Could not sort the contact book.\n");
+        else
+            print_contact_list(&view, &page, offset, limit);
+        vector_free(&page);
+    }
+    else if (cmd == CMD_COMPLETE)
+    {
+        PositionList matches = VECTOR_INIT(size_t);
+        if (serve_require(server, snapshot, SERVE_NAMES) != 0 ||
+            serve_complete(snapshot, &view, version, term, limit, &matches) != 0)
+            fprintf(err_stream(), "Error: Could not search the contact book.\n");
+        else
+            print_completions(&view, term, &matches);
+        vector_free(&matches);
+    }
+    else if (cmd == CMD_FIND && fuzzy)
+    {
+        // The index covers the contacts the snapshot was built with; those
+        // added since are scanned.
+        FuzzyMatchList matches = {0};
+        if (serve_require(server, snapshot, SERVE_FUZZY) != 0 ||
+            fuzzy_match_words(&snapshot->fuzzy, &view, snapshot->base_count, term, &matches) != 0)
         {
-            list_remove(list, i, contact_free);
-            deleted_count++;
-            // Don't increment i, as the list has shifted.
+            fprintf(err_stream(), "Error: Could not search the contact book.\n");
+            matches.size = 0;
         }
-        else
+        size_t kept = 0;
+        for (size_t i = 0; i < matches.size; ++i)
         {
-            i++;
+            if (serve_visible(snapshot, version, matches.items[i].pos))
+                matches.items[kept++] = matches.items[i];
         }
+        matches.size = kept;
+        fuzzy_rank(&view, &matches, limit != SIZE_MAX ? limit : FUZZY_DEFAULT_LIMIT);
+        print_fuzzy_results(&view, term, &matches);
+        free(matches.items);
     }
-    if (deleted_count > 0)
+    else if (cmd == CMD_FIND)
     {
-        printf("Successfully deleted %d contact(s) named '%s'.\n", deleted_count, name_to_delete);
+        // The column covers the contacts the snapshot was built with; those
+        // added since are confirmed one by one, like any candidate.
+        fprintf(out_stream(), "--- Search Results for '%s' ---\n", term);
+        PositionList candidates = VECTOR_INIT(size_t);
+        size_t first = 0;
+        if (snapshot->column_built && column_scan(&snapshot->column, &view, term, &candidates) == 0)
+        {
+            serve_filter(snapshot, version, &candidates);
+            first = snapshot->base_count;
+        }
+        else
+        {
+            vector_clear(&candidates);
+        }
+        serve_collect(snapshot, version, first, view.size, &candidates);
+        serve_sort(snapshot, &candidates);
+        const int found_count = print_matches(&view, term, &candidates, 1, limit);
+        vector_free(&candidates);
+        if (found_count == 0)
+            fprintf(out_stream(), "No contacts found matching that term.\n");
+        fprintf(out_stream(), "------------------------------------\n");
     }
     else
     {
-        printf("No contact found with the exact name '%s'.\n", name_to_delete);
+        const char *key = argv[2];
+        PositionList by_name = VECTOR_INIT(size_t), by_email = VECTOR_INIT(size_t);
+        size_t first = 0;
+        if (snapshot->indexed && index_find(&snapshot->by_name, &view, key, &by_name) == 0 &&
+            index_find(&snapshot->by_email, &view, key, &by_email) == 0)
+        {
+            serve_filter(snapshot, version, &by_name);
+            serve_filter(snapshot, version, &by_email);
+            first = snapshot->base_count;
+        }
+        else
+        {
+            // Without the indexes, or if a lookup ran out of memory, scan.
+            vector_clear(&by_name);
+            vector_clear(&by_email);
+        }
+        for (size_t pos = first; pos < view.size; ++pos)
+        {
+            if (!serve_visible(snapshot, version, pos))
+                continue;
+            if (strcmp(view.items[pos].name, key) == 0)
+                positions_push(&by_name, pos);
+            if (strcmp(view.items[pos].email, key) == 0)
+                positions_push(&by_email, pos);
+        }
+        serve_sort(snapshot, &by_name);
+        serve_sort(snapshot, &by_email);
+        print_exact_matches(&view, key, &by_name, &by_email);
+        vector_free(&by_name);
+        vector_free(&by_email);
     }
+    tie_origins = NULL;
+    serve_unpin(server, slot);
+    return 1;
 }
 
-// --- Contact Management Implementation ---
+/**
+ * @brief Runs one request, with its output captured into the two buffers.
+ * @return The status of the command, as from run_command.
+ */
+static int serve_dispatch(Server *server, int argc, char *argv[])
+{
+    if (serve_read(server, argc, argv))
+        return 0;
+    const Command cmd = parse_command(argv[1]);
+    pthread_mutex_lock(&server->write_lock);
+    ContactBook *book = server->book;
+    const int rc = run_command(book, argc, argv);
+    if ((cmd == CMD_ADD || cmd == CMD_DELETE || cmd == CMD_IMPORT) && book->file.base == NULL &&
+        log_should_compact(&book->log) && book_compact(book) != 0)
+        fprintf(stderr, "Warning: Could not compact '%s'; changes remain in '%s'.\n", CSV_FILENAME, LOG_FILENAME);
+    if (server->changes.length != 0 || book->changes_lost)
+        serve_publish(server); // On failure, searches keep seeing the last snapshot
+    pthread_mutex_unlock(&server->write_lock);
+    return rc;
+}
 
-static Contact *contact_create(const char *name, const char *phone, const char *email)
+static int serve_read_all(int fd, void *data, size_t len)
 {
-    Contact *contact = (Contact *)malloc(sizeof(Contact));
-    if (contact == NULL)
+    unsigned char *p = (unsigned char *)data;
+    while (len > 0)
     {
-        perror("Failed to allocate memory for contact");
-        return NULL;
+        const ssize_t n = read(fd, p, len);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return -1;
+        p += n;
+        len -= (size_t)n;
     }
-    contact->name = strdup(name);
-    contact->phone = strdup(phone);
-    contact->email = strdup(email);
+    return 0;
+}
 
-    if (contact->name == NULL || contact->phone == NULL || contact->email == NULL)
+/**
+ * @brief Reads one frame: a 32-bit big-endian length and that many bytes.
+ * @return The payload, which the caller frees, or NULL at EOF or on error.
+ */
+static char *serve_read_frame(int fd, uint32_t max_length, uint32_t *length)
+{
+    uint32_t wire;
+    if (serve_read_all(fd, &wire, sizeof(wire)) != 0)
+        return NULL;
+    *length = ntohl(wire);
+    if (*length > max_length)
+        return NULL;
+    char *payload = (char *)malloc(*length + 1);
+    if (payload == NULL || serve_read_all(fd, payload, *length) != 0)
     {
-        perror("Failed to allocate memory for contact details");
-        contact_free(contact); // Cleans up partially allocated memory
+        free(payload);
         return NULL;
     }
-    return contact;
+    payload[*length] = '\0';
+    return payload;
 }
 
-static void contact_free(void *data)
+typedef struct
 {
-    if (data == NULL)
-        return;
-    Contact *contact = (Contact *)data;
-    free(contact->name);
-    free(contact->phone);
-    free(contact->email);
-    free(contact);
-}
-
-// --- CSV I/O Implementation ---
+    Server *server;
+    int fd;
+} ServeConnection;
 
-static int load_contacts_from_csv(LinkedList *list, const char *filename)
+/**
+ * @brief Serves the requests of one client until it disconnects.
+ *
+ * A request frame holds the command and its arguments, each NUL-terminated.
+ * The response holds two big-endian lengths and the command's status (0 or
+ * 1), followed by the text the command printed to stdout and to stderr.
+ */
+static void *serve_connection(void *arg)
 {
-    FILE *file = fopen(filename, "r");
-    if (file == NULL)
+    ServeConnection *connection = (ServeConnection *)arg;
+    Server *server = connection->server;
+    const int fd = connection->fd;
+    free(connection);
+
+    uint32_t length;
+    char *request;
+    while ((request = serve_read_frame(fd, SERVE_MAX_REQUEST, &length)) != NULL)
     {
-        if (errno != ENOENT)
+        char *argv[SESSION_MAX_ARGS + 2];
+        int argc = 0;
+        argv[argc++] = server->prog_name;
+        for (uint32_t i = 0; i < length && argc <= SESSION_MAX_ARGS; i += (uint32_t)strlen(request + i) + 1)
+            argv[argc++] = request + i;
+        argv[argc] = NULL;
+
+        char *out = NULL, *err = NULL;
+        size_t out_len = 0, err_len = 0;
+        int failed = 1;
+        command_out = open_memstream(&out, &out_len);
+        command_err = open_memstream(&err, &err_len);
+        if (command_out != NULL && command_err != NULL)
         {
-            perror("Error opening contacts file for reading");
+            if (argc < 2 || length == 0 || request[length - 1] != '\0')
+                fprintf(command_err, "Error: Malformed request.\n");
+            else
+                failed = serve_dispatch(server, argc, argv) != 0;
         }
-        return -1;
+        if (command_out != NULL)
+            fclose(command_out);
+        if (command_err != NULL)
+            fclose(command_err);
+        command_out = command_err = NULL;
+        free(request);
+
+        const uint32_t header[3] = {htonl((uint32_t)out_len), htonl((uint32_t)err_len), htonl((uint32_t)failed)};
+        const int sent = log_write_all(fd, header, sizeof(header)) == 0 &&
+                         log_write_all(fd, out ? out : "", out_len) == 0 &&
+                         log_write_all(fd, err ? err : "", err_len) == 0;
+        free(out);
+        free(err);
+        if (!sent)
+            break;
+        serve_prepare(server);
     }
+    close(fd);
+    return NULL;
+}
+
+static volatile sig_atomic_t serve_listen_fd = -1;
 
-    char line[MAX_LINE_LENGTH];
-    while (fgets(line, sizeof(line), file))
+static void serve_stop(int signum)
+{
+    (void)signum;
+    if (serve_listen_fd >= 0)
+        close(serve_listen_fd); // Makes accept() fail, ending the loop
+    serve_listen_fd = -1;
+}
+
+/**
+ * @brief Serves the book over SERVE_SOCKET until interrupted, one thread per
+ * client. Commands that change the book take turns on the write lock; find,
+ * get, list and complete read the current snapshot instead.
+ */
+static void handle_serve(ContactBook *book, char *prog_name)
+{
+    Server server;
+    memset(&server, 0, sizeof(server));
+    server.book = book;
+    server.prog_name = prog_name;
+    pthread_mutex_init(&server.write_lock, NULL);
+    vector_init(&server.changes, sizeof(BookChange));
+    book->changes = &server.changes;
+    if (serve_publish(&server) != 0)
     {
-        line[strcspn(line, "\r\n")] = 0; // Remove trailing newline
+        serve_close(&server);
+        return;
+    }
 
-        char *line_ptr = line;
-        char *name = get_csv_field(&line_ptr, CSV_DELIMITERS);
-        char *phone = get_csv_field(&line_ptr, CSV_DELIMITERS);
-        char *email = get_csv_field(&line_ptr, CSV_DELIMITERS);
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        perror("Failed to create socket");
+        serve_close(&server);
+        return;
+    }
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, SERVE_SOCKET);
+    unlink(SERVE_SOCKET); // Left behind by a daemon that did not shut down cleanly
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, SOMAXCONN) != 0)
+    {
+        perror("Failed to listen on socket");
+        close(fd);
+        serve_close(&server);
+        return;
+    }
+    serve_listen_fd = fd;
+    signal(SIGINT, serve_stop);
+    signal(SIGTERM, serve_stop);
+    signal(SIGPIPE, SIG_IGN); // A client hanging up must not kill the daemon
+    printf("Serving %zu contact(s) on '%s'. Press Ctrl+C to stop.\n", book->contacts->live, SERVE_SOCKET);
+    fflush(stdout);
 
-        if (name && phone && email)
+    for (;;)
+    {
+        const int client = accept(fd, NULL, NULL);
+        if (client < 0)
         {
-            Contact *contact = contact_create(str_trim(name), str_trim(phone), str_trim(email));
-            if (contact && list_append(list, contact) != 0)
-            {
-                contact_free(contact); // Clean up if append fails
-            }
+            if (errno == EINTR && serve_listen_fd >= 0)
+                continue;
+            break;
+        }
+        ServeConnection *connection = (ServeConnection *)malloc(sizeof(ServeConnection));
+        pthread_t thread;
+        if (connection == NULL)
+        {
+            close(client);
+            continue;
+        }
+        connection->server = &server;
+        connection->fd = client;
+        if (pthread_create(&thread, NULL, serve_connection, connection) != 0)
+        {
+            close(client);
+            free(connection);
+            continue;
         }
+        pthread_detach(thread);
     }
-    fclose(file);
-    return 0;
+
+    // Wait out any write in progress; the book is closed by the caller and
+    // clients still connected are cut off when the process exits.
+    pthread_mutex_lock(&server.write_lock);
+    unlink(SERVE_SOCKET);
+    serve_close(&server);
+    printf("\nDaemon stopped.\n");
 }
 
-static int save_contacts_to_csv(const LinkedList *list, const char *filename)
+/**
+ * @brief Connects to a daemon serving this directory's book, if one runs.
+ * @return The connected socket, or -1 if there is no daemon.
+ */
+static int client_connect(void)
 {
-    FILE *file = fopen(filename, "w");
-    if (file == NULL)
-    {
-        perror("Error opening contacts file for writing");
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
         return -1;
-    }
-    for (size_t i = 0; i < list->size; ++i)
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, SERVE_SOCKET);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
     {
-        Contact *c = (Contact *)list_get(list, i);
-        // Basic CSV writing; for robustness, would need to handle quotes/commas in fields
-        fprintf(file, "%s,%s,%s\n", c->name, c->phone, c->email);
+        close(fd);
+        return -1;
     }
-    fclose(file);
-    return 0;
+    return fd;
 }
 
-static char *get_csv_field(char **line, const char *delimiters)
+/**
+ * @brief Sends `argv[1..argc)` to the daemon and prints its response.
+ * @return 0 on success, 1 if the command failed, -1 if the daemon could
+ * not be reached.
+ */
+static int client_run(int fd, int argc, char *argv[])
 {
-    char *token = strtok_r(*line, delimiters, line);
-    return token;
+    size_t length = 0;
+    for (int i = 1; i < argc; ++i)
+        length += strlen(argv[i]) + 1;
+    if (length > SERVE_MAX_REQUEST)
+    {
+        fprintf(stderr, "Error: Command is too long to send to the daemon.\n");
+        return 1;
+    }
+    char *request = (char *)malloc(sizeof(uint32_t) + length);
+    if (request == NULL)
+        return -1;
+    const uint32_t wire = htonl((uint32_t)length);
+    memcpy(request, &wire, sizeof(wire));
+    char *p = request + sizeof(wire);
+    for (int i = 1; i < argc; ++i)
+    {
+        const size_t len = strlen(argv[i]) + 1;
+        memcpy(p, argv[i], len);
+        p += len;
+    }
+    const int sent = log_write_all(fd, request, sizeof(wire) + length) == 0;
+    free(request);
+
+    uint32_t header[3];
+    if (!sent || serve_read_all(fd, header, sizeof(header)) != 0)
+    {
+        fprintf(stderr, "Error: Lost the connection to the contact book daemon.\n");
+        return -1;
+    }
+    const uint32_t lengths[2] = {ntohl(header[0]), ntohl(header[1])};
+    FILE *streams[2] = {stdout, stderr};
+    char chunk[64 * 1024];
+    for (int s = 0; s < 2; ++s)
+    {
+        for (uint32_t left = lengths[s]; left > 0;)
+        {
+            const size_t n = left < sizeof(chunk) ? left : sizeof(chunk);
+            if (serve_read_all(fd, chunk, n) != 0)
+            {
+                fprintf(stderr, "Error: Lost the connection to the contact book daemon.\n");
+                return -1;
+            }
+            fwrite(chunk, 1, n, streams[s]);
+            left -= (uint32_t)n;
+        }
+    }
+    return header[2] != 0 ? 1 : 0;
 }
 
-// --- Linked List Implementation ---
+// --- Contact Array Implementation ---
 
-static LinkedList *list_create(void)
+static ContactArray *array_create(void)
 {
-    LinkedList *list = (LinkedList *)calloc(1, sizeof(LinkedList));
-    if (list == NULL)
+    ContactArray *array = (ContactArray *)calloc(1, sizeof(ContactArray));
+    if (array == NULL)
     {
-        perror("Failed to allocate memory for LinkedList");
+        perror("Failed to allocate memory for ContactArray");
     }
-    return list;
+    return array;
 }
 
-static void list_destroy(LinkedList *list, void (*free_func)(void *))
+static void array_destroy(ContactArray *array)
 {
-    if (list == NULL)
+    if (array == NULL)
         return;
-    Node *current = list->head;
-    while (current != NULL)
-    {
-        Node *next_node = current->next;
-        if (free_func != NULL && current->data != NULL)
-        {
-            free_func(current->data);
-        }
-        free(current);
-        current = next_node;
-    }
-    free(list);
+    arena_release(&array->strings);
+    free(array->items);
+    free(array);
 }
 
-static int list_append(LinkedList *list, void *data)
+static int array_reserve(ContactArray *array, size_t min_capacity)
 {
-    if (list == NULL)
-        return -1;
-    Node *new_node = (Node *)calloc(1, sizeof(Node));
-    if (new_node == NULL)
-    {
-        perror("Failed to allocate memory for new node");
-        return -1;
-    }
-    new_node->data = data;
-    if (list->head == NULL)
+    if (min_capacity <= array->capacity)
+        return 0;
+    size_t new_capacity = array->capacity ? array->capacity : ARRAY_INITIAL_CAPACITY;
+    while (new_capacity < min_capacity)
     {
-        list->head = new_node;
-        list->tail = new_node;
+        new_capacity *= 2;
     }
-    else
+    Contact *items = (Contact *)realloc(array->items, new_capacity * sizeof(Contact));
+    if (items == NULL)
     {
-        list->tail->next = new_node;
-        list->tail = new_node;
+        perror("Failed to grow ContactArray");
+        return -1;
     }
-    list->size++;
+    array->items = items;
+    array->capacity = new_capacity;
     return 0;
 }
 
-static void *list_get(const LinkedList *list, size_t index)
+/**
+ * @brief Appends an empty slot to the array and returns it for the caller to fill.
+ * @return A pointer to the new slot, or NULL if the array could not grow.
+ */
+static Contact *array_push(ContactArray *array)
+{
+    if (array == NULL || array_reserve(array, array->size + 1) != 0)
+        return NULL;
+    Contact *slot = &array->items[array->size++];
+    memset(slot, 0, sizeof(*slot));
+    array->live++;
+    return slot;
+}
+
+/**
+ * @brief Returns the entry at `pos` for reuse: either a tombstone, which is
+ * revived, or the slot just past the end, which is pushed.
+ * @return The entry to fill, or NULL if `pos` holds a live contact.
+ */
+static Contact *array_claim(ContactArray *array, size_t pos)
 {
-    if (list == NULL || index >= list->size)
+    if (pos == array->size)
+        return array_push(array);
+    if (pos > array->size || contact_is_live(&array->items[pos]))
         return NULL;
-    Node *current = list->head;
-    for (size_t i = 0; i < index; i++)
+    array->live++;
+    return &array->items[pos];
+}
+
+/**
+ * @brief Drops the last entry, undoing an array_push whose contact could not be filled.
+ */
+static void array_pop(ContactArray *array)
+{
+    array->size--;
+    array->live--;
+}
+
+/**
+ * @brief Marks the contact at `pos` as deleted without moving any other entry.
+ */
+static void array_tombstone(ContactArray *array, size_t pos)
+{
+    Contact *c = &array->items[pos];
+    c->name = c->phone = c->email = NULL;
+    array->live--;
+}
+
+static void array_clear(ContactArray *array)
+{
+    array->size = 0;
+    array->live = 0;
+}
+
+/**
+ * @brief Removes every contact matching `pred`, compacting in one pass.
+ *
+ * Tombstones are dropped as well, so positions change and any index over
+ * the array must be rebuilt. The removed contacts' strings remain in the
+ * arena until it is released.
+ * @return The number of live contacts removed.
+ */
+static size_t array_remove_if(ContactArray *array, int (*pred)(const Contact *, const void *), const void *ctx)
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < array->size; ++i)
     {
-        current = current->next;
+        const Contact *c = &array->items[i];
+        if (contact_is_live(c) && !pred(c, ctx))
+        {
+            array->items[kept++] = *c;
+        }
     }
-    return current->data;
+    const size_t removed = array->live - kept;
+    array->size = kept;
+    array->live = kept;
+    return removed;
 }
 
-static int list_remove(LinkedList *list, size_t index, void (*free_func)(void *))
+/**
+ * @brief Drops all tombstones. Positions change, so indexes must be rebuilt.
+ */
+static void array_compact(ContactArray *array)
 {
-    if (list == NULL || index >= list->size)
-        return -1;
-    Node *to_delete = NULL;
-    if (index == 0)
+    size_t kept = 0;
+    for (size_t i = 0; i < array->size; ++i)
     {
-        to_delete = list->head;
-        list->head = list->head->next;
-        if (list->size == 1)
-            list->tail = NULL;
+        if (contact_is_live(&array->items[i]))
+            array->items[kept++] = array->items[i];
     }
-    else
+    array->size = kept;
+}
+
+static inline Contact *array_begin(const ContactArray *array)
+{
+    return array->items;
+}
+
+static inline Contact *array_end(const ContactArray *array)
+{
+    return array->items + array->size;
+}
+
+// --- Utility Implementation ---
+
+/**
+ * @brief Updates a running CRC-32 (IEEE 802.3) with `len` more bytes.
+ *
+ * Uses slicing-by-8: `table[k][b]` is the CRC of byte `b` followed by `k`
+ * zero bytes, so eight bytes are folded in with eight independent lookups.
+ */
+static uint32_t crc32_update(uint32_t crc, const void *data, size_t len)
+{
+    static uint32_t table[8][256];
+    static int table_ready = 0;
+    if (!table_ready)
     {
-        Node *current = list->head;
-        for (size_t i = 0; i < index - 1; i++)
+        for (uint32_t i = 0; i < 256; ++i)
         {
-            current = current->next;
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[0][i] = c;
         }
-        to_delete = current->next;
-        current->next = to_delete->next;
-        if (current->next == NULL)
+        for (uint32_t i = 0; i < 256; ++i)
         {
-            list->tail = current;
+            for (int k = 1; k < 8; ++k)
+                table[k][i] = table[0][table[k - 1][i] & 0xFF] ^ (table[k - 1][i] >> 8);
         }
+        table_ready = 1;
     }
-    if (free_func != NULL && to_delete->data != NULL)
+    const unsigned char *p = (const unsigned char *)data;
+    crc = ~crc;
+    for (; len >= 8; len -= 8, p += 8)
     {
-        free_func(to_delete->data);
+        // Assembled byte by byte, so it is endian-independent and unaligned-safe.
+        const uint32_t lo = crc ^ ((uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24);
+        crc = table[7][lo & 0xFF] ^ table[6][(lo >> 8) & 0xFF] ^ table[5][(lo >> 16) & 0xFF] ^ table[4][lo >> 24] ^
+              table[3][p[4]] ^ table[2][p[5]] ^ table[1][p[6]] ^ table[0][p[7]];
     }
-    free(to_delete);
-    list->size--;
-    return 0;
+    while (len--)
+        crc = table[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return ~crc;
 }
 
-// --- Utility Implementation ---
+/**
+ * @brief Hashes a NUL-terminated string with the runtime library's hash,
+ * keeping the low 32 bits that the in-memory indexes store.
+ */
+static uint32_t hash_string(const char *str)
+{
+    return (uint32_t)hashmap_hash(str, strlen(str));
+}
 
 static char *str_trim(char *str)
 {
@@ -6,25 +6,72 @@
  * including the total number of characters, words, and lines. It also
  * provides a fun fact about the word count.
  *
+ * The file can be read in one of three ways, chosen with --io:
+ *
+ *   - read: large aligned reads, after telling the kernel with
+ *     posix_fadvise that the file is read sequentially so that it reads
+ *     further ahead;
+ *   - mmap: the file is mapped and counted in place by --threads threads,
+ *     with no copy, under MADV_SEQUENTIAL and, where the file system
+ *     supports them, huge pages;
+ *   - direct: O_DIRECT reads, bypassing the page cache, into two buffers
+ *     in turn, one counted on another thread while the next is read.
+ *
+ * With --io=auto (the default), large files are autotuned: the first slices
+ * of the file are analyzed with each strategy and thread count in turn, the
+ * fastest analyzes the rest, and the choice is recorded for the file's
+ * device and size, and for whether the file was mostly in the page cache,
+ * in $XDG_CACHE_HOME/file-analyzer/io-tuning.tsv. Later runs reuse a
+ * record for up to 30 days; --retune ignores it and tunes again. Smaller
+ * files, and any file when --threads is given, use mmap, or read when
+ * tiny. --verbose reports the choice on stderr.
+ *
  * @example
  *   ./file-analyzer my_document.txt
+ *   ./file-analyzer --io=mmap --threads 4 big.log
+ *   ./file-analyzer --verbose big.log
+ *   ./file-analyzer --retune big.log
  *
  * @author Gemini
  * @date 2025-07-04
  *
  ******************************************************************************/
 
+#define _GNU_SOURCE // For O_DIRECT, MADV_HUGEPAGE and mincore
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <ctype.h>
 #include <stdbool.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "threadpool.h"
+#include "timing.h"
 
 // --- Constants and Type Definitions ---
 
-#define MAX_LINE_LENGTH 2048
 #define WORD_DELIMITERS " \t\n\r.,;:!?\"'()[]{}<>&/"
 
+#define IO_ALIGNMENT 4096                     // O_DIRECT buffers, offsets and lengths are multiples of this
+#define READ_CHUNK (4 * 1024 * 1024)          // Bytes per read for the read and direct strategies
+#define MMAP_MIN_CHUNK (4 * 1024 * 1024)      // Fewest bytes worth a counting thread of their own
+#define MAX_THREADS 64
+#define SMALL_FILE_SIZE (1024 * 1024)         // Below this, read beats setting up a mapping
+#define AUTOTUNE_SLICE (8 * 1024 * 1024)      // Bytes each trial analyzes, at least
+#define AUTOTUNE_MIN_SIZE (128 * 1024 * 1024) // Smaller files are not worth tuning
+#define AUTOTUNE_BUDGET 4                     // Trials analyze at most 1/this of the file
+#define MAX_CANDIDATES 16
+#define TUNING_MAX_AGE (30 * 24 * 60 * 60)    // Seconds a record is trusted for
+#define CACHE_SAMPLES 64                      // Windows of the file checked for residency...
+#define CACHE_SAMPLE_PAGES 16                 // ...of this many pages each
+#define TUNING_DIR "file-analyzer"
+#define TUNING_FILE "io-tuning.tsv"
+
 /**
  * @brief Holds the statistics for an analyzed file.
  */
@@ -33,94 +80,758 @@ typedef struct
     long long char_count;
     long long word_count;
     long long line_count;
+    bool in_word;   // The last byte scanned was part of a word
+    char last_byte; // So a final line without '\n' is still counted
 } FileStats;
 
+typedef enum
+{
+    IO_AUTO,
+    IO_READ,
+    IO_MMAP,
+    IO_DIRECT,
+} IoStrategy;
+
+static const char *const IO_NAMES[] = {"auto", "read", "mmap", "direct"};
+
+/**
+ * @brief How to read a file: the strategy and, for mmap, the threads.
+ */
+typedef struct
+{
+    IoStrategy strategy;
+    int threads;
+} IoPlan;
+
+typedef struct
+{
+    const char *filename;
+    IoPlan plan; // IO_AUTO to choose; 0 threads for the default
+    bool retune; // Autotune even if a record exists
+    bool verbose;
+} Options;
+
+/**
+ * @brief An open input, and what the strategies have set up for it so far.
+ */
+typedef struct
+{
+    const char *filename;
+    int fd;
+    int direct_fd;    // Opened on first use; -1 until then
+    bool no_direct;   // The file system refused O_DIRECT
+    bool regular;     // Seekable with a known size; anything else is streamed
+    struct stat st;
+    const char *map;  // The whole file, mapped on first use
+    ThreadPool *pool; // Counting threads, started on first use
+    int pool_workers;
+} InputFile;
+
+/**
+ * @brief A slice of the file, counted from a fresh state on some thread.
+ */
+typedef struct
+{
+    const char *data;
+    size_t length;
+    FileStats stats;
+} CountTask;
+
 // --- Function Prototypes ---
 
+// Options
+static int parse_options(int argc, char *argv[], Options *options);
+static void print_usage(const char *prog_name);
+
 // File Processing
-static int analyze_file(const char *filename, FileStats *stats);
-static void process_line(char *line, FileStats *stats);
+static int analyze_file(const Options *options, FileStats *stats);
+static int run_range(InputFile *file, IoPlan plan, off_t offset, off_t length, FileStats *stats);
+static int read_range(InputFile *file, off_t offset, off_t length, FileStats *stats);
+static int mmap_range(InputFile *file, int threads, off_t offset, off_t length, FileStats *stats);
+static int direct_range(InputFile *file, off_t offset, off_t length, FileStats *stats);
+static int map_file(InputFile *file);
+static ThreadPool *file_pool(InputFile *file, int workers);
+static void close_input(InputFile *file);
+
+// Counting
+static void init_delimiters(void);
+static void process_block(const char *data, size_t length, FileStats *stats);
+static void count_task(void *arg);
+static void merge_counts(FileStats *stats, const CountTask *task);
+
+// Strategy Selection
+static int online_cpus(void);
+static IoPlan default_plan(off_t size, int threads);
+static int autotune(InputFile *file, bool cached, bool verbose, FileStats *stats, IoPlan *plan, off_t *offset);
+static bool is_cached(InputFile *file);
+static int size_class(off_t size);
+static int tuning_path(char *path, size_t size, bool create);
+static bool lookup_tuning(const struct stat *st, bool cached, IoPlan *plan);
+static void record_tuning(const struct stat *st, bool cached, IoPlan plan, double mb_per_second);
 
 // Analysis and Output
 static void print_analysis(const char *filename, const FileStats *stats);
 static bool is_prime(long long n);
 
+// --- Globals ---
+
+static bool is_delimiter[256]; // Indexed by byte, built from WORD_DELIMITERS
+
 // --- Main Application Logic ---
 
 int main(int argc, char *argv[])
 {
-    if (argc != 2)
+    Options options;
+    if (parse_options(argc, argv, &options) != 0)
     {
-        fprintf(stderr, "Usage: %s <filename>\n", argv[0]);
-        fprintf(stderr, "Analyzes a text file and reports statistics about it.\n");
+        print_usage(argv[0]);
         return EXIT_FAILURE;
     }
 
-    const char *filename = argv[1];
-    FileStats stats = {0, 0, 0};
+    FileStats stats = {0, 0, 0, false, '\n'};
 
-    if (analyze_file(filename, &stats) != 0)
+    if (analyze_file(&options, &stats) != 0)
     {
         // Error message is printed inside analyze_file
         return EXIT_FAILURE;
     }
 
-    print_analysis(filename, &stats);
+    print_analysis(options.filename, &stats);
 
     return EXIT_SUCCESS;
 }
 
+// --- Options Implementation ---
+
+/**
+ * @brief Parses `[--io=STRATEGY] [--threads N] [--retune] [--verbose] <filename>`.
+ * @return 0 on success, -1 on a bad command line.
+ */
+static int parse_options(int argc, char *argv[], Options *options)
+{
+    *options = (Options){NULL, {IO_AUTO, 0}, false, false};
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strncmp(argv[i], "--io=", 5) == 0)
+        {
+            int found = -1;
+            for (int s = 0; s < (int)(sizeof(IO_NAMES) / sizeof(IO_NAMES[0])); ++s)
+            {
+                if (strcmp(argv[i] + 5, IO_NAMES[s]) == 0)
+                    found = s;
+            }
+            if (found < 0)
+            {
+                fprintf(stderr, "Error: unknown I/O strategy '%s'.\n", argv[i] + 5);
+                return -1;
+            }
+            options->plan.strategy = (IoStrategy)found;
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            char *end;
+            const long threads = strtol(argv[++i], &end, 10);
+            if (*end != '\0' || threads < 1 || threads > MAX_THREADS)
+            {
+                fprintf(stderr, "Error: --threads needs a number from 1 to %d.\n", MAX_THREADS);
+                return -1;
+            }
+            options->plan.threads = (int)threads;
+        }
+        else if (strcmp(argv[i], "--retune") == 0)
+        {
+            options->retune = true;
+        }
+        else if (strcmp(argv[i], "--verbose") == 0)
+        {
+            options->verbose = true;
+        }
+        else if (argv[i][0] == '-' && argv[i][1] != '\0')
+        {
+            fprintf(stderr, "Error: unknown option '%s'.\n", argv[i]);
+            return -1;
+        }
+        else if (options->filename == NULL)
+        {
+            options->filename = argv[i];
+        }
+        else
+        {
+            return -1;
+        }
+    }
+    return options->filename != NULL ? 0 : -1;
+}
+
+static void print_usage(const char *prog_name)
+{
+    fprintf(stderr, "Usage: %s [--io=auto|read|mmap|direct] [--threads N] [--retune] [--verbose] <filename>\n",
+            prog_name);
+    fprintf(stderr, "Analyzes a text file and reports statistics about it.\n");
+}
+
 // --- File Processing Implementation ---
 
 /**
  * @brief Opens and processes a file, calculating statistics.
- * @param filename The path to the file.
+ * @param options The file to analyze and how to read it.
  * @param stats A pointer to the FileStats struct to populate.
  * @return 0 on success, -1 on failure.
  */
-static int analyze_file(const char *filename, FileStats *stats)
+static int analyze_file(const Options *options, FileStats *stats)
 {
-    FILE *file = fopen(filename, "r");
-    if (file == NULL)
+    InputFile file = {options->filename, open(options->filename, O_RDONLY), -1, false, false, {0}, NULL, NULL, 0};
+    if (file.fd < 0)
     {
         perror("Error opening file");
         return -1;
     }
+    if (fstat(file.fd, &file.st) != 0)
+    {
+        perror("Error reading from file");
+        close(file.fd);
+        return -1;
+    }
+    file.regular = S_ISREG(file.st.st_mode);
+    if (file.regular)
+        posix_fadvise(file.fd, 0, 0, POSIX_FADV_SEQUENTIAL); // Widens the readahead window
+    init_delimiters();
 
-    char line[MAX_LINE_LENGTH];
-    while (fgets(line, sizeof(line), file))
+    IoPlan plan = options->plan;
+    const char *reason = "as asked";
+    off_t offset = 0;
+    int rc = 0;
+    if (!file.regular)
+    {
+        plan = (IoPlan){IO_READ, 1};
+        reason = "not a regular file";
+    }
+    else if (plan.strategy != IO_AUTO)
     {
+        if (plan.threads == 0)
+            plan.threads = default_plan(file.st.st_size, 0).threads;
+    }
+    else if (plan.threads != 0 || file.st.st_size < AUTOTUNE_MIN_SIZE)
+    {
+        plan = default_plan(file.st.st_size, plan.threads);
+        reason = options->plan.threads != 0 ? "threads as asked" : "default for the size";
+    }
+    else
+    {
+        const bool cached = is_cached(&file);
+        if (!options->retune && lookup_tuning(&file.st, cached, &plan))
+        {
+            reason = cached ? "recorded for this device and size, cached" : "recorded for this device and size";
+        }
+        else
+        {
+            rc = autotune(&file, cached, options->verbose, stats, &plan, &offset);
+            reason = cached ? "autotuned, cached" : "autotuned";
+        }
+    }
+    if (plan.strategy != IO_MMAP)
+        plan.threads = 1;
+
+    if (options->verbose)
+        fprintf(stderr, "I/O: %s, %d thread%s (%s)\n", IO_NAMES[plan.strategy], plan.threads,
+                plan.threads == 1 ? "" : "s", reason);
+    if (rc == 0)
+        rc = run_range(&file, plan, offset, file.regular ? file.st.st_size - offset : -1, stats);
+    if (rc == 0 && stats->last_byte != '\n')
         stats->line_count++;
-        stats->char_count += strlen(line);
-        process_line(line, stats);
+
+    close_input(&file);
+    return rc;
+}
+
+/**
+ * @brief Analyzes `length` bytes from `offset` (or all that is left, when
+ * `length` is negative) as `plan` says, continuing the counts in `stats`.
+ * @return 0 on success, -1 on failure (after printing a message).
+ */
+static int run_range(InputFile *file, IoPlan plan, off_t offset, off_t length, FileStats *stats)
+{
+    switch (plan.strategy)
+    {
+    case IO_MMAP:
+        return mmap_range(file, plan.threads, offset, length, stats);
+    case IO_DIRECT:
+        return direct_range(file, offset, length, stats);
+    default:
+        return read_range(file, offset, length, stats);
     }
+}
 
-    if (ferror(file))
+/**
+ * @brief The read strategy: READ_CHUNK bytes at a time into one aligned
+ * buffer, each chunk counted as it arrives.
+ */
+static int read_range(InputFile *file, off_t offset, off_t length, FileStats *stats)
+{
+    void *buffer;
+    if (posix_memalign(&buffer, IO_ALIGNMENT, READ_CHUNK) != 0)
     {
-        perror("Error reading from file");
-        fclose(file);
+        fprintf(stderr, "Error: could not allocate the read buffer.\n");
         return -1;
     }
+    int rc = 0;
+    while (length != 0)
+    {
+        const size_t want = length < 0 || length > READ_CHUNK ? READ_CHUNK : (size_t)length;
+        const ssize_t n = file->regular ? pread(file->fd, buffer, want, offset) : read(file->fd, buffer, want);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+        {
+            perror("Error reading from file");
+            rc = -1;
+        }
+        if (n <= 0)
+            break;
+        process_block((const char *)buffer, (size_t)n, stats);
+        offset += n;
+        if (length > 0)
+            length -= n;
+    }
+    free(buffer);
+    return rc;
+}
 
-    fclose(file);
+/**
+ * @brief The mmap strategy: the range is split into a slice per thread,
+ * each counted in place, and their counts merged in order.
+ */
+static int mmap_range(InputFile *file, int threads, off_t offset, off_t length, FileStats *stats)
+{
+    if (length <= 0)
+        return 0;
+    if (map_file(file) != 0)
+        return -1;
+
+    if ((off_t)threads * MMAP_MIN_CHUNK > length)
+        threads = (int)(length / MMAP_MIN_CHUNK) + 1;
+    ThreadPool *pool = threads > 1 ? file_pool(file, threads - 1) : NULL;
+    if (pool == NULL)
+        threads = 1;
+
+    CountTask tasks[MAX_THREADS];
+    const char *begin = file->map + offset;
+    for (int t = 0; t < threads; ++t)
+    {
+        const size_t from = (size_t)(length * t / threads);
+        const size_t to = (size_t)(length * (t + 1) / threads);
+        tasks[t] = (CountTask){begin + from, to - from, {0, 0, 0, false, '\n'}};
+        if (t > 0 && pool_submit(pool, count_task, &tasks[t]) != 0)
+            count_task(&tasks[t]); // Could not hand it off: count it here
+    }
+    count_task(&tasks[0]);
+    if (pool != NULL)
+        pool_wait(pool);
+    for (int t = 0; t < threads; ++t)
+        merge_counts(stats, &tasks[t]);
+    return 0;
+}
+
+/**
+ * @brief The direct strategy: O_DIRECT reads into two aligned buffers in
+ * turn, each counted on a pool worker while the other is being filled.
+ *
+ * Falls back to the read strategy where the file system refuses O_DIRECT.
+ */
+static int direct_range(InputFile *file, off_t offset, off_t length, FileStats *stats)
+{
+    if (file->direct_fd < 0 && !file->no_direct)
+    {
+        file->direct_fd = open(file->filename, O_RDONLY | O_DIRECT);
+        file->no_direct = file->direct_fd < 0;
+        if (file->no_direct)
+            fprintf(stderr, "Note: O_DIRECT is not supported for '%s'; using read.\n", file->filename);
+    }
+    if (file->no_direct || offset % IO_ALIGNMENT != 0)
+        return read_range(file, offset, length, stats);
+
+    void *buffer;
+    if (posix_memalign(&buffer, IO_ALIGNMENT, 2 * READ_CHUNK) != 0)
+    {
+        fprintf(stderr, "Error: could not allocate the read buffers.\n");
+        return -1;
+    }
+    ThreadPool *pool = file_pool(file, 1);
+    CountTask tasks[2];
+    int pending = -1; // The task being counted, if any
+    int current = 0;  // The buffer to fill next
+    int rc = 0;
+    const off_t end = offset + length;
+    while (offset < end)
+    {
+        // Reads past the end of the range keep the length aligned; the
+        // excess is dropped.
+        const off_t left = end - offset < READ_CHUNK ? end - offset : READ_CHUNK;
+        const size_t want = ((size_t)left + IO_ALIGNMENT - 1) & ~(size_t)(IO_ALIGNMENT - 1);
+        char *data = (char *)buffer + (size_t)current * READ_CHUNK;
+        ssize_t n = pread(file->direct_fd, data, want, offset);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+        {
+            perror("Error reading from file");
+            rc = -1;
+        }
+        if (n <= 0)
+            break;
+        if (n > left)
+            n = left;
+
+        if (pool != NULL)
+            pool_wait(pool);
+        if (pending >= 0)
+            merge_counts(stats, &tasks[pending]);
+        tasks[current] = (CountTask){data, (size_t)n, {0, 0, 0, false, '\n'}};
+        if (pool == NULL || pool_submit(pool, count_task, &tasks[current]) != 0)
+            count_task(&tasks[current]);
+        pending = current;
+        current ^= 1;
+        offset += n;
+    }
+    if (pool != NULL)
+        pool_wait(pool);
+    if (pending >= 0)
+        merge_counts(stats, &tasks[pending]);
+    free(buffer);
+    return rc;
+}
+
+/**
+ * @brief Maps the whole file, once, for sequential reading.
+ * @return 0 on success, -1 on failure (after printing a message).
+ */
+static int map_file(InputFile *file)
+{
+    if (file->map != NULL)
+        return 0;
+    void *map = mmap(NULL, (size_t)file->st.st_size, PROT_READ, MAP_PRIVATE, file->fd, 0);
+    if (map == MAP_FAILED)
+    {
+        perror("Error mapping file");
+        return -1;
+    }
+    madvise(map, (size_t)file->st.st_size, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+    madvise(map, (size_t)file->st.st_size, MADV_HUGEPAGE); // Fails harmlessly where unsupported
+#endif
+    file->map = (const char *)map;
     return 0;
 }
 
 /**
- * @brief Processes a single line to count words.
- * @param line The line to process.
+ * @brief Returns the file's pool with `workers` threads, starting (or
+ * restarting) it as needed.
+ * @return The pool, or NULL if it could not be started.
+ */
+static ThreadPool *file_pool(InputFile *file, int workers)
+{
+    if (file->pool != NULL && file->pool_workers != workers)
+    {
+        pool_destroy(file->pool);
+        file->pool = NULL;
+    }
+    if (file->pool == NULL)
+    {
+        file->pool = pool_create(workers);
+        file->pool_workers = workers;
+    }
+    return file->pool;
+}
+
+static void close_input(InputFile *file)
+{
+    pool_destroy(file->pool);
+    if (file->map != NULL)
+        munmap((void *)file->map, (size_t)file->st.st_size);
+    if (file->direct_fd >= 0)
+        close(file->direct_fd);
+    close(file->fd);
+}
+
+// --- Counting Implementation ---
+
+/**
+ * @brief Fills the delimiter table from WORD_DELIMITERS.
+ */
+static void init_delimiters(void)
+{
+    for (const char *d = WORD_DELIMITERS; *d != '\0'; ++d)
+        is_delimiter[(unsigned char)*d] = true;
+}
+
+/**
+ * @brief Counts the characters, words and lines in a block of the file.
+ *
+ * Blocks are arbitrary slices of the file, so a word may straddle two of
+ * them; `stats->in_word` carries that state across calls.
+ *
+ * @param data The block.
+ * @param length Its length in bytes.
  * @param stats A pointer to the FileStats struct to update.
  */
-static void process_line(char *line, FileStats *stats)
+static void process_block(const char *data, size_t length, FileStats *stats)
+{
+    const unsigned char *p = (const unsigned char *)data;
+    long long words = 0;
+    long long lines = 0;
+    bool in_word = stats->in_word;
+    for (size_t i = 0; i < length; ++i)
+    {
+        const bool delimiter = is_delimiter[p[i]];
+        words += !delimiter && !in_word;
+        lines += p[i] == '\n';
+        in_word = !delimiter;
+    }
+    stats->char_count += (long long)length;
+    stats->word_count += words;
+    stats->line_count += lines;
+    stats->in_word = in_word;
+    if (length > 0)
+        stats->last_byte = data[length - 1];
+}
+
+static void count_task(void *arg)
+{
+    CountTask *task = (CountTask *)arg;
+    process_block(task->data, task->length, &task->stats);
+}
+
+/**
+ * @brief Adds the counts of a slice that was counted from a fresh state to
+ * those of everything before it. A word running across the boundary was
+ * counted on both sides, so it is taken off once.
+ */
+static void merge_counts(FileStats *stats, const CountTask *task)
+{
+    if (task->length == 0)
+        return;
+    const bool joined = stats->in_word && !is_delimiter[(unsigned char)task->data[0]];
+    stats->char_count += task->stats.char_count;
+    stats->word_count += task->stats.word_count - joined;
+    stats->line_count += task->stats.line_count;
+    stats->in_word = task->stats.in_word;
+    stats->last_byte = task->stats.last_byte;
+}
+
+// --- Strategy Selection Implementation ---
+
+static int online_cpus(void)
+{
+    const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus < 1 ? 1 : (cpus > MAX_THREADS ? MAX_THREADS : (int)cpus);
+}
+
+/**
+ * @brief The plan for a file that is not autotuned: read for tiny files,
+ * else mmap with `threads` threads, or one per CPU up to one per
+ * MMAP_MIN_CHUNK bytes.
+ */
+static IoPlan default_plan(off_t size, int threads)
+{
+    if (size < SMALL_FILE_SIZE)
+        return (IoPlan){IO_READ, 1};
+    if (threads == 0)
+    {
+        threads = online_cpus();
+        if ((off_t)threads * MMAP_MIN_CHUNK > size)
+            threads = (int)(size / MMAP_MIN_CHUNK) + 1;
+    }
+    return (IoPlan){IO_MMAP, threads};
+}
+
+/**
+ * @brief Analyzes the first slices of the file with each candidate plan in
+ * turn, timing each, then records the fastest.
+ *
+ * The candidates are read, direct, and mmap with 1, 2, 4, ... threads up to
+ * one per CPU, as many as fit in 1/AUTOTUNE_BUDGET of the file. Each gets a
+ * slice of at least MMAP_MIN_CHUNK bytes per thread.
+ *
+ * @param cached Whether the file was mostly in the page cache, for the record.
+ * @param plan Set to the fastest plan.
+ * @param offset Advanced past the slices analyzed.
+ * @return 0 on success, -1 on failure (after printing a message).
+ */
+static int autotune(InputFile *file, bool cached, bool verbose, FileStats *stats, IoPlan *plan, off_t *offset)
 {
-    char *saveptr; // For strtok_r
-    char *token = strtok_r(line, WORD_DELIMITERS, &saveptr);
+    IoPlan candidates[MAX_CANDIDATES];
+    int count = 0;
+    candidates[count++] = (IoPlan){IO_READ, 1};
+    candidates[count++] = (IoPlan){IO_DIRECT, 1};
+    const int cpus = online_cpus();
+    for (int threads = 1; count < MAX_CANDIDATES; threads *= 2)
+    {
+        candidates[count++] = (IoPlan){IO_MMAP, threads < cpus ? threads : cpus};
+        if (threads >= cpus)
+            break;
+    }
 
-    while (token != NULL)
+    const off_t budget = file->st.st_size / AUTOTUNE_BUDGET;
+    double best_rate = 0;
+    *plan = default_plan(file->st.st_size, 0);
+    for (int i = 0; i < count; ++i)
     {
-        stats->word_count++;
-        token = strtok_r(NULL, WORD_DELIMITERS, &saveptr);
+        off_t slice = (off_t)candidates[i].threads * MMAP_MIN_CHUNK;
+        slice = slice > AUTOTUNE_SLICE ? slice : AUTOTUNE_SLICE;
+        if (*offset + slice > budget)
+            break;
+        Stopwatch stopwatch;
+        stopwatch_start(&stopwatch);
+        if (run_range(file, candidates[i], *offset, slice, stats) != 0)
+            return -1;
+        const double rate = (double)slice / stopwatch_elapsed(&stopwatch) / 1e6;
+        *offset += slice;
+        if (candidates[i].strategy == IO_DIRECT && file->no_direct)
+            continue; // That was really read
+        if (verbose)
+            fprintf(stderr, "Trial: %s, %d thread%s: %.0f MB/s\n", IO_NAMES[candidates[i].strategy],
+                    candidates[i].threads, candidates[i].threads == 1 ? "" : "s", rate);
+        if (rate > best_rate)
+        {
+            best_rate = rate;
+            *plan = candidates[i];
+        }
     }
+    if (best_rate > 0)
+        record_tuning(&file->st, cached, *plan, best_rate);
+    return 0;
+}
+
+/**
+ * @brief Whether at least half of the file is in the page cache, judged
+ * from CACHE_SAMPLES windows spread evenly across it. Which strategy wins
+ * depends on this more than on anything else.
+ */
+static bool is_cached(InputFile *file)
+{
+    const long page = sysconf(_SC_PAGESIZE);
+    if (page <= 0 || map_file(file) != 0)
+        return false;
+    const size_t pages = ((size_t)file->st.st_size + (size_t)page - 1) / (size_t)page;
+    unsigned char residency[CACHE_SAMPLE_PAGES];
+    size_t resident = 0, checked = 0;
+    for (size_t i = 0; i < CACHE_SAMPLES; ++i)
+    {
+        const size_t first = pages * i / CACHE_SAMPLES;
+        const size_t count = pages - first < CACHE_SAMPLE_PAGES ? pages - first : CACHE_SAMPLE_PAGES;
+        if (mincore((void *)(file->map + first * (size_t)page), count * (size_t)page, residency) != 0)
+            return false;
+        for (size_t p = 0; p < count; ++p)
+            resident += residency[p] & 1;
+        checked += count;
+    }
+    return resident * 2 >= checked;
+}
+
+/**
+ * @brief Groups file sizes by power of two, so a choice carries over to
+ * files of a similar size.
+ */
+static int size_class(off_t size)
+{
+    int bits = 0;
+    while (size > 1)
+    {
+        size >>= 1;
+        bits++;
+    }
+    return bits;
+}
+
+/**
+ * @brief Writes the path of the tuning record into `path`, creating its
+ * directory when `create` is set.
+ * @return 0 on success, -1 if there is no cache directory to use.
+ */
+static int tuning_path(char *path, size_t size, bool create)
+{
+    char base[4096];
+    const char *cache = getenv("XDG_CACHE_HOME");
+    const char *home = getenv("HOME");
+    int n;
+    if (cache != NULL && cache[0] != '\0')
+        n = snprintf(base, sizeof(base), "%s", cache);
+    else if (home != NULL && home[0] != '\0')
+        n = snprintf(base, sizeof(base), "%s/.cache", home);
+    else
+        return -1;
+    if (n < 0 || (size_t)n >= sizeof(base))
+        return -1;
+    n = snprintf(path, size, "%s/" TUNING_DIR, base);
+    if (n < 0 || (size_t)n >= size)
+        return -1;
+    if (create)
+    {
+        mkdir(base, 0755); // Either may exist already
+        mkdir(path, 0755);
+    }
+    n = snprintf(path, size, "%s/" TUNING_DIR "/" TUNING_FILE, base);
+    return n < 0 || (size_t)n >= size ? -1 : 0;
+}
+
+/**
+ * @brief Looks up the plan recorded for the file's device, size class and
+ * cache state in the last TUNING_MAX_AGE seconds; the latest record wins.
+ * @return true if one was found.
+ */
+static bool lookup_tuning(const struct stat *st, bool cached, IoPlan *plan)
+{
+    char path[4096];
+    if (tuning_path(path, sizeof(path), false) != 0)
+        return false;
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+        return false;
+
+    const long long now = (long long)time(NULL);
+    bool found = false;
+    char line[256];
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        unsigned long long device;
+        int bits, threads;
+        long long recorded;
+        char state[8], name[16];
+        if (sscanf(line, "%llu %d %7s %15s %d %*f %lld", &device, &bits, state, name, &threads, &recorded) != 6 ||
+            device != (unsigned long long)st->st_dev || bits != size_class(st->st_size) ||
+            strcmp(state, cached ? "cached" : "uncached") != 0 || threads < 1 || threads > MAX_THREADS ||
+            now - recorded > TUNING_MAX_AGE)
+            continue;
+        for (int s = IO_READ; s <= IO_DIRECT; ++s)
+        {
+            if (strcmp(name, IO_NAMES[s]) == 0)
+            {
+                *plan = (IoPlan){(IoStrategy)s, threads};
+                found = true;
+            }
+        }
+    }
+    fclose(file);
+    return found;
+}
+
+/**
+ * @brief Appends "device, size class, cached|uncached, strategy, threads,
+ * MB/s, time", separated by tabs, to the tuning record. Failure to record
+ * is not an error.
+ */
+static void record_tuning(const struct stat *st, bool cached, IoPlan plan, double mb_per_second)
+{
+    char path[4096];
+    if (tuning_path(path, sizeof(path), true) != 0)
+        return;
+    FILE *file = fopen(path, "a");
+    if (file == NULL)
+        return;
+    fprintf(file, "%llu\t%d\t%s\t%s\t%d\t%.0f\t%lld\n", (unsigned long long)st->st_dev,
+            size_class(st->st_size), cached ? "cached" : "uncached", IO_NAMES[plan.strategy], plan.threads,
+            mb_per_second, (long long)time(NULL));
+    fclose(file);
 }
 
 // --- Analysis and Output Implementation ---
@@ -3,17 +3,28 @@
  * @brief A robust, minimalist, multi-threaded HTTP server.
  *
  * This server listens on a specified port for incoming HTTP connections.
- * It handles each connection in a separate thread, serving a dynamic homepage
- * for the root path (/) and a 404 Not Found error for all other paths.
+ * Connections are handed to a fixed pool of worker threads, which look the
+ * requested path up in a hash table of routes, serving the homepage for the
+ * root path (/) and a 404 Not Found error for all other paths. Each worker
+ * assembles its responses in a buffer of its own.
+ *
+ * Workers can be pinned to CPUs (--pin) and grouped per NUMA node (--numa):
+ * each node then has a pool of its own, whose workers run only on that
+ * node's CPUs and allocate their state there, and a connection is handed to
+ * the node whose CPU received it. On shutdown, a stats line shows how many
+ * requests each worker served.
+ * A client that sends nothing, or stops reading, is dropped after
+ * CLIENT_TIMEOUT_SECONDS, so idle connections cannot hold the workers.
  * The server is designed to be robust, with proper error handling, dynamic
  * response generation, and a graceful shutdown mechanism via SIGINT (Ctrl+C).
  *
  * @example
  *   # Compile the server
- *   gcc -Wall -Wextra -pthread tiny-server.c -o tiny-server
+ *   make tiny-server
  *
  *   # Run the server
  *   ./tiny-server
+ *   ./tiny-server --workers 16 --numa --pin
  *
  *   Then, open a web browser to http://localhost:8080
  *
@@ -22,46 +33,139 @@
  *
  ******************************************************************************/
 
+#define _GNU_SOURCE // For CPU affinity (sched_getaffinity, pthread_setaffinity_np)
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <sys/socket.h>
+#include <sys/time.h> // For struct timeval
 #include <netinet/in.h>
+#include <netinet/tcp.h> // For TCP_DEFER_ACCEPT
 #include <arpa/inet.h> // For inet_ntop
 #include <signal.h>
-#include <pthread.h>
 #include <errno.h>
+#include <stdbool.h>
+#include <sched.h>
+#include <pthread.h>
+
+#include "bufio.h"
+#include "hashmap.h"
+#include "threadpool.h"
 
 // --- Constants ---
 
 #define PORT 8080
-#define BUFFER_SIZE 4096 // Increased buffer size for response generation
+#define BUFFER_SIZE 4096           // Bytes of a request that are read
+#define RESPONSE_BUFFER_SIZE 16384 // Each worker's response buffer; larger bodies bypass it
 #define MAX_PENDING_CONNECTIONS 10
+#define WORKERS_PER_CPU 4 // Workers block on client I/O, so run more than one per core
+#define CLIENT_TIMEOUT_SECONDS 5 // Longest a worker waits on one client to send or receive
+#define MAX_NODES 64
+#define NODE_SYSFS "/sys/devices/system/node"
 
-// --- Client Thread Data ---
-// A struct to pass both the socket and address info to the thread.
+// --- Client Connection Data ---
+// A struct to pass both the socket and address info to a worker.
 typedef struct
 {
     int socket;
     char ip_str[INET_ADDRSTRLEN];
 } client_info_t;
 
+// --- Routes ---
+// A page served for GET requests to an exact path.
+typedef struct
+{
+    const char *path;
+    const char *content_type;
+    const char *body;
+} route_t;
+
+static const char HOMEPAGE_BODY[] = "<!DOCTYPE html>"
+                                   "<html lang=\"en\">"
+                                   "<head><meta charset=\"UTF-8\"><title>Tiny C Server</title>"
+                                   "<style>body{font-family:sans-serif;background-color:#f0f0f0;text-align:center;} h1{color:#333;}</style>"
+                                   "</head><body>"
+                                   "<h1>Welcome!</h1><p>This page is served by a tiny C server.</p>"
+                                   "</body></html>";
+
+static const route_t ROUTES[] = {
+    {"/", "text/html", HOMEPAGE_BODY},
+};
+
+// --- Worker Placement ---
+// The CPUs of one NUMA node that the server may use, and its workers.
+typedef struct
+{
+    int id; // Node number, or -1 when nodes are not told apart
+    cpu_set_t cpus;
+    int cpu_count;
+    int first_worker; // The node's first worker in `workers`
+    int worker_count;
+    ThreadPool *pool;
+} node_t;
+
+// State belonging to one worker, allocated by the worker itself after it has
+// been placed, so that it lands in memory local to the worker's node.
+typedef struct
+{
+    BufWriter out;
+    long requests;
+    int cpu; // The CPU the worker is pinned to, or -1
+} worker_t;
+
+typedef struct
+{
+    int worker_count; // 0 for WORKERS_PER_CPU per usable CPU
+    bool pin;
+    bool numa;
+} options_t;
+
 // --- Global Variables ---
 
 static volatile sig_atomic_t server_running = 1;
 static int server_fd = -1;
+static HashMap routes; // Path -> route_t, built once before serving
+
+static node_t nodes[MAX_NODES];
+static int node_count;
+static bool pin_workers;
+static worker_t **workers; // Filled in by each worker as it starts
+static int total_workers;
+static _Thread_local worker_t *current_worker;
 
 // --- Function Prototypes ---
+static int parse_options(int argc, char *argv[], options_t *options);
 static int create_server_socket(int port);
-static void *handle_client(void *arg);
+static int set_client_timeouts(int client_socket);
+static int build_routes(void);
+static int find_nodes(bool numa);
+static int parse_cpulist(const char *list, cpu_set_t *cpus);
+static int nth_cpu(const cpu_set_t *cpus, int n);
+static int start_workers(int worker_count);
+static void init_worker(int index, void *context);
+static void stop_workers(void);
+static node_t *pick_node(int client_socket);
+static void print_worker_stats(void);
+static void handle_client(void *arg);
 static void signal_handler(int signum);
-static void send_response(int client_socket, const char *status_code, const char *content_type, const char *body);
+static void send_response(BufWriter *out, const char *status_code, const char *content_type, const char *body);
 
 // --- Main Application Logic ---
 
-int main(void)
+int main(int argc, char *argv[])
 {
+    options_t options;
+    if (parse_options(argc, argv, &options) != 0)
+    {
+        fprintf(stderr, "Usage: %s [--workers N] [--pin] [--numa]\n", argv[0]);
+        fprintf(stderr, "  --workers N  Run N worker threads (default: %d per CPU).\n", WORKERS_PER_CPU);
+        fprintf(stderr, "  --pin        Pin each worker to one CPU.\n");
+        fprintf(stderr, "  --numa       Keep each worker, its memory and its connections on one NUMA node.\n");
+        return EXIT_FAILURE;
+    }
+
     // Block SIGPIPE: If a client closes a connection while we're writing to it,
     // we get a SIGPIPE signal, which terminates the process. It's better to
     // handle the error from the send() call directly.
@@ -74,9 +178,25 @@ int main(void)
     sigaction(SIGINT, &sa, NULL);
     sigaction(SIGTERM, &sa, NULL);
 
+    if (build_routes() != 0 || find_nodes(options.numa) != 0)
+    {
+        perror("Failed to set up the server");
+        return EXIT_FAILURE;
+    }
+    pin_workers = options.pin;
+    int usable_cpus = 0;
+    for (int i = 0; i < node_count; ++i)
+        usable_cpus += nodes[i].cpu_count;
+    if (start_workers(options.worker_count != 0 ? options.worker_count : usable_cpus * WORKERS_PER_CPU) != 0)
+    {
+        perror("Failed to start the worker threads");
+        return EXIT_FAILURE;
+    }
+
     server_fd = create_server_socket(PORT);
     if (server_fd < 0)
     {
+        stop_workers();
         return EXIT_FAILURE;
     }
 
@@ -98,6 +218,12 @@ int main(void)
             continue;
         }
 
+        if (set_client_timeouts(client_socket) != 0)
+        {
+            close(client_socket);
+            continue;
+        }
+
         // Create a struct to hold client info
         client_info_t *client_info = malloc(sizeof(client_info_t));
         if (client_info == NULL)
@@ -110,26 +236,60 @@ int main(void)
         // Log the client's IP address
         inet_ntop(AF_INET, &client_addr.sin_addr, client_info->ip_str, INET_ADDRSTRLEN);
 
-        pthread_t thread_id;
-        if (pthread_create(&thread_id, NULL, handle_client, client_info) != 0)
+        if (pool_submit(pick_node(client_socket)->pool, handle_client, client_info) != 0)
         {
-            perror("pthread_create failed");
+            perror("pool_submit failed");
             close(client_socket);
             free(client_info);
         }
-        else
-        {
-            pthread_detach(thread_id);
-        }
     }
 
     printf("\nServer shutting down gracefully.\n");
-    // The signal handler closes the socket, so no extra cleanup is needed here.
+    // The signal handler closes the socket; connections already accepted are
+    // still answered before the workers stop.
+    stop_workers();
+    hashmap_free(&routes);
     return EXIT_SUCCESS;
 }
 
 // --- Server Setup Implementation ---
 
+/**
+ * @brief Parses the command-line options.
+ * @return 0 on success, -1 on an unknown option or a bad value.
+ */
+static int parse_options(int argc, char *argv[], options_t *options)
+{
+    *options = (options_t){0, false, false};
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--pin") == 0)
+        {
+            options->pin = true;
+        }
+        else if (strcmp(argv[i], "--numa") == 0)
+        {
+            options->numa = true;
+        }
+        else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc)
+        {
+            char *end;
+            long count = strtol(argv[++i], &end, 10);
+            if (*end != '\0' || count < 1 || count > 4096)
+            {
+                fprintf(stderr, "Error: --workers needs a number from 1 to 4096.\n");
+                return -1;
+            }
+            options->worker_count = (int)count;
+        }
+        else
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
 static int create_server_socket(int port)
 {
     int sockfd = socket(AF_INET, SOCK_STREAM, 0);
@@ -148,6 +308,12 @@ static int create_server_socket(int port)
         return -1;
     }
 
+    // Hand over connections only once their request has arrived, so that
+    // idle ones do not reach the workers at all. Best effort: the timeouts
+    // on each client socket still apply where this is unsupported.
+    int defer = CLIENT_TIMEOUT_SECONDS;
+    setsockopt(sockfd, IPPROTO_TCP, TCP_DEFER_ACCEPT, &defer, sizeof(defer));
+
     struct sockaddr_in server_addr;
     memset(&server_addr, 0, sizeof(server_addr));
     server_addr.sin_family = AF_INET;
@@ -170,12 +336,303 @@ static int create_server_socket(int port)
     return sockfd;
 }
 
+/**
+ * @brief Bounds how long a worker can block on a client, in either
+ * direction, to CLIENT_TIMEOUT_SECONDS.
+ * @return 0 on success, -1 on failure (after printing an error).
+ */
+static int set_client_timeouts(int client_socket)
+{
+    const struct timeval timeout = {CLIENT_TIMEOUT_SECONDS, 0};
+    if (setsockopt(client_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) < 0 ||
+        setsockopt(client_socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) < 0)
+    {
+        perror("setsockopt(SO_RCVTIMEO/SO_SNDTIMEO) failed");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Indexes ROUTES by path.
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int build_routes(void)
+{
+    for (size_t i = 0; i < sizeof(ROUTES) / sizeof(ROUTES[0]); ++i)
+    {
+        if (hashmap_put(&routes, ROUTES[i].path, strlen(ROUTES[i].path), (void *)&ROUTES[i]) != 0)
+            return -1;
+    }
+    return 0;
+}
+
+// --- Worker Placement Implementation ---
+
+/**
+ * @brief Fills `nodes` with the CPUs this process may run on, one entry per
+ * NUMA node when `numa` is set (as listed in sysfs), else a single entry.
+ * @return 0 on success, -1 if the CPUs could not be determined.
+ */
+static int find_nodes(bool numa)
+{
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+        return -1;
+
+    node_count = 0;
+    for (int id = 0; numa && id < MAX_NODES; ++id)
+    {
+        char path[64], list[1024];
+        snprintf(path, sizeof(path), NODE_SYSFS "/node%d/cpulist", id);
+        FILE *file = fopen(path, "r");
+        if (file == NULL)
+            continue; // Node numbers may have gaps
+        const bool read = fgets(list, sizeof(list), file) != NULL;
+        fclose(file);
+        node_t *node = &nodes[node_count];
+        if (!read || parse_cpulist(list, &node->cpus) != 0)
+            continue;
+        CPU_AND(&node->cpus, &node->cpus, &allowed);
+        node->cpu_count = CPU_COUNT(&node->cpus);
+        if (node->cpu_count > 0) // Memory-only nodes, or none of ours
+        {
+            node->id = id;
+            node_count++;
+        }
+    }
+    if (node_count == 0)
+    {
+        nodes[0].id = -1;
+        nodes[0].cpus = allowed;
+        nodes[0].cpu_count = CPU_COUNT(&allowed);
+        node_count = 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Parses a sysfs CPU list such as "0-3,8-11" into `cpus`.
+ * @return 0 on success, -1 if the list is malformed.
+ */
+static int parse_cpulist(const char *list, cpu_set_t *cpus)
+{
+    CPU_ZERO(cpus);
+    const char *p = list;
+    while (*p != '\0' && *p != '\n')
+    {
+        char *end;
+        long first = strtol(p, &end, 10);
+        long last = first;
+        if (end == p)
+            return -1;
+        if (*end == '-')
+        {
+            p = end + 1;
+            last = strtol(p, &end, 10);
+            if (end == p)
+                return -1;
+        }
+        for (long cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu)
+            CPU_SET((int)cpu, cpus);
+        p = *end == ',' ? end + 1 : end;
+    }
+    return 0;
+}
+
+/**
+ * @brief Returns the `n`th CPU (from 0) in `cpus`, which must hold more
+ * than `n`.
+ */
+static int nth_cpu(const cpu_set_t *cpus, int n)
+{
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+    {
+        if (CPU_ISSET(cpu, cpus) && n-- == 0)
+            return cpu;
+    }
+    return -1;
+}
+
+/**
+ * @brief Shares `worker_count` workers among the nodes by their CPU counts
+ * (at least one each) and starts a pool per node.
+ *
+ * Each pool is created while the main thread is bound to the pool's node,
+ * so that its queues, like the workers' own state, are allocated there.
+ *
+ * @return 0 on success, -1 on failure.
+ */
+static int start_workers(int worker_count)
+{
+    int usable_cpus = 0;
+    for (int i = 0; i < node_count; ++i)
+        usable_cpus += nodes[i].cpu_count;
+
+    total_workers = 0;
+    int cpus_so_far = 0;
+    for (int i = 0; i < node_count; ++i)
+    {
+        cpus_so_far += nodes[i].cpu_count;
+        int share = (int)((long)worker_count * cpus_so_far / usable_cpus) - total_workers;
+        nodes[i].first_worker = total_workers;
+        nodes[i].worker_count = share > 0 ? share : 1;
+        total_workers += nodes[i].worker_count;
+    }
+    workers = calloc((size_t)total_workers, sizeof(worker_t *));
+    if (workers == NULL)
+        return -1;
+
+    cpu_set_t main_cpus;
+    sched_getaffinity(0, sizeof(main_cpus), &main_cpus);
+    int rc = 0;
+    for (int i = 0; i < node_count && rc == 0; ++i)
+    {
+        node_t *node = &nodes[i];
+        if (node_count > 1)
+            sched_setaffinity(0, sizeof(node->cpus), &node->cpus);
+        node->pool = pool_create_with_init(node->worker_count, init_worker, node);
+        if (node->pool == NULL)
+            rc = -1;
+        if (node->id >= 0)
+            printf("Node %d: %d workers on %d CPUs\n", node->id, node->worker_count, node->cpu_count);
+    }
+    sched_setaffinity(0, sizeof(main_cpus), &main_cpus);
+    if (rc == 0)
+        printf("Started %d workers%s.\n", total_workers, pin_workers ? ", each pinned to one CPU" : "");
+    return rc;
+}
+
+/**
+ * @brief Places a worker on its CPU or node, then allocates its state. Runs
+ * on the worker's own thread, so the kernel backs the allocations with
+ * memory on the node the worker now runs on (first-touch placement).
+ */
+static void init_worker(int index, void *context)
+{
+    const node_t *node = (const node_t *)context;
+    int cpu = -1;
+    if (pin_workers)
+    {
+        cpu_set_t one;
+        CPU_ZERO(&one);
+        cpu = nth_cpu(&node->cpus, index % node->cpu_count);
+        CPU_SET(cpu, &one);
+        pthread_setaffinity_np(pthread_self(), sizeof(one), &one);
+    }
+    else if (node_count > 1)
+    {
+        pthread_setaffinity_np(pthread_self(), sizeof(node->cpus), &node->cpus);
+    }
+
+    worker_t *worker = calloc(1, sizeof(worker_t));
+    if (worker == NULL || writer_init(&worker->out, -1, RESPONSE_BUFFER_SIZE) != 0)
+    {
+        perror("Failed to allocate a worker's buffer");
+        free(worker);
+        return; // The worker will refuse its connections
+    }
+    memset(worker->out.buffer, 0, worker->out.capacity); // Fault the pages in here
+    worker->cpu = cpu;
+    current_worker = worker;
+    workers[node->first_worker + index] = worker;
+}
+
+/**
+ * @brief Finishes the queued connections, stops every pool, prints the
+ * per-worker stats and frees the workers.
+ */
+static void stop_workers(void)
+{
+    for (int i = 0; i < node_count; ++i)
+    {
+        pool_destroy(nodes[i].pool);
+        nodes[i].pool = NULL;
+    }
+    print_worker_stats();
+    for (int i = 0; i < total_workers; ++i)
+    {
+        if (workers[i] != NULL)
+            writer_free(&workers[i]->out);
+        free(workers[i]);
+    }
+    free(workers);
+    workers = NULL;
+}
+
+/**
+ * @brief Chooses the node to serve a connection: the one whose CPU received
+ * it, where the kernel reports that, else the next in turn.
+ */
+static node_t *pick_node(int client_socket)
+{
+    static unsigned next_node;
+    if (node_count == 1)
+        return &nodes[0];
+#ifdef SO_INCOMING_CPU
+    int cpu;
+    socklen_t length = sizeof(cpu);
+    if (getsockopt(client_socket, SOL_SOCKET, SO_INCOMING_CPU, &cpu, &length) == 0 && cpu >= 0 && cpu < CPU_SETSIZE)
+    {
+        for (int i = 0; i < node_count; ++i)
+        {
+            if (CPU_ISSET(cpu, &nodes[i].cpus))
+                return &nodes[i];
+        }
+    }
+#else
+    (void)client_socket;
+#endif
+    return &nodes[next_node++ % (unsigned)node_count];
+}
+
+/**
+ * @brief Prints one line with the requests each worker served, nodes
+ * separated by '|', and their spread.
+ */
+static void print_worker_stats(void)
+{
+    long total = 0, least = -1, most = 0;
+    printf("Requests per worker:");
+    for (int i = 0; i < node_count; ++i)
+    {
+        if (i > 0)
+            printf(" |");
+        for (int w = nodes[i].first_worker; w < nodes[i].first_worker + nodes[i].worker_count; ++w)
+        {
+            const long requests = workers[w] != NULL ? workers[w]->requests : 0;
+            if (workers[w] != NULL && workers[w]->cpu >= 0)
+                printf(" %ld@cpu%d", requests, workers[w]->cpu);
+            else
+                printf(" %ld", requests);
+            total += requests;
+            least = least < 0 || requests < least ? requests : least;
+            most = requests > most ? requests : most;
+        }
+    }
+    printf(" (total %ld, min %ld, max %ld, mean %.1f)\n", total, least, most, (double)total / total_workers);
+}
+
 // --- Connection Handling Implementation ---
 
-static void *handle_client(void *arg)
+/**
+ * @brief Serves one connection; runs on a pool worker.
+ * @param arg The client_info_t, freed here.
+ */
+static void handle_client(void *arg)
 {
     client_info_t *info = (client_info_t *)arg;
     int client_socket = info->socket;
+    worker_t *worker = current_worker;
+    if (worker == NULL)
+    {
+        close(client_socket);
+        free(info);
+        return;
+    }
+    BufWriter *out = &worker->out;
+    out->fd = client_socket;
+    worker->requests++;
 
     printf("Accepted connection from %s\n", info->ip_str);
 
@@ -194,34 +651,33 @@ static void *handle_client(void *arg)
 
             if (strcmp(method, "GET") == 0)
             {
-                if (strcmp(path, "/") == 0)
+                void **found = hashmap_lookup(&routes, path, strlen(path));
+                if (found != NULL)
                 {
-                    const char *body = "<!DOCTYPE html>"
-                                       "<html lang=\"en\">"
-                                       "<head><meta charset=\"UTF-8\"><title>Tiny C Server</title>"
-                                       "<style>body{font-family:sans-serif;background-color:#f0f0f0;text-align:center;} h1{color:#333;}</style>"
-                                       "</head><body>"
-                                       "<h1>Welcome!</h1><p>This page is served by a tiny C server.</p>"
-                                       "</body></html>";
-                    send_response(client_socket, "200 OK", "text/html", body);
+                    const route_t *route = (const route_t *)*found;
+                    send_response(out, "200 OK", route->content_type, route->body);
                 }
                 else
                 {
-                    send_response(client_socket, "404 Not Found", "text/plain", "Not Found");
+                    send_response(out, "404 Not Found", "text/plain", "Not Found");
                 }
             }
             else
             {
                 // Method not supported
-                send_response(client_socket, "405 Method Not Allowed", "text/plain", "Method Not Allowed");
+                send_response(out, "405 Method Not Allowed", "text/plain", "Method Not Allowed");
             }
         }
         else
         {
             // Malformed request
-            send_response(client_socket, "400 Bad Request", "text/plain", "Bad Request");
+            send_response(out, "400 Bad Request", "text/plain", "Bad Request");
         }
     }
+    else if (bytes_read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    {
+        printf("Timed out waiting for a request from %s\n", info->ip_str);
+    }
     else if (bytes_read < 0)
     {
         perror("recv failed");
@@ -231,54 +687,31 @@ static void *handle_client(void *arg)
     printf("Closing connection for %s\n", info->ip_str);
     close(client_socket);
     free(info); // Free the memory allocated in main
-    return NULL;
 }
 
 /**
  * @brief Constructs and sends a full HTTP response.
- * @param client_socket The socket to send the response to.
+ * @param out The worker's buffer, writing to the client socket.
  * @param status_code The HTTP status (e.g., "200 OK").
  * @param content_type The MIME type of the body (e.g., "text/html").
  * @param body The content to send as the response body.
  */
-static void send_response(int client_socket, const char *status_code, const char *content_type, const char *body)
+static void send_response(BufWriter *out, const char *status_code, const char *content_type, const char *body)
 {
-    char response_buffer[BUFFER_SIZE];
     size_t body_len = strlen(body);
 
-    int response_len = snprintf(response_buffer, BUFFER_SIZE,
-                                "HTTP/1.1 %s\r\n"
-                                "Content-Type: %s\r\n"
-                                "Content-Length: %zu\r\n"
-                                "Connection: close\r\n\r\n"
-                                "%s",
-                                status_code, content_type, body_len, body);
-
-    if (response_len < 0)
-    {
-        // This should be rare, but it's good practice to check.
-        fprintf(stderr, "Error: snprintf failed when creating response.\n");
-        return;
-    }
-
-    size_t len_to_send = (size_t)response_len;
-
-    // If snprintf was truncated, it returns the number of bytes it *would* have
-    // written. We must not send more than our buffer's actual size.
-    if (len_to_send >= BUFFER_SIZE)
-    {
-        len_to_send = BUFFER_SIZE - 1; // The buffer is null-terminated.
-    }
-
-    // Send the response. It might take multiple calls if the buffer is large.
-    ssize_t bytes_sent = send(client_socket, response_buffer, len_to_send, 0);
-    if (bytes_sent < 0)
+    // Headers and body go out in one write when they fit the buffer; a body
+    // too large for it follows the headers directly, never truncated.
+    if (writer_printf(out,
+                      "HTTP/1.1 %s\r\n"
+                      "Content-Type: %s\r\n"
+                      "Content-Length: %zu\r\n"
+                      "Connection: close\r\n\r\n",
+                      status_code, content_type, body_len) != 0 ||
+        writer_write(out, body, body_len) != 0 || writer_flush(out) != 0)
     {
         perror("send failed");
-    }
-    else if ((size_t)bytes_sent < len_to_send)
-    {
-        fprintf(stderr, "Warning: Only sent %zd of %zu bytes.\n", bytes_sent, len_to_send);
+        out->length = 0; // Drop whatever is left for this client
     }
 }
 
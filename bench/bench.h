@@ -0,0 +1,201 @@
+/*******************************************************************************
+ * @file bench.h
+ * @brief Helpers shared by the benchmarks: timing, running the built apps
+ * and recording results.
+ *
+ * The macrobenchmarks run the apps as a user would, from the directory
+ * named by BENCH_APPS (default "bin"), so the same driver measures a debug,
+ * release or PGO build. Every result is printed and, when BENCH_RESULTS
+ * names a file, appended to it as a "name<TAB>value<TAB>unit" line for
+ * bench/compare.sh. Units ending in "/s" are better higher, all others
+ * better lower.
+ *
+ * Everything here is static inline, so each benchmark stays a single
+ * translation unit and unused helpers cost nothing. Define _XOPEN_SOURCE
+ * 700 before including it.
+ *
+ ******************************************************************************/
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+// --- Constants ---
+
+#define BENCH_PATH_MAX 4096
+#define BENCH_DEFAULT_APPS "bin"
+
+// --- Timing ---
+
+static inline double bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// --- Options ---
+
+/**
+ * @brief Returns 1 if the benchmark was asked for a short run, as `make pgo`
+ * does to train, else 0.
+ */
+static inline int bench_quick(int argc, char *argv[])
+{
+    return argc > 1 && strcmp(argv[1], "--quick") == 0;
+}
+
+/**
+ * @brief Writes `dir`/`name` into `path`, which holds BENCH_PATH_MAX bytes.
+ * @return 0 on success, -1 if the path is too long.
+ */
+static inline int bench_join(char *path, const char *dir, const char *name)
+{
+    if (snprintf(path, BENCH_PATH_MAX, "%s/%s", dir, name) >= BENCH_PATH_MAX)
+    {
+        fprintf(stderr, "Error: Path too long under '%s'.\n", dir);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Writes the absolute path of an app's binary under BENCH_APPS into
+ * `path`, so it can be run from any directory.
+ * @return 0 if the binary exists and is executable, -1 otherwise.
+ */
+static inline int bench_app(const char *name, char *path)
+{
+    const char *dir = getenv("BENCH_APPS");
+    char relative[BENCH_PATH_MAX];
+    if (bench_join(relative, dir != NULL ? dir : BENCH_DEFAULT_APPS, name) != 0)
+        return -1;
+    if (realpath(relative, path) == NULL || access(path, X_OK) != 0)
+    {
+        fprintf(stderr, "Error: Cannot run '%s'; build it first.\n", relative);
+        return -1;
+    }
+    return 0;
+}
+
+// --- Scratch Space ---
+
+/**
+ * @brief Creates a fresh directory for generated data under TMPDIR (default
+ * /tmp) and writes its path into `path`.
+ * @return 0 on success, -1 on failure.
+ */
+static inline int bench_tempdir(char *path)
+{
+    const char *tmp = getenv("TMPDIR");
+    snprintf(path, BENCH_PATH_MAX, "%s/c-repo-bench-XXXXXX", tmp != NULL ? tmp : "/tmp");
+    if (mkdtemp(path) == NULL)
+    {
+        perror("Failed to create a scratch directory");
+        return -1;
+    }
+    return 0;
+}
+
+// --- Running the Apps ---
+
+/**
+ * @brief Starts a program with stdin from `input` (or /dev/null) and its
+ * output discarded, in directory `dir` if that is not NULL.
+ * @return The child's pid, or -1 on failure.
+ */
+static inline pid_t bench_start(char *const argv[], const char *dir, const char *input)
+{
+    const pid_t pid = fork();
+    if (pid < 0)
+    {
+        perror("fork failed");
+        return -1;
+    }
+    if (pid == 0)
+    {
+        const int in = open(input != NULL ? input : "/dev/null", O_RDONLY);
+        const int null = open("/dev/null", O_WRONLY);
+        if (in < 0 || null < 0 || (dir != NULL && chdir(dir) != 0))
+            _exit(127);
+        dup2(in, STDIN_FILENO);
+        dup2(null, STDOUT_FILENO);
+        dup2(null, STDERR_FILENO);
+        execv(argv[0], argv);
+        _exit(127);
+    }
+    return pid;
+}
+
+/**
+ * @brief Waits for a program started by bench_start().
+ * @return 0 if it exited with status 0, -1 otherwise.
+ */
+static inline int bench_wait(pid_t pid, const char *name)
+{
+    int status;
+    if (waitpid(pid, &status, 0) < 0)
+    {
+        perror("waitpid failed");
+        return -1;
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        fprintf(stderr, "Error: '%s' failed.\n", name);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Runs a program to completion, as bench_start() starts it.
+ * @return The elapsed wall-clock seconds, or a negative value on failure.
+ */
+static inline double bench_run(char *const argv[], const char *dir, const char *input)
+{
+    const double start = bench_now();
+    const pid_t pid = bench_start(argv, dir, input);
+    if (pid < 0 || bench_wait(pid, argv[0]) != 0)
+        return -1;
+    return bench_now() - start;
+}
+
+/**
+ * @brief Removes a directory made by bench_tempdir() and everything in it.
+ */
+static inline void bench_remove(const char *path)
+{
+    char *argv[] = {"/bin/rm", "-rf", (char *)path, NULL};
+    bench_run(argv, NULL, NULL);
+}
+
+// --- Results ---
+
+/**
+ * @brief Prints one result and appends it to the file named by BENCH_RESULTS.
+ */
+static inline void bench_record(const char *name, double value, const char *unit)
+{
+    printf("  %-44s %12.3f %s\n", name, value, unit);
+    const char *results = getenv("BENCH_RESULTS");
+    if (results == NULL || *results == '\0')
+        return;
+    FILE *file = fopen(results, "a");
+    if (file == NULL)
+    {
+        perror("Failed to open the results file");
+        return;
+    }
+    fprintf(file, "%s\t%.6g\t%s\n", name, value, unit);
+    fclose(file);
+}
+
+#endif // BENCH_H
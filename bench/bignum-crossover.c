@@ -0,0 +1,207 @@
+/*******************************************************************************
+ * @file bignum-crossover.c
+ * @brief Measures where the calculator's exact arithmetic should switch
+ * between its multiplication and division algorithms.
+ *
+ * The calculator's source is compiled in whole, so the benchmark drives the
+ * very functions `--precision` uses. For each operand size it times:
+ *
+ *   - schoolbook multiplication against one level of Karatsuba on top of it;
+ *   - Karatsuba (at the tuned threshold) against one level of Toom-3;
+ *   - long division of a 2n-limb number by an n-limb one against division
+ *     through a Newton reciprocal.
+ *
+ * The crossover is the first size from which the faster algorithm keeps
+ * winning; compare it with the BIG_*_THRESHOLD defaults in calculator.c.
+ *
+ * @example
+ *   make bench
+ *
+ ******************************************************************************/
+
+#define main calculator_main
+#include "../apps/calculator/src/calculator.c"
+#undef main
+
+#include <time.h>
+
+// --- Constants ---
+
+#define BENCH_ROUNDS 5          // Each timing is the best of this many rounds...
+#define BENCH_MIN_SECONDS 0.01 // ...each repeating the operation for at least this long
+
+static const size_t MUL_SIZES[] = {8, 12, 16, 20, 24, 32, 40, 48, 64, 80, 96, 128, 160, 192, 256, 320, 384, 512, 768, 1024};
+static const size_t DIV_SIZES[] = {16, 32, 48, 64, 96, 128, 160, 192, 256, 384, 512, 768, 1024, 1536, 2048, 4096};
+
+// --- Function Prototypes ---
+
+static double now(void);
+static void random_number(BigInt *x, size_t limbs);
+static double time_multiply(const BigInt *a, const BigInt *b);
+static double time_divide(const BigInt *a, const BigInt *b);
+static size_t report_crossover(const char *title, const char *slow, const char *fast, const size_t *sizes,
+                               size_t count, const double *slow_times, const double *fast_times);
+
+// --- Main Application Logic ---
+
+int main(void)
+{
+    const size_t mul_count = sizeof(MUL_SIZES) / sizeof(MUL_SIZES[0]);
+    const size_t div_count = sizeof(DIV_SIZES) / sizeof(DIV_SIZES[0]);
+    double slow[sizeof(DIV_SIZES) / sizeof(DIV_SIZES[0]) + sizeof(MUL_SIZES) / sizeof(MUL_SIZES[0])];
+    double fast[sizeof(slow) / sizeof(slow[0])];
+    BigInt a, b;
+    big_init(&a);
+    big_init(&b);
+    srand(12345);
+
+    // Schoolbook against a single level of Karatsuba.
+    for (size_t i = 0; i < mul_count; ++i)
+    {
+        random_number(&a, MUL_SIZES[i]);
+        random_number(&b, MUL_SIZES[i]);
+        karatsuba_threshold = SIZE_MAX;
+        slow[i] = time_multiply(&a, &b);
+        karatsuba_threshold = MUL_SIZES[i];
+        toom3_threshold = SIZE_MAX;
+        fast[i] = time_multiply(&a, &b);
+    }
+    const size_t karatsuba = report_crossover("Multiplication", "schoolbook", "karatsuba", MUL_SIZES, mul_count, slow, fast);
+
+    // Karatsuba against a single level of Toom-3, both over the measured
+    // Karatsuba threshold.
+    for (size_t i = 0; i < mul_count; ++i)
+    {
+        random_number(&a, MUL_SIZES[i]);
+        random_number(&b, MUL_SIZES[i]);
+        karatsuba_threshold = karatsuba;
+        toom3_threshold = SIZE_MAX;
+        slow[i] = time_multiply(&a, &b);
+        toom3_threshold = MUL_SIZES[i];
+        fast[i] = time_multiply(&a, &b);
+    }
+    const size_t toom3 = report_crossover("Multiplication", "karatsuba", "toom-3", MUL_SIZES, mul_count, slow, fast);
+
+    // Long division against a Newton reciprocal, with the tuned multiplication.
+    karatsuba_threshold = karatsuba;
+    toom3_threshold = toom3;
+    for (size_t i = 0; i < div_count; ++i)
+    {
+        random_number(&a, 2 * DIV_SIZES[i]);
+        random_number(&b, DIV_SIZES[i]);
+        newton_threshold = SIZE_MAX;
+        slow[i] = time_divide(&a, &b);
+        newton_threshold = DIV_SIZES[i];
+        fast[i] = time_divide(&a, &b);
+    }
+    report_crossover("Division 2n/n", "long", "newton", DIV_SIZES, div_count, slow, fast);
+
+    printf("Built-in thresholds (limbs): karatsuba %d, toom-3 %d, newton %d\n",
+           BIG_KARATSUBA_THRESHOLD, BIG_TOOM3_THRESHOLD, BIG_NEWTON_THRESHOLD);
+    big_free(&a);
+    big_free(&b);
+    return EXIT_SUCCESS;
+}
+
+// --- Function Implementations ---
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Sets x to a random number of exactly `limbs` limbs.
+ */
+static void random_number(BigInt *x, size_t limbs)
+{
+    big_reserve(x, limbs);
+    for (size_t i = 0; i < limbs; ++i)
+        x->limbs[i] = (uint32_t)rand() << 16 ^ (uint32_t)rand();
+    x->limbs[limbs - 1] |= 0x80000000u;
+    x->length = limbs;
+    x->negative = 0;
+}
+
+/**
+ * @brief Returns the seconds one a * b takes, the best of BENCH_ROUNDS
+ * averages so that other load on the machine does not skew it.
+ */
+static double time_multiply(const BigInt *a, const BigInt *b)
+{
+    BigInt r;
+    big_init(&r);
+    double best = HUGE_VAL;
+    for (int round = 0; round < BENCH_ROUNDS; ++round)
+    {
+        size_t runs = 0;
+        const double start = now();
+        double elapsed;
+        do
+        {
+            big_mul(&r, a, b);
+            runs++;
+        } while ((elapsed = now() - start) < BENCH_MIN_SECONDS);
+        if (elapsed / (double)runs < best)
+            best = elapsed / (double)runs;
+    }
+    big_free(&r);
+    return best;
+}
+
+/**
+ * @brief Returns the seconds one a / b takes, as time_multiply does.
+ */
+static double time_divide(const BigInt *a, const BigInt *b)
+{
+    BigInt q, r;
+    big_init(&q);
+    big_init(&r);
+    double best = HUGE_VAL;
+    for (int round = 0; round < BENCH_ROUNDS; ++round)
+    {
+        size_t runs = 0;
+        const double start = now();
+        double elapsed;
+        do
+        {
+            big_divmod(&q, &r, a, b);
+            runs++;
+        } while ((elapsed = now() - start) < BENCH_MIN_SECONDS);
+        if (elapsed / (double)runs < best)
+            best = elapsed / (double)runs;
+    }
+    big_free(&q);
+    big_free(&r);
+    return best;
+}
+
+/**
+ * @brief Prints one comparison table.
+ * @return The first size from which `fast` wins at every larger size, or
+ * SIZE_MAX if it never settles within the sizes measured.
+ */
+static size_t report_crossover(const char *title, const char *slow, const char *fast, const size_t *sizes,
+                               size_t count, const double *slow_times, const double *fast_times)
+{
+    printf("%s: %s vs %s\n", title, slow, fast);
+    printf("  %6s  %12s  %12s  %7s\n", "limbs", slow, fast, "speedup");
+    size_t crossover = SIZE_MAX;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const double speedup = slow_times[i] / fast_times[i];
+        printf("  %6zu  %10.2fus  %10.2fus  %6.2fx\n", sizes[i], slow_times[i] * 1e6, fast_times[i] * 1e6, speedup);
+        if (speedup <= 1.0)
+            crossover = SIZE_MAX;
+        else if (crossover == SIZE_MAX)
+            crossover = sizes[i];
+    }
+    if (crossover == SIZE_MAX)
+        printf("  No crossover up to %zu limbs.\n\n", sizes[count - 1]);
+    else
+        printf("  Crossover: %zu limbs (%zu bits, about %zu digits).\n\n", crossover, crossover * 32,
+               (size_t)((double)crossover * 32 * 0.30103));
+    return crossover;
+}
@@ -0,0 +1,138 @@
+/*******************************************************************************
+ * @file calculator-throughput.c
+ * @brief Measures the calculator's bulk evaluation end to end, in rows per
+ * second.
+ *
+ * A CSV file of three columns is written from a fixed seed, and the
+ * calculator under BENCH_APPS evaluates expressions over it with `-e`,
+ * reading, parsing, evaluating and printing every row. Each expression is
+ * timed on one thread with the interpreter and with `--jit`, and on the
+ * default number of threads, best of BENCH_ROUNDS runs.
+ *
+ * bench/expression-evaluation.c measures evaluation alone.
+ *
+ * @example
+ *   make bench
+ *   BENCH_APPS=bin/release bin/bench/calculator-throughput
+ *
+ ******************************************************************************/
+
+#define _XOPEN_SOURCE 700 // For clock_gettime, fork, mkdtemp and realpath
+
+#include "bench.h"
+
+#include <stdint.h>
+
+// --- Constants ---
+
+#define ROWS 2000000      // Rows in the input...
+#define QUICK_ROWS 200000 // ...or with --quick
+#define BENCH_ROUNDS 3    // Each timing is the best of this many runs
+
+static const char *const EXPRESSIONS[][2] = {
+    {"arithmetic", "(x + y) * z - x / (y + 1)"},
+    {"functions", "sqrt(x * x + y * y) + sin(z)"},
+};
+
+// --- Function Prototypes ---
+
+static uint64_t next_random(uint64_t *state);
+static int write_input(const char *path, long rows);
+static int measure(const char *label, char *argv[], long rows);
+
+// --- Main Application Logic ---
+
+int main(int argc, char *argv[])
+{
+    char calculator[BENCH_PATH_MAX], dir[BENCH_PATH_MAX], input[BENCH_PATH_MAX];
+    if (bench_app("calculator", calculator) != 0 || bench_tempdir(dir) != 0)
+        return EXIT_FAILURE;
+
+    const long rows = bench_quick(argc, argv) ? QUICK_ROWS : ROWS;
+    int status = bench_join(input, dir, "input.csv");
+    if (status == 0)
+        status = write_input(input, rows);
+    if (status == 0)
+        printf("calculator: %ld rows\n", rows);
+    for (size_t i = 0; status == 0 && i < sizeof(EXPRESSIONS) / sizeof(EXPRESSIONS[0]); ++i)
+    {
+        char *expression = (char *)EXPRESSIONS[i][1];
+        char *interpreter[] = {calculator, "-e", expression, "--in", input, "--threads", "1", NULL};
+        char *jit[] = {calculator, "-e", expression, "--in", input, "--threads", "1", "--jit", NULL};
+        char *threaded[] = {calculator, "-e", expression, "--in", input, "--jit", NULL};
+        char label[64];
+        snprintf(label, sizeof(label), "calculator/%s/interpreter", EXPRESSIONS[i][0]);
+        status = measure(label, interpreter, rows);
+        snprintf(label, sizeof(label), "calculator/%s/jit", EXPRESSIONS[i][0]);
+        if (status == 0)
+            status = measure(label, jit, rows);
+        snprintf(label, sizeof(label), "calculator/%s/jit-threads", EXPRESSIONS[i][0]);
+        if (status == 0)
+            status = measure(label, threaded, rows);
+    }
+
+    bench_remove(dir);
+    return status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// --- Function Implementations ---
+
+/**
+ * @brief A xorshift generator, so the input is the same on every system.
+ */
+static uint64_t next_random(uint64_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/**
+ * @brief Writes `rows` rows of x, y and z: amounts with two decimals,
+ * integers and fractions, as such files usually hold.
+ * @return 0 on success, -1 on failure.
+ */
+static int write_input(const char *path, long rows)
+{
+    FILE *file = fopen(path, "w");
+    if (file == NULL)
+    {
+        perror("Failed to create the input");
+        return -1;
+    }
+    uint64_t state = 12345;
+    fputs("x,y,z\n", file);
+    for (long i = 0; i < rows; ++i)
+    {
+        const double x = (double)(next_random(&state) % 100000) / 100;
+        const long y = (long)(next_random(&state) % 100000);
+        const double z = (double)(next_random(&state) >> 11) / 9007199254740992.0 - 0.5;
+        fprintf(file, "%.2f,%ld,%.6f\n", x, y, z);
+    }
+    if (fclose(file) != 0)
+    {
+        perror("Failed to write the input");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Times one command and records rows per second.
+ * @return 0 on success, -1 on failure.
+ */
+static int measure(const char *label, char *argv[], long rows)
+{
+    double best = -1;
+    for (int round = 0; round < BENCH_ROUNDS; ++round)
+    {
+        const double elapsed = bench_run(argv, NULL, NULL);
+        if (elapsed < 0)
+            return -1;
+        if (best < 0 || elapsed < best)
+            best = elapsed;
+    }
+    bench_record(label, (double)rows / best / 1e6, "M rows/s");
+    return 0;
+}
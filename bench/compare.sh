@@ -0,0 +1,57 @@
+#!/bin/sh
+#
+# compare.sh - Compares two benchmark result files written by `make bench`.
+#
+# Each file holds "name<TAB>value<TAB>unit" lines. For every result in both,
+# prints the two values and the speedup of the second over the first:
+# above 1.00x is faster, whether the unit is a rate (ending in "/s", better
+# higher) or a time (better lower). Changes beyond the threshold, 5% by
+# default, are marked; results found in only one file are listed after.
+#
+# Usage:
+#   bench/compare.sh <before.tsv> <after.tsv> [threshold-percent]
+#
+# Example:
+#   make bench BENCH_RESULTS=before.tsv
+#   make release && make bench BENCH_APPS=bin/release BENCH_RESULTS=after.tsv
+#   bench/compare.sh before.tsv after.tsv
+
+if [ $# -lt 2 ] || [ $# -gt 3 ]; then
+    echo "Usage: $0 <before.tsv> <after.tsv> [threshold-percent]" >&2
+    exit 1
+fi
+for file in "$1" "$2"; do
+    if [ ! -r "$file" ]; then
+        echo "Error: Cannot read '$file'." >&2
+        exit 1
+    fi
+done
+
+awk -F '\t' -v threshold="${3:-5}" '
+    FNR == NR { before[$1] = $2; unit[$1] = $3; order[++count] = $1; next }
+    {
+        after[$1] = $2
+        if (!($1 in before)) { added[++added_count] = $1; unit[$1] = $3 }
+    }
+    END {
+        printf "%-44s %12s %12s %9s\n", "benchmark", "before", "after", "speedup"
+        faster = slower = 0
+        for (i = 1; i <= count; ++i) {
+            name = order[i]
+            if (!(name in after)) { removed[++removed_count] = name; continue }
+            old = before[name]; new = after[name]
+            if (old <= 0 || new <= 0) { speedup = 1 }
+            else if (unit[name] ~ /\/s$/) { speedup = new / old }
+            else { speedup = old / new }
+            mark = ""
+            if (speedup >= 1 + threshold / 100) { mark = "  faster"; faster++ }
+            else if (speedup <= 1 / (1 + threshold / 100)) { mark = "  SLOWER"; slower++ }
+            printf "%-44s %12.3f %12.3f %8.2fx%s  %s\n", name, old, new, speedup, mark, unit[name]
+        }
+        for (i = 1; i <= added_count; ++i)
+            printf "%-44s %12s %12.3f %9s  %s\n", added[i], "-", after[added[i]], "new", unit[added[i]]
+        for (i = 1; i <= removed_count; ++i)
+            printf "%-44s %12.3f %12s %9s  %s\n", removed[i], before[removed[i]], "-", "gone", unit[removed[i]]
+        printf "\n%d faster, %d slower by more than %s%%.\n", faster, slower, threshold
+    }
+' "$1" "$2"
@@ -0,0 +1,207 @@
+/*******************************************************************************
+ * @file contact-book-scale.c
+ * @brief Measures contact-book's commands on books of 10k to 1M contacts.
+ *
+ * For each size, a book of generated contacts is written as CSV, and every
+ * command is run as a fresh process, so each timing includes loading the
+ * book: the cost a user sees. Against the CSV book it times
+ *
+ *   - load: `list --limit 1`, which reads every contact;
+ *   - find, get and delete, each of one contact;
+ *
+ * then imports the same contacts into a binary book and times load, a
+ * scanning find, get, building the trigram index, an indexed find and
+ * delete there. Every timing is the best of BENCH_ROUNDS runs, in ms.
+ *
+ * @example
+ *   make bench
+ *   BENCH_APPS=bin/release bin/bench/contact-book-scale
+ *
+ ******************************************************************************/
+
+#define _XOPEN_SOURCE 700 // For clock_gettime, fork, mkdtemp and realpath
+
+#include "bench.h"
+
+#include <sys/stat.h>
+
+// --- Constants ---
+
+#define BENCH_ROUNDS 3 // Each timing is the best of this many runs
+#define NAME_MAX_LENGTH 64
+
+static const long SIZES[] = {10000, 100000, 1000000};
+static const long QUICK_SIZES[] = {10000, 100000};
+
+static const char *const FIRST_NAMES[] = {"Ada",   "Alan",  "Barbara", "Brian", "Claude", "Dennis", "Edsger", "Frances",
+                                          "Grace", "Hedy",  "Ivan",    "John",  "Ken",    "Linus",  "Margaret", "Niklaus"};
+static const char *const LAST_NAMES[] = {"Allen",   "Backus", "Dijkstra", "Hamilton", "Hopper",  "Kernighan",
+                                         "Knuth",   "Lamarr", "Liskov",   "McCarthy", "Ritchie", "Shannon",
+                                         "Thompson", "Torvalds", "Turing", "Wirth"};
+
+// --- Function Prototypes ---
+
+static void contact_name(long i, char *name);
+static int write_book(const char *path, long count);
+static int time_command(const char *label, long size, const char *dir, char *argv[], long vary);
+static int measure(const char *book, const char *dir, long size);
+
+// --- Main Application Logic ---
+
+int main(int argc, char *argv[])
+{
+    char book[BENCH_PATH_MAX], dir[BENCH_PATH_MAX];
+    if (bench_app("contact-book", book) != 0 || bench_tempdir(dir) != 0)
+        return EXIT_FAILURE;
+
+    const int quick = bench_quick(argc, argv);
+    const long *sizes = quick ? QUICK_SIZES : SIZES;
+    const size_t count = quick ? sizeof(QUICK_SIZES) / sizeof(QUICK_SIZES[0]) : sizeof(SIZES) / sizeof(SIZES[0]);
+    int status = 0;
+    for (size_t i = 0; status == 0 && i < count; ++i)
+    {
+        printf("contact-book: %ld contacts\n", sizes[i]);
+        status = measure(book, dir, sizes[i]);
+    }
+
+    bench_remove(dir);
+    return status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// --- Function Implementations ---
+
+/**
+ * @brief Writes the name of contact `i`: unique, and spread over the
+ * alphabet like real names.
+ */
+static void contact_name(long i, char *name)
+{
+    snprintf(name, NAME_MAX_LENGTH, "%s %s %ld", FIRST_NAMES[i % 16], LAST_NAMES[i / 16 % 16], i);
+}
+
+/**
+ * @brief Writes a CSV book of `count` generated contacts to `path`.
+ * @return 0 on success, -1 on failure.
+ */
+static int write_book(const char *path, long count)
+{
+    FILE *file = fopen(path, "w");
+    if (file == NULL)
+    {
+        perror("Failed to create a book");
+        return -1;
+    }
+    for (long i = 0; i < count; ++i)
+    {
+        char name[NAME_MAX_LENGTH];
+        contact_name(i, name);
+        fprintf(file, "%s,555-%04ld,%s.%s%ld@example.com\n", name, i % 10000, FIRST_NAMES[i % 16],
+                LAST_NAMES[i / 16 % 16], i);
+    }
+    if (fclose(file) != 0)
+    {
+        perror("Failed to write a book");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Times a command in the book's directory and records the best run.
+ *
+ * When `vary` is not negative, the last argument is replaced on each round
+ * by the name of a different contact, numbered from `vary`, so that commands
+ * like `delete` always find something to do.
+ * @return 0 on success, -1 on failure.
+ */
+static int time_command(const char *label, long size, const char *dir, char *argv[], long vary)
+{
+    char name[NAME_MAX_LENGTH];
+    int last = 0;
+    while (argv[last + 1] != NULL)
+        last++;
+    double best = -1;
+    for (int round = 0; round < BENCH_ROUNDS; ++round)
+    {
+        if (vary >= 0)
+        {
+            contact_name(vary + round, name);
+            argv[last] = name;
+        }
+        const double elapsed = bench_run(argv, dir, NULL);
+        if (elapsed < 0)
+            return -1;
+        if (best < 0 || elapsed < best)
+            best = elapsed;
+    }
+    char result[96];
+    snprintf(result, sizeof(result), "contact-book/%ld/%s", size, label);
+    bench_record(result, best * 1e3, "ms");
+    return 0;
+}
+
+/**
+ * @brief Runs every measurement on a book of `size` contacts.
+ * @return 0 on success, -1 on failure.
+ */
+static int measure(const char *book, const char *dir, long size)
+{
+    char csv_dir[BENCH_PATH_MAX], binary_dir[BENCH_PATH_MAX], path[BENCH_PATH_MAX], binary_book[BENCH_PATH_MAX];
+    char name[32];
+    snprintf(name, sizeof(name), "csv-%ld", size);
+    if (bench_join(csv_dir, dir, name) != 0)
+        return -1;
+    snprintf(name, sizeof(name), "binary-%ld", size);
+    if (bench_join(binary_dir, dir, name) != 0 || bench_join(binary_book, binary_dir, "contacts.cbk") != 0)
+        return -1;
+    if (mkdir(csv_dir, 0700) != 0 || mkdir(binary_dir, 0700) != 0)
+    {
+        perror("Failed to create a book directory");
+        return -1;
+    }
+    if (bench_join(path, csv_dir, "contacts.csv") != 0 || write_book(path, size) != 0)
+        return -1;
+    if (bench_join(path, binary_dir, "import.csv") != 0 || write_book(path, size) != 0)
+        return -1;
+
+    // Distinct contacts for each command, from the middle of the book.
+    char find_term[NAME_MAX_LENGTH], get_name[NAME_MAX_LENGTH];
+    contact_name(size / 2 + 1, find_term);
+    contact_name(size / 3 + 1, get_name);
+
+    char *list[] = {(char *)book, "list", "--limit", "1", NULL};
+    char *find[] = {(char *)book, "find", find_term, NULL};
+    char *get[] = {(char *)book, "get", get_name, NULL};
+    char *erase[] = {(char *)book, "delete", NULL, NULL};
+    char *import[] = {(char *)book, "import", path, NULL};
+    char *index[] = {(char *)book, "index", NULL};
+    if (time_command("csv/load", size, csv_dir, list, -1) != 0 ||
+        time_command("csv/find", size, csv_dir, find, -1) != 0 ||
+        time_command("csv/get", size, csv_dir, get, -1) != 0 ||
+        time_command("csv/delete", size, csv_dir, erase, size / 4) != 0)
+        return -1;
+
+    // Import once per round into an empty book; the last one stays.
+    double best = -1;
+    for (int round = 0; round < BENCH_ROUNDS; ++round)
+    {
+        unlink(binary_book);
+        const double elapsed = bench_run(import, binary_dir, NULL);
+        if (elapsed < 0)
+            return -1;
+        if (best < 0 || elapsed < best)
+            best = elapsed;
+    }
+    char result[96];
+    snprintf(result, sizeof(result), "contact-book/%ld/binary/import", size);
+    bench_record(result, best * 1e3, "ms");
+
+    if (time_command("binary/load", size, binary_dir, list, -1) != 0 ||
+        time_command("binary/find-scan", size, binary_dir, find, -1) != 0 ||
+        time_command("binary/get", size, binary_dir, get, -1) != 0 ||
+        time_command("binary/index", size, binary_dir, index, -1) != 0 ||
+        time_command("binary/find-indexed", size, binary_dir, find, -1) != 0 ||
+        time_command("binary/delete", size, binary_dir, erase, size / 4) != 0)
+        return -1;
+    return 0;
+}
@@ -0,0 +1,176 @@
+/*******************************************************************************
+ * @file expression-evaluation.c
+ * @brief Measures the calculator's expression evaluation alone, in
+ * evaluations per second.
+ *
+ * The calculator's source is compiled in whole, so the benchmark drives the
+ * very functions `-e` uses. Over columns of random values held in memory it
+ * times each expression:
+ *
+ *   - row by row through program_run, as a single `<expression>` runs;
+ *   - a block at a time through program_run_block, as `-e` runs;
+ *   - through native code from jit_compile, with SSE2 and, where the
+ *     processor has it, AVX, as `-e --jit` runs.
+ *
+ * The block and native results are checked against each other bit for bit.
+ * bench/calculator-throughput.c measures the same work end to end.
+ *
+ * @example
+ *   make bench
+ *
+ ******************************************************************************/
+
+#define main calculator_main
+#include "../apps/calculator/src/calculator.c"
+#undef main
+
+#include "bench.h"
+
+// --- Constants ---
+
+#define BENCH_ROWS (1 << 22) // Rows in the columns
+#define BENCH_ROUNDS 3       // Each timing is the best of this many passes
+#define BENCH_COLUMNS 3
+
+static const char *const COLUMN_NAMES[BENCH_COLUMNS] = {"x", "y", "z"};
+static const char *const EXPRESSIONS[][2] = {
+    {"arithmetic", "(x + y) * z - x / (y + 1)"},
+    {"functions", "sqrt(x * x + y * y) + sin(z)"},
+    {"deep", "((x + 1) * (y + 2) - (z + 3) * (x + 4)) / ((y + 5) * (z + 6) + 7)"},
+};
+
+// --- Function Prototypes ---
+
+static double time_rows(const Program *program, double *const *columns, double *out);
+static double time_blocks(const Program *program, double *const *columns, const double *scalars, double *stack,
+                          double *out);
+static double time_native(const JitCode *jit, double *const *columns, double *out);
+static void record(const char *expression, const char *method, double seconds);
+
+// --- Main Application Logic ---
+
+int main(void)
+{
+    double *columns[BENCH_COLUMNS];
+    static const double scalars[EXPR_MAX_VARIABLES]; // No bindings
+    double *expected = (double *)malloc(BENCH_ROWS * sizeof(double));
+    double *out = (double *)malloc(BENCH_ROWS * sizeof(double));
+    double *stack = (double *)malloc((EXPR_MAX_STACK + 1) * BULK_BLOCK * sizeof(double));
+    if (expected == NULL || out == NULL || stack == NULL)
+    {
+        perror("Failed to allocate memory for the columns");
+        return EXIT_FAILURE;
+    }
+    srand(12345);
+    for (int c = 0; c < BENCH_COLUMNS; ++c)
+    {
+        columns[c] = (double *)malloc(BENCH_ROWS * sizeof(double));
+        if (columns[c] == NULL)
+        {
+            perror("Failed to allocate memory for the columns");
+            return EXIT_FAILURE;
+        }
+        for (size_t i = 0; i < BENCH_ROWS; ++i)
+            columns[c][i] = (double)rand() / RAND_MAX * 200 - 100;
+    }
+    printf("Expression evaluation: %d rows\n", BENCH_ROWS);
+
+    int status = EXIT_SUCCESS;
+    for (size_t e = 0; e < sizeof(EXPRESSIONS) / sizeof(EXPRESSIONS[0]); ++e)
+    {
+        Program program;
+        if (program_compile(&program, EXPRESSIONS[e][1], COLUMN_NAMES, BENCH_COLUMNS, 0) != 0)
+            return EXIT_FAILURE;
+        record(EXPRESSIONS[e][0], "row", time_rows(&program, columns, out));
+        record(EXPRESSIONS[e][0], "block", time_blocks(&program, columns, scalars, stack, expected));
+
+        for (int avx = 0; avx <= 1; ++avx)
+        {
+            if (avx && !__builtin_cpu_supports("avx"))
+                continue;
+            JitCode jit;
+            jit_use_avx = avx;
+            if (jit_compile(&jit, &program, BENCH_COLUMNS, scalars) != 0)
+                continue;
+            record(EXPRESSIONS[e][0], avx ? "native-avx" : "native-sse2", time_native(&jit, columns, out));
+            if (memcmp(out, expected, BENCH_ROWS * sizeof(double)) != 0)
+            {
+                fprintf(stderr, "Error: Native code for '%s' differs from the interpreter.\n", EXPRESSIONS[e][1]);
+                status = EXIT_FAILURE;
+            }
+            jit_free(&jit);
+        }
+        program_free(&program);
+    }
+
+    for (int c = 0; c < BENCH_COLUMNS; ++c)
+        free(columns[c]);
+    free(expected);
+    free(out);
+    free(stack);
+    return status;
+}
+
+// --- Function Implementations ---
+
+static double time_rows(const Program *program, double *const *columns, double *out)
+{
+    double best = HUGE_VAL;
+    for (int round = 0; round < BENCH_ROUNDS; ++round)
+    {
+        const double start = bench_now();
+        for (size_t i = 0; i < BENCH_ROWS; ++i)
+        {
+            const double row[BENCH_COLUMNS] = {columns[0][i], columns[1][i], columns[2][i]};
+            program_run(program, row, &out[i]);
+        }
+        const double elapsed = bench_now() - start;
+        if (elapsed < best)
+            best = elapsed;
+    }
+    return best;
+}
+
+static double time_blocks(const Program *program, double *const *columns, const double *scalars, double *stack,
+                          double *out)
+{
+    double best = HUGE_VAL;
+    for (int round = 0; round < BENCH_ROUNDS; ++round)
+    {
+        const double start = bench_now();
+        for (size_t i = 0; i < BENCH_ROWS; i += BULK_BLOCK)
+        {
+            const double *block[BENCH_COLUMNS] = {columns[0] + i, columns[1] + i, columns[2] + i};
+            program_run_block(program, block, scalars, BULK_BLOCK, stack, out + i);
+        }
+        const double elapsed = bench_now() - start;
+        if (elapsed < best)
+            best = elapsed;
+    }
+    return best;
+}
+
+static double time_native(const JitCode *jit, double *const *columns, double *out)
+{
+    double best = HUGE_VAL;
+    for (int round = 0; round < BENCH_ROUNDS; ++round)
+    {
+        const double start = bench_now();
+        for (size_t i = 0; i < BENCH_ROWS; i += BULK_BLOCK)
+        {
+            const double *block[BENCH_COLUMNS] = {columns[0] + i, columns[1] + i, columns[2] + i};
+            jit->run(block, BULK_BLOCK, out + i);
+        }
+        const double elapsed = bench_now() - start;
+        if (elapsed < best)
+            best = elapsed;
+    }
+    return best;
+}
+
+static void record(const char *expression, const char *method, double seconds)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "expression/%s/%s", expression, method);
+    bench_record(name, BENCH_ROWS / seconds / 1e6, "M evaluations/s");
+}
@@ -0,0 +1,191 @@
+/*******************************************************************************
+ * @file file-analyzer-throughput.c
+ * @brief Measures file-analyzer's throughput in MB/s on generated corpora.
+ *
+ * Three corpora are written from a fixed seed, each of the same size:
+ *
+ *   - prose: words from a small vocabulary with punctuation, in lines of
+ *     about 70 characters;
+ *   - long lines: the same words in lines of about 10 KB;
+ *   - numbers: one short number per line, so per-line costs dominate.
+ *
+ * The analyzer under BENCH_APPS reads each one, best of BENCH_ROUNDS runs,
+ * with the file already in the page cache from the previous run. Prose is
+ * also read with each --io strategy forced, as file-analyzer/prose/<io>.
+ * Autotuning records go to the temporary directory, not the user's cache.
+ *
+ * @example
+ *   make bench
+ *   BENCH_APPS=bin/release bin/bench/file-analyzer-throughput
+ *
+ ******************************************************************************/
+
+#define _XOPEN_SOURCE 700 // For clock_gettime, fork, mkdtemp, realpath and setenv
+
+#include "bench.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// --- Constants ---
+
+#define CORPUS_BYTES (64L << 20)      // Size of each corpus...
+#define QUICK_CORPUS_BYTES (8L << 20) // ...or with --quick
+#define BENCH_ROUNDS 3                // Each timing is the best of this many runs
+
+static const char *const WORDS[] = {
+    "the",    "of",      "and",    "a",         "to",     "in",      "is",    "you",  "that",   "it",
+    "he",     "was",     "for",    "on",        "are",    "as",      "with",  "his",  "they",   "I",
+    "server", "request", "file",   "analysis",  "number", "contact", "value", "line", "memory", "buffer",
+    "quick",  "brown",   "fox",    "jumps",     "over",   "lazy",    "dog",   "well", "(see",   "below)",
+};
+static const char *const PUNCTUATION[] = {" ", " ", " ", " ", " ", " ", ", ", "; ", ". ", "! "};
+static const char *const IO_STRATEGIES[] = {"read", "mmap", "direct"};
+
+// --- Type Definitions ---
+
+typedef enum
+{
+    CORPUS_PROSE,
+    CORPUS_LONG_LINES,
+    CORPUS_NUMBERS
+} CorpusKind;
+
+// --- Function Prototypes ---
+
+static uint64_t next_random(uint64_t *state);
+static long write_corpus(const char *path, CorpusKind kind, long bytes);
+static int measure(const char *analyzer, const char *dir, const char *name, CorpusKind kind, long bytes,
+                   bool strategies);
+static int time_analyzer(const char *analyzer, const char *path, const char *io, const char *result, long bytes);
+
+// --- Main Application Logic ---
+
+int main(int argc, char *argv[])
+{
+    char analyzer[BENCH_PATH_MAX], dir[BENCH_PATH_MAX];
+    if (bench_app("file-analyzer", analyzer) != 0 || bench_tempdir(dir) != 0)
+        return EXIT_FAILURE;
+    setenv("XDG_CACHE_HOME", dir, 1);
+
+    const long bytes = bench_quick(argc, argv) ? QUICK_CORPUS_BYTES : CORPUS_BYTES;
+    printf("file-analyzer: %ld MB corpora\n", bytes >> 20);
+    int status = measure(analyzer, dir, "prose", CORPUS_PROSE, bytes, true);
+    if (status == 0)
+        status = measure(analyzer, dir, "long-lines", CORPUS_LONG_LINES, bytes, false);
+    if (status == 0)
+        status = measure(analyzer, dir, "numbers", CORPUS_NUMBERS, bytes, false);
+
+    bench_remove(dir);
+    return status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// --- Function Implementations ---
+
+/**
+ * @brief A xorshift generator, so the corpora are the same on every system.
+ */
+static uint64_t next_random(uint64_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/**
+ * @brief Writes about `bytes` bytes of the given kind of text to `path`.
+ * @return The exact number written, or -1 on failure.
+ */
+static long write_corpus(const char *path, CorpusKind kind, long bytes)
+{
+    FILE *file = fopen(path, "w");
+    if (file == NULL)
+    {
+        perror("Failed to create a corpus");
+        return -1;
+    }
+    const long line_length = kind == CORPUS_LONG_LINES ? 10000 : 70;
+    uint64_t state = 12345 + (uint64_t)kind;
+    long written = 0, line = 0;
+    while (written < bytes)
+    {
+        const uint64_t r = next_random(&state);
+        int n;
+        if (kind == CORPUS_NUMBERS)
+            n = fprintf(file, "%llu\n", (unsigned long long)(r % 1000000));
+        else
+        {
+            n = fprintf(file, "%s%s", WORDS[r % (sizeof(WORDS) / sizeof(WORDS[0]))],
+                        PUNCTUATION[(r >> 32) % (sizeof(PUNCTUATION) / sizeof(PUNCTUATION[0]))]);
+            line += n;
+            if (line >= line_length)
+            {
+                n += fputs("\n", file) >= 0;
+                line = 0;
+            }
+        }
+        written += n;
+    }
+    if (fclose(file) != 0)
+    {
+        perror("Failed to write a corpus");
+        return -1;
+    }
+    return written;
+}
+
+/**
+ * @brief Writes one corpus, times the analyzer over it and records MB/s;
+ * with `strategies`, once more for each --io strategy.
+ * @return 0 on success, -1 on failure.
+ */
+static int measure(const char *analyzer, const char *dir, const char *name, CorpusKind kind, long bytes,
+                   bool strategies)
+{
+    char path[BENCH_PATH_MAX];
+    if (bench_join(path, dir, name) != 0)
+        return -1;
+    const long written = write_corpus(path, kind, bytes);
+    if (written < 0)
+        return -1;
+
+    char result[64];
+    snprintf(result, sizeof(result), "file-analyzer/%s", name);
+    int status = time_analyzer(analyzer, path, NULL, result, written);
+    for (size_t i = 0; strategies && status == 0 && i < sizeof(IO_STRATEGIES) / sizeof(IO_STRATEGIES[0]); ++i)
+    {
+        snprintf(result, sizeof(result), "file-analyzer/%s/%s", name, IO_STRATEGIES[i]);
+        status = time_analyzer(analyzer, path, IO_STRATEGIES[i], result, written);
+    }
+    unlink(path);
+    return status;
+}
+
+/**
+ * @brief Runs the analyzer on `path`, with `--io=<io>` unless `io` is NULL,
+ * and records the best of BENCH_ROUNDS as `result` in MB/s.
+ * @return 0 on success, -1 on failure.
+ */
+static int time_analyzer(const char *analyzer, const char *path, const char *io, const char *result, long bytes)
+{
+    char option[32];
+    char *argv[] = {(char *)analyzer, (char *)path, NULL, NULL};
+    if (io != NULL)
+    {
+        snprintf(option, sizeof(option), "--io=%s", io);
+        argv[1] = option;
+        argv[2] = (char *)path;
+    }
+    double best = -1;
+    for (int round = 0; round < BENCH_ROUNDS; ++round)
+    {
+        const double elapsed = bench_run(argv, NULL, NULL);
+        if (elapsed < 0)
+            return -1;
+        if (best < 0 || elapsed < best)
+            best = elapsed;
+    }
+    bench_record(result, (double)bytes / best / 1e6, "MB/s");
+    return 0;
+}
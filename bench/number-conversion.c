@@ -0,0 +1,225 @@
+/*******************************************************************************
+ * @file number-conversion.c
+ * @brief Compares the calculator's number parsing and printing with the C
+ * library's.
+ *
+ * The calculator's source is compiled in whole, so the benchmark drives the
+ * very functions `-e` uses. Over a corpus of a few million numbers it times:
+ *
+ *   - strtod against parse_decimal (Clinger, then Eisel-Lemire);
+ *   - printf's "%.17g" against format_double (Grisu3, shortest round trip).
+ *
+ * Both are checked along the way: every parsed value must equal strtod's
+ * bit for bit, and every printed one must read back as the value printed.
+ * The corpus mixes random bit patterns, fractions in [0, 1), two-decimal
+ * amounts and integers, in equal shares, from a fixed seed.
+ *
+ * @example
+ *   make bench
+ *
+ ******************************************************************************/
+
+#define main calculator_main
+#include "../apps/calculator/src/calculator.c"
+#undef main
+
+#include <time.h>
+
+// --- Constants ---
+
+#define BENCH_NUMBERS 4000000 // Numbers in the corpus
+#define BENCH_ROUNDS 3        // Each timing is the best of this many passes
+
+// --- Function Prototypes ---
+
+static double now(void);
+static uint64_t next_random(uint64_t *state);
+static double corpus_value(uint64_t *state, int kind);
+static double time_strtod(const char *text, const size_t *offsets, double *values);
+static double time_parse_decimal(const char *text, const size_t *offsets, double *values);
+static double time_printf(const double *values, char *text);
+static double time_format_double(const double *values, char *text);
+static void report(const char *task, const char *slow, const char *fast, double slow_seconds, double fast_seconds);
+
+// --- Main Application Logic ---
+
+int main(void)
+{
+    double *values = (double *)malloc(BENCH_NUMBERS * sizeof(double));
+    double *parsed = (double *)malloc(BENCH_NUMBERS * sizeof(double));
+    size_t *offsets = (size_t *)malloc((BENCH_NUMBERS + 1) * sizeof(size_t));
+    char *text = (char *)malloc((size_t)BENCH_NUMBERS * NUMBER_MAX_TEXT);
+    if (values == NULL || parsed == NULL || offsets == NULL || text == NULL)
+    {
+        perror("Failed to allocate memory for the corpus");
+        return EXIT_FAILURE;
+    }
+
+    // The corpus, written the way data usually arrives: by printf.
+    uint64_t state = 12345;
+    size_t length = 0;
+    for (size_t i = 0; i < BENCH_NUMBERS; ++i)
+    {
+        const int kind = (int)(i % 4);
+        values[i] = corpus_value(&state, kind);
+        offsets[i] = length;
+        length += (size_t)sprintf(text + length, kind == 2 ? "%.2f" : "%.17g", values[i]) + 1;
+    }
+    offsets[BENCH_NUMBERS] = length;
+    printf("Corpus: %d numbers, %.1f MB of text\n\n", BENCH_NUMBERS, (double)length / 1e6);
+
+    // Parsing; strtod's results replace the originals as the reference.
+    const double strtod_seconds = time_strtod(text, offsets, values);
+    const double parse_seconds = time_parse_decimal(text, offsets, parsed);
+    size_t mismatches = 0;
+    for (size_t i = 0; i < BENCH_NUMBERS; ++i)
+        mismatches += memcmp(&parsed[i], &values[i], sizeof(double)) != 0;
+    report("Parsing", "strtod", "parse_decimal", strtod_seconds, parse_seconds);
+    printf("  Values differing from strtod: %zu\n\n", mismatches);
+
+    // Printing.
+    const double printf_seconds = time_printf(values, text);
+    const double format_seconds = time_format_double(values, text);
+    size_t failures = 0, printf_bytes = 0, format_bytes = 0;
+    for (size_t i = 0; i < BENCH_NUMBERS; ++i)
+    {
+        char shortest[NUMBER_MAX_TEXT], full[NUMBER_MAX_TEXT];
+        format_bytes += (size_t)(format_double(values[i], shortest) - shortest);
+        printf_bytes += (size_t)sprintf(full, "%.17g", values[i]);
+        failures += strtod(shortest, NULL) != values[i];
+    }
+    report("Printing", "%.17g", "format_double", printf_seconds, format_seconds);
+    printf("  Values not reading back: %zu; text %.1f MB against %.1f MB\n", failures, (double)format_bytes / 1e6,
+           (double)printf_bytes / 1e6);
+
+    free(values);
+    free(parsed);
+    free(offsets);
+    free(text);
+    return mismatches == 0 && failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// --- Function Implementations ---
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief A xorshift generator, so the corpus is the same on every system.
+ */
+static uint64_t next_random(uint64_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/**
+ * @brief Returns a number of the given kind: 0 for random bits, 1 for a
+ * fraction, 2 for a two-decimal amount, 3 for an integer.
+ */
+static double corpus_value(uint64_t *state, int kind)
+{
+    switch (kind)
+    {
+    case 0:
+        for (;;)
+        {
+            const uint64_t bits = next_random(state);
+            double value;
+            memcpy(&value, &bits, sizeof(value));
+            // Normal numbers only: strtod reports subnormals as out of range.
+            if (isnormal(value))
+                return value;
+        }
+    case 1:
+        return (double)(next_random(state) >> 11) / 9007199254740992.0;
+    case 2:
+        return (double)(next_random(state) % 10000000) / 100;
+    default:
+        return (double)(int64_t)(next_random(state) % 2000000001) - 1000000000;
+    }
+}
+
+static double time_strtod(const char *text, const size_t *offsets, double *values)
+{
+    double best = HUGE_VAL;
+    for (int round = 0; round < BENCH_ROUNDS; ++round)
+    {
+        const double start = now();
+        for (size_t i = 0; i < BENCH_NUMBERS; ++i)
+            values[i] = strtod(text + offsets[i], NULL);
+        const double elapsed = now() - start;
+        if (elapsed < best)
+            best = elapsed;
+    }
+    return best;
+}
+
+static double time_parse_decimal(const char *text, const size_t *offsets, double *values)
+{
+    double best = HUGE_VAL;
+    for (int round = 0; round < BENCH_ROUNDS; ++round)
+    {
+        const double start = now();
+        for (size_t i = 0; i < BENCH_NUMBERS; ++i)
+            parse_decimal(text + offsets[i], text + offsets[i + 1] - 1, &values[i]);
+        const double elapsed = now() - start;
+        if (elapsed < best)
+            best = elapsed;
+    }
+    return best;
+}
+
+static double time_printf(const double *values, char *text)
+{
+    double best = HUGE_VAL;
+    for (int round = 0; round < BENCH_ROUNDS; ++round)
+    {
+        const double start = now();
+        char *p = text;
+        for (size_t i = 0; i < BENCH_NUMBERS; ++i)
+            p += sprintf(p, "%.17g\n", values[i]);
+        const double elapsed = now() - start;
+        if (elapsed < best)
+            best = elapsed;
+    }
+    return best;
+}
+
+static double time_format_double(const double *values, char *text)
+{
+    double best = HUGE_VAL;
+    for (int round = 0; round < BENCH_ROUNDS; ++round)
+    {
+        const double start = now();
+        char *p = text;
+        for (size_t i = 0; i < BENCH_NUMBERS; ++i)
+        {
+            p = format_double(values[i], p);
+            *p++ = '\n';
+        }
+        const double elapsed = now() - start;
+        if (elapsed < best)
+            best = elapsed;
+    }
+    return best;
+}
+
+/**
+ * @brief Prints one comparison: throughput of each side and the speedup.
+ */
+static void report(const char *task, const char *slow, const char *fast, double slow_seconds, double fast_seconds)
+{
+    printf("%s: %s vs %s\n", task, slow, fast);
+    printf("  %-14s %8.1f ns/number  %6.1f M numbers/s\n", slow, slow_seconds / BENCH_NUMBERS * 1e9,
+           BENCH_NUMBERS / slow_seconds / 1e6);
+    printf("  %-14s %8.1f ns/number  %6.1f M numbers/s\n", fast, fast_seconds / BENCH_NUMBERS * 1e9,
+           BENCH_NUMBERS / fast_seconds / 1e6);
+    printf("  Speedup: %.2fx\n", slow_seconds / fast_seconds);
+}
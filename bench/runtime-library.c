@@ -0,0 +1,397 @@
+/*******************************************************************************
+ * @file runtime-library.c
+ * @brief Measures the shared runtime library in lib/ against what the
+ * applications used before it.
+ *
+ * Each building block is timed beside the C library or POSIX call it
+ * replaces:
+ *
+ *   - arena_strdup against strdup and free, for many short strings;
+ *   - reader_read_line against fgets, over a file of text lines;
+ *   - hashmap_put and hashmap_lookup, for hits and misses;
+ *   - vector_append against a fixed array (the upper bound);
+ *   - pool_submit against a pthread_create and pthread_join per task;
+ *   - the cost of one timing_now_ns reading.
+ *
+ * @example
+ *   make bench
+ *
+ ******************************************************************************/
+
+#define _XOPEN_SOURCE 700 // For realpath, in bench.h
+
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "bench.h"
+
+#include "arena.h"
+#include "bufio.h"
+#include "hashmap.h"
+#include "threadpool.h"
+#include "timing.h"
+#include "vector.h"
+
+// --- Constants ---
+
+#define BENCH_ROUNDS 3           // Each timing is the best of this many passes
+#define BENCH_STRINGS 1000000    // Strings copied by the allocation passes
+#define BENCH_LINES 2000000      // Lines in the text file
+#define BENCH_KEYS 1000000       // Keys in the hash map
+#define BENCH_PUSHES 10000000    // Elements appended to the vector
+#define BENCH_POOL_TASKS 200000  // Tasks run through the pool
+#define BENCH_THREAD_TASKS 20000 // Tasks run on threads of their own
+#define BENCH_CLOCK_READS 10000000
+
+// --- Type Definitions ---
+
+typedef double (*Pass)(void *context);
+
+typedef struct
+{
+    char *text; // BENCH_STRINGS NUL-terminated strings, back to back
+    char **copies;
+} Strings;
+
+typedef struct
+{
+    char path[BENCH_PATH_MAX];
+    size_t lines; // Counted by the last pass, for checking
+} TextFile;
+
+typedef struct
+{
+    char *keys; // BENCH_KEYS keys of 16 bytes each
+    HashMap map;
+} Keys;
+
+// --- Globals ---
+
+static atomic_long tasks_run; // Incremented by every task
+static volatile uint64_t clock_sink;
+
+// --- Function Prototypes ---
+
+static double best_of(Pass pass, void *context);
+static uint64_t next_random(uint64_t *state);
+static void record(const char *name, double count, double seconds, const char *unit);
+
+// Passes
+static double pass_arena(void *context);
+static double pass_malloc(void *context);
+static double pass_reader(void *context);
+static double pass_fgets(void *context);
+static double pass_hashmap_put(void *context);
+static double pass_hashmap_hit(void *context);
+static double pass_hashmap_miss(void *context);
+static double pass_vector(void *context);
+static double pass_array(void *context);
+static double pass_pool(void *context);
+static double pass_threads(void *context);
+static void count_task(void *arg);
+static void *count_thread(void *arg);
+
+// --- Main Application Logic ---
+
+int main(void)
+{
+    // Short strings of 8 to 39 characters, the size of names and emails.
+    Strings strings = {malloc((size_t)BENCH_STRINGS * 40), malloc(BENCH_STRINGS * sizeof(char *))};
+    Keys keys = {malloc((size_t)BENCH_KEYS * 16), {0}};
+    if (strings.text == NULL || strings.copies == NULL || keys.keys == NULL)
+    {
+        perror("Failed to allocate memory for the inputs");
+        return EXIT_FAILURE;
+    }
+    uint64_t state = 12345;
+    char *p = strings.text;
+    for (int i = 0; i < BENCH_STRINGS; ++i)
+    {
+        const int length = 8 + (int)(next_random(&state) % 32);
+        for (int c = 0; c < length; ++c)
+            *p++ = (char)('a' + next_random(&state) % 26);
+        *p++ = '\0';
+    }
+    for (int i = 0; i < BENCH_KEYS; ++i)
+        snprintf(keys.keys + (size_t)i * 16, 16, "key-%011d", i);
+
+    char dir[BENCH_PATH_MAX];
+    TextFile file;
+    if (bench_tempdir(dir) != 0 || bench_join(file.path, dir, "lines.txt") != 0)
+        return EXIT_FAILURE;
+    FILE *out = fopen(file.path, "w");
+    if (out == NULL)
+    {
+        perror("Failed to create the text file");
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < BENCH_LINES; ++i)
+        fprintf(out, "%d,Person %d,555-%04d,person%d@example.com\n", i, i, i % 10000, i);
+    const long file_size = ftell(out);
+    fclose(out);
+
+    printf("Runtime library\n");
+    const double arena_seconds = best_of(pass_arena, &strings);
+    const double malloc_seconds = best_of(pass_malloc, &strings);
+    record("runtime/strings/arena", BENCH_STRINGS, arena_seconds, "M strings/s");
+    record("runtime/strings/malloc", BENCH_STRINGS, malloc_seconds, "M strings/s");
+
+    const double reader_seconds = best_of(pass_reader, &file);
+    const size_t reader_lines = file.lines;
+    const double fgets_seconds = best_of(pass_fgets, &file);
+    record("runtime/lines/reader", (double)file_size, reader_seconds, "MB/s");
+    record("runtime/lines/fgets", (double)file_size, fgets_seconds, "MB/s");
+    if (reader_lines != BENCH_LINES || file.lines != BENCH_LINES)
+    {
+        fprintf(stderr, "Error: counted %zu and %zu lines, expected %d.\n", reader_lines, file.lines, BENCH_LINES);
+        return EXIT_FAILURE;
+    }
+
+    record("runtime/hashmap/put", BENCH_KEYS, best_of(pass_hashmap_put, &keys), "M operations/s");
+    record("runtime/hashmap/hit", BENCH_KEYS, best_of(pass_hashmap_hit, &keys), "M operations/s");
+    record("runtime/hashmap/miss", BENCH_KEYS, best_of(pass_hashmap_miss, &keys), "M operations/s");
+    hashmap_free(&keys.map);
+
+    record("runtime/append/vector", BENCH_PUSHES, best_of(pass_vector, NULL), "M elements/s");
+    record("runtime/append/array", BENCH_PUSHES, best_of(pass_array, NULL), "M elements/s");
+
+    record("runtime/tasks/pool", BENCH_POOL_TASKS, best_of(pass_pool, NULL), "M tasks/s");
+    record("runtime/tasks/threads", BENCH_THREAD_TASKS, best_of(pass_threads, NULL), "M tasks/s");
+
+    Stopwatch stopwatch;
+    stopwatch_start(&stopwatch);
+    for (int i = 0; i < BENCH_CLOCK_READS; ++i)
+        clock_sink = timing_now_ns();
+    bench_record("runtime/timing/read", (double)stopwatch_elapsed_ns(&stopwatch) / BENCH_CLOCK_READS, "ns");
+
+    bench_remove(dir);
+    free(strings.text);
+    free(strings.copies);
+    free(keys.keys);
+    return EXIT_SUCCESS;
+}
+
+// --- Helpers ---
+
+static double best_of(Pass pass, void *context)
+{
+    double best = HUGE_VAL;
+    for (int round = 0; round < BENCH_ROUNDS; ++round)
+    {
+        const double seconds = pass(context);
+        if (seconds < best)
+            best = seconds;
+    }
+    return best;
+}
+
+static uint64_t next_random(uint64_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static void record(const char *name, double count, double seconds, const char *unit)
+{
+    bench_record(name, count / seconds / 1e6, unit);
+}
+
+// --- Allocation ---
+
+static double pass_arena(void *context)
+{
+    Strings *strings = (Strings *)context;
+    const double start = bench_now();
+    Arena arena = {0};
+    const char *s = strings->text;
+    for (int i = 0; i < BENCH_STRINGS; ++i)
+    {
+        strings->copies[i] = arena_strdup(&arena, s);
+        s += strlen(s) + 1;
+    }
+    arena_release(&arena);
+    return bench_now() - start;
+}
+
+static double pass_malloc(void *context)
+{
+    Strings *strings = (Strings *)context;
+    const double start = bench_now();
+    const char *s = strings->text;
+    for (int i = 0; i < BENCH_STRINGS; ++i)
+    {
+        strings->copies[i] = strdup(s);
+        s += strlen(s) + 1;
+    }
+    for (int i = 0; i < BENCH_STRINGS; ++i)
+        free(strings->copies[i]);
+    return bench_now() - start;
+}
+
+// --- Line Reading ---
+
+static double pass_reader(void *context)
+{
+    TextFile *file = (TextFile *)context;
+    const double start = bench_now();
+    const int fd = open(file->path, O_RDONLY);
+    BufReader reader;
+    if (fd < 0 || reader_init(&reader, fd, 0) != 0)
+    {
+        perror("Failed to open the text file");
+        exit(EXIT_FAILURE);
+    }
+    const char *line;
+    size_t length;
+    file->lines = 0;
+    while (reader_read_line(&reader, &line, &length) == 1)
+        file->lines++;
+    reader_free(&reader);
+    close(fd);
+    return bench_now() - start;
+}
+
+static double pass_fgets(void *context)
+{
+    TextFile *file = (TextFile *)context;
+    const double start = bench_now();
+    FILE *in = fopen(file->path, "r");
+    if (in == NULL)
+    {
+        perror("Failed to open the text file");
+        exit(EXIT_FAILURE);
+    }
+    char line[4096];
+    file->lines = 0;
+    while (fgets(line, sizeof(line), in) != NULL)
+        file->lines++;
+    fclose(in);
+    return bench_now() - start;
+}
+
+// --- Hash Map ---
+
+static double pass_hashmap_put(void *context)
+{
+    Keys *keys = (Keys *)context;
+    hashmap_free(&keys->map);
+    const double start = bench_now();
+    for (int i = 0; i < BENCH_KEYS; ++i)
+        hashmap_put(&keys->map, keys->keys + (size_t)i * 16, 15, keys);
+    return bench_now() - start;
+}
+
+static double pass_hashmap_hit(void *context)
+{
+    Keys *keys = (Keys *)context;
+    size_t found = 0;
+    const double start = bench_now();
+    for (int i = 0; i < BENCH_KEYS; ++i)
+        found += hashmap_lookup(&keys->map, keys->keys + (size_t)i * 16, 15) != NULL;
+    const double seconds = bench_now() - start;
+    if (found != BENCH_KEYS)
+    {
+        fprintf(stderr, "Error: found %zu of %d keys.\n", found, BENCH_KEYS);
+        exit(EXIT_FAILURE);
+    }
+    return seconds;
+}
+
+static double pass_hashmap_miss(void *context)
+{
+    Keys *keys = (Keys *)context;
+    size_t found = 0;
+    const double start = bench_now();
+    for (int i = 0; i < BENCH_KEYS; ++i)
+        found += hashmap_lookup(&keys->map, keys->keys + (size_t)i * 16, 14) != NULL; // A prefix of each key
+    const double seconds = bench_now() - start;
+    if (found != 0)
+    {
+        fprintf(stderr, "Error: found %zu keys that were never added.\n", found);
+        exit(EXIT_FAILURE);
+    }
+    return seconds;
+}
+
+// --- Appending ---
+
+static double pass_vector(void *context)
+{
+    (void)context;
+    const double start = bench_now();
+    Vector vector;
+    vector_init(&vector, sizeof(int));
+    for (int i = 0; i < BENCH_PUSHES; ++i)
+        vector_append(&vector, &i);
+    const int last = *(const int *)vector_at(&vector, vector.length - 1);
+    vector_free(&vector);
+    const double seconds = bench_now() - start;
+    return last == BENCH_PUSHES - 1 ? seconds : HUGE_VAL;
+}
+
+static double pass_array(void *context)
+{
+    (void)context;
+    const double start = bench_now();
+    int *array = (int *)malloc(BENCH_PUSHES * sizeof(int));
+    if (array == NULL)
+        return HUGE_VAL;
+    for (int i = 0; i < BENCH_PUSHES; ++i)
+        array[i] = i;
+    const int last = *(volatile int *)&array[BENCH_PUSHES - 1];
+    free(array);
+    const double seconds = bench_now() - start;
+    return last == BENCH_PUSHES - 1 ? seconds : HUGE_VAL;
+}
+
+// --- Tasks ---
+
+static void count_task(void *arg)
+{
+    (void)arg;
+    atomic_fetch_add(&tasks_run, 1);
+}
+
+static void *count_thread(void *arg)
+{
+    count_task(arg);
+    return NULL;
+}
+
+static double pass_pool(void *context)
+{
+    (void)context;
+    ThreadPool *pool = pool_create(0);
+    if (pool == NULL)
+    {
+        perror("Failed to start the thread pool");
+        exit(EXIT_FAILURE);
+    }
+    atomic_store(&tasks_run, 0);
+    const double start = bench_now();
+    for (int i = 0; i < BENCH_POOL_TASKS; ++i)
+        pool_submit(pool, count_task, NULL);
+    pool_wait(pool);
+    const double seconds = bench_now() - start;
+    pool_destroy(pool);
+    return atomic_load(&tasks_run) == BENCH_POOL_TASKS ? seconds : HUGE_VAL;
+}
+
+static double pass_threads(void *context)
+{
+    (void)context;
+    atomic_store(&tasks_run, 0);
+    const double start = bench_now();
+    for (int i = 0; i < BENCH_THREAD_TASKS; ++i)
+    {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, count_thread, NULL) == 0)
+            pthread_join(thread, NULL);
+    }
+    const double seconds = bench_now() - start;
+    return atomic_load(&tasks_run) == BENCH_THREAD_TASKS ? seconds : HUGE_VAL;
+}
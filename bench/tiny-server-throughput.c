@@ -0,0 +1,242 @@
+/*******************************************************************************
+ * @file tiny-server-throughput.c
+ * @brief Measures tiny-server's request throughput and latency over loopback.
+ *
+ * The server under BENCH_APPS is started on its usual port, and clients on
+ * separate threads each send a fixed number of `GET /` requests one after
+ * another, one connection per request as the server expects. Each client
+ * count is reported as requests per second overall and as the median and
+ * 99th-percentile time from connect to the end of the response.
+ *
+ * The port must be free: stop any running tiny-server first.
+ *
+ * @example
+ *   make bench
+ *   BENCH_APPS=bin/release bin/bench/tiny-server-throughput
+ *
+ ******************************************************************************/
+
+#define _XOPEN_SOURCE 700 // For clock_gettime, fork, mkdtemp and realpath
+
+#include "bench.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sys/socket.h>
+
+// --- Constants ---
+
+#define SERVER_PORT 8080        // Fixed in tiny-server.c
+#define REQUESTS 20000          // Requests per client count...
+#define QUICK_REQUESTS 2000     // ...or with --quick
+#define MAX_CLIENTS 16
+#define STARTUP_SECONDS 5.0     // How long to wait for the server to listen
+#define RESPONSE_BUFFER 4096
+
+static const int CLIENT_COUNTS[] = {1, 4, 16};
+
+// --- Type Definitions ---
+
+typedef struct
+{
+    int requests;       // Requests to send
+    double *latencies;  // Seconds each one took
+    int failures;
+} Client;
+
+// --- Function Prototypes ---
+
+static int connect_server(void);
+static int wait_for_server(void);
+static int request(void);
+static void *client_thread(void *arg);
+static int compare_doubles(const void *a, const void *b);
+static int run_clients(int client_count, int requests);
+
+// --- Main Application Logic ---
+
+int main(int argc, char *argv[])
+{
+    char server[BENCH_PATH_MAX];
+    if (bench_app("tiny-server", server) != 0)
+        return EXIT_FAILURE;
+    signal(SIGPIPE, SIG_IGN);
+
+    char *server_argv[] = {server, NULL};
+    const pid_t pid = bench_start(server_argv, NULL, NULL);
+    if (pid < 0)
+        return EXIT_FAILURE;
+    int status = wait_for_server();
+    if (status != 0)
+        fprintf(stderr, "Error: tiny-server did not start listening on port %d.\n", SERVER_PORT);
+
+    const int requests = bench_quick(argc, argv) ? QUICK_REQUESTS : REQUESTS;
+    printf("tiny-server: %d requests per client count\n", requests);
+    for (size_t i = 0; status == 0 && i < sizeof(CLIENT_COUNTS) / sizeof(CLIENT_COUNTS[0]); ++i)
+        status = run_clients(CLIENT_COUNTS[i], requests);
+
+    // SIGINT shuts the server down cleanly, so profiles get written.
+    kill(pid, SIGINT);
+    if (bench_wait(pid, server) != 0)
+        status = -1;
+    return status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// --- Function Implementations ---
+
+static int connect_server(void)
+{
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(SERVER_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief Polls until the server accepts connections.
+ * @return 0 once it does, -1 if it has not within STARTUP_SECONDS.
+ */
+static int wait_for_server(void)
+{
+    const double deadline = bench_now() + STARTUP_SECONDS;
+    while (bench_now() < deadline)
+    {
+        const int fd = connect_server();
+        if (fd >= 0)
+        {
+            close(fd);
+            return 0;
+        }
+        const struct timespec pause = {0, 10 * 1000 * 1000};
+        nanosleep(&pause, NULL);
+    }
+    return -1;
+}
+
+/**
+ * @brief Sends one request and reads the response until the server closes
+ * the connection.
+ * @return 0 if a complete 200 response arrived, -1 otherwise.
+ */
+static int request(void)
+{
+    static const char REQUEST[] = "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    const int fd = connect_server();
+    if (fd < 0)
+        return -1;
+    // Reset rather than linger, so tens of thousands of connections do not
+    // use up the ephemeral ports.
+    const struct linger reset = {1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_LINGER, &reset, sizeof(reset));
+
+    int status = send(fd, REQUEST, sizeof(REQUEST) - 1, 0) == (ssize_t)(sizeof(REQUEST) - 1) ? 0 : -1;
+    char response[RESPONSE_BUFFER];
+    size_t length = 0;
+    while (status == 0)
+    {
+        const ssize_t n = recv(fd, response + length, sizeof(response) - 1 - length, 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        length += (size_t)n;
+        if (length == sizeof(response) - 1)
+            break;
+    }
+    response[length] = '\0';
+    close(fd);
+    if (status != 0 || strncmp(response, "HTTP/1.1 200 OK", 15) != 0)
+        return -1;
+    return 0;
+}
+
+static void *client_thread(void *arg)
+{
+    Client *client = (Client *)arg;
+    for (int i = 0; i < client->requests; ++i)
+    {
+        const double start = bench_now();
+        if (request() != 0)
+            client->failures++;
+        client->latencies[i] = bench_now() - start;
+    }
+    return NULL;
+}
+
+static int compare_doubles(const void *a, const void *b)
+{
+    const double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Sends `requests` requests split across `client_count` clients and
+ * records the throughput and latency percentiles.
+ * @return 0 on success, -1 if any request failed.
+ */
+static int run_clients(int client_count, int requests)
+{
+    Client clients[MAX_CLIENTS];
+    pthread_t threads[MAX_CLIENTS];
+    const int per_client = requests / client_count;
+    double *latencies = (double *)malloc((size_t)per_client * client_count * sizeof(double));
+    if (latencies == NULL)
+    {
+        perror("Failed to allocate latencies");
+        return -1;
+    }
+
+    int started = 0;
+    const double start = bench_now();
+    for (; started < client_count; ++started)
+    {
+        clients[started] = (Client){per_client, latencies + (size_t)started * per_client, 0};
+        if (pthread_create(&threads[started], NULL, client_thread, &clients[started]) != 0)
+        {
+            perror("pthread_create failed");
+            break;
+        }
+    }
+    int failures = started == client_count ? 0 : 1;
+    for (int i = 0; i < started; ++i)
+    {
+        pthread_join(threads[i], NULL);
+        failures += clients[i].failures;
+    }
+    const double elapsed = bench_now() - start;
+
+    const size_t total = (size_t)per_client * started;
+    if (total == 0)
+    {
+        free(latencies);
+        return -1;
+    }
+    qsort(latencies, total, sizeof(double), compare_doubles);
+    char name[64];
+    snprintf(name, sizeof(name), "tiny-server/clients-%d/throughput", client_count);
+    bench_record(name, (double)total / elapsed, "requests/s");
+    snprintf(name, sizeof(name), "tiny-server/clients-%d/p50", client_count);
+    bench_record(name, latencies[total / 2] * 1e6, "us");
+    snprintf(name, sizeof(name), "tiny-server/clients-%d/p99", client_count);
+    bench_record(name, latencies[total * 99 / 100] * 1e6, "us");
+    free(latencies);
+
+    if (failures != 0)
+    {
+        fprintf(stderr, "Error: %d of %zu requests failed.\n", failures, total);
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,68 @@
+/*******************************************************************************
+ * @file arena.h
+ * @brief A bump allocator: many small allocations, freed all at once.
+ *
+ * Allocations are carved back to back out of large blocks, so they cost a
+ * pointer increment and sit next to each other in memory. Nothing is freed
+ * individually; arena_reset() recycles the arena for reuse and
+ * arena_release() returns all of its memory.
+ *
+ * A zero-initialized Arena is empty and ready to use.
+ *
+ ******************************************************************************/
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// --- Constants and Type Definitions ---
+
+#define ARENA_DEFAULT_BLOCK_SIZE (64 * 1024)
+
+typedef struct ArenaBlock ArenaBlock;
+
+typedef struct
+{
+    ArenaBlock *head;  // The block allocations come from; older ones follow
+    size_t block_size; // Minimum size of new blocks, or 0 for the default
+} Arena;
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Returns `size` bytes aligned to `align` (a power of two), or NULL
+ * if a new block could not be allocated.
+ */
+void *arena_alloc(Arena *arena, size_t size, size_t align);
+
+/**
+ * @brief Ensures the current block has room for at least `bytes` more bytes,
+ * so that the allocations that follow are contiguous.
+ * @return 0 on success, -1 if a new block could not be allocated.
+ */
+int arena_reserve(Arena *arena, size_t bytes);
+
+/**
+ * @brief Copies a NUL-terminated string into the arena.
+ * @return The copy, or NULL on allocation failure.
+ */
+char *arena_strdup(Arena *arena, const char *str);
+
+/**
+ * @brief Copies `length` bytes into the arena and NUL-terminates them.
+ * @return The copy, or NULL on allocation failure.
+ */
+char *arena_strndup(Arena *arena, const char *str, size_t length);
+
+/**
+ * @brief Discards every allocation but keeps the newest block for reuse.
+ */
+void arena_reset(Arena *arena);
+
+/**
+ * @brief Frees every block; the arena is empty again afterwards.
+ */
+void arena_release(Arena *arena);
+
+#endif // ARENA_H
@@ -0,0 +1,117 @@
+/*******************************************************************************
+ * @file bufio.h
+ * @brief Buffered reading and writing over raw file descriptors.
+ *
+ * A BufReader reads large blocks with read(2) into one buffer and hands
+ * out views of it, so callers scan the data in place instead of copying it
+ * a line at a time as stdio does. A BufWriter gathers small writes into one
+ * buffer and passes large ones straight through, so a response or a report
+ * leaves in as few write(2) calls as possible.
+ *
+ * Buffers are page-aligned, which O_DIRECT reads require. Reads return as
+ * soon as any data has arrived, so pipes, sockets and terminals are served
+ * a line at a time; interrupted reads and partial writes are retried.
+ * Functions returning int give 0 on success and -1 on error with errno
+ * set; nothing is printed.
+ *
+ ******************************************************************************/
+
+#ifndef BUFIO_H
+#define BUFIO_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+// --- Constants and Type Definitions ---
+
+#define BUFIO_DEFAULT_CAPACITY (64 * 1024)
+#define BUFIO_ALIGNMENT 4096
+
+typedef struct
+{
+    int fd;
+    char *buffer;
+    size_t capacity;
+    size_t start; // Unconsumed data is buffer[start, end)
+    size_t end;
+    int eof;
+} BufReader;
+
+typedef struct
+{
+    int fd;
+    char *buffer;
+    size_t capacity;
+    size_t length; // Bytes waiting to be written
+} BufWriter;
+
+// --- Reader Prototypes ---
+
+/**
+ * @brief Prepares a reader over `fd` with a buffer of `capacity` bytes (0
+ * for the default), rounded up to BUFIO_ALIGNMENT.
+ */
+int reader_init(BufReader *reader, int fd, size_t capacity);
+
+/**
+ * @brief Returns the next block of data in place, refilling the buffer as
+ * needed, and consumes it.
+ * @return 1 with *data and *length set, 0 at end of input, -1 on error.
+ */
+int reader_next(BufReader *reader, const char **data, size_t *length);
+
+/**
+ * @brief Returns the next line in place, including its '\n' unless it is
+ * the last line and has none, and consumes it. The buffer grows to hold
+ * lines longer than it. The view is valid until the next call.
+ * @return 1 with *line and *length set, 0 at end of input, -1 on error.
+ */
+int reader_read_line(BufReader *reader, const char **line, size_t *length);
+
+/**
+ * @brief Copies up to `n` bytes into `dst`.
+ * @return The number of bytes copied (0 at end of input), or -1 on error.
+ */
+ssize_t reader_read(BufReader *reader, void *dst, size_t n);
+
+/**
+ * @brief Frees the buffer; the descriptor is left open.
+ */
+void reader_free(BufReader *reader);
+
+// --- Writer Prototypes ---
+
+/**
+ * @brief Prepares a writer over `fd` with a buffer of `capacity` bytes (0
+ * for the default).
+ */
+int writer_init(BufWriter *writer, int fd, size_t capacity);
+
+/**
+ * @brief Buffers `n` bytes, writing them straight out when they would not
+ * fit in an empty buffer.
+ */
+int writer_write(BufWriter *writer, const void *data, size_t n);
+
+/**
+ * @brief Buffers a NUL-terminated string.
+ */
+int writer_puts(BufWriter *writer, const char *str);
+
+/**
+ * @brief Formats into the buffer, as printf does.
+ */
+int writer_printf(BufWriter *writer, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+ * @brief Writes out everything buffered.
+ */
+int writer_flush(BufWriter *writer);
+
+/**
+ * @brief Flushes, then frees the buffer; the descriptor is left open.
+ * @return The result of the flush.
+ */
+int writer_free(BufWriter *writer);
+
+#endif // BUFIO_H
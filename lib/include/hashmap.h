@@ -0,0 +1,77 @@
+/*******************************************************************************
+ * @file hashmap.h
+ * @brief An open-addressing hash map from byte-string keys to pointers.
+ *
+ * Entries live in one flat array probed linearly, so a lookup usually
+ * touches a single cache line, and each slot keeps its key's full hash so
+ * that keys are only compared when the hashes match. Deletion shifts later
+ * entries back instead of leaving tombstones, so probe sequences never
+ * degrade. The table doubles when it becomes three quarters full.
+ *
+ * Keys are not copied: they must outlive their entries (an Arena is a
+ * convenient owner). A zero-initialized HashMap is empty and ready to use.
+ *
+ ******************************************************************************/
+
+#ifndef HASHMAP_H
+#define HASHMAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// --- Type Definitions ---
+
+typedef struct
+{
+    const void *key;
+    size_t key_length;
+    uint64_t hash; // 0 marks an empty slot
+    void *value;
+} HashSlot;
+
+typedef struct
+{
+    HashSlot *slots;
+    size_t capacity; // A power of two, or 0 before the first insertion
+    size_t count;
+} HashMap;
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Sizes the table for `expected` entries, so that inserting them
+ * never has to grow it.
+ * @return 0 on success, -1 on allocation failure.
+ */
+int hashmap_reserve(HashMap *map, size_t expected);
+
+/**
+ * @brief Hashes a key. Never returns 0.
+ */
+uint64_t hashmap_hash(const void *key, size_t length);
+
+/**
+ * @brief Inserts a key, or replaces its value if present.
+ * @return 0 on success, -1 on allocation failure.
+ */
+int hashmap_put(HashMap *map, const void *key, size_t length, void *value);
+
+/**
+ * @brief Looks a key up.
+ * @return A pointer to its value, which may be updated in place, or NULL if
+ * the key is absent.
+ */
+void **hashmap_lookup(const HashMap *map, const void *key, size_t length);
+
+/**
+ * @brief Removes a key.
+ * @return 1 if it was present, 0 otherwise.
+ */
+int hashmap_remove(HashMap *map, const void *key, size_t length);
+
+/**
+ * @brief Frees the table; the map is empty again afterwards.
+ */
+void hashmap_free(HashMap *map);
+
+#endif // HASHMAP_H
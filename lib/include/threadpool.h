@@ -0,0 +1,67 @@
+/*******************************************************************************
+ * @file threadpool.h
+ * @brief A fixed set of worker threads that run submitted tasks.
+ *
+ * Each worker owns a task queue. Tasks submitted from outside the pool are
+ * dealt round-robin across the queues; tasks submitted by a worker go onto
+ * its own queue. A worker whose queue runs dry steals from the others before
+ * going to sleep, so uneven task sizes still keep every thread busy.
+ *
+ ******************************************************************************/
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+// --- Type Definitions ---
+
+typedef struct ThreadPool ThreadPool;
+
+typedef void (*PoolTask)(void *arg);
+
+typedef void (*PoolWorkerInit)(int worker_index, void *context);
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Starts a pool of `worker_count` threads, or one per online CPU when
+ * `worker_count` is 0.
+ * @return The pool, or NULL if it could not be started.
+ */
+ThreadPool *pool_create(int worker_count);
+
+/**
+ * @brief As pool_create(), but each worker first runs `init(index, context)`
+ * on its own thread, before it takes any task. Pinning the worker to CPUs
+ * there, then allocating its memory, keeps both on the worker's NUMA node.
+ */
+ThreadPool *pool_create_with_init(int worker_count, PoolWorkerInit init, void *context);
+
+/**
+ * @brief Queues `task(arg)` to run on some worker.
+ * @return 0 on success, -1 on allocation failure (the task is not queued).
+ */
+int pool_submit(ThreadPool *pool, PoolTask task, void *arg);
+
+/**
+ * @brief Blocks until every submitted task has finished. Must not be called
+ * from a worker of the same pool.
+ */
+void pool_wait(ThreadPool *pool);
+
+/**
+ * @brief Runs the remaining tasks, stops the workers and frees the pool.
+ */
+void pool_destroy(ThreadPool *pool);
+
+/**
+ * @brief Returns the number of worker threads.
+ */
+int pool_worker_count(const ThreadPool *pool);
+
+/**
+ * @brief Returns the calling worker's index in [0, worker count), or -1 when
+ * called from a thread that is not a pool worker.
+ */
+int pool_worker_index(void);
+
+#endif // THREADPOOL_H
@@ -0,0 +1,50 @@
+/*******************************************************************************
+ * @file timing.h
+ * @brief Monotonic clocks for measuring elapsed time.
+ *
+ * Every reading comes from CLOCK_MONOTONIC, which never jumps when the
+ * system time is changed, so differences between readings are always
+ * meaningful.
+ *
+ ******************************************************************************/
+
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <stdint.h>
+
+// --- Type Definitions ---
+
+typedef struct
+{
+    uint64_t start_ns;
+} Stopwatch;
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Returns the monotonic clock in nanoseconds.
+ */
+uint64_t timing_now_ns(void);
+
+/**
+ * @brief Returns the monotonic clock in seconds.
+ */
+double timing_now(void);
+
+/**
+ * @brief Starts (or restarts) a stopwatch.
+ */
+void stopwatch_start(Stopwatch *stopwatch);
+
+/**
+ * @brief Returns the seconds since the stopwatch was started.
+ */
+double stopwatch_elapsed(const Stopwatch *stopwatch);
+
+/**
+ * @brief Returns the nanoseconds since the stopwatch was started.
+ */
+uint64_t stopwatch_elapsed_ns(const Stopwatch *stopwatch);
+
+#endif // TIMING_H
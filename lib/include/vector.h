@@ -0,0 +1,69 @@
+/*******************************************************************************
+ * @file vector.h
+ * @brief A growable array of fixed-size elements.
+ *
+ * Elements are stored contiguously and the capacity doubles when full, so
+ * appending is amortized constant time and iterating is a plain array walk.
+ * Pointers into the vector are invalidated by anything that grows it.
+ *
+ ******************************************************************************/
+
+#ifndef VECTOR_H
+#define VECTOR_H
+
+#include <stddef.h>
+
+// --- Type Definitions ---
+
+typedef struct
+{
+    void *data;
+    size_t length;       // Elements in use
+    size_t capacity;     // Elements allocated
+    size_t element_size; // Bytes per element
+} Vector;
+
+// An empty vector of `type`, for initializers: `Vector v = VECTOR_INIT(int);`
+#define VECTOR_INIT(type) {NULL, 0, 0, sizeof(type)}
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Prepares an empty vector of elements of `element_size` bytes.
+ */
+void vector_init(Vector *vector, size_t element_size);
+
+/**
+ * @brief Ensures room for at least `capacity` elements.
+ * @return 0 on success, -1 on allocation failure.
+ */
+int vector_reserve(Vector *vector, size_t capacity);
+
+/**
+ * @brief Appends an uninitialized element.
+ * @return A pointer to it, or NULL on allocation failure.
+ */
+void *vector_push(Vector *vector);
+
+/**
+ * @brief Appends a copy of `element`.
+ * @return 0 on success, -1 on allocation failure.
+ */
+int vector_append(Vector *vector, const void *element);
+
+/**
+ * @brief Returns a pointer to element `index`, which must be in range.
+ */
+void *vector_at(const Vector *vector, size_t index);
+
+/**
+ * @brief Empties the vector, keeping its memory.
+ */
+void vector_clear(Vector *vector);
+
+/**
+ * @brief Frees the elements; the vector is empty again afterwards.
+ */
+void vector_free(Vector *vector);
+
+#endif // VECTOR_H
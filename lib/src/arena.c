@@ -0,0 +1,99 @@
+/*******************************************************************************
+ * @file arena.c
+ * @brief A bump allocator: many small allocations, freed all at once.
+ ******************************************************************************/
+
+#include "arena.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// --- Type Definitions ---
+
+/**
+ * @brief One block in an arena's chain, newest first.
+ */
+struct ArenaBlock
+{
+    ArenaBlock *next;
+    size_t used;
+    size_t capacity;
+    _Alignas(max_align_t) char data[];
+};
+
+// --- Arena Implementation ---
+
+int arena_reserve(Arena *arena, size_t bytes)
+{
+    ArenaBlock *head = arena->head;
+    if (head != NULL && head->capacity - head->used >= bytes)
+        return 0;
+    const size_t minimum = arena->block_size != 0 ? arena->block_size : ARENA_DEFAULT_BLOCK_SIZE;
+    const size_t capacity = bytes > minimum ? bytes : minimum;
+    ArenaBlock *block = (ArenaBlock *)malloc(sizeof(ArenaBlock) + capacity);
+    if (block == NULL)
+        return -1;
+    block->next = head;
+    block->used = 0;
+    block->capacity = capacity;
+    arena->head = block;
+    return 0;
+}
+
+void *arena_alloc(Arena *arena, size_t size, size_t align)
+{
+    // Reserving for the worst-case padding keeps this to one check; blocks
+    // are large, so the slack rarely matters.
+    if (arena_reserve(arena, size + align - 1) != 0)
+        return NULL;
+    ArenaBlock *head = arena->head;
+    const size_t padding = (size_t)(-(uintptr_t)(head->data + head->used)) & (align - 1);
+    void *p = head->data + head->used + padding;
+    head->used += padding + size;
+    return p;
+}
+
+char *arena_strndup(Arena *arena, const char *str, size_t length)
+{
+    if (arena_reserve(arena, length + 1) != 0)
+        return NULL;
+    char *copy = arena->head->data + arena->head->used;
+    memcpy(copy, str, length);
+    copy[length] = '\0';
+    arena->head->used += length + 1;
+    return copy;
+}
+
+char *arena_strdup(Arena *arena, const char *str)
+{
+    return arena_strndup(arena, str, strlen(str));
+}
+
+void arena_reset(Arena *arena)
+{
+    ArenaBlock *head = arena->head;
+    if (head == NULL)
+        return;
+    ArenaBlock *block = head->next;
+    while (block != NULL)
+    {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    head->next = NULL;
+    head->used = 0;
+}
+
+void arena_release(Arena *arena)
+{
+    ArenaBlock *block = arena->head;
+    while (block != NULL)
+    {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->head = NULL;
+}
@@ -0,0 +1,265 @@
+/*******************************************************************************
+ * @file bufio.c
+ * @brief Buffered reading and writing over raw file descriptors.
+ ******************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L // For posix_memalign
+
+#include "bufio.h"
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// --- Function Prototypes ---
+
+static char *buffer_alloc(size_t *capacity);
+static int reader_fill(BufReader *reader);
+static int write_all(int fd, const char *data, size_t n);
+
+// --- Buffers ---
+
+/**
+ * @brief Allocates a page-aligned buffer, rounding *capacity up to whole
+ * pages (0 means the default).
+ */
+static char *buffer_alloc(size_t *capacity)
+{
+    size_t size = *capacity != 0 ? *capacity : BUFIO_DEFAULT_CAPACITY;
+    size = (size + BUFIO_ALIGNMENT - 1) & ~(size_t)(BUFIO_ALIGNMENT - 1);
+    void *buffer;
+    const int rc = posix_memalign(&buffer, BUFIO_ALIGNMENT, size);
+    if (rc != 0)
+    {
+        errno = rc;
+        return NULL;
+    }
+    *capacity = size;
+    return (char *)buffer;
+}
+
+// --- Reader Implementation ---
+
+int reader_init(BufReader *reader, int fd, size_t capacity)
+{
+    memset(reader, 0, sizeof(*reader));
+    reader->fd = fd;
+    reader->buffer = buffer_alloc(&capacity);
+    if (reader->buffer == NULL)
+        return -1;
+    reader->capacity = capacity;
+    return 0;
+}
+
+/**
+ * @brief Moves unconsumed data to the front and reads once into the space
+ * after it.
+ *
+ * A single read returns whatever has arrived, so on a pipe, socket or
+ * terminal a complete line is handed out without waiting for the buffer
+ * to fill; callers that need more call again.
+ * @return 1 if bytes were added, 0 at the end of the input or if the
+ * buffer is full, -1 on error.
+ */
+static int reader_fill(BufReader *reader)
+{
+    if (reader->start != 0)
+    {
+        memmove(reader->buffer, reader->buffer + reader->start, reader->end - reader->start);
+        reader->end -= reader->start;
+        reader->start = 0;
+    }
+    if (reader->eof || reader->end == reader->capacity)
+        return 0;
+    for (;;)
+    {
+        const ssize_t n = read(reader->fd, reader->buffer + reader->end, reader->capacity - reader->end);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        if (n == 0)
+            reader->eof = 1;
+        reader->end += (size_t)n;
+        return n != 0;
+    }
+}
+
+int reader_next(BufReader *reader, const char **data, size_t *length)
+{
+    if (reader->start == reader->end && reader_fill(reader) < 0)
+        return -1;
+    if (reader->start == reader->end)
+        return 0;
+    *data = reader->buffer + reader->start;
+    *length = reader->end - reader->start;
+    reader->start = reader->end;
+    return 1;
+}
+
+int reader_read_line(BufReader *reader, const char **line, size_t *length)
+{
+    size_t scanned = 0; // Bytes already known to hold no '\n'
+    for (;;)
+    {
+        const char *begin = reader->buffer + reader->start;
+        const size_t available = reader->end - reader->start;
+        const char *newline = (const char *)memchr(begin + scanned, '\n', available - scanned);
+        if (newline != NULL || (reader->eof && available != 0))
+        {
+            *line = begin;
+            *length = newline != NULL ? (size_t)(newline - begin) + 1 : available;
+            reader->start += *length;
+            return 1;
+        }
+        if (reader->eof)
+            return 0;
+        scanned = available;
+        if (reader->start == 0 && reader->end == reader->capacity)
+        {
+            // The line fills the buffer: double it.
+            size_t capacity = reader->capacity * 2;
+            char *buffer = buffer_alloc(&capacity);
+            if (buffer == NULL)
+                return -1;
+            memcpy(buffer, reader->buffer, reader->end);
+            free(reader->buffer);
+            reader->buffer = buffer;
+            reader->capacity = capacity;
+        }
+        if (reader_fill(reader) < 0)
+            return -1;
+    }
+}
+
+ssize_t reader_read(BufReader *reader, void *dst, size_t n)
+{
+    if (reader->start == reader->end)
+    {
+        // Large reads skip the buffer.
+        if (n >= reader->capacity)
+        {
+            for (;;)
+            {
+                const ssize_t got = read(reader->fd, dst, n);
+                if (got >= 0 || errno != EINTR)
+                    return got;
+            }
+        }
+        if (reader_fill(reader) < 0)
+            return -1;
+    }
+    const size_t available = reader->end - reader->start;
+    const size_t count = n < available ? n : available;
+    memcpy(dst, reader->buffer + reader->start, count);
+    reader->start += count;
+    return (ssize_t)count;
+}
+
+void reader_free(BufReader *reader)
+{
+    free(reader->buffer);
+    reader->buffer = NULL;
+}
+
+// --- Writer Implementation ---
+
+int writer_init(BufWriter *writer, int fd, size_t capacity)
+{
+    memset(writer, 0, sizeof(*writer));
+    writer->fd = fd;
+    writer->buffer = buffer_alloc(&capacity);
+    if (writer->buffer == NULL)
+        return -1;
+    writer->capacity = capacity;
+    return 0;
+}
+
+/**
+ * @brief Writes all `n` bytes, retrying partial and interrupted writes.
+ */
+static int write_all(int fd, const char *data, size_t n)
+{
+    while (n > 0)
+    {
+        const ssize_t written = write(fd, data, n);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        data += written;
+        n -= (size_t)written;
+    }
+    return 0;
+}
+
+int writer_flush(BufWriter *writer)
+{
+    const size_t length = writer->length;
+    writer->length = 0;
+    return write_all(writer->fd, writer->buffer, length);
+}
+
+int writer_write(BufWriter *writer, const void *data, size_t n)
+{
+    if (n <= writer->capacity - writer->length)
+    {
+        memcpy(writer->buffer + writer->length, data, n);
+        writer->length += n;
+        return 0;
+    }
+    if (writer_flush(writer) != 0)
+        return -1;
+    if (n >= writer->capacity)
+        return write_all(writer->fd, (const char *)data, n);
+    memcpy(writer->buffer, data, n);
+    writer->length = n;
+    return 0;
+}
+
+int writer_puts(BufWriter *writer, const char *str)
+{
+    return writer_write(writer, str, strlen(str));
+}
+
+int writer_printf(BufWriter *writer, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    const size_t room = writer->capacity - writer->length;
+    const int n = vsnprintf(writer->buffer + writer->length, room, format, args);
+    va_end(args);
+    if (n < 0)
+        return -1;
+    if ((size_t)n < room)
+    {
+        writer->length += (size_t)n;
+        return 0;
+    }
+
+    // Too long for what is left: format into a buffer of its own.
+    char *text = (char *)malloc((size_t)n + 1);
+    if (text == NULL)
+        return -1;
+    va_start(args, format);
+    vsnprintf(text, (size_t)n + 1, format, args);
+    va_end(args);
+    const int rc = writer_write(writer, text, (size_t)n);
+    free(text);
+    return rc;
+}
+
+int writer_free(BufWriter *writer)
+{
+    const int rc = writer_flush(writer);
+    free(writer->buffer);
+    writer->buffer = NULL;
+    return rc;
+}
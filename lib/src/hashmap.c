@@ -0,0 +1,161 @@
+/*******************************************************************************
+ * @file hashmap.c
+ * @brief An open-addressing hash map from byte-string keys to pointers.
+ ******************************************************************************/
+
+#include "hashmap.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// --- Constants ---
+
+#define HASHMAP_MIN_CAPACITY 16
+#define HASHMAP_MULTIPLIER 0x9E3779B97F4A7C15ull // 2^64 / golden ratio
+
+// --- Function Prototypes ---
+
+static int hashmap_grow(HashMap *map, size_t capacity);
+static HashSlot *hashmap_find(const HashMap *map, const void *key, size_t length, uint64_t hash);
+
+// --- Hashing ---
+
+uint64_t hashmap_hash(const void *key, size_t length)
+{
+    // Eight bytes at a time, multiplied in, then MurmurHash3's finalizer to
+    // spread every input bit over the low bits used as the index.
+    const unsigned char *p = (const unsigned char *)key;
+    uint64_t h = (uint64_t)length * HASHMAP_MULTIPLIER;
+    for (; length >= 8; p += 8, length -= 8)
+    {
+        uint64_t word;
+        memcpy(&word, p, sizeof(word));
+        h = (h ^ word) * HASHMAP_MULTIPLIER;
+        h ^= h >> 32;
+    }
+    if (length > 0)
+    {
+        uint64_t word = 0;
+        memcpy(&word, p, length);
+        h = (h ^ word) * HASHMAP_MULTIPLIER;
+    }
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h != 0 ? h : 1;
+}
+
+// --- Table Management ---
+
+int hashmap_reserve(HashMap *map, size_t expected)
+{
+    size_t capacity = map->capacity != 0 ? map->capacity : HASHMAP_MIN_CAPACITY;
+    while (expected > capacity / 4 * 3)
+        capacity *= 2;
+    return capacity == map->capacity ? 0 : hashmap_grow(map, capacity);
+}
+
+/**
+ * @brief Moves every entry into a fresh table of `capacity` slots.
+ */
+static int hashmap_grow(HashMap *map, size_t capacity)
+{
+    HashSlot *slots = (HashSlot *)calloc(capacity, sizeof(HashSlot));
+    if (slots == NULL)
+        return -1;
+    const size_t mask = capacity - 1;
+    for (size_t i = 0; i < map->capacity; ++i)
+    {
+        const HashSlot *slot = &map->slots[i];
+        if (slot->hash == 0)
+            continue;
+        size_t j = (size_t)slot->hash & mask;
+        while (slots[j].hash != 0)
+            j = (j + 1) & mask;
+        slots[j] = *slot;
+    }
+    free(map->slots);
+    map->slots = slots;
+    map->capacity = capacity;
+    return 0;
+}
+
+void hashmap_free(HashMap *map)
+{
+    free(map->slots);
+    map->slots = NULL;
+    map->capacity = 0;
+    map->count = 0;
+}
+
+// --- Lookup, Insertion and Removal ---
+
+/**
+ * @brief Returns the slot holding the key, or the empty slot where it would
+ * go; the table must not be full.
+ */
+static HashSlot *hashmap_find(const HashMap *map, const void *key, size_t length, uint64_t hash)
+{
+    const size_t mask = map->capacity - 1;
+    for (size_t i = (size_t)hash & mask;; i = (i + 1) & mask)
+    {
+        HashSlot *slot = &map->slots[i];
+        if (slot->hash == 0 ||
+            (slot->hash == hash && slot->key_length == length && memcmp(slot->key, key, length) == 0))
+            return slot;
+    }
+}
+
+int hashmap_put(HashMap *map, const void *key, size_t length, void *value)
+{
+    if (hashmap_reserve(map, map->count + 1) != 0)
+        return -1;
+    const uint64_t hash = hashmap_hash(key, length);
+    HashSlot *slot = hashmap_find(map, key, length, hash);
+    if (slot->hash == 0)
+    {
+        *slot = (HashSlot){key, length, hash, value};
+        map->count++;
+    }
+    else
+    {
+        slot->value = value;
+    }
+    return 0;
+}
+
+void **hashmap_lookup(const HashMap *map, const void *key, size_t length)
+{
+    if (map->count == 0)
+        return NULL;
+    HashSlot *slot = hashmap_find(map, key, length, hashmap_hash(key, length));
+    return slot->hash != 0 ? &slot->value : NULL;
+}
+
+int hashmap_remove(HashMap *map, const void *key, size_t length)
+{
+    if (map->count == 0)
+        return 0;
+    HashSlot *slot = hashmap_find(map, key, length, hashmap_hash(key, length));
+    if (slot->hash == 0)
+        return 0;
+
+    // Backward-shift deletion: pull each following entry of the cluster
+    // into the hole unless that would move it before its home slot.
+    const size_t mask = map->capacity - 1;
+    size_t hole = (size_t)(slot - map->slots);
+    for (size_t i = (hole + 1) & mask; map->slots[i].hash != 0; i = (i + 1) & mask)
+    {
+        const size_t home = (size_t)map->slots[i].hash & mask;
+        if (((i - home) & mask) >= ((i - hole) & mask))
+        {
+            map->slots[hole] = map->slots[i];
+            hole = i;
+        }
+    }
+    map->slots[hole].hash = 0;
+    map->count--;
+    return 1;
+}
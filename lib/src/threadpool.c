@@ -0,0 +1,353 @@
+/*******************************************************************************
+ * @file threadpool.c
+ * @brief A fixed set of worker threads that run submitted tasks.
+ ******************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L // For sysconf
+
+#include "threadpool.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// --- Constants ---
+
+#define QUEUE_INITIAL_CAPACITY 64
+
+// --- Type Definitions ---
+
+typedef struct
+{
+    PoolTask task;
+    void *arg;
+} Job;
+
+/**
+ * @brief One worker's FIFO of jobs, a ring buffer that doubles when full.
+ */
+typedef struct
+{
+    pthread_mutex_t mutex;
+    Job *jobs;
+    size_t capacity;
+    size_t head;
+    size_t count;
+} WorkQueue;
+
+typedef struct
+{
+    ThreadPool *pool;
+    int index;
+} WorkerStart;
+
+struct ThreadPool
+{
+    int worker_count;
+    pthread_t *threads;
+    WorkerStart *starts;
+    WorkQueue *queues;
+
+    atomic_size_t queued;     // Jobs sitting in queues
+    atomic_size_t unfinished; // Jobs submitted but not yet finished
+    atomic_int sleepers;      // Workers waiting on `wake`
+    atomic_uint next_queue;   // Round-robin cursor for external submits
+
+    pthread_mutex_t mutex; // Guards sleeping, waiting and `stopping`
+    pthread_cond_t wake;
+    pthread_cond_t done;
+    bool stopping;
+
+    PoolWorkerInit init; // Run by each worker as it starts, or NULL
+    void *init_context;
+};
+
+// --- Globals ---
+
+static _Thread_local int current_worker = -1;
+
+// --- Function Prototypes ---
+
+// Queues
+static int queue_init(WorkQueue *queue);
+static void queue_free(WorkQueue *queue);
+static int queue_push(WorkQueue *queue, Job job);
+static bool queue_pop(WorkQueue *queue, Job *job);
+
+// Pool Lifecycle
+static void pool_stop(ThreadPool *pool, int thread_count, int queue_count);
+
+// Workers
+static void *worker_main(void *arg);
+static bool take_job(ThreadPool *pool, int index, Job *job);
+static void finish_job(ThreadPool *pool);
+
+// --- Pool Lifecycle ---
+
+ThreadPool *pool_create(int worker_count)
+{
+    return pool_create_with_init(worker_count, NULL, NULL);
+}
+
+ThreadPool *pool_create_with_init(int worker_count, PoolWorkerInit init, void *context)
+{
+    if (worker_count <= 0)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        worker_count = cpus > 0 ? (int)cpus : 1;
+    }
+
+    ThreadPool *pool = (ThreadPool *)calloc(1, sizeof(ThreadPool));
+    if (pool == NULL)
+        return NULL;
+    pool->threads = (pthread_t *)calloc((size_t)worker_count, sizeof(pthread_t));
+    pool->starts = (WorkerStart *)calloc((size_t)worker_count, sizeof(WorkerStart));
+    pool->queues = (WorkQueue *)calloc((size_t)worker_count, sizeof(WorkQueue));
+    if (pool->threads == NULL || pool->starts == NULL || pool->queues == NULL)
+    {
+        free(pool->threads);
+        free(pool->starts);
+        free(pool->queues);
+        free(pool);
+        return NULL;
+    }
+    atomic_init(&pool->queued, 0);
+    atomic_init(&pool->unfinished, 0);
+    atomic_init(&pool->sleepers, 0);
+    atomic_init(&pool->next_queue, 0);
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    pool->init = init;
+    pool->init_context = context;
+
+    // Workers read the count as soon as they start, so it is set first.
+    pool->worker_count = worker_count;
+    int queues = 0;
+    while (queues < worker_count && queue_init(&pool->queues[queues]) == 0)
+        queues++;
+    int started = 0;
+    if (queues == worker_count)
+    {
+        for (; started < worker_count; ++started)
+        {
+            pool->starts[started] = (WorkerStart){pool, started};
+            if (pthread_create(&pool->threads[started], NULL, worker_main, &pool->starts[started]) != 0)
+                break;
+        }
+    }
+    if (started == worker_count)
+        return pool;
+
+    // Partial start: stop whatever came up and report failure.
+    pool_stop(pool, started, queues);
+    return NULL;
+}
+
+void pool_destroy(ThreadPool *pool)
+{
+    if (pool != NULL)
+        pool_stop(pool, pool->worker_count, pool->worker_count);
+}
+
+/**
+ * @brief Stops and joins the first `thread_count` workers, then frees the
+ * first `queue_count` queues and the pool.
+ */
+static void pool_stop(ThreadPool *pool, int thread_count, int queue_count)
+{
+    pthread_mutex_lock(&pool->mutex);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (int i = 0; i < thread_count; ++i)
+        pthread_join(pool->threads[i], NULL);
+    for (int i = 0; i < queue_count; ++i)
+        queue_free(&pool->queues[i]);
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->mutex);
+    free(pool->threads);
+    free(pool->starts);
+    free(pool->queues);
+    free(pool);
+}
+
+int pool_worker_count(const ThreadPool *pool)
+{
+    return pool->worker_count;
+}
+
+int pool_worker_index(void)
+{
+    return current_worker;
+}
+
+// --- Submitting and Waiting ---
+
+int pool_submit(ThreadPool *pool, PoolTask task, void *arg)
+{
+    int index = current_worker;
+    if (index < 0 || index >= pool->worker_count)
+        index = (int)(atomic_fetch_add(&pool->next_queue, 1) % (unsigned)pool->worker_count);
+
+    // Count the job before it becomes visible so that neither counter can
+    // drop below zero when a worker grabs it straight away.
+    atomic_fetch_add(&pool->unfinished, 1);
+    atomic_fetch_add(&pool->queued, 1);
+    if (queue_push(&pool->queues[index], (Job){task, arg}) != 0)
+    {
+        atomic_fetch_sub(&pool->queued, 1);
+        finish_job(pool);
+        return -1;
+    }
+
+    // A worker announces itself in `sleepers` before re-checking `queued`,
+    // and we bumped `queued` before reading `sleepers`, so at least one side
+    // sees the other and no wakeup is lost.
+    if (atomic_load(&pool->sleepers) > 0)
+    {
+        pthread_mutex_lock(&pool->mutex);
+        pthread_cond_signal(&pool->wake);
+        pthread_mutex_unlock(&pool->mutex);
+    }
+    return 0;
+}
+
+void pool_wait(ThreadPool *pool)
+{
+    pthread_mutex_lock(&pool->mutex);
+    while (atomic_load(&pool->unfinished) > 0)
+        pthread_cond_wait(&pool->done, &pool->mutex);
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+// --- Workers ---
+
+/**
+ * @brief Runs jobs until the pool is stopping and every queue is empty.
+ */
+static void *worker_main(void *arg)
+{
+    const WorkerStart *start = (const WorkerStart *)arg;
+    ThreadPool *pool = start->pool;
+    current_worker = start->index;
+    if (pool->init != NULL)
+        pool->init(current_worker, pool->init_context);
+
+    for (;;)
+    {
+        Job job;
+        if (take_job(pool, current_worker, &job))
+        {
+            job.task(job.arg);
+            finish_job(pool);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->mutex);
+        atomic_fetch_add(&pool->sleepers, 1);
+        while (atomic_load(&pool->queued) == 0 && !pool->stopping)
+            pthread_cond_wait(&pool->wake, &pool->mutex);
+        atomic_fetch_sub(&pool->sleepers, 1);
+        bool stop = pool->stopping && atomic_load(&pool->queued) == 0;
+        pthread_mutex_unlock(&pool->mutex);
+        if (stop)
+            break;
+    }
+    current_worker = -1;
+    return NULL;
+}
+
+/**
+ * @brief Takes the oldest job from the worker's own queue, or steals the
+ * oldest job from another worker's queue.
+ */
+static bool take_job(ThreadPool *pool, int index, Job *job)
+{
+    for (int i = 0; i < pool->worker_count; ++i)
+    {
+        if (queue_pop(&pool->queues[(index + i) % pool->worker_count], job))
+        {
+            atomic_fetch_sub(&pool->queued, 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Retires one job, waking pool_wait() callers when it was the last.
+ */
+static void finish_job(ThreadPool *pool)
+{
+    if (atomic_fetch_sub(&pool->unfinished, 1) == 1)
+    {
+        pthread_mutex_lock(&pool->mutex);
+        pthread_cond_broadcast(&pool->done);
+        pthread_mutex_unlock(&pool->mutex);
+    }
+}
+
+// --- Queues ---
+
+static int queue_init(WorkQueue *queue)
+{
+    queue->jobs = (Job *)malloc(QUEUE_INITIAL_CAPACITY * sizeof(Job));
+    if (queue->jobs == NULL)
+        return -1;
+    pthread_mutex_init(&queue->mutex, NULL);
+    queue->capacity = QUEUE_INITIAL_CAPACITY;
+    queue->head = 0;
+    queue->count = 0;
+    return 0;
+}
+
+static void queue_free(WorkQueue *queue)
+{
+    pthread_mutex_destroy(&queue->mutex);
+    free(queue->jobs);
+    queue->jobs = NULL;
+}
+
+static int queue_push(WorkQueue *queue, Job job)
+{
+    pthread_mutex_lock(&queue->mutex);
+    if (queue->count == queue->capacity)
+    {
+        // Unroll the ring into a buffer twice the size.
+        Job *jobs = (Job *)malloc(queue->capacity * 2 * sizeof(Job));
+        if (jobs == NULL)
+        {
+            pthread_mutex_unlock(&queue->mutex);
+            return -1;
+        }
+        for (size_t i = 0; i < queue->count; ++i)
+            jobs[i] = queue->jobs[(queue->head + i) % queue->capacity];
+        free(queue->jobs);
+        queue->jobs = jobs;
+        queue->capacity *= 2;
+        queue->head = 0;
+    }
+    queue->jobs[(queue->head + queue->count) % queue->capacity] = job;
+    queue->count++;
+    pthread_mutex_unlock(&queue->mutex);
+    return 0;
+}
+
+static bool queue_pop(WorkQueue *queue, Job *job)
+{
+    pthread_mutex_lock(&queue->mutex);
+    bool found = queue->count > 0;
+    if (found)
+    {
+        *job = queue->jobs[queue->head];
+        queue->head = (queue->head + 1) % queue->capacity;
+        queue->count--;
+    }
+    pthread_mutex_unlock(&queue->mutex);
+    return found;
+}
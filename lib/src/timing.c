@@ -0,0 +1,39 @@
+/*******************************************************************************
+ * @file timing.c
+ * @brief Monotonic clocks for measuring elapsed time.
+ ******************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L // For clock_gettime
+
+#include "timing.h"
+
+#include <time.h>
+
+// --- Timing Implementation ---
+
+uint64_t timing_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+double timing_now(void)
+{
+    return (double)timing_now_ns() / 1e9;
+}
+
+void stopwatch_start(Stopwatch *stopwatch)
+{
+    stopwatch->start_ns = timing_now_ns();
+}
+
+double stopwatch_elapsed(const Stopwatch *stopwatch)
+{
+    return (double)stopwatch_elapsed_ns(stopwatch) / 1e9;
+}
+
+uint64_t stopwatch_elapsed_ns(const Stopwatch *stopwatch)
+{
+    return timing_now_ns() - stopwatch->start_ns;
+}
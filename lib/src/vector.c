@@ -0,0 +1,72 @@
+/*******************************************************************************
+ * @file vector.c
+ * @brief A growable array of fixed-size elements.
+ ******************************************************************************/
+
+#include "vector.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// --- Constants ---
+
+#define VECTOR_MIN_CAPACITY 8
+
+// --- Vector Implementation ---
+
+void vector_init(Vector *vector, size_t element_size)
+{
+    vector->data = NULL;
+    vector->length = 0;
+    vector->capacity = 0;
+    vector->element_size = element_size;
+}
+
+int vector_reserve(Vector *vector, size_t capacity)
+{
+    if (capacity <= vector->capacity)
+        return 0;
+    size_t grown = vector->capacity != 0 ? vector->capacity : VECTOR_MIN_CAPACITY;
+    while (grown < capacity)
+        grown *= 2;
+    void *data = realloc(vector->data, grown * vector->element_size);
+    if (data == NULL)
+        return -1;
+    vector->data = data;
+    vector->capacity = grown;
+    return 0;
+}
+
+void *vector_push(Vector *vector)
+{
+    if (vector->length == vector->capacity && vector_reserve(vector, vector->length + 1) != 0)
+        return NULL;
+    return (char *)vector->data + vector->length++ * vector->element_size;
+}
+
+int vector_append(Vector *vector, const void *element)
+{
+    void *slot = vector_push(vector);
+    if (slot == NULL)
+        return -1;
+    memcpy(slot, element, vector->element_size);
+    return 0;
+}
+
+void *vector_at(const Vector *vector, size_t index)
+{
+    return (char *)vector->data + index * vector->element_size;
+}
+
+void vector_clear(Vector *vector)
+{
+    vector->length = 0;
+}
+
+void vector_free(Vector *vector)
+{
+    free(vector->data);
+    vector->data = NULL;
+    vector->length = 0;
+    vector->capacity = 0;
+}
@@ -0,0 +1,135 @@
+/*******************************************************************************
+ * @file arena.c
+ * @brief Unit tests for the bump allocator.
+ ******************************************************************************/
+
+#include "arena.h"
+#include "test.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+// --- Constants ---
+
+#define ALLOCATIONS 2000
+#define MAX_ALIGN 4096
+
+// --- Tests ---
+
+static void test_alignment(void)
+{
+    // Every power of two up to a page, interleaved with odd sizes that
+    // leave the next allocation misaligned.
+    Arena arena = {0};
+    static struct
+    {
+        unsigned char *p;
+        size_t size;
+    } blocks[ALLOCATIONS];
+    bool aligned = true;
+    for (size_t i = 0; i < ALLOCATIONS; ++i)
+    {
+        const size_t align = (size_t)1 << (i % 13);
+        const size_t size = 1 + i % 97;
+        unsigned char *p = arena_alloc(&arena, size, align);
+        CHECK(p != NULL);
+        aligned &= ((uintptr_t)p & (align - 1)) == 0;
+        memset(p, (int)(i & 0xFF), size);
+        blocks[i].p = p;
+        blocks[i].size = size;
+    }
+    CHECK(aligned);
+
+    // No allocation overwrote another.
+    bool intact = true;
+    for (size_t i = 0; i < ALLOCATIONS; ++i)
+    {
+        for (size_t j = 0; j < blocks[i].size; ++j)
+            intact &= blocks[i].p[j] == (unsigned char)(i & 0xFF);
+    }
+    CHECK(intact);
+    arena_release(&arena);
+    CHECK(arena.head == NULL);
+}
+
+static void test_large_allocations(void)
+{
+    // Larger than a block, and with the block size set explicitly.
+    Arena arena = {NULL, 1024};
+    char *small = arena_alloc(&arena, 16, 8);
+    char *large = arena_alloc(&arena, 3 * ARENA_DEFAULT_BLOCK_SIZE, MAX_ALIGN);
+    CHECK(small != NULL && large != NULL);
+    CHECK(((uintptr_t)large & (MAX_ALIGN - 1)) == 0);
+    memset(large, 'x', 3 * ARENA_DEFAULT_BLOCK_SIZE);
+    memset(small, 'y', 16);
+    CHECK(large[0] == 'x' && large[3 * ARENA_DEFAULT_BLOCK_SIZE - 1] == 'x');
+    CHECK(arena_alloc(&arena, 0, 1) != NULL);
+    arena_release(&arena);
+}
+
+static void test_strings(void)
+{
+    Arena arena = {0};
+    char *copy = arena_strdup(&arena, "hello");
+    CHECK(copy != NULL && strcmp(copy, "hello") == 0);
+    char *prefix = arena_strndup(&arena, "world wide", 5);
+    CHECK(prefix != NULL && strcmp(prefix, "world") == 0);
+    char *empty = arena_strdup(&arena, "");
+    CHECK(empty != NULL && empty[0] == '\0');
+    CHECK(strcmp(copy, "hello") == 0); // Later copies left it alone
+    arena_release(&arena);
+}
+
+static void test_reset_reuses_memory(void)
+{
+    Arena arena = {0};
+    void *first = arena_alloc(&arena, 100, 16);
+    for (int i = 0; i < 100; ++i)
+        arena_alloc(&arena, 50, 8);
+    arena_reset(&arena);
+    CHECK(arena_alloc(&arena, 100, 16) == first);
+
+    // After spilling into more blocks, reset keeps only the newest one.
+    for (int i = 0; i < 10; ++i)
+        arena_alloc(&arena, ARENA_DEFAULT_BLOCK_SIZE / 2, 8);
+    arena_reset(&arena);
+    void *again = arena_alloc(&arena, 8, 8);
+    CHECK(again != NULL);
+    arena_reset(&arena);
+    CHECK(arena_alloc(&arena, 8, 8) == again);
+    arena_release(&arena);
+
+    Arena unused = {0};
+    arena_reset(&unused); // Resetting an empty arena is a no-op
+    CHECK(unused.head == NULL);
+}
+
+static void test_reserve_is_contiguous(void)
+{
+    Arena arena = {0};
+    arena_alloc(&arena, ARENA_DEFAULT_BLOCK_SIZE - 64, 1); // Nearly fill the block
+    CHECK(arena_reserve(&arena, 1000) == 0);
+    char *previous = arena_strndup(&arena, "abcdefghij", 9);
+    bool contiguous = true;
+    for (int i = 0; i < 99; ++i)
+    {
+        char *next = arena_strndup(&arena, "abcdefghij", 9);
+        contiguous &= next == previous + 10;
+        previous = next;
+    }
+    CHECK(contiguous);
+    arena_release(&arena);
+}
+
+// --- Main ---
+
+int main(void)
+{
+    RUN(test_alignment);
+    RUN(test_large_allocations);
+    RUN(test_strings);
+    RUN(test_reset_reuses_memory);
+    RUN(test_reserve_is_contiguous);
+    return test_finish("arena");
+}
@@ -0,0 +1,294 @@
+/*******************************************************************************
+ * @file bufio.c
+ * @brief Unit tests for the buffered reader and writer.
+ *
+ * The reader tests use the smallest buffer (one BUFIO_ALIGNMENT page) so
+ * that ordinary inputs already span several refills, lines straddle the
+ * buffer's end, and some lines are many times longer than the buffer.
+ * The pipe test keeps the writing end open, so a reader that waits for
+ * more than has arrived blocks; an alarm turns that into a failure.
+ *
+ ******************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L // For fileno
+
+#include "bufio.h"
+#include "test.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+// --- Constants ---
+
+#define LINE_COUNT 3000
+#define LONG_LINE 10000
+#define VERY_LONG_LINE 50000
+#define PIPE_TIMEOUT_S 5
+
+// --- Helpers ---
+
+/**
+ * @brief Returns a descriptor for an unlinked temporary file holding
+ * `data`, positioned at its start, or -1. The FILE is kept in *file.
+ */
+static int temp_input(FILE **file, const char *data, size_t length)
+{
+    *file = tmpfile();
+    if (*file == NULL)
+        return -1;
+    if (length != 0 && fwrite(data, 1, length, *file) != length)
+        return -1;
+    if (fflush(*file) != 0 || lseek(fileno(*file), 0, SEEK_SET) != 0)
+        return -1;
+    return fileno(*file);
+}
+
+/**
+ * @brief Builds LINE_COUNT lines of varying length, each "<n>:" followed
+ * by a run of one letter.
+ * @return The text's length; the caller frees *text.
+ */
+static size_t make_lines(char **text)
+{
+    size_t capacity = (size_t)LINE_COUNT * 200;
+    *text = malloc(capacity);
+    size_t length = 0;
+    for (int i = 0; i < LINE_COUNT; ++i)
+    {
+        length += (size_t)sprintf(*text + length, "%d:", i);
+        const size_t run = (size_t)(i * 37 % 150);
+        memset(*text + length, 'a' + i % 26, run);
+        length += run;
+        (*text)[length++] = '\n';
+    }
+    return length;
+}
+
+/**
+ * @brief Reads `fd` line by line and checks the lines add up to `text`.
+ * @return The number of lines read.
+ */
+static size_t read_back_lines(int fd, const char *text, size_t length)
+{
+    BufReader reader;
+    CHECK(reader_init(&reader, fd, 1) == 0);
+    CHECK(reader.capacity == BUFIO_ALIGNMENT);
+    size_t offset = 0;
+    size_t lines = 0;
+    bool matches = true;
+    const char *line;
+    size_t line_length;
+    int rc;
+    while ((rc = reader_read_line(&reader, &line, &line_length)) == 1)
+    {
+        const bool last = offset + line_length == length;
+        matches &= offset + line_length <= length;
+        matches &= matches && memcmp(line, text + offset, line_length) == 0;
+        matches &= last || line[line_length - 1] == '\n';
+        matches &= memchr(line, '\n', line_length - 1) == NULL;
+        offset += line_length;
+        lines++;
+    }
+    CHECK(rc == 0);
+    CHECK(matches);
+    CHECK(offset == length);
+    CHECK(reader_read_line(&reader, &line, &line_length) == 0); // End of input is sticky
+    reader_free(&reader);
+    return lines;
+}
+
+// --- Reader Tests ---
+
+static void test_lines_across_refills(void)
+{
+    char *text;
+    const size_t length = make_lines(&text);
+    CHECK(length > 10 * BUFIO_ALIGNMENT);
+    FILE *file;
+    const int fd = temp_input(&file, text, length);
+    CHECK(fd >= 0);
+    CHECK(read_back_lines(fd, text, length) == LINE_COUNT);
+    fclose(file);
+    free(text);
+}
+
+static void test_lines_longer_than_the_buffer(void)
+{
+    // Short, long, short, very long, then a final line with no newline.
+    const size_t length = 6 + LONG_LINE + 1 + 3 + VERY_LONG_LINE + 1 + 4;
+    char *text = malloc(length);
+    size_t at = 0;
+    memcpy(text + at, "first\n", 6);
+    at += 6;
+    memset(text + at, 'L', LONG_LINE);
+    at += LONG_LINE;
+    text[at++] = '\n';
+    memcpy(text + at, "ab\n", 3);
+    at += 3;
+    for (size_t i = 0; i < VERY_LONG_LINE; ++i)
+        text[at++] = (char)('0' + i % 10);
+    text[at++] = '\n';
+    memcpy(text + at, "tail", 4);
+    at += 4;
+    CHECK(at == length);
+
+    FILE *file;
+    const int fd = temp_input(&file, text, length);
+    CHECK(fd >= 0);
+    CHECK(read_back_lines(fd, text, length) == 5);
+    fclose(file);
+    free(text);
+}
+
+static void test_blank_lines_and_empty_input(void)
+{
+    static const char text[] = "\n\nx\n\n";
+    FILE *file;
+    int fd = temp_input(&file, text, sizeof(text) - 1);
+    CHECK(read_back_lines(fd, text, sizeof(text) - 1) == 4);
+    fclose(file);
+
+    fd = temp_input(&file, "", 0);
+    BufReader reader;
+    const char *data;
+    size_t length;
+    CHECK(reader_init(&reader, fd, 0) == 0);
+    CHECK(reader.capacity == BUFIO_DEFAULT_CAPACITY);
+    CHECK(reader_read_line(&reader, &data, &length) == 0);
+    CHECK(reader_next(&reader, &data, &length) == 0);
+    char byte;
+    CHECK(reader_read(&reader, &byte, 1) == 0);
+    reader_free(&reader);
+    fclose(file);
+}
+
+static void test_blocks_and_reads(void)
+{
+    char *text;
+    const size_t length = make_lines(&text);
+    FILE *file;
+    int fd = temp_input(&file, text, length);
+
+    // reader_next hands back consecutive blocks, none larger than the buffer.
+    BufReader reader;
+    CHECK(reader_init(&reader, fd, 1) == 0);
+    CHECK(((uintptr_t)reader.buffer & (BUFIO_ALIGNMENT - 1)) == 0);
+    size_t offset = 0;
+    bool matches = true;
+    const char *data;
+    size_t block;
+    while (reader_next(&reader, &data, &block) == 1)
+    {
+        matches &= block <= reader.capacity && offset + block <= length;
+        matches &= matches && memcmp(data, text + offset, block) == 0;
+        offset += block;
+    }
+    CHECK(matches);
+    CHECK(offset == length);
+    reader_free(&reader);
+
+    // reader_read mixes small buffered reads with large direct ones.
+    CHECK(lseek(fd, 0, SEEK_SET) == 0);
+    CHECK(reader_init(&reader, fd, 1) == 0);
+    char *copy = malloc(length);
+    static const size_t sizes[] = {1, 7, 100, 3 * BUFIO_ALIGNMENT, 4095, 2};
+    offset = 0;
+    for (size_t i = 0; offset < length; ++i)
+    {
+        const size_t want = sizes[i % (sizeof(sizes) / sizeof(sizes[0]))];
+        const ssize_t got = reader_read(&reader, copy + offset, want < length - offset ? want : length - offset);
+        if (got <= 0)
+            break;
+        offset += (size_t)got;
+    }
+    CHECK(offset == length);
+    CHECK(memcmp(copy, text, length) == 0);
+    CHECK(reader_read(&reader, copy, 1) == 0);
+    reader_free(&reader);
+    free(copy);
+    fclose(file);
+    free(text);
+}
+
+static void test_lines_from_a_pipe(void)
+{
+    int fds[2];
+    CHECK(pipe(fds) == 0);
+    BufReader reader;
+    CHECK(reader_init(&reader, fds[0], 0) == 0);
+    const char *line;
+    size_t length;
+    alarm(PIPE_TIMEOUT_S);
+
+    // Each line is read as soon as it is written, with the pipe still open.
+    CHECK(write(fds[1], "one\ntw", 6) == 6);
+    CHECK(reader_read_line(&reader, &line, &length) == 1);
+    CHECK(length == 4 && memcmp(line, "one\n", 4) == 0);
+    CHECK(write(fds[1], "o\n", 2) == 2);
+    CHECK(reader_read_line(&reader, &line, &length) == 1);
+    CHECK(length == 4 && memcmp(line, "two\n", 4) == 0);
+    CHECK(write(fds[1], "three", 5) == 5);
+    const char *data;
+    CHECK(reader_next(&reader, &data, &length) == 1);
+    CHECK(length == 5 && memcmp(data, "three", 5) == 0);
+
+    close(fds[1]);
+    CHECK(reader_read_line(&reader, &line, &length) == 0);
+    alarm(0);
+    reader_free(&reader);
+    close(fds[0]);
+}
+
+// --- Writer Tests ---
+
+static void test_writer(void)
+{
+    FILE *file;
+    const int fd = temp_input(&file, "", 0);
+    BufWriter writer;
+    CHECK(writer_init(&writer, fd, 1) == 0);
+    CHECK(writer.capacity == BUFIO_ALIGNMENT);
+
+    // Small writes, one larger than the buffer, and formatted output.
+    char *expected = malloc(4 * BUFIO_ALIGNMENT);
+    size_t length = 0;
+    for (int i = 0; i < 300; ++i)
+    {
+        CHECK(writer_puts(&writer, "ab") == 0);
+        memcpy(expected + length, "ab", 2);
+        length += 2;
+    }
+    char big[2 * BUFIO_ALIGNMENT + 10];
+    for (size_t i = 0; i < sizeof(big); ++i)
+        big[i] = (char)('a' + i % 26);
+    CHECK(writer_write(&writer, big, sizeof(big)) == 0);
+    memcpy(expected + length, big, sizeof(big));
+    length += sizeof(big);
+    CHECK(writer_printf(&writer, "%d-%s\n", 42, "end") == 0);
+    memcpy(expected + length, "42-end\n", 7);
+    length += 7;
+    CHECK(writer_free(&writer) == 0); // Flushes
+
+    char *written = malloc(length + 1);
+    CHECK(lseek(fd, 0, SEEK_SET) == 0);
+    CHECK(read(fd, written, length + 1) == (ssize_t)length);
+    CHECK(memcmp(written, expected, length) == 0);
+    free(written);
+    free(expected);
+    fclose(file);
+}
+
+// --- Main ---
+
+int main(void)
+{
+    RUN(test_lines_across_refills);
+    RUN(test_lines_longer_than_the_buffer);
+    RUN(test_blank_lines_and_empty_input);
+    RUN(test_blocks_and_reads);
+    RUN(test_lines_from_a_pipe);
+    RUN(test_writer);
+    return test_finish("bufio");
+}
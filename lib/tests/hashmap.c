@@ -0,0 +1,268 @@
+/*******************************************************************************
+ * @file hashmap.c
+ * @brief Unit tests for the open-addressing hash map.
+ *
+ * Besides the basic operations, the collision tests pick keys that share a
+ * home slot in a table of known size, delete from the middle and the ends
+ * of their probe runs (including runs that wrap around the end of the
+ * table), and check after every step that each remaining entry is still
+ * reachable from its home slot without crossing an empty one.
+ *
+ ******************************************************************************/
+
+#include "hashmap.h"
+#include "test.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+// --- Constants ---
+
+#define KEY_COUNT 1000
+#define KEY_LENGTH 16
+#define SMALL_CAPACITY 16 // What hashmap_reserve gives for up to 12 entries
+#define RANDOM_KEYS 500
+#define RANDOM_STEPS 20000
+
+// --- Globals ---
+
+static char keys[KEY_COUNT][KEY_LENGTH]; // Keys must outlive their entries
+
+// --- Helpers ---
+
+static void *value_of(size_t i)
+{
+    return (void *)(uintptr_t)(i + 1);
+}
+
+static size_t make_key(size_t i, const char *prefix)
+{
+    return (size_t)snprintf(keys[i], KEY_LENGTH, "%s%zu", prefix, i);
+}
+
+/**
+ * @brief Fills keys[first..first+count) with distinct keys whose home
+ * slot in a table of SMALL_CAPACITY slots is `home`.
+ */
+static void make_colliding_keys(size_t first, size_t count, size_t home)
+{
+    size_t found = 0;
+    for (unsigned n = 0; found < count; ++n)
+    {
+        char key[KEY_LENGTH];
+        const int length = snprintf(key, sizeof(key), "c%zu-%zu-%u", first, home, n);
+        if ((hashmap_hash(key, (size_t)length) & (SMALL_CAPACITY - 1)) == home)
+            memcpy(keys[first + found++], key, (size_t)length + 1);
+    }
+}
+
+/**
+ * @brief Checks that no probe run has a hole: every entry's slot is reached
+ * from its home slot through occupied slots only.
+ */
+static bool runs_are_intact(const HashMap *map)
+{
+    const size_t mask = map->capacity - 1;
+    for (size_t i = 0; i < map->capacity; ++i)
+    {
+        if (map->slots[i].hash == 0)
+            continue;
+        for (size_t j = map->slots[i].hash & mask; j != i; j = (j + 1) & mask)
+        {
+            if (map->slots[j].hash == 0)
+                return false;
+        }
+    }
+    return true;
+}
+
+static size_t occupied_slots(const HashMap *map)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < map->capacity; ++i)
+        count += map->slots[i].hash != 0;
+    return count;
+}
+
+// --- Tests ---
+
+static void test_put_lookup_replace(void)
+{
+    HashMap map = {0};
+    for (size_t i = 0; i < KEY_COUNT; ++i)
+    {
+        const size_t length = make_key(i, "key");
+        CHECK(hashmap_put(&map, keys[i], length, value_of(i)) == 0);
+    }
+    CHECK(map.count == KEY_COUNT);
+    for (size_t i = 0; i < KEY_COUNT; ++i)
+    {
+        void **found = hashmap_lookup(&map, keys[i], strlen(keys[i]));
+        CHECK(found != NULL && *found == value_of(i));
+    }
+
+    // Replacing keeps one entry per key; values can be updated in place.
+    CHECK(hashmap_put(&map, keys[7], strlen(keys[7]), value_of(700)) == 0);
+    CHECK(map.count == KEY_COUNT);
+    void **found = hashmap_lookup(&map, keys[7], strlen(keys[7]));
+    CHECK(found != NULL && *found == value_of(700));
+    *found = value_of(7);
+    CHECK(*hashmap_lookup(&map, keys[7], strlen(keys[7])) == value_of(7));
+
+    CHECK(hashmap_lookup(&map, "absent", 6) == NULL);
+    CHECK(hashmap_lookup(&map, keys[1], 2) == NULL); // A prefix of a key is another key
+    CHECK(hashmap_remove(&map, "absent", 6) == 0);
+    hashmap_free(&map);
+    CHECK(map.count == 0 && map.capacity == 0);
+    CHECK(hashmap_lookup(&map, keys[0], strlen(keys[0])) == NULL);
+}
+
+static void test_empty_key_and_binary_keys(void)
+{
+    HashMap map = {0};
+    static const char binary[] = {'a', '\0', 'b'};
+    CHECK(hashmap_put(&map, "", 0, value_of(1)) == 0);
+    CHECK(hashmap_put(&map, binary, sizeof(binary), value_of(2)) == 0);
+    CHECK(hashmap_put(&map, binary, 1, value_of(3)) == 0);
+    CHECK(*hashmap_lookup(&map, "", 0) == value_of(1));
+    CHECK(*hashmap_lookup(&map, binary, sizeof(binary)) == value_of(2));
+    CHECK(*hashmap_lookup(&map, "a", 1) == value_of(3));
+    CHECK(hashmap_hash("", 0) != 0);
+    hashmap_free(&map);
+}
+
+static void test_reserve_avoids_growth(void)
+{
+    HashMap map = {0};
+    CHECK(hashmap_reserve(&map, KEY_COUNT) == 0);
+    const size_t capacity = map.capacity;
+    const HashSlot *slots = map.slots;
+    CHECK(capacity >= KEY_COUNT);
+    for (size_t i = 0; i < KEY_COUNT; ++i)
+        hashmap_put(&map, keys[i], make_key(i, "r"), value_of(i));
+    CHECK(map.capacity == capacity && map.slots == slots);
+    hashmap_free(&map);
+}
+
+static void test_backward_shift_under_collisions(void)
+{
+    // Keys homed at slots 5, 6 and 7 form one run of eight from slot 5. The
+    // slot-7 keys go in second, so they sit at their home in the middle of
+    // the run and must not be shifted in front of it.
+    HashMap map = {0};
+    CHECK(hashmap_reserve(&map, 8) == 0);
+    CHECK(map.capacity == SMALL_CAPACITY);
+    make_colliding_keys(0, 2, 5);
+    make_colliding_keys(2, 2, 7);
+    make_colliding_keys(4, 2, 5);
+    make_colliding_keys(6, 2, 6);
+    for (size_t i = 0; i < 8; ++i)
+        CHECK(hashmap_put(&map, keys[i], strlen(keys[i]), value_of(i)) == 0);
+    CHECK(map.capacity == SMALL_CAPACITY);
+    CHECK(runs_are_intact(&map));
+
+    // Delete from the middle, the front and the back of the run.
+    static const size_t order[] = {2, 0, 7, 4, 6, 1, 5, 3};
+    bool removed[8] = {false};
+    for (size_t step = 0; step < 8; ++step)
+    {
+        const size_t victim = order[step];
+        CHECK(hashmap_remove(&map, keys[victim], strlen(keys[victim])) == 1);
+        CHECK(hashmap_remove(&map, keys[victim], strlen(keys[victim])) == 0);
+        removed[victim] = true;
+        CHECK(runs_are_intact(&map));
+        CHECK(occupied_slots(&map) == map.count); // No tombstones are left behind
+        for (size_t i = 0; i < 8; ++i)
+        {
+            void **found = hashmap_lookup(&map, keys[i], strlen(keys[i]));
+            CHECK(removed[i] ? found == NULL : found != NULL && *found == value_of(i));
+        }
+    }
+    CHECK(map.count == 0);
+    hashmap_free(&map);
+}
+
+static void test_backward_shift_across_the_end(void)
+{
+    // Keys homed at the last two slots wrap around to the front.
+    HashMap map = {0};
+    CHECK(hashmap_reserve(&map, 8) == 0);
+    make_colliding_keys(0, 4, SMALL_CAPACITY - 1);
+    make_colliding_keys(4, 2, SMALL_CAPACITY - 2);
+    make_colliding_keys(6, 2, 0);
+    for (size_t i = 0; i < 8; ++i)
+        CHECK(hashmap_put(&map, keys[i], strlen(keys[i]), value_of(i)) == 0);
+    CHECK(runs_are_intact(&map));
+
+    static const size_t order[] = {4, 0, 6, 2, 5, 7, 1, 3};
+    bool removed[8] = {false};
+    for (size_t step = 0; step < 8; ++step)
+    {
+        const size_t victim = order[step];
+        CHECK(hashmap_remove(&map, keys[victim], strlen(keys[victim])) == 1);
+        removed[victim] = true;
+        CHECK(runs_are_intact(&map));
+        CHECK(occupied_slots(&map) == map.count);
+        for (size_t i = 0; i < 8; ++i)
+        {
+            void **found = hashmap_lookup(&map, keys[i], strlen(keys[i]));
+            CHECK(removed[i] ? found == NULL : found != NULL && *found == value_of(i));
+        }
+    }
+    hashmap_free(&map);
+}
+
+static void test_random_operations(void)
+{
+    // Random puts and removes, checked against a plain array.
+    HashMap map = {0};
+    void *expected[RANDOM_KEYS] = {NULL};
+    size_t lengths[RANDOM_KEYS];
+    for (size_t i = 0; i < RANDOM_KEYS; ++i)
+        lengths[i] = make_key(i, "x");
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    size_t live = 0;
+    bool consistent = true;
+    for (size_t step = 0; step < RANDOM_STEPS; ++step)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        const size_t i = (size_t)(state % RANDOM_KEYS);
+        if (state & (1ull << 40))
+        {
+            live += expected[i] == NULL;
+            expected[i] = value_of(step);
+            consistent &= hashmap_put(&map, keys[i], lengths[i], expected[i]) == 0;
+        }
+        else
+        {
+            consistent &= hashmap_remove(&map, keys[i], lengths[i]) == (expected[i] != NULL);
+            live -= expected[i] != NULL;
+            expected[i] = NULL;
+        }
+        consistent &= map.count == live;
+    }
+    CHECK(consistent);
+    CHECK(runs_are_intact(&map));
+    for (size_t i = 0; i < RANDOM_KEYS; ++i)
+    {
+        void **found = hashmap_lookup(&map, keys[i], lengths[i]);
+        CHECK(expected[i] == NULL ? found == NULL : found != NULL && *found == expected[i]);
+    }
+    hashmap_free(&map);
+}
+
+// --- Main ---
+
+int main(void)
+{
+    RUN(test_put_lookup_replace);
+    RUN(test_empty_key_and_binary_keys);
+    RUN(test_reserve_avoids_growth);
+    RUN(test_backward_shift_under_collisions);
+    RUN(test_backward_shift_across_the_end);
+    RUN(test_random_operations);
+    return test_finish("hashmap");
+}
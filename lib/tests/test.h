@@ -0,0 +1,59 @@
+/*******************************************************************************
+ * @file test.h
+ * @brief A minimal harness for the runtime library's unit tests.
+ *
+ * Each module has one test program, lib/tests/<module>.c, built and run by
+ * `make test`. A program is a list of test functions run with RUN(); CHECK()
+ * records a failure with its file and line and carries on, so one run
+ * reports every broken expectation. The program exits non-zero if any
+ * check failed.
+ *
+ ******************************************************************************/
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// --- Globals ---
+
+static int test_checks;
+static int test_failures;
+
+// --- Checks ---
+
+#define CHECK(condition) test_check((condition) != 0, #condition, __FILE__, __LINE__)
+
+static inline void test_check(int ok, const char *expression, const char *file, int line)
+{
+    test_checks++;
+    if (!ok)
+    {
+        test_failures++;
+        fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+    }
+}
+
+// --- Running ---
+
+#define RUN(test) test_run(#test, test)
+
+static inline void test_run(const char *name, void (*test)(void))
+{
+    const int failures = test_failures;
+    test();
+    printf("  %-44s %s\n", name, test_failures == failures ? "ok" : "FAILED");
+}
+
+/**
+ * @brief Prints the summary line for `module`.
+ * @return The program's exit status.
+ */
+static inline int test_finish(const char *module)
+{
+    printf("%s: %d checks, %d failed\n", module, test_checks, test_failures);
+    return test_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif // TEST_H
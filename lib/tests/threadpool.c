@@ -0,0 +1,178 @@
+/*******************************************************************************
+ * @file threadpool.c
+ * @brief Unit tests for the work-stealing thread pool.
+ *
+ * The stealing test pins a task to one worker and has it queue more work
+ * on its own queue while it stays busy, so the work can only finish if
+ * another worker steals it. Waits on other threads are bounded so that a
+ * broken pool fails the test instead of hanging it.
+ *
+ ******************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L // For nanosleep
+
+#include "threadpool.h"
+#include "test.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <time.h>
+
+// --- Constants ---
+
+#define TASK_COUNT 10000
+#define INNER_TASKS 64
+#define QUEUED_TASKS 100
+#define MAX_WORKERS 64
+#define WAIT_LIMIT_MS 5000
+
+// --- Globals ---
+
+static atomic_int counter;
+static atomic_int bad_index;
+static atomic_int inits[MAX_WORKERS];
+static atomic_int inner_done;
+static atomic_int inner_on_outer_worker;
+static atomic_int outer_worker;
+static ThreadPool *shared_pool;
+
+// --- Helpers ---
+
+static void sleep_ms(long ms)
+{
+    const struct timespec delay = {ms / 1000, (ms % 1000) * 1000000L};
+    nanosleep(&delay, NULL);
+}
+
+static void count_task(void *arg)
+{
+    atomic_fetch_add(&counter, (int)(long)arg);
+    const int index = pool_worker_index();
+    if (index < 0 || index >= pool_worker_count(shared_pool))
+        atomic_store(&bad_index, 1);
+}
+
+static void record_init(int worker_index, void *context)
+{
+    if (worker_index >= 0 && worker_index < MAX_WORKERS)
+        atomic_fetch_add(&inits[worker_index], 1);
+    atomic_fetch_add((atomic_int *)context, 1);
+}
+
+static void inner_task(void *arg)
+{
+    (void)arg;
+    if (pool_worker_index() == atomic_load(&outer_worker))
+        atomic_fetch_add(&inner_on_outer_worker, 1);
+    atomic_fetch_add(&inner_done, 1);
+}
+
+/**
+ * @brief Queues INNER_TASKS on its own worker's queue, then stays busy
+ * until they are done or WAIT_LIMIT_MS passes.
+ */
+static void outer_task(void *arg)
+{
+    (void)arg;
+    atomic_store(&outer_worker, pool_worker_index());
+    for (int i = 0; i < INNER_TASKS; ++i)
+        pool_submit(shared_pool, inner_task, NULL);
+    for (int waited = 0; atomic_load(&inner_done) < INNER_TASKS && waited < WAIT_LIMIT_MS; ++waited)
+        sleep_ms(1);
+}
+
+static void slow_task(void *arg)
+{
+    sleep_ms((long)arg);
+    atomic_fetch_add(&counter, 1);
+}
+
+// --- Tests ---
+
+static void test_submit_and_wait(void)
+{
+    atomic_store(&counter, 0);
+    atomic_store(&bad_index, 0);
+    shared_pool = pool_create(4);
+    CHECK(shared_pool != NULL);
+    CHECK(pool_worker_count(shared_pool) == 4);
+    long expected = 0;
+    for (long i = 1; i <= TASK_COUNT; ++i)
+    {
+        CHECK(pool_submit(shared_pool, count_task, (void *)(i % 7)) == 0);
+        expected += i % 7;
+    }
+    pool_wait(shared_pool);
+    CHECK(atomic_load(&counter) == expected);
+    CHECK(atomic_load(&bad_index) == 0);
+
+    // The pool can be reused after a wait.
+    CHECK(pool_submit(shared_pool, count_task, (void *)1) == 0);
+    pool_wait(shared_pool);
+    CHECK(atomic_load(&counter) == expected + 1);
+    pool_destroy(shared_pool);
+    CHECK(pool_worker_index() == -1);
+}
+
+static void test_worker_init(void)
+{
+    atomic_int total = 0;
+    for (int i = 0; i < MAX_WORKERS; ++i)
+        atomic_store(&inits[i], 0);
+    ThreadPool *pool = pool_create_with_init(3, record_init, &total);
+    CHECK(pool != NULL);
+    pool_wait(pool);
+    pool_destroy(pool);
+    CHECK(atomic_load(&total) == 3);
+    for (int i = 0; i < 3; ++i)
+        CHECK(atomic_load(&inits[i]) == 1);
+}
+
+static void test_stealing(void)
+{
+    atomic_store(&inner_done, 0);
+    atomic_store(&inner_on_outer_worker, 0);
+    atomic_store(&outer_worker, -1);
+    shared_pool = pool_create(2);
+    CHECK(shared_pool != NULL);
+    CHECK(pool_submit(shared_pool, outer_task, NULL) == 0);
+    pool_wait(shared_pool);
+    CHECK(atomic_load(&inner_done) == INNER_TASKS);
+    CHECK(atomic_load(&inner_on_outer_worker) == 0); // All were stolen
+    pool_destroy(shared_pool);
+}
+
+static void test_destroy_runs_queued_tasks(void)
+{
+    // One worker is held up by the first task while the rest queue behind it.
+    atomic_store(&counter, 0);
+    ThreadPool *pool = pool_create(1);
+    CHECK(pool != NULL);
+    CHECK(pool_submit(pool, slow_task, (void *)50L) == 0);
+    for (int i = 0; i < QUEUED_TASKS; ++i)
+        CHECK(pool_submit(pool, slow_task, (void *)0L) == 0);
+    pool_destroy(pool);
+    CHECK(atomic_load(&counter) == QUEUED_TASKS + 1);
+}
+
+static void test_defaults(void)
+{
+    ThreadPool *pool = pool_create(0);
+    CHECK(pool != NULL);
+    CHECK(pool_worker_count(pool) >= 1);
+    pool_wait(pool); // Nothing submitted: returns at once
+    pool_destroy(pool);
+    pool_destroy(NULL);
+}
+
+// --- Main ---
+
+int main(void)
+{
+    RUN(test_submit_and_wait);
+    RUN(test_worker_init);
+    RUN(test_stealing);
+    RUN(test_destroy_runs_queued_tasks);
+    RUN(test_defaults);
+    return test_finish("threadpool");
+}
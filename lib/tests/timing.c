@@ -0,0 +1,63 @@
+/*******************************************************************************
+ * @file timing.c
+ * @brief Unit tests for the monotonic clocks and stopwatch.
+ ******************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L // For nanosleep
+
+#include "timing.h"
+#include "test.h"
+
+#include <stdbool.h>
+#include <time.h>
+
+// --- Constants ---
+
+#define SLEEP_NS 20000000L // 20 ms
+#define READINGS 100000
+
+// --- Tests ---
+
+static void test_monotonic(void)
+{
+    bool monotonic = true;
+    uint64_t previous = timing_now_ns();
+    for (int i = 0; i < READINGS; ++i)
+    {
+        const uint64_t now = timing_now_ns();
+        monotonic &= now >= previous;
+        previous = now;
+    }
+    CHECK(monotonic);
+
+    // The two clocks agree to well within a second.
+    const double seconds = timing_now();
+    const double from_ns = (double)timing_now_ns() / 1e9;
+    CHECK(from_ns >= seconds && from_ns - seconds < 1.0);
+}
+
+static void test_stopwatch(void)
+{
+    Stopwatch stopwatch;
+    stopwatch_start(&stopwatch);
+    const struct timespec delay = {0, SLEEP_NS};
+    nanosleep(&delay, NULL);
+    const uint64_t ns = stopwatch_elapsed_ns(&stopwatch);
+    const double seconds = stopwatch_elapsed(&stopwatch);
+    CHECK(ns >= (uint64_t)SLEEP_NS);
+    CHECK(ns < 100 * (uint64_t)SLEEP_NS); // Generous for loaded machines
+    CHECK(seconds >= (double)ns / 1e9);
+
+    // Restarting resets the origin.
+    stopwatch_start(&stopwatch);
+    CHECK(stopwatch_elapsed_ns(&stopwatch) < ns);
+}
+
+// --- Main ---
+
+int main(void)
+{
+    RUN(test_monotonic);
+    RUN(test_stopwatch);
+    return test_finish("timing");
+}
@@ -0,0 +1,91 @@
+/*******************************************************************************
+ * @file vector.c
+ * @brief Unit tests for the growable array.
+ ******************************************************************************/
+
+#include "vector.h"
+#include "test.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+// --- Constants and Type Definitions ---
+
+#define ELEMENTS 10000
+
+typedef struct
+{
+    int id;
+    char name[12];
+    double score;
+} Record;
+
+// --- Tests ---
+
+static void test_push_and_at(void)
+{
+    Vector vector = VECTOR_INIT(int);
+    CHECK(vector.length == 0 && vector.capacity == 0 && vector.element_size == sizeof(int));
+    for (int i = 0; i < ELEMENTS; ++i)
+    {
+        int *slot = vector_push(&vector);
+        CHECK(slot != NULL);
+        *slot = i * 3;
+    }
+    CHECK(vector.length == ELEMENTS);
+    CHECK(vector.capacity >= ELEMENTS);
+    bool matches = true;
+    for (int i = 0; i < ELEMENTS; ++i)
+        matches &= *(int *)vector_at(&vector, (size_t)i) == i * 3;
+    CHECK(matches);
+    CHECK(((int *)vector.data)[17] == 51);
+    vector_free(&vector);
+    CHECK(vector.data == NULL && vector.length == 0 && vector.capacity == 0);
+    CHECK(vector.element_size == sizeof(int)); // Reusable after free
+}
+
+static void test_append_structs(void)
+{
+    Vector vector;
+    vector_init(&vector, sizeof(Record));
+    for (int i = 0; i < 100; ++i)
+    {
+        Record record = {i, "", i / 2.0};
+        snprintf(record.name, sizeof(record.name), "r%d", i);
+        CHECK(vector_append(&vector, &record) == 0);
+    }
+    const Record *last = vector_at(&vector, 99);
+    CHECK(last->id == 99 && strcmp(last->name, "r99") == 0 && last->score == 49.5);
+    vector_free(&vector);
+}
+
+static void test_reserve_and_clear(void)
+{
+    Vector vector = VECTOR_INIT(double);
+    CHECK(vector_reserve(&vector, ELEMENTS) == 0);
+    CHECK(vector.capacity >= ELEMENTS && vector.length == 0);
+    void *data = vector.data;
+    for (int i = 0; i < ELEMENTS; ++i)
+    {
+        const double value = i;
+        vector_append(&vector, &value);
+    }
+    CHECK(vector.data == data); // No reallocation within the reservation
+    CHECK(vector_reserve(&vector, 10) == 0);
+    CHECK(vector.data == data && vector.length == ELEMENTS); // Never shrinks
+
+    const size_t capacity = vector.capacity;
+    vector_clear(&vector);
+    CHECK(vector.length == 0 && vector.capacity == capacity && vector.data == data);
+    vector_free(&vector);
+}
+
+// --- Main ---
+
+int main(void)
+{
+    RUN(test_push_and_at);
+    RUN(test_append_structs);
+    RUN(test_reserve_and_clear);
+    return test_finish("vector");
+}